@@ -13,8 +13,9 @@
 
 namespace MiscLib
 {
-	extern size_t rn_buf[];
-	extern size_t rn_point;
+	// Liangliang: the state of the generator is per thread, so that detectors can run on different threads
+	extern thread_local size_t rn_buf[];
+	extern thread_local size_t rn_point;
 	void rn_setseed(size_t);
 	size_t rn_refresh(void);
 	inline size_t rn_rand()
@@ -41,7 +41,7 @@
 
 static std::vector<std::string> key_words = {
         "v:point", "v:connectivity", "v:deleted", "v:normal", "f:normal",
-        "f:connectivity", "f:deleted", "f:triangle_range",
+        "f:connectivity", "f:deleted", "f:triangle_range", "m:triangulation",
         "e:deleted", "h:connectivity"
 };
 
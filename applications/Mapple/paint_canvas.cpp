@@ -52,6 +52,7 @@
 #include <easy3d/renderer/texture_manager.h>
 #include <easy3d/renderer/text_renderer.h>
 #include <easy3d/renderer/buffers.h>
+#include <easy3d/renderer/buffers_async.h>
 #include <easy3d/fileio/resources.h>
 #include <easy3d/util/logging.h>
 #include <easy3d/util/file_system.h>
@@ -119,6 +120,11 @@ PaintCanvas::~PaintCanvas() {
 
 
 void PaintCanvas::cleanup() {
+    qApp->removeEventFilter(this);
+    // the buffers being prepared refer to the models
+    buffers::AsyncUpdater::terminate();
+    buffers::AsyncUpdater::set_ready_callback(nullptr);
+
     for (auto m : models_) {
         delete m->renderer();
         delete m;
@@ -196,6 +202,16 @@ void PaintCanvas::initializeGL() {
     texter_->add_font(resource::directory() + "/fonts/en_Earth-Normal.ttf");
     texter_->add_font(resource::directory() + "/fonts/en_Roboto-Medium.ttf");
 
+    // the buffers of large models are prepared in a worker thread, so the UI does not freeze after an operation
+    buffers::AsyncUpdater::set_enabled(true);
+    buffers::AsyncUpdater::set_ready_callback([this]() {
+        QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+    });
+    qApp->installEventFilter(this);
+
+    // the shader programs are built from their binaries cached by the previous runs
+    ShaderManager::set_cache_directory(file_system::home_directory() + "/.easy3d/shader_cache");
+
     timer_.start();
 
     // Calls user defined method.
@@ -239,6 +255,8 @@ void PaintCanvas::mousePressEvent(QMouseEvent *e) {
             bt = tools::MIDDLE_BUTTON;
         if (bt != tools::NO_BUTTON) {
             makeCurrent();
+            // the tools pick (and may modify) the models, which must match the buffers being rendered
+            buffers::AsyncUpdater::finish();
             tool_manager()->press(bt, e->pos().x(), e->pos().y());
             doneCurrent();
         }
@@ -289,6 +307,7 @@ void PaintCanvas::mouseReleaseEvent(QMouseEvent *e) {
             bt = tools::MIDDLE_BUTTON;
         if (bt != tools::NO_BUTTON) {
             makeCurrent();
+            buffers::AsyncUpdater::finish();
             tool_manager()->release(bt, e->pos().x(), e->pos().y());
             doneCurrent();
         }
@@ -359,6 +378,7 @@ void PaintCanvas::mouseMoveEvent(QMouseEvent *e) {
             bt = tools::MIDDLE_BUTTON;
 
         makeCurrent();
+        buffers::AsyncUpdater::finish();
         tool_manager()->drag(bt, e->pos().x(), e->pos().y());
         doneCurrent();
     }
@@ -738,6 +758,21 @@ void PaintCanvas::closeEvent(QCloseEvent *e) {
 }
 
 
+bool PaintCanvas::eventFilter(QObject *obj, QEvent *e) {
+    // the mouse presses on the canvas navigate the camera, or are handled by the tools (see mousePressEvent())
+    const bool input = e->type() == QEvent::Shortcut ||
+                       (obj->isWidgetType() &&
+                        (e->type() == QEvent::KeyPress || (obj != this && e->type() == QEvent::MouseButtonPress)));
+    if (input && buffers::AsyncUpdater::num_pending() + buffers::AsyncUpdater::num_ready() > 0) {
+        makeCurrent();
+        buffers::AsyncUpdater::finish();
+        doneCurrent();
+        update();
+    }
+    return QOpenGLWidget::eventFilter(obj, e);
+}
+
+
 std::string PaintCanvas::usage() const {
     return std::string(
             " ------------------------------------------------------------------\n"
@@ -1030,6 +1065,11 @@ void PaintCanvas::preDraw() {
     // If you want to reuse the paintGL() method for offscreen rendering,
     // you have to clear both color and depth buffers beforehand.
     //func_->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    // the buffers prepared asynchronously are uploaded within the time budget of a frame, the rest in the next
+    buffers::AsyncUpdater::upload();
+    if (buffers::AsyncUpdater::num_ready() > 0)
+        update();
 }
 
 
@@ -203,6 +203,12 @@ protected:
     virtual void timerEvent(QTimerEvent *) override;
     virtual void closeEvent(QCloseEvent *) override;
 
+    // The buffers of the drawables are prepared in a worker thread (see buffers::AsyncUpdater), and the models must
+    // not be modified meanwhile. The pending jobs are finished before processing the input that may modify the models
+    // or pick them, i.e., the input outside the canvas, the key presses, and the input handled by the tools (the
+    // camera can still be navigated meanwhile).
+    virtual bool eventFilter(QObject *, QEvent *) override;
+
 protected:
     void drawCornerAxes();
 
@@ -40,6 +40,7 @@
 
 #include <easy3d/renderer/camera.h>
 #include <easy3d/renderer/transform.h>
+#include <easy3d/renderer/buffers_async.h>
 #include <easy3d/util/logging.h>
 #include <easy3d/util/progress.h>
 
@@ -108,6 +109,11 @@ bool PaintCanvas::saveSnapshot(int w, int h, int samples, const QString &file_na
 
     makeCurrent();
 
+    // the snapshot shows the current state of the models: the buffers are not updated asynchronously
+    const bool async_update = buffers::AsyncUpdater::is_enabled();
+    buffers::AsyncUpdater::finish();
+    buffers::AsyncUpdater::set_enabled(false);
+
 #ifdef USE_QT_FBO
     QOpenGLFramebufferObjectFormat format;
     format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
@@ -186,6 +192,7 @@ bool PaintCanvas::saveSnapshot(int w, int h, int samples, const QString &file_na
     }
 
     delete fbo;
+    buffers::AsyncUpdater::set_enabled(async_update);
 
     // restore the projection matrix
     camera()->set_projection_matrix(proj_matrix);
@@ -0,0 +1,340 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <easy3d/algo/batch_triangulator.h>
+#include <easy3d/algo/tessellator.h>
+
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+namespace easy3d {
+
+    namespace details {
+
+        // polygons with more corners are not ear clipped (ear clipping is quadratic in the number of corners)
+        const int max_ear_clipping_size = 64;
+
+        // the scratch data of a thread, reused for all the polygons processed by the thread
+        struct Workspace {
+            std::vector<double> x, y;       // the projected corners
+            std::vector<int> prev, next;    // the remaining corners during ear clipping
+            Tessellator tessellator;
+        };
+
+
+        // projects a polygon onto the coordinate plane best aligned with its Newell normal. The projection is
+        // mirrored if necessary such that the polygon is counterclockwise in 2D. Returns false if the polygon is
+        // degenerate (i.e., its normal vanishes).
+        inline bool project(const std::vector<vec3> &points, const unsigned int *ids, int n, Workspace &ws,
+                            vec3 &normal) {
+            double nx = 0.0, ny = 0.0, nz = 0.0;
+            for (int i = 0, j = n - 1; i < n; j = i++) {
+                const vec3 &p = points[ids[j]];
+                const vec3 &q = points[ids[i]];
+                nx += (double(p.y) - q.y) * (double(p.z) + q.z);
+                ny += (double(p.z) - q.z) * (double(p.x) + q.x);
+                nz += (double(p.x) - q.x) * (double(p.y) + q.y);
+            }
+            const double n2[3] = {std::abs(nx), std::abs(ny), std::abs(nz)};
+            const int k = (n2[0] > n2[1]) ? (n2[0] > n2[2] ? 0 : 2) : (n2[1] > n2[2] ? 1 : 2);
+            if (n2[k] <= 0.0)
+                return false;
+
+            normal = vec3(static_cast<float>(nx), static_cast<float>(ny), static_cast<float>(nz));
+            const double sign = ((k == 0 ? nx : (k == 1 ? ny : nz)) > 0.0) ? 1.0 : -1.0;
+            const int a = (k + 1) % 3;
+            const int b = (k + 2) % 3;
+            ws.x.resize(n);
+            ws.y.resize(n);
+            for (int i = 0; i < n; ++i) {
+                const vec3 &p = points[ids[i]];
+                ws.x[i] = p[a];
+                ws.y[i] = p[b] * sign;
+            }
+            return true;
+        }
+
+
+        // twice the signed area of the projected triangle (i, j, k)
+        inline double orientation(const Workspace &ws, int i, int j, int k) {
+            return (ws.x[j] - ws.x[i]) * (ws.y[k] - ws.y[i]) - (ws.y[j] - ws.y[i]) * (ws.x[k] - ws.x[i]);
+        }
+
+
+        // returns a strictly convex corner to start a fan from if the projected polygon is convex, and -1 otherwise.
+        inline int convex_apex(const Workspace &ws, int n) {
+            int apex = -1;
+            int x_flips = 0, y_flips = 0;
+            double last_dx = 0.0, last_dy = 0.0;
+            for (int i = 0; i < n; ++i) {
+                const int p = (i + n - 1) % n;
+                const int q = (i + 1) % n;
+                const double o = orientation(ws, p, i, q);
+                if (o < 0.0)
+                    return -1;
+                if (o > 0.0 && apex < 0)
+                    apex = i;
+
+                // a convex polygon changes its direction at most twice along each axis (this rejects polygons
+                // winding more than once, e.g., pentagrams)
+                const double dx = ws.x[q] - ws.x[i];
+                const double dy = ws.y[q] - ws.y[i];
+                if (dx != 0.0) {
+                    if (dx * last_dx < 0.0) ++x_flips;
+                    last_dx = dx;
+                }
+                if (dy != 0.0) {
+                    if (dy * last_dy < 0.0) ++y_flips;
+                    last_dy = dy;
+                }
+            }
+            if (x_flips > 2 || y_flips > 2)
+                return -1;
+            return apex;
+        }
+
+
+        // is corner i (with its remaining neighbors p and q) an ear?
+        inline bool is_ear(const Workspace &ws, int p, int i, int q) {
+            if (orientation(ws, p, i, q) <= 0.0)
+                return false;
+            for (int j = ws.next[q]; j != p; j = ws.next[j]) {
+                // corners coinciding with the triangle's corners do not block it
+                if ((ws.x[j] == ws.x[p] && ws.y[j] == ws.y[p]) ||
+                    (ws.x[j] == ws.x[i] && ws.y[j] == ws.y[i]) ||
+                    (ws.x[j] == ws.x[q] && ws.y[j] == ws.y[q]))
+                    continue;
+                if (orientation(ws, p, i, j) >= 0.0 && orientation(ws, i, q, j) >= 0.0 &&
+                    orientation(ws, q, p, j) >= 0.0)
+                    return false;
+            }
+            return true;
+        }
+
+
+        // triangulates a projected simple polygon by ear clipping. Returns false if no ear can be found (i.e., the
+        // polygon is not simple), in which case the content appended to 'triangles' is incomplete.
+        inline bool ear_clip(Workspace &ws, const unsigned int *ids, int n, std::vector<unsigned int> &triangles) {
+            ws.prev.resize(n);
+            ws.next.resize(n);
+            for (int i = 0; i < n; ++i) {
+                ws.prev[i] = (i + n - 1) % n;
+                ws.next[i] = (i + 1) % n;
+            }
+
+            int i = 0;
+            int remaining = n;
+            int stall = 0;
+            while (remaining > 3) {
+                const int p = ws.prev[i];
+                const int q = ws.next[i];
+                if (is_ear(ws, p, i, q)) {
+                    triangles.push_back(ids[p]);
+                    triangles.push_back(ids[i]);
+                    triangles.push_back(ids[q]);
+                    ws.next[p] = q;
+                    ws.prev[q] = p;
+                    --remaining;
+                    stall = 0;
+                    i = q;
+                } else {
+                    if (++stall > remaining)
+                        return false;
+                    i = q;
+                }
+            }
+            triangles.push_back(ids[ws.prev[i]]);
+            triangles.push_back(ids[i]);
+            triangles.push_back(ids[ws.next[i]]);
+            return true;
+        }
+
+
+        // triangulates a polygon using the tessellator. Returns false if the tessellator introduces new vertices,
+        // in which case the content appended to 'triangles' is incomplete.
+        inline bool tessellate(Workspace &ws, const std::vector<vec3> &points, const unsigned int *ids, int n,
+                               const vec3 &normal, std::vector<unsigned int> &triangles) {
+            Tessellator &tessellator = ws.tessellator;
+            tessellator.reset();
+            tessellator.begin_polygon(normal);
+            tessellator.set_winding_rule(Tessellator::WINDING_NONZERO);
+            tessellator.begin_contour();
+            for (int i = 0; i < n; ++i) {
+                Tessellator::Vertex vertex(points[ids[i]], i);
+                vertex.push_back(i);    // keep coincident corners apart
+                tessellator.add_vertex(vertex);
+            }
+            tessellator.end_contour();
+            tessellator.end_polygon();
+
+            const std::vector<Tessellator::Vertex *> &vertices = tessellator.vertices();
+            for (const auto &element : tessellator.elements()) {
+                if (element.size() != 3)
+                    continue;
+                for (auto id : element) {
+                    const int corner = vertices[id]->index;
+                    if (corner < 0)
+                        return false;
+                    triangles.push_back(ids[corner]);
+                }
+            }
+            return true;
+        }
+
+    }
+
+
+    std::size_t BatchTriangulator::triangulate(
+            const std::vector<vec3> &points,
+            const std::vector<unsigned int> &offsets,
+            const std::vector<unsigned int> &indices,
+            std::vector<unsigned int> &triangles,
+            std::vector<unsigned int> &triangle_offsets
+    ) {
+        triangles.clear();
+        triangle_offsets.assign(offsets.size(), 0);
+        if (offsets.size() < 2)
+            return 0;
+
+        const int num = static_cast<int>(offsets.size() - 1);
+
+        // The triangles of convex polygons (fans) are generated directly into the result. The triangles of the other
+        // polygons are computed in the first pass and stored in the buffer of the thread that computed them.
+        std::vector<int> source(num, -1);       // -1: fan; otherwise: the thread holding the triangles
+        std::vector<unsigned int> start(num, 0);    // fan: the apex; otherwise: the offset in the thread's buffer
+
+        int num_threads = 1;
+#ifdef _OPENMP
+        num_threads = omp_get_max_threads();
+#endif
+        std::vector< std::vector<unsigned int> > buffers(num_threads);
+
+        // pass 1: count the triangles of each polygon
+#pragma omp parallel num_threads(num_threads)
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            details::Workspace ws;
+            std::vector<unsigned int> &buffer = buffers[tid];
+
+#pragma omp for schedule(dynamic, 1024)
+            for (int i = 0; i < num; ++i) {
+                const unsigned int *ids = indices.data() + offsets[i];
+                const int n = static_cast<int>(offsets[i + 1] - offsets[i]);
+                triangle_offsets[i + 1] = (n < 3) ? 0 : n - 2;
+                if (n <= 3)
+                    continue;
+
+                vec3 normal;
+                if (!details::project(points, ids, n, ws, normal))
+                    continue;   // degenerate: a fan is as good as anything else
+
+                const int apex = details::convex_apex(ws, n);
+                if (apex >= 0) {
+                    start[i] = apex;
+                    continue;
+                }
+
+                const std::size_t begin = buffer.size();
+                if (n > details::max_ear_clipping_size || !details::ear_clip(ws, ids, n, buffer)) {
+                    buffer.resize(begin);
+                    if (!details::tessellate(ws, points, ids, n, normal, buffer)) {
+                        buffer.resize(begin);
+                        continue;   // self-intersecting: fall back to a fan
+                    }
+                }
+                source[i] = tid;
+                start[i] = static_cast<unsigned int>(begin);
+                triangle_offsets[i + 1] = static_cast<unsigned int>((buffer.size() - begin) / 3);
+            }
+        }
+
+        for (int i = 0; i < num; ++i)
+            triangle_offsets[i + 1] += triangle_offsets[i];
+        const std::size_t num_triangles = triangle_offsets[num];
+
+        // pass 2: write the triangles into their final places
+        triangles.resize(num_triangles * 3);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < num; ++i) {
+            unsigned int *out = triangles.data() + 3 * static_cast<std::size_t>(triangle_offsets[i]);
+            const unsigned int count = triangle_offsets[i + 1] - triangle_offsets[i];
+            if (source[i] >= 0) {
+                const unsigned int *in = buffers[source[i]].data() + start[i];
+                std::copy(in, in + count * 3, out);
+            } else {
+                const unsigned int *ids = indices.data() + offsets[i];
+                const unsigned int n = offsets[i + 1] - offsets[i];
+                const unsigned int apex = start[i];
+                for (unsigned int k = 1; k <= count; ++k) {
+                    *out++ = ids[apex];
+                    *out++ = ids[(apex + k) % n];
+                    *out++ = ids[(apex + k + 1) % n];
+                }
+            }
+        }
+
+        return num_triangles;
+    }
+
+
+    std::size_t BatchTriangulator::triangulate(
+            const SurfaceMesh *mesh,
+            std::vector<unsigned int> &triangles,
+            std::vector<unsigned int> &triangle_offsets
+    ) {
+        // collect the faces in the compressed form
+        const int num = static_cast<int>(mesh->faces_size());
+        std::vector<unsigned int> offsets(num + 1, 0);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const SurfaceMesh::Face f(i);
+            offsets[i + 1] = mesh->is_deleted(f) ? 0 : mesh->valence(f);
+        }
+        for (int i = 0; i < num; ++i)
+            offsets[i + 1] += offsets[i];
+
+        std::vector<unsigned int> indices(offsets[num]);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const SurfaceMesh::Face f(i);
+            if (mesh->is_deleted(f))
+                continue;
+            unsigned int *out = indices.data() + offsets[i];
+            for (auto v : mesh->vertices(f))
+                *out++ = v.idx();
+        }
+
+        return triangulate(mesh->points(), offsets, indices, triangles, triangle_offsets);
+    }
+
+}
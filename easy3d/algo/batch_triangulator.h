@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_ALGO_BATCH_TRIANGULATOR_H
+#define EASY3D_ALGO_BATCH_TRIANGULATOR_H
+
+
+#include <easy3d/core/surface_mesh.h>
+
+#include <vector>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Triangulates a large number of polygons in one go.
+     * \details The polygons are triangulated in parallel and the resulting triangles are written directly into a
+     * single index array. Each polygon is projected onto the plane perpendicular to its (Newell) normal and then
+     *  - triangles are copied;
+     *  - convex polygons are triangulated as a fan around a strictly convex corner;
+     *  - other simple polygons are triangulated by ear clipping;
+     *  - the rest (e.g., self-intersecting or very large polygons) are handed over to a Tessellator. Each thread
+     *    owns one Tessellator and reuses it for all the polygons it processes.
+     * All triangles are oriented consistently with their polygons and refer to the input vertices only. If the
+     * Tessellator would introduce new vertices (i.e., the polygon self-intersects), the polygon is triangulated as a
+     * fan instead.
+     * \sa Tessellator, SurfaceMeshTriangulation.
+     */
+    class BatchTriangulator {
+    public:
+        /**
+         * \brief Triangulates a set of polygons given in compressed form.
+         * @param points The vertex positions.
+         * @param offsets The polygon offsets (with a size of the number of polygons + 1). The i-th polygon consists
+         *      of the vertices \c indices[offsets[i]], ..., \c indices[offsets[i+1] - 1].
+         * @param indices The vertex indices of all the polygons.
+         * @param triangles Returns the vertex indices of the triangles (3 per triangle).
+         * @param triangle_offsets Returns the triangle offsets (with the same size as \p offsets). The i-th polygon
+         *      is covered by the triangles in the range [triangle_offsets[i], triangle_offsets[i+1]).
+         * @return The number of triangles.
+         */
+        static std::size_t triangulate(
+                const std::vector<vec3> &points,
+                const std::vector<unsigned int> &offsets,
+                const std::vector<unsigned int> &indices,
+                std::vector<unsigned int> &triangles,
+                std::vector<unsigned int> &triangle_offsets
+        );
+
+        /**
+         * \brief Triangulates all the faces of a surface mesh. The mesh is not modified.
+         * @param mesh The surface mesh.
+         * @param triangles Returns the vertex indices of the triangles (3 per triangle).
+         * @param triangle_offsets Returns the triangle offsets (with a size of \c mesh->faces_size() + 1). The face
+         *      \c f is covered by the triangles in the range [triangle_offsets[f.idx()], triangle_offsets[f.idx()+1]).
+         *      Deleted faces have empty ranges.
+         * @return The number of triangles.
+         */
+        static std::size_t triangulate(
+                const SurfaceMesh *mesh,
+                std::vector<unsigned int> &triangles,
+                std::vector<unsigned int> &triangle_offsets
+        );
+    };
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_BATCH_TRIANGULATOR_H
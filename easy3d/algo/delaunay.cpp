@@ -26,6 +26,8 @@
 #include <easy3d/algo/delaunay.h>
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <fstream>
 #include <string>
 
@@ -54,6 +56,9 @@ namespace easy3d {
         cell_to_v_ = nullptr;
         cell_to_cell_ = nullptr;
         is_locked_ = false;
+        grid_res_[0] = grid_res_[1] = grid_res_[2] = 0;
+        grid_min_[0] = grid_min_[1] = grid_min_[2] = 0.0f;
+        grid_cell_size_ = 1.0f;
     }
 
 
@@ -80,26 +85,248 @@ namespace easy3d {
             if (dimension() >= 6) {
                 update_neighbors();
             }
+            update_grid();
         }
     }
 
 
-    unsigned int Delaunay::nearest_vertex(const float *p) const {
-        // Unefficient implementation (but at least it works).
-        std::cerr << "TODO: replace with line walk (or maybe we could use kd-tree here)" << std::endl;
+    unsigned int Delaunay::nearest_vertex(const float *p, int hint) const {
         assert(nb_vertices() > 0);
-        unsigned int result = 0;
-        float d = squared_distance(dimension(), vertex_ptr(0), p);
-        for (unsigned int i = 1; i < nb_vertices(); i++) {
-            float cur_d = squared_distance(dimension(), vertex_ptr(i), p);
-            if (cur_d < d) {
-                d = cur_d;
-                result = i;
+        int v = hint;
+        if (v < 0 || v >= static_cast<int>(nb_vertices()) || v_to_cell_.empty() || v_to_cell_[v] == -1)
+            v = seed_vertex(p);
+        if (v < 0) { // no triangulation: linear scan
+            unsigned int result = 0;
+            float d = squared_distance(dimension(), vertex_ptr(0), p);
+            for (unsigned int i = 1; i < nb_vertices(); i++) {
+                float cur_d = squared_distance(dimension(), vertex_ptr(i), p);
+                if (cur_d < d) {
+                    d = cur_d;
+                    result = i;
+                }
             }
+            return result;
+        }
+
+        // Greedy walk in the Delaunay graph: if none of the neighbors of a vertex is closer to p than the vertex
+        // itself, the vertex is the nearest one.
+        float d = squared_distance(dimension(), vertex_ptr(v), p);
+        while (true) {
+            int best = v;
+            const int start = v_to_cell_[v];
+            int t = start;
+            do {
+                for (unsigned int lv = 0; lv < cell_size(); ++lv) {
+                    const int w = cell_vertex(t, lv);
+                    const float cur_d = squared_distance(dimension(), vertex_ptr(w), p);
+                    if (cur_d < d) {
+                        d = cur_d;
+                        best = w;
+                    }
+                }
+                t = next_around_vertex(t, index(t, v));
+            } while (t != start);
+            if (best == v)
+                return v;
+            v = best;
+        }
+    }
+
+
+    namespace details {
+
+        // the orientation of the simplex (a, b, c) in 2D and (a, b, c, d) in 3D
+        inline double orient(unsigned int dim, const float *a, const float *b, const float *c, const float *d) {
+            if (dim == 2)
+                return (double(b[0]) - a[0]) * (double(c[1]) - a[1]) - (double(b[1]) - a[1]) * (double(c[0]) - a[0]);
+            const double bx = double(b[0]) - a[0], by = double(b[1]) - a[1], bz = double(b[2]) - a[2];
+            const double cx = double(c[0]) - a[0], cy = double(c[1]) - a[1], cz = double(c[2]) - a[2];
+            const double dx = double(d[0]) - a[0], dy = double(d[1]) - a[1], dz = double(d[2]) - a[2];
+            return bx * (cy * dz - cz * dy) - by * (cx * dz - cz * dx) + bz * (cx * dy - cy * dx);
+        }
+
+    }
+
+
+    int Delaunay::locate(const float *p, int hint) const {
+        if (nb_cells() == 0 || cell_to_cell_ == nullptr)
+            return -1;
+        if (dimension() != 2 && dimension() != 3) {
+            LOG_FIRST_N(WARNING, 1) << "point location is only supported for 2D and 3D triangulations";
+            return -1;
+        }
+
+        int c = hint;
+        if (c < 0 || c >= static_cast<int>(nb_cells())) {
+            const int v = seed_vertex(p);
+            c = v >= 0 ? v_to_cell_[v] : 0;
+            if (c < 0)
+                c = 0;
+        }
+
+        // Visibility walk: move to the neighbor across a facet that separates the cell from p. The facets are
+        // tested starting from a pseudo-random one, which prevents the walk from cycling.
+        unsigned int seed = 0x9E3779B9u;
+        int previous = -1;
+        const float *pts[4];
+        for (unsigned int step = 0; step < nb_cells(); ++step) {
+            for (unsigned int lv = 0; lv < cell_size(); ++lv)
+                pts[lv] = vertex_ptr(cell_vertex(c, lv));
+            const double o = details::orient(dimension(), pts[0], pts[1], pts[2], dimension() == 3 ? pts[3] : nullptr);
+
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            const unsigned int first = seed % cell_size();
+
+            int next = -1;
+            for (unsigned int i = 0; i < cell_size(); ++i) {
+                const unsigned int lf = (first + i) % cell_size();
+                const int neighbor = cell_adjacent(c, lf);
+                if (neighbor == previous && neighbor != -1)
+                    continue; // p cannot be behind the facet we just crossed
+                // replace the vertex opposite to facet lf by p
+                const float *q[4] = {pts[0], pts[1], pts[2], dimension() == 3 ? pts[3] : nullptr};
+                q[lf] = p;
+                const double op = details::orient(dimension(), q[0], q[1], q[2], q[3]);
+                if (op * o < 0) {
+                    if (neighbor == -1)
+                        return -1; // p is outside the convex hull
+                    next = neighbor;
+                    break;
+                }
+            }
+
+            if (next == -1)
+                return c;
+            previous = c;
+            c = next;
+        }
+
+        LOG(WARNING) << "point location did not converge";
+        return -1;
+    }
+
+
+    void Delaunay::nearest_vertices(unsigned int nb_points, const float *points,
+                                    std::vector<unsigned int> &result) const {
+        result.resize(nb_points);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < static_cast<int>(nb_points); ++i)
+            result[i] = nearest_vertex(points + dimension() * i);
+    }
+
+
+    void Delaunay::locate(unsigned int nb_points, const float *points, std::vector<int> &result) const {
+        result.resize(nb_points);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < static_cast<int>(nb_points); ++i)
+            result[i] = locate(points + dimension() * i);
+    }
+
+
+    void Delaunay::update_grid() {
+        grid_.clear();
+        if (dimension() > 3 || nb_vertices() == 0)
+            return;
+
+        float max_corner[3];
+        for (unsigned int i = 0; i < dimension(); ++i) {
+            grid_min_[i] = std::numeric_limits<float>::max();
+            max_corner[i] = -std::numeric_limits<float>::max();
+        }
+        for (unsigned int v = 0; v < nb_vertices(); ++v) {
+            const float *p = vertex_ptr(v);
+            for (unsigned int i = 0; i < dimension(); ++i) {
+                grid_min_[i] = std::min(grid_min_[i], p[i]);
+                max_corner[i] = std::max(max_corner[i], p[i]);
+            }
+        }
+
+        // about 4 vertices per grid cell
+        double volume = 1.0;
+        unsigned int nb_axes = 0;
+        for (unsigned int i = 0; i < dimension(); ++i) {
+            if (max_corner[i] > grid_min_[i]) {
+                volume *= max_corner[i] - grid_min_[i];
+                ++nb_axes;
+            }
+        }
+        const double nb_grid_cells = std::max(1.0, nb_vertices() / 4.0);
+        grid_cell_size_ = nb_axes > 0 ? static_cast<float>(std::pow(volume / nb_grid_cells, 1.0 / nb_axes)) : 1.0f;
+        grid_cell_size_ = std::max(grid_cell_size_, std::numeric_limits<float>::min());
+        std::size_t total = 1;
+        for (unsigned int i = 0; i < 3; ++i) {
+            grid_res_[i] = 1;
+            if (i < dimension() && max_corner[i] > grid_min_[i])
+                grid_res_[i] = std::max(1u, static_cast<unsigned int>(
+                        std::ceil((max_corner[i] - grid_min_[i]) / grid_cell_size_)));
+            total *= grid_res_[i];
+        }
+
+        // each grid cell stores the vertex closest to its center
+        grid_.assign(total, -1);
+        std::vector<float> dist(total, std::numeric_limits<float>::max());
+        for (unsigned int v = 0; v < nb_vertices(); ++v) {
+            if (v_to_cell_[v] == -1)
+                continue; // duplicated vertices are not in the triangulation
+            const float *p = vertex_ptr(v);
+            std::size_t id = 0;
+            float d = 0;
+            for (int i = static_cast<int>(dimension()) - 1; i >= 0; --i) {
+                const float x = (p[i] - grid_min_[i]) / grid_cell_size_;
+                const unsigned int ix = std::min(grid_res_[i] - 1, static_cast<unsigned int>(x));
+                id = id * grid_res_[i] + ix;
+                d += (x - ix - 0.5f) * (x - ix - 0.5f);
+            }
+            if (d < dist[id]) {
+                dist[id] = d;
+                grid_[id] = static_cast<int>(v);
+            }
+        }
+
+        // the empty grid cells inherit the vertex of a nearby non-empty grid cell (breadth first)
+        std::vector<std::size_t> front, next_front;
+        for (std::size_t id = 0; id < total; ++id) {
+            if (grid_[id] != -1)
+                front.push_back(id);
+        }
+        const std::size_t stride[3] = {1, grid_res_[0], std::size_t(grid_res_[0]) * grid_res_[1]};
+        while (!front.empty()) {
+            next_front.clear();
+            for (std::size_t id : front) {
+                std::size_t rest = id;
+                for (unsigned int i = 0; i < dimension(); ++i) {
+                    const unsigned int ix = static_cast<unsigned int>(rest % grid_res_[i]);
+                    rest /= grid_res_[i];
+                    if (ix > 0 && grid_[id - stride[i]] == -1) {
+                        grid_[id - stride[i]] = grid_[id];
+                        next_front.push_back(id - stride[i]);
+                    }
+                    if (ix + 1 < grid_res_[i] && grid_[id + stride[i]] == -1) {
+                        grid_[id + stride[i]] = grid_[id];
+                        next_front.push_back(id + stride[i]);
+                    }
+                }
+            }
+            front.swap(next_front);
         }
-        return result;
     }
 
+
+    int Delaunay::seed_vertex(const float *p) const {
+        if (grid_.empty())
+            return -1;
+        std::size_t id = 0;
+        for (int i = static_cast<int>(dimension()) - 1; i >= 0; --i) {
+            const float x = (p[i] - grid_min_[i]) / grid_cell_size_;
+            const unsigned int ix = x <= 0 ? 0 : std::min(grid_res_[i] - 1, static_cast<unsigned int>(x));
+            id = id * grid_res_[i] + ix;
+        }
+        return grid_[id];
+    }
+
+
     void Delaunay::get_neighbors(unsigned int v, std::vector<unsigned int> &neighbors) const {
         assert(v < nb_vertices());
         if (neighbors_.size() != 0) {
@@ -110,25 +337,13 @@ namespace easy3d {
     }
 
     void Delaunay::update_neighbors() {
-        std::cerr << "update neighbors begin" << std::endl;
         neighbors_.resize(nb_vertices());
 
-        //parallel_for(*this, &Delaunay::store_neighbors, 0, nb_vertices()) ;
-        /**
-         * parallel_for(f, from, to) is equivalent to
-         * the following loop, computed in parallel:
-         * for(unsigned int i=from; i<to; i++) {
-         *    f(i)
-         * }
-         * f may be anything that has an operator()(unsigned int i)
-         */
-
-        for (unsigned int i = 0; i < nb_vertices(); ++i) {
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < static_cast<int>(nb_vertices()); ++i) {
             get_neighbors_internal(i, neighbors_[i]);
         }
 
-        std::cerr << "update neighbors end" << std::endl;
-
         const bool show_stats = false;
         if (show_stats) {
             std::size_t min_N = neighbors_[0].size();
@@ -139,8 +354,7 @@ namespace easy3d {
                 min_N = std::min(min_N, neighbors_[i].size());
                 max_N = std::max(max_N, neighbors_[i].size());
             }
-            std::cerr << "|Ni|: min=" << min_N << " max=" << max_N
-                      << " avg=" << sum / neighbors_.size() << std::endl;
+            LOG(INFO) << "|Ni|: min=" << min_N << " max=" << max_N << " avg=" << sum / neighbors_.size();
 
             std::vector<int> histogram(max_N + 1, 0);
             for (std::size_t i = 0; i < neighbors_.size(); i++) {
@@ -61,7 +61,27 @@ namespace easy3d {
 
         const int *cell_to_cell() const { return cell_to_cell_; }
 
-        virtual unsigned int nearest_vertex(const float *p) const;
+        /**
+         * Returns the index of the vertex nearest to point \p p.
+         * The query starts from a vertex found by a coarse grid and walks along the Delaunay edges towards \p p.
+         * If \p hint is a valid vertex index, the query starts from \p hint (e.g., the result of a nearby query).
+         */
+        virtual unsigned int nearest_vertex(const float *p, int hint = -1) const;
+
+        /**
+         * Returns the index of the cell (triangle in 2D, tetrahedron in 3D) containing point \p p, or -1 if \p p is
+         * outside the convex hull. The cell is found by a visibility walk starting from \p hint if it is a valid
+         * cell index, or from a cell near \p p found by a coarse grid.
+         * \note Only 2D and 3D triangulations are supported.
+         */
+        int locate(const float *p, int hint = -1) const;
+
+        /**
+         * Batched versions of nearest_vertex() and locate(). The queries are processed in parallel.
+         * \param points The coordinates of the \p nb_points query points (\c dimension() values for each point).
+         */
+        void nearest_vertices(unsigned int nb_points, const float *points, std::vector<unsigned int> &result) const;
+        void locate(unsigned int nb_points, const float *points, std::vector<int> &result) const;
 
         // obtaining the index of the 'lv'_th vertex in the 'c'_th cell.
         int cell_vertex(unsigned int c, unsigned int lv) const {
@@ -138,6 +158,12 @@ namespace easy3d {
 
         void update_neighbors();
 
+        // builds the coarse grid used to find the starting vertex of the queries.
+        void update_grid();
+
+        // returns a vertex near \p p (using the coarse grid).
+        int seed_vertex(const float *p) const;
+
         void set_next_around_vertex(
                 unsigned int c1, unsigned int lv, unsigned int c2
         ) {
@@ -161,6 +187,12 @@ namespace easy3d {
         std::vector<int> cicl_;
         std::vector <std::vector<unsigned int>> neighbors_;
         bool is_locked_;
+
+        // a coarse grid storing a vertex (the one closest to the cell center) for each grid cell
+        std::vector<int> grid_;
+        unsigned int grid_res_[3];
+        float grid_min_[3];
+        float grid_cell_size_;
     };
 
 }   // namespace easy3d
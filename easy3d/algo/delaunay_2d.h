@@ -48,12 +48,26 @@ namespace easy3d {
             set_vertices((unsigned int) vertices.size(), &vertices[0].x);
         }
 
-        unsigned int nearest_vertex(const float *p) const {
-            return Delaunay::nearest_vertex(p);
+        unsigned int nearest_vertex(const float *p, int hint = -1) const {
+            return Delaunay::nearest_vertex(p, hint);
         }
 
-        unsigned int nearest_vertex(const vec2 &p) const {
-            return nearest_vertex(p.data());
+        unsigned int nearest_vertex(const vec2 &p, int hint = -1) const {
+            return nearest_vertex(p.data(), hint);
+        }
+
+        // returns the index of the triangle containing \p p, or -1 if \p p is outside the convex hull.
+        int locate(const vec2 &p, int hint = -1) const {
+            return Delaunay::locate(p.data(), hint);
+        }
+
+        // batched (and parallel) nearest vertex and point location queries
+        void nearest_vertices(const std::vector<vec2> &points, std::vector<unsigned int> &result) const {
+            Delaunay::nearest_vertices((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
+        }
+
+        void locate(const std::vector<vec2> &points, std::vector<int> &result) const {
+            Delaunay::locate((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
         }
 
         const vec2 &vertex(unsigned int i) const {
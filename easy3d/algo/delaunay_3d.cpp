@@ -224,4 +224,176 @@ namespace easy3d {
         cell.end_facet();
     }
 
+
+    bool Delaunay3::get_voronoi_facet(
+            unsigned int t, unsigned int lv1, unsigned int lv2, std::vector<int> &vertices
+    ) const {
+        const unsigned int v1 = tet_vertex(t, lv1);
+        const unsigned int v2 = tet_vertex(t, lv2);
+
+        // Start iteration from a tetrahedron incident to the border (see get_voronoi_facet() above)
+        int first = t, prev = 0, next = 0;
+        do {
+            const unsigned int f = next_around_halfedge_[index(first, v2)][index(first, v1)];
+            prev = tet_adjacent(first, f);
+            if (prev == -1)
+                break;
+            first = prev;
+        } while (first != static_cast<int>(t));
+
+        if (prev == -1)
+            vertices.push_back(-1);  // infinite vertex #1
+
+        int cur = first;
+        do {
+            vertices.push_back(cur);
+            next = tet_adjacent(cur, next_around_halfedge_[index(cur, v1)][index(cur, v2)]);
+            if (next == -1)
+                break;
+            cur = next;
+        } while (cur != first);
+
+        if (next == -1)
+            vertices.push_back(-1);  // infinite vertex #2
+
+        return prev != -1;
+    }
+
+
+    void Delaunay3::get_voronoi_cells(VoronoiCells3d &cells, bool geometry) const {
+        std::vector<unsigned int> vertices(nb_vertices());
+        for (unsigned int v = 0; v < nb_vertices(); ++v)
+            vertices[v] = v;
+        get_voronoi_cells(vertices, cells, geometry);
+    }
+
+
+    void Delaunay3::get_voronoi_cells(
+            const std::vector<unsigned int> &vertices, VoronoiCells3d &cells, bool geometry
+    ) const {
+        cells.clear();
+        const int num = static_cast<int>(vertices.size());
+        cells.vertices_ = vertices;
+        cells.bounded_.assign(num, 0);
+        if (geometry) {
+            cells.volume_.assign(num, 0.0f);
+            cells.centroid_.resize(num);
+            cells.circumcenters_.resize(nb_tets());
+#pragma omp parallel for schedule(static)
+            for (int t = 0; t < static_cast<int>(nb_tets()); ++t)
+                cells.circumcenters_[t] = tet_circumcenter(t);
+        }
+
+        // The cells are extracted in blocks (in parallel), each into its own CSR arrays. The blocks are then
+        // concatenated.
+        struct Block {
+            std::vector<unsigned int> cell_size;      // number of facets of each cell
+            std::vector<unsigned int> facet_size;     // number of vertices of each facet
+            std::vector<unsigned int> facet_bisector;
+            std::vector<int> facet_vertex;
+        };
+        const int block_size = 1024;
+        const int nb_blocks = (num + block_size - 1) / block_size;
+        std::vector<Block> blocks(nb_blocks);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < nb_blocks; ++b) {
+            Block &block = blocks[b];
+            std::vector<unsigned int> visited_neigh;
+            const int end = std::min(num, (b + 1) * block_size);
+            for (int c = b * block_size; c < end; ++c) {
+                const unsigned int v = vertices[c];
+                assert(v < nb_vertices());
+                const std::size_t first_facet = block.facet_size.size();
+                bool bounded = vertex_cell(v) != -1; // -1 happens for geometrically duplicated vertices
+                if (bounded) {
+                    visited_neigh.clear();
+                    // For each t incident to v
+                    int t = vertex_cell(v);
+                    do {
+                        const unsigned int lvit = index(t, v);
+                        // For each edge (t,neigh) incident to v
+                        for (unsigned int lv = 0; lv < 4; lv++) {
+                            const unsigned int neigh = tet_vertex(t, lv);
+                            if (lv != lvit && !contains(visited_neigh, neigh)) {
+                                visited_neigh.push_back(neigh);
+                                const std::size_t size = block.facet_vertex.size();
+                                bounded &= get_voronoi_facet(t, lvit, lv, block.facet_vertex);
+                                block.facet_bisector.push_back(neigh);
+                                block.facet_size.push_back(static_cast<unsigned int>(block.facet_vertex.size() - size));
+                            }
+                        }
+                        t = next_around_vertex(t, lvit);
+                    } while (t != vertex_cell(v));
+                }
+                block.cell_size.push_back(static_cast<unsigned int>(block.facet_size.size() - first_facet));
+                cells.bounded_[c] = bounded;
+
+                if (!geometry)
+                    continue;
+
+                // The cell is convex and contains v, so it is decomposed into tetrahedra formed by v and
+                // the triangle fans of its facets.
+                const vec3 &p = vertex(v);
+                cells.centroid_[c] = p;
+                if (!bounded)
+                    continue;
+                double volume = 0.0;
+                dvec3 centroid(0.0, 0.0, 0.0);
+                const int *fv = block.facet_vertex.data() + (block.facet_vertex.size());
+                for (std::size_t f = block.facet_size.size(); f > first_facet; --f) {
+                    const unsigned int size = block.facet_size[f - 1];
+                    fv -= size;
+                    const vec3 &a = cells.circumcenters_[fv[0]];
+                    for (unsigned int i = 1; i + 1 < size; ++i) {
+                        const vec3 &b = cells.circumcenters_[fv[i]];
+                        const vec3 &d = cells.circumcenters_[fv[i + 1]];
+                        const double w = std::abs(dot(a - p, cross(b - p, d - p))) / 6.0;
+                        volume += w;
+                        centroid += dvec3(p + a + b + d) * (w * 0.25);
+                    }
+                }
+                cells.volume_[c] = static_cast<float>(volume);
+                if (volume > 0)
+                    cells.centroid_[c] = vec3(centroid / volume);
+            }
+        }
+
+        // concatenate the blocks
+        std::vector<std::size_t> cell_offset(nb_blocks + 1, 0);
+        std::vector<std::size_t> facet_offset(nb_blocks + 1, 0);
+        std::vector<std::size_t> vertex_offset(nb_blocks + 1, 0);
+        for (int b = 0; b < nb_blocks; ++b) {
+            cell_offset[b + 1] = cell_offset[b] + blocks[b].cell_size.size();
+            facet_offset[b + 1] = facet_offset[b] + blocks[b].facet_size.size();
+            vertex_offset[b + 1] = vertex_offset[b] + blocks[b].facet_vertex.size();
+        }
+        cells.cell_ptr_.resize(num + 1);
+        cells.facet_ptr_.resize(facet_offset[nb_blocks] + 1);
+        cells.facet_bisector_.resize(facet_offset[nb_blocks]);
+        cells.facet_vertex_.resize(vertex_offset[nb_blocks]);
+
+#pragma omp parallel for schedule(static)
+        for (int b = 0; b < nb_blocks; ++b) {
+            const Block &block = blocks[b];
+            unsigned int ptr = static_cast<unsigned int>(facet_offset[b]);
+            for (std::size_t i = 0; i < block.cell_size.size(); ++i) {
+                cells.cell_ptr_[cell_offset[b] + i] = ptr;
+                ptr += block.cell_size[i];
+            }
+            ptr = static_cast<unsigned int>(vertex_offset[b]);
+            for (std::size_t i = 0; i < block.facet_size.size(); ++i) {
+                cells.facet_ptr_[facet_offset[b] + i] = ptr;
+                ptr += block.facet_size[i];
+            }
+            std::copy(block.facet_bisector.begin(), block.facet_bisector.end(),
+                      cells.facet_bisector_.begin() + facet_offset[b]);
+            std::copy(block.facet_vertex.begin(), block.facet_vertex.end(),
+                      cells.facet_vertex_.begin() + vertex_offset[b]);
+        }
+        cells.cell_ptr_[num] = static_cast<unsigned int>(facet_offset[nb_blocks]);
+        cells.facet_ptr_[facet_offset[nb_blocks]] = static_cast<unsigned int>(vertex_offset[nb_blocks]);
+    }
+
+
 }
\ No newline at end of file
@@ -37,6 +37,7 @@ class tetgenio;
 namespace easy3d {
 
     class VoronoiCell3d;
+    class VoronoiCells3d;
 
     class Delaunay3 : public Delaunay {
     public:
@@ -62,12 +63,26 @@ namespace easy3d {
 
         int vertex_tet(int v) const { return vertex_cell(v); }
 
-        unsigned int nearest_vertex(const float *p) const {
-            return Delaunay::nearest_vertex(p);
+        unsigned int nearest_vertex(const float *p, int hint = -1) const {
+            return Delaunay::nearest_vertex(p, hint);
         }
 
-        unsigned int nearest_vertex(const vec3 &p) const {
-            return nearest_vertex(p.data());
+        unsigned int nearest_vertex(const vec3 &p, int hint = -1) const {
+            return nearest_vertex(p.data(), hint);
+        }
+
+        // returns the index of the tetrahedron containing \p p, or -1 if \p p is outside the convex hull.
+        int locate(const vec3 &p, int hint = -1) const {
+            return Delaunay::locate(p.data(), hint);
+        }
+
+        // batched (and parallel) nearest vertex and point location queries
+        void nearest_vertices(const std::vector<vec3> &points, std::vector<unsigned int> &result) const {
+            Delaunay::nearest_vertices((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
+        }
+
+        void locate(const std::vector<vec3> &points, std::vector<int> &result) const {
+            Delaunay::locate((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
         }
 
         const vec3 &vertex(unsigned int i) const {
@@ -124,7 +139,23 @@ namespace easy3d {
                 unsigned int v, VoronoiCell3d &cell, bool geometry = true
         ) const;
 
+        // Retrieves the Voronoi cells associated with the given vertices (in parallel). If geometry is true, the
+        // Voronoi vertices, and the volume and centroid of each bounded cell are also computed.
+        void get_voronoi_cells(
+                const std::vector<unsigned int> &vertices, VoronoiCells3d &cells, bool geometry = true
+        ) const;
+
+        // Retrieves the Voronoi cells of all vertices (in parallel).
+        void get_voronoi_cells(VoronoiCells3d &cells, bool geometry = true) const;
+
     protected:
+        // Collects the vertices of the Voronoi facet dual to the edge (lv1, lv2) of tetrahedron t. Each vertex is
+        // given by the tetrahedron it is dual to, or -1 for a vertex at infinity. Returns false if the facet is
+        // unbounded.
+        bool get_voronoi_facet(
+                unsigned int t, unsigned int lv1, unsigned int lv2, std::vector<int> &vertices
+        ) const;
+
         void get_voronoi_facet(
                 VoronoiCell3d &cell, unsigned int t,
                 unsigned int lv1, unsigned int lv2, bool geometry
@@ -300,6 +331,113 @@ namespace easy3d {
         std::vector<bool> infinite_;
     };
 
+    //________________________________________________________________________________
+
+    /**
+    * VoronoiCells3d stores a set of Voronoi cells in Compressed Row Storage arrays
+    * (cell -> facets -> vertices), which is filled by Delaunay3::get_voronoi_cells().
+    * - Cell c is dual to the Delaunay vertex cell_vertex(c). Its facets are in the range
+    *    [cell_begin(c) ... cell_end(c) - 1].
+    * - Facet f lies on the bisector plane of [cell_vertex(c), facet_bisector(f)]. Its
+    *    vertices are in the range [facet_begin(f) ... facet_end(f) - 1].
+    * - Vertex i is the dual of tetrahedron facet_vertex(i), or -1 for a vertex at infinity
+    *    (only in unbounded cells). The Voronoi vertices (i.e., the circumcenters of the
+    *    tetrahedra) are shared by all cells and are accessed by vertex(facet_vertex(i)).
+    */
+    class VoronoiCells3d {
+    public:
+        VoronoiCells3d() { clear(); }
+
+        void clear() {
+            vertices_.clear();
+            cell_ptr_.assign(1, 0);
+            facet_ptr_.assign(1, 0);
+            facet_bisector_.clear();
+            facet_vertex_.clear();
+            bounded_.clear();
+            volume_.clear();
+            centroid_.clear();
+            circumcenters_.clear();
+        }
+
+        unsigned int nb_cells() const { return (unsigned int) vertices_.size(); }
+
+        unsigned int nb_facets() const { return (unsigned int) facet_bisector_.size(); }
+
+        unsigned int cell_vertex(unsigned int c) const {
+            assert(c < nb_cells());
+            return vertices_[c];
+        }
+
+        unsigned int cell_begin(unsigned int c) const {
+            assert(c < nb_cells());
+            return cell_ptr_[c];
+        }
+
+        unsigned int cell_end(unsigned int c) const {
+            assert(c < nb_cells());
+            return cell_ptr_[c + 1];
+        }
+
+        unsigned int facet_begin(unsigned int f) const {
+            assert(f < nb_facets());
+            return facet_ptr_[f];
+        }
+
+        unsigned int facet_end(unsigned int f) const {
+            assert(f < nb_facets());
+            return facet_ptr_[f + 1];
+        }
+
+        unsigned int facet_bisector(unsigned int f) const {
+            assert(f < nb_facets());
+            return facet_bisector_[f];
+        }
+
+        int facet_vertex(unsigned int i) const {
+            assert(i < facet_vertex_.size());
+            return facet_vertex_[i];
+        }
+
+        // a cell is unbounded if its Delaunay vertex is on the convex hull
+        bool is_bounded(unsigned int c) const {
+            assert(c < nb_cells());
+            return bounded_[c] != 0;
+        }
+
+        // the Voronoi vertex dual to tetrahedron t (available if the cells were extracted with geometry)
+        const vec3 &vertex(int t) const {
+            assert(t >= 0 && t < (int) circumcenters_.size());
+            return circumcenters_[t];
+        }
+
+        // the volume of cell c (available if the cells were extracted with geometry). It is 0 for unbounded cells.
+        float volume(unsigned int c) const {
+            assert(c < volume_.size());
+            return volume_[c];
+        }
+
+        // the centroid of cell c (available if the cells were extracted with geometry). For unbounded cells, this is
+        // the Delaunay vertex.
+        const vec3 &centroid(unsigned int c) const {
+            assert(c < centroid_.size());
+            return centroid_[c];
+        }
+
+    private:
+        std::vector<unsigned int> vertices_;
+        std::vector<unsigned int> cell_ptr_;
+        std::vector<unsigned int> facet_ptr_;
+        std::vector<unsigned int> facet_bisector_;
+        std::vector<int> facet_vertex_;
+        std::vector<unsigned char> bounded_;
+        std::vector<float> volume_;
+        std::vector<vec3> centroid_;
+        std::vector<vec3> circumcenters_;
+
+        friend class Delaunay3;
+    };
+
 /*
  * The commented one is enough for basic 3D Delaunay implementation.
  * The above one is verbose for easy understanding of the interface 
@@ -0,0 +1,51 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <easy3d/algo/graph_enumerator.h>
+#include <easy3d/algo/union_find.h>
+
+
+namespace easy3d {
+
+    int GraphEnumerator::enumerate_connected_components(Graph *graph, Graph::VertexProperty<int> id) {
+        const int num_edges = static_cast<int>(graph->edges_size());
+        UnionFind uf(graph->vertices_size());
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const Graph::Edge e(i);
+            if (!graph->is_deleted(e))
+                uf.unite(graph->vertex(e, 0).idx(), graph->vertex(e, 1).idx());
+        }
+
+        std::vector<bool> deleted;
+        if (graph->n_vertices() != graph->vertices_size()) {  // there are deleted vertices
+            deleted.resize(graph->vertices_size());
+            for (unsigned int i = 0; i < graph->vertices_size(); ++i)
+                deleted[i] = graph->is_deleted(Graph::Vertex(i));
+        }
+        return uf.label(id.vector(), deleted);
+    }
+
+}
@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASY3D_ALGO_GRAPH_ENUMERATOR_H
+#define EASY3D_ALGO_GRAPH_ENUMERATOR_H
+
+
+#include <easy3d/core/graph.h>
+
+
+namespace easy3d {
+
+    class GraphEnumerator {
+    public:
+
+        /**
+         * Enumerates the connected components of a graph.
+         * The components are labeled by a parallel union-find over the edges. They are numbered in the order of
+         * their first vertices. Deleted vertices are labeled as -1.
+         * @param graph The input graph.
+         * @param id The vertex property storing the result.
+         * @return The number of connected components.
+         */
+        static int enumerate_connected_components(Graph *graph, Graph::VertexProperty<int> id);
+
+    };
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_GRAPH_ENUMERATOR_H
@@ -0,0 +1,92 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <easy3d/algo/point_cloud_enumerator.h>
+#include <easy3d/algo/union_find.h>
+#include <easy3d/kdtree/kdtree_search_nanoflann.h>
+
+
+namespace easy3d {
+
+    namespace details {
+
+        // the deleted points (empty if there is none)
+        std::vector<bool> deleted_points(const PointCloud *cloud) {
+            std::vector<bool> deleted;
+            if (cloud->n_vertices() != cloud->vertices_size()) {
+                deleted.resize(cloud->vertices_size());
+                for (unsigned int i = 0; i < cloud->vertices_size(); ++i)
+                    deleted[i] = cloud->is_deleted(PointCloud::Vertex(i));
+            }
+            return deleted;
+        }
+
+        // labels the components of the graph defined by the neighbors returned by the query
+        template<typename Query>
+        int enumerate(PointCloud *cloud, PointCloud::VertexProperty<int> id, Query query) {
+            const auto &deleted = deleted_points(cloud);
+
+            KdTreeSearch_NanoFLANN kdtree;
+            kdtree.begin();
+            kdtree.add_point_cloud(cloud);
+            kdtree.end();
+
+            const auto &points = cloud->points();
+            const int num = static_cast<int>(points.size());
+            UnionFind uf(num);
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (int i = 0; i < num; ++i) {
+                if (!deleted.empty() && deleted[i])
+                    continue;
+                std::vector<int> neighbors;
+                query(kdtree, points[i], neighbors);
+                for (auto j : neighbors) {
+                    if (j != i && (deleted.empty() || !deleted[j]))
+                        uf.unite(i, j);
+                }
+            }
+            return uf.label(id.vector(), deleted);
+        }
+
+    }
+
+
+    int PointCloudEnumerator::enumerate_knn_components(PointCloud *cloud, PointCloud::VertexProperty<int> id, int k) {
+        return details::enumerate(cloud, id, [k](const KdTreeSearch &tree, const vec3 &p, std::vector<int> &neighbors) {
+            tree.find_closest_k_points(p, k + 1, neighbors);   // the point itself is included
+        });
+    }
+
+
+    int PointCloudEnumerator::enumerate_radius_components(PointCloud *cloud, PointCloud::VertexProperty<int> id,
+                                                          float radius) {
+        const float squared_radius = radius * radius;
+        return details::enumerate(cloud, id, [squared_radius](const KdTreeSearch &tree, const vec3 &p,
+                                                              std::vector<int> &neighbors) {
+            tree.find_points_in_range(p, squared_radius, neighbors);
+        });
+    }
+
+}
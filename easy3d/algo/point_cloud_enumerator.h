@@ -0,0 +1,66 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASY3D_ALGO_POINT_CLOUD_ENUMERATOR_H
+#define EASY3D_ALGO_POINT_CLOUD_ENUMERATOR_H
+
+
+#include <easy3d/core/point_cloud.h>
+
+
+namespace easy3d {
+
+    class PointCloudEnumerator {
+    public:
+
+        /**
+         * Enumerates the connected components of the k-nearest neighbor graph of a point cloud. Two points are
+         * connected if either of them is among the k nearest neighbors of the other one.
+         * The components are labeled by a parallel union-find. They are numbered in the order of their first
+         * points. Deleted points are labeled as -1.
+         * @param cloud The input point cloud.
+         * @param id The vertex property storing the result.
+         * @param k The number of nearest neighbors of each point.
+         * @return The number of connected components.
+         */
+        static int enumerate_knn_components(PointCloud *cloud, PointCloud::VertexProperty<int> id, int k = 16);
+
+        /**
+         * Enumerates the connected components of the radius graph of a point cloud. Two points are connected if
+         * their distance is smaller than the radius.
+         * The components are labeled by a parallel union-find. They are numbered in the order of their first
+         * points. Deleted points are labeled as -1.
+         * @param cloud The input point cloud.
+         * @param id The vertex property storing the result.
+         * @param radius The radius of the neighborhood.
+         * @return The number of connected components.
+         */
+        static int enumerate_radius_components(PointCloud *cloud, PointCloud::VertexProperty<int> id, float radius);
+
+    };
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_POINT_CLOUD_ENUMERATOR_H
@@ -30,20 +30,16 @@
 #include <easy3d/util/stop_watch.h>
 
 
-#ifdef HAS_BOOST
-
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/connected_components.hpp>
-#include <boost/graph/prim_minimum_spanning_tree.hpp>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <cmath>
 
 #ifdef VISUALIZATION_FOR_DEBUGGING
-#include <easy3d/core/constant.h>
 #include <easy3d/core/random.h>
 #include <easy3d/renderer/drawable_lines.h>
 #endif
 
-#endif
-
 
 namespace easy3d {
 
@@ -103,268 +99,202 @@ namespace easy3d {
         return true;
     }
 
-#ifdef HAS_BOOST
-
     namespace details {
 
-        struct VertexProperty {
-            VertexProperty(easy3d::PointCloud::Vertex v = easy3d::PointCloud::Vertex(-1)) : vertex(v) {}
-
-            easy3d::PointCloud::Vertex vertex;
-        };
-
-        struct EdgeProperty {
-            EdgeProperty(float w = -std::numeric_limits<float>::max()) : weight(w) {}
-
-            float weight;
-        };
+        /// RiemannianGraph encodes the adjacency relations of the points in their K nearest neighbors in a compact
+        /// (CSR-like) form with a fixed number of slots per point: the neighbors of point i are stored in
+        /// neighbors[i * k, (i + 1) * k), unused slots are -1. The edge weight 1 - | normal1 * normal2 | is cheap to
+        /// evaluate and is thus computed when needed instead of being stored.
+        struct RiemannianGraph {
+            std::size_t k;
+            std::vector<int> neighbors;
 
-        /// RiemannianGraph encodes:
-        /// - the adjacency relations of vertices in a K neighbors.
-        /// - vertices contain the corresponding input point cloud vertex
-        /// - the edge weight = edge weight = 1 - | normal1 * normal2 |
-        class RiemannianGraph
-                : public boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, VertexProperty, EdgeProperty> {
-        public:
-            typedef RiemannianGraph::vertex_descriptor Vertex;
-            typedef RiemannianGraph::edge_descriptor Edge;
-
-        public:
-            Vertex top;
+            std::size_t num_points() const { return k > 0 ? neighbors.size() / k : 0; }
         };
 
-        // builds the graph
-        void build_graph(easy3d::PointCloud *cloud, const KdTreeSearch *tree, unsigned int k, RiemannianGraph &graph) {
-            // Step 1: create the vertices of the graph
-
-            // we need to remember the vertex descriptor of each point.
-            // This is needed in a later stage to add edges.
-            auto vertex_descriptors = cloud->vertex_property<RiemannianGraph::Vertex>("v:descriptors");
-
-            for (auto v : cloud->vertices())
-                vertex_descriptors[v] = boost::add_vertex(VertexProperty(v), graph);
-
-            // Step 2: create the edges connecting neighboring points.
 
-            auto points = cloud->get_vertex_property<easy3d::vec3>("v:point");
-            auto normals = cloud->get_vertex_property<easy3d::vec3>("v:normal");
-            for (auto v : cloud->vertices()) {
-                const easy3d::vec3 &p = points[v];
+        // builds the graph (the kNN queries are run in parallel)
+        void build_graph(const std::vector<vec3> &points, const KdTreeSearch *tree, unsigned int k,
+                         RiemannianGraph &graph) {
+            const int num = static_cast<int>(points.size());
+            graph.k = k - 1; // the query result includes the point itself
+            graph.neighbors.assign(num * graph.k, -1);
 
-                // The indices of the neighbors of v (NOTE: the result include v itself).
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (int i = 0; i < num; ++i) {
+                // The indices of the neighbors of i (NOTE: the result include i itself).
                 std::vector<int> neighbor_indices;
-                tree->find_closest_k_points(p, k, neighbor_indices);
+                tree->find_closest_k_points(points[i], k, neighbor_indices);
                 if (neighbor_indices.size() < k)
                     continue; // in extreme cases, a point cloud can have less than K points
 
-                // now let's create the edges
-                for (std::size_t i = 0; i < neighbor_indices.size(); ++i) {
-                    int index = neighbor_indices[i];
-                    if (index == v.idx())
-                        continue; // this is actually the current vertex
-
-                    easy3d::PointCloud::Vertex v2(index);
-                    RiemannianGraph::Vertex vd1 = vertex_descriptors[v];
-                    RiemannianGraph::Vertex vd2 = vertex_descriptors[v2];
-                    std::pair<RiemannianGraph::Edge, bool> ed = boost::edge(vd1, vd2, graph);
-                    if (ed.second)
-                        continue; // the edge already exists.
-
-                    const easy3d::vec3 &n1 = normals[v];
-                    const easy3d::vec3 &n2 = normals[v2];
-                    float weight = 1.0f - std::abs(dot(n1, n2));
-                    if (weight < 0)
-                        weight = 0; // safety check
-
-                    // add an edge to the graph: add_edge()
-                    boost::add_edge(vd1, vd2, EdgeProperty(weight), graph);
+                std::size_t slot = i * graph.k;
+                const std::size_t end = slot + graph.k;
+                for (std::size_t j = 0; j < neighbor_indices.size() && slot < end; ++j) {
+                    if (neighbor_indices[j] != i) // this is actually the current point
+                        graph.neighbors[slot++] = neighbor_indices[j];
                 }
             }
-
-            cloud->remove_vertex_property(vertex_descriptors);
         }
 
 
-        /// MST_Graph encodes:
-        /// - the adjacency relations of vertices in a Minimum Spanning Tree.
-        /// - vertices contain the corresponding input point cloud vertex
-        /// - a boolean indicating if the normal is oriented.
-        struct MST_VertexProperty : public VertexProperty {
-            MST_VertexProperty(easy3d::PointCloud::Vertex v = easy3d::PointCloud::Vertex(-1), bool oriented = false)
-                    : VertexProperty(v), is_oriented(oriented) {}
-
-            bool is_oriented;
-        };
-
-        class MST_Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, MST_VertexProperty> {
-        public:
-            typedef typename MST_Graph::vertex_descriptor Vertex;
-            typedef typename MST_Graph::edge_descriptor Edge;
-
-        public:
-            MST_Graph(PointCloud::VertexProperty<vec3> nmap) : normal_map(nmap) {}
-
-            PointCloud::VertexProperty<vec3> normal_map;
-
-            Vertex root;
-        };
-
-
-        void extract_minimum_spanning_tree(const RiemannianGraph &graph, MST_Graph &mst) {
-            RiemannianGraph::Vertex top = graph.top;
-
-            std::vector<details::RiemannianGraph::Vertex> predecessor(boost::num_vertices(graph));
-            boost::prim_minimum_spanning_tree(
-                    graph,
-                    &predecessor[0],
-                    boost::weight_map(boost::get(&details::EdgeProperty::weight, graph)).root_vertex(top)
-            );
-
-            // we create a directed graph (i.e., MST_Graph) to represent the MST.
-            // add vertices
-            for (std::size_t i = 0; i < predecessor.size(); ++i) {
-                // the current vertex: graph[i].vertex
-                PointCloud::Vertex v = graph[i].vertex;
-
-                if (predecessor[i] == i) { // is either the root or unreachable
-                    // the root or unreachable vertices are marked "oriented".
-                    auto vt = boost::add_vertex(MST_VertexProperty(v, true), mst);
-                    if (i == top)
-                        mst.root = vt;
-                } else {
-                    // other vertices are marked "oriented".
-                    boost::add_vertex(MST_VertexProperty(v, false), mst);
-                }
-            }
-
-            // add edges
-            for (std::size_t i = 0; i < predecessor.size(); ++i) {
-                if (predecessor[i] == i)  // is either the root or not reachable
-                    continue;
-                else {
-                    // the parent: predecessor[i]
-                    // current vertex: i
-                    boost::add_edge(predecessor[i], i, mst);
-                }
+        inline int find_root(std::vector<int> &parent, int i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]]; // path halving
+                i = parent[i];
             }
+            return i;
         }
 
-        template<class Graph>
-        class BfsVisitor : public boost::default_bfs_visitor {
-        public:
-            typedef typename Graph::vertex_descriptor VertexDescriptor;
-            typedef typename Graph::edge_descriptor EdgeDescriptor;
 
-            BfsVisitor(std::function<void(EdgeDescriptor e, Graph &g)> fun)
-                    : func_(fun) {}
+        /// Extracts the minimum spanning forest of the graph using Borůvka's algorithm. In each round, the cheapest
+        /// edge leaving each tree is found by a parallel scan over all edges, and the trees are then merged along
+        /// these edges. Ties are broken by the edge index, so the result is deterministic.
+        /// @param forest The edges of the forest (each given by a pair of point indices).
+        /// @param label The tree (identified by one of its points) each point belongs to.
+        void extract_minimum_spanning_forest(const RiemannianGraph &graph, const std::vector<vec3> &normals,
+                                             std::vector<std::pair<int, int> > &forest, std::vector<int> &label) {
+            const int num = static_cast<int>(graph.num_points());
+            const std::int64_t num_slots = static_cast<std::int64_t>(graph.neighbors.size());
+            const std::size_t k = graph.k;
+
+            auto weight = [&](std::uint64_t e) -> float {
+                return 1.0f - std::abs(dot(normals[e / k], normals[graph.neighbors[e]]));
+            };
+            auto cheaper = [&](std::uint64_t a, std::uint64_t b) -> bool {
+                const float wa = weight(a), wb = weight(b);
+                return (wa < wb) || (wa == wb && a < b);
+            };
+
+            const std::uint64_t none = std::numeric_limits<std::uint64_t>::max();
+            std::vector<std::atomic<std::uint64_t> > cheapest(num);
+            auto update = [&](std::atomic<std::uint64_t> &slot, std::uint64_t e) {
+                std::uint64_t current = slot.load(std::memory_order_relaxed);
+                while (current == none || cheaper(e, current)) {
+                    if (slot.compare_exchange_weak(current, e))
+                        break;
+                }
+            };
 
-            // Note: boost requires const graph
-            void examine_edge(EdgeDescriptor edge, const Graph &graph) const {
-                func_(edge, const_cast<Graph &>(graph));
-            }
+            std::vector<int> parent(num);
+            label.resize(num);
+            std::vector<int> roots(num);
+            for (int i = 0; i < num; ++i)
+                parent[i] = label[i] = roots[i] = i;
 
-        private:
-            std::function<void(EdgeDescriptor edge, Graph &graph)> func_;
-        };
+            forest.clear();
+            forest.reserve(num);
+            while (true) {
+#pragma omp parallel for
+                for (int i = 0; i < static_cast<int>(roots.size()); ++i)
+                    cheapest[roots[i]].store(none, std::memory_order_relaxed);
+
+                // the cheapest edge leaving each tree
+#pragma omp parallel for schedule(static)
+                for (std::int64_t e = 0; e < num_slots; ++e) {
+                    const int j = graph.neighbors[e];
+                    if (j < 0)
+                        continue;
+                    const int ti = label[e / k];
+                    const int tj = label[j];
+                    if (ti != tj) {
+                        update(cheapest[ti], e);
+                        update(cheapest[tj], e);
+                    }
+                }
 
+                // merge the trees (this only touches the roots)
+                const std::size_t num_edges = forest.size();
+                for (int r : roots) {
+                    const std::uint64_t e = cheapest[r].load(std::memory_order_relaxed);
+                    if (e == none)
+                        continue;
+                    const int i = static_cast<int>(e / k);
+                    const int j = graph.neighbors[e];
+                    const int ri = find_root(parent, i);
+                    const int rj = find_root(parent, j);
+                    if (ri == rj)
+                        continue; // the same edge has been chosen by both trees
+                    parent[std::max(ri, rj)] = std::min(ri, rj);
+                    forest.emplace_back(i, j);
+                }
+                if (forest.size() == num_edges)
+                    break;
 
-        /// find the top vertex (the one with the largest Z value) in the graph.
-        /// orient the normal of the point with maximum Z towards +Z axis.
-        void find_top_vertex(PointCloud *cloud, RiemannianGraph &graph) {
-            float top_z = -std::numeric_limits<float>::max();
-            auto points = cloud->get_vertex_property<vec3>("v:point");
+                // relabel the points
+                for (int r : roots)
+                    find_root(parent, r);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                    label[i] = parent[label[i]];
 
-            auto vi = boost::vertices(graph);
-            for (auto vit = vi.first; vit != vi.second; ++vit) {
-                RiemannianGraph::Vertex vd = *vit;
-                PointCloud::Vertex v = graph[vd].vertex;
-                if (points[v].z > top_z) {
-                    graph.top = vd;
-                    top_z = points[v].z;
+                std::vector<int> new_roots;
+                for (int r : roots) {
+                    if (parent[r] == r)
+                        new_roots.push_back(r);
                 }
-            }
-
-            PointCloud::Vertex top = graph[graph.top].vertex;
-            if (top.idx() != -1) {
-                auto normals = cloud->get_vertex_property<vec3>("v:normal");
-                if (normals[top].z < 0)
-                    normals[top] = -normals[top];
+                roots.swap(new_roots);
             }
         }
 
 
-        // extract the connected components of a graph. The results are stored in a set of graphs
-        std::vector<RiemannianGraph> connected_components(PointCloud *cloud, const RiemannianGraph &riemannian_graph) {
-            std::vector<std::size_t> labels(boost::num_vertices(riemannian_graph));
-            std::size_t num = boost::connected_components(riemannian_graph, &labels[0]);
-
-            std::vector<RiemannianGraph> components(num);
-
-            // we need to remember the vertex descriptor of each point.
-            // This is needed in a later stage to add edges.
-            auto vertex_descriptors = cloud->vertex_property<RiemannianGraph::Vertex>("v:descriptors");
-
-            for (std::size_t i = 0; i < boost::num_vertices(riemannian_graph); ++i) {
-                std::size_t idx = labels[i];
-                RiemannianGraph &graph = components[idx];
-                PointCloud::Vertex v = riemannian_graph[i].vertex;
-                vertex_descriptors[v] = boost::add_vertex(VertexProperty(v), graph);
+        /// Propagates the normal orientation along each tree of the forest, starting from its top vertex (the one
+        /// with the largest Z value) whose normal is oriented towards the +Z axis. The trees are processed in parallel.
+        /// \pre Normals must be unit vectors
+        void propagate_normals(const std::vector<vec3> &points, std::vector<vec3> &normals,
+                               const std::vector<std::pair<int, int> > &forest, const std::vector<int> &label) {
+            const int num = static_cast<int>(points.size());
+
+            // the trees in CSR form
+            std::vector<int> offset(num + 1, 0);
+            for (const auto &e : forest) {
+                ++offset[e.first + 1];
+                ++offset[e.second + 1];
             }
-
-            // add the edges for each graph
-            auto ei = boost::edges(riemannian_graph);
-            for (auto eit = ei.first; eit != ei.second; ++eit) {
-                auto vd1 = boost::source(*eit, riemannian_graph);
-                auto vd2 = boost::target(*eit, riemannian_graph);
-                if (labels[vd1] == labels[vd2]) { // they belong to the same component
-                    std::size_t idx = labels[vd1];
-                    RiemannianGraph &graph = components[idx];
-                    auto p1 = riemannian_graph[vd1].vertex;
-                    auto p2 = riemannian_graph[vd2].vertex;
-                    auto s = vertex_descriptors[p1];
-                    auto t = vertex_descriptors[p2];
-                    boost::add_edge(s, t, EdgeProperty(riemannian_graph[*eit].weight), graph);
-                }
+            for (int i = 0; i < num; ++i)
+                offset[i + 1] += offset[i];
+            std::vector<int> adjacency(offset[num]);
+            std::vector<int> fill(offset.begin(), offset.end() - 1);
+            for (const auto &e : forest) {
+                adjacency[fill[e.first]++] = e.second;
+                adjacency[fill[e.second]++] = e.first;
             }
 
-            cloud->remove_vertex_property(vertex_descriptors);
-
-            for (auto &graph : components)
-                find_top_vertex(cloud, graph);
-
-            return components;
-        }
+            // the top vertex of each tree
+            std::vector<int> top(num, -1);
+            for (int i = 0; i < num; ++i) {
+                int &t = top[label[i]];
+                if (t == -1 || points[i].z > points[t].z)
+                    t = i;
+            }
+            std::vector<int> tops;
+            for (int i = 0; i < num; ++i) {
+                if (top[i] != -1)
+                    tops.push_back(top[i]);
+            }
 
-        /// propage the normal orientation from the source vertex to the target vertex
-        /// It does not orient normals that are already oriented.
-        /// It does not propagate the orientation if the angle between 2 normals > angle_max.
-        /// \pre Normals must be unit vectors
-        /// \pre `0 < angle_max <= PI/2`
-        void propagate_normal(MST_Graph::Edge edge, MST_Graph &graph) {
-            const static double angle_max = M_PI * 0.5;
-
-            // Gets source
-            MST_Graph::Vertex source_vertex = boost::source(edge, graph);
-            const bool source_normal_is_oriented = graph[source_vertex].is_oriented;
-            PointCloud::Vertex v_source = graph[source_vertex].vertex;
-            const vec3 &source_normal = graph.normal_map[v_source];
-
-            // Gets target
-            MST_Graph::Vertex target_vertex = boost::target(edge, graph);
-            bool &target_normal_is_oriented = graph[target_vertex].is_oriented;
-            PointCloud::Vertex v_target = graph[target_vertex].vertex;
-            vec3 &target_normal = graph.normal_map[v_target];
-
-            if (!target_normal_is_oriented) {
-                float normals_dot = dot(source_normal, target_normal);
-                if (normals_dot < 0) {
-                    target_normal = -target_normal;
+#pragma omp parallel for schedule(dynamic)
+            for (int t = 0; t < static_cast<int>(tops.size()); ++t) {
+                const int root = tops[t];
+                if (normals[root].z < 0)
+                    normals[root] = -normals[root];
+
+                // depth first traversal (each entry is a point and its parent in the tree)
+                std::vector<std::pair<int, int> > stack;
+                stack.emplace_back(root, -1);
+                while (!stack.empty()) {
+                    const int v = stack.back().first;
+                    const int from = stack.back().second;
+                    stack.pop_back();
+                    for (int j = offset[v]; j < offset[v + 1]; ++j) {
+                        const int w = adjacency[j];
+                        if (w == from)
+                            continue;
+                        if (dot(normals[v], normals[w]) < 0)
+                            normals[w] = -normals[w];
+                        stack.emplace_back(w, v);
+                    }
                 }
-
-                // Is orientation robust?
-                target_normal_is_oriented = source_normal_is_oriented &&
-                                            (std::abs(normals_dot) >=
-                                             std::cos(angle_max)); // oriented iff angle <= m_angle_max
             }
         }
     }
@@ -382,6 +312,11 @@ namespace easy3d {
             return false;
         }
 
+        if (k < 2) {
+            LOG(ERROR) << "at least 2 neighbors are required to construct the graph";
+            return false;
+        }
+
         StopWatch w;
         w.start();
 
@@ -392,61 +327,51 @@ namespace easy3d {
         kdtree.end();
         LOG(INFO) << "done. " << w.time_string();
 
+        const std::vector<vec3> &points = cloud->points();
+
         w.restart();
         LOG(INFO) << "constructing graph...";
-        details::RiemannianGraph riemannian_graph;
-        details::build_graph(cloud, &kdtree, k, riemannian_graph);
-
-        // a point clouds might be in multiple clusters, so we have to extract the connected components
-        // first. After that, we can reorient all the components one by one.
-        std::vector<details::RiemannianGraph> components
-                = details::connected_components(cloud, riemannian_graph);
-        LOG(INFO) << "done. #vertices: " << boost::num_vertices(riemannian_graph)
-                  << ", #edges: " << boost::num_edges(riemannian_graph)
-                  << ", #components: " << components.size()
+        details::RiemannianGraph graph;
+        details::build_graph(points, &kdtree, k, graph);
+        LOG(INFO) << "done. #vertices: " << graph.num_points() << ", #edge slots: " << graph.neighbors.size()
                   << ". " << w.time_string();
 
+        // a point clouds might be in multiple clusters, which results in multiple trees that are reoriented
+        // independently.
         w.restart();
         LOG(INFO) << "extract minimum spanning tree...";
-        std::vector<details::MST_Graph> ms_trees;
-        for (const auto &graph : components) {
-            ms_trees.emplace_back(cloud->get_vertex_property<vec3>("v:normal"));
-            details::MST_Graph &mst = ms_trees.back();
-            details::extract_minimum_spanning_tree(graph, mst);
-        }
-        LOG(INFO) << "done. " << w.time_string();
+        std::vector<std::pair<int, int> > forest;
+        std::vector<int> label;
+        details::extract_minimum_spanning_forest(graph, normals.vector(), forest, label);
+        LOG(INFO) << "done. #trees: " << points.size() - forest.size() << ". " << w.time_string();
+
+        // the graph is not needed any more
+        std::vector<int>().swap(graph.neighbors);
 
         w.restart();
         LOG(INFO) << "propagate...";
-        for (const auto &mst : ms_trees) {
-            // Traverse the point set along the MST to propagate source_point's orientation
-            details::BfsVisitor<details::MST_Graph> bfsVisitor(details::propagate_normal);
-            boost::breadth_first_search(mst, mst.root, boost::visitor(bfsVisitor));
-        }
+        details::propagate_normals(points, normals.vector(), forest, label);
         LOG(INFO) << "done. " << w.time_string();
 
 #ifdef VISUALIZATION_FOR_DEBUGGING
-        // for debugging: create a drawable to visualize the MST_Graph
+        // for debugging: create a drawable to visualize the minimum spanning forest
         LinesDrawable* mst_graph = cloud->drawable("mst_graph");
         if (!mst_graph)
             mst_graph = cloud->add_drawable("mst_graph");
 
-        auto point_prop = cloud->get_vertex_property<vec3>("v:point");
-        std::vector<vec3> points, colors;
-        for (const auto& mst : ms_trees) {
-            const vec3& c = random_color(); // give each mst a unique color
-            auto ei = boost::edges(mst);
-            for (auto eit = ei.first; eit != ei.second; ++eit) {
-               auto sd = boost::source(*eit, mst);
-               auto td = boost::target(*eit, mst);
-               PointCloud::Vertex sv = mst[sd].vertex;
-               PointCloud::Vertex tv = mst[td].vertex;
-               points.push_back(point_prop[sv]);    colors.push_back(c);
-               points.push_back(point_prop[tv]);    colors.push_back(c);
-            }
+        std::vector<vec3> tree_colors(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (label[i] == static_cast<int>(i))
+                tree_colors[i] = random_color(); // give each tree a unique color
+        }
+        std::vector<vec3> vertices, colors;
+        for (const auto &e : forest) {
+            const vec3 &c = tree_colors[label[e.first]];
+            vertices.push_back(points[e.first]);    colors.push_back(c);
+            vertices.push_back(points[e.second]);   colors.push_back(c);
         }
 
-        mst_graph->update_vertex_buffer(points);
+        mst_graph->update_vertex_buffer(vertices);
         mst_graph->update_color_buffer(colors);
         mst_graph->set_per_vertex_color(true);
         mst_graph->set_visible(true);
@@ -454,15 +379,4 @@ namespace easy3d {
 
         return true;
     }
-
-#else
-
-    bool PointCloudNormals::reorient(PointCloud *cloud, unsigned int k) const
-    {
-        LOG(ERROR) << "reorient point cloud normals requires boost";
-        return false;
-    }
-
-#endif
-
 }
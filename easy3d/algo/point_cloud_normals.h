@@ -42,6 +42,9 @@ namespace easy3d {
         /// Reorients the point cloud normals.
         /// This method implements the normal reorientation method described in
         /// Hoppe et al. Surface reconstruction from unorganized points. SIGGRAPH 1992.
+        /// The orientation is propagated along the minimum spanning forest of the K-nearest-neighbor graph (weighted by
+        /// 1 - |n_i * n_j|), starting from the top point of each tree. The graph construction, the spanning forest
+        /// extraction (Boruvka's algorithm), and the propagation (one tree per thread) run in parallel.
         /// @param k: the number of neighboring points to construct the graph.
         bool reorient(PointCloud *cloud, unsigned int k = 16) const;
     };
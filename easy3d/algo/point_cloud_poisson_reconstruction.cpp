@@ -25,6 +25,11 @@
 #include <easy3d/algo/point_cloud_poisson_reconstruction.h>
 
 #include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <cfloat>
+#include <thread>
 
 #ifdef WIN32
 #define NOMINMAX
@@ -104,8 +109,7 @@ namespace easy3d {
         scale_ = 1.1f;
         pointWeight_ = 4.0f;
         gsIter_ = 8;
-        threads_ = omp_get_num_procs();
-        LOG(INFO) << "number of threads: " << threads_;
+        threads_ = 0; // follow the OpenMP setting
 
         confidence_ = false;
         normalWeight_ = false;
@@ -116,81 +120,86 @@ namespace easy3d {
     }
 
 
-    template<class Vertex>
-    SurfaceMesh *
-    convert_to_mesh(CoredFileMeshData<Vertex> &mesh, const XForm4x4<REAL> &iXForm, const std::string &density_attr_name,
-                    bool has_colors) {
-        std::size_t num_ic_pts = mesh.inCorePoints.size();
-        int num_ooc_pts = mesh.outOfCorePointCount();
-        int num_face = mesh.polygonCount();
-        if (num_face <= 0) {
-            LOG(ERROR) << "reconstructed mesh has 0 facet";
-            return nullptr;
-        }
-
-        SurfaceMesh *result = new SurfaceMesh;
-        SurfaceMesh::VertexProperty<float> density = result->add_vertex_property<float>(density_attr_name);
-        SurfaceMesh::VertexProperty<vec3> color;
-        if (has_colors)
-            color = result->add_vertex_property<vec3>("v:color");
+    namespace details {
 
-        std::vector<SurfaceMesh::Vertex> all_vertices;
-
-        REAL min_density = FLT_MAX;
-        REAL max_density = -FLT_MAX;
-        mesh.resetIterator();
-        for (std::size_t i = 0; i < num_ic_pts; ++i) {
-            const Vertex &v = mesh.inCorePoints[i];
-            const Point3D<REAL> &pt = iXForm * v.point;
-            SurfaceMesh::Vertex vv = result->add_vertex(vec3(pt.coords[0], pt.coords[1], pt.coords[2]));
-            all_vertices.push_back(vv);
-            density[vv] = v.value;
-            min_density = std::min(min_density, v.value);
-            max_density = std::max(max_density, v.value);
-
-            if (has_colors) {
-                vec3 c(v.color);
-                color[vv] = c / 255.0f;
+        template<class Vertex>
+        SurfaceMesh *convert_to_mesh(CoredVectorMeshData<Vertex> &mesh, const XForm4x4<REAL> &iXForm,
+                                     const std::string &density_attr_name, bool has_colors, int threads) {
+            const int num_ic_pts = static_cast<int>(mesh.inCorePoints.size());
+            const int num_ooc_pts = mesh.outOfCorePointCount();
+            const int num_vertices = num_ic_pts + num_ooc_pts;
+            const int num_face = mesh.polygonCount();
+            if (num_face <= 0) {
+                LOG(ERROR) << "reconstructed mesh has 0 facet";
+                return nullptr;
             }
-        }
 
-        for (int i = 0; i < num_ooc_pts; ++i) {
+            SurfaceMesh *result = new SurfaceMesh;
+            // for a closed manifold surface, #E = #V + #F - 2.
+            result->reserve(num_vertices, num_vertices + num_face, num_face);
+            SurfaceMesh::VertexProperty<float> density = result->add_vertex_property<float>(density_attr_name);
+            SurfaceMesh::VertexProperty<vec3> color;
+            if (has_colors)
+                color = result->add_vertex_property<vec3>("v:color");
+            result->resize(num_vertices, 0, 0);
+
+            std::vector<vec3> &points = result->points();
+            auto copy_vertex = [&](int i, const Vertex &v) {
+                const Point3D<REAL> &pt = iXForm * v.point;
+                points[i] = vec3(pt.coords[0], pt.coords[1], pt.coords[2]);
+                density.vector()[i] = v.value;
+                if (has_colors)
+                    color.vector()[i] = vec3(v.color) / 255.0f;
+            };
+
+            // the in-core vertices are independent and are thus copied in parallel
+#pragma omp parallel for num_threads(threads)
+            for (int i = 0; i < num_ic_pts; ++i)
+                copy_vertex(i, mesh.inCorePoints[i]);
+
+            mesh.resetIterator();
             Vertex v;
-            mesh.nextOutOfCorePoint(v);
-            const Point3D<REAL> &pt = iXForm * v.point;
-            SurfaceMesh::Vertex vv = result->add_vertex(vec3(pt.coords[0], pt.coords[1], pt.coords[2]));
-            all_vertices.push_back(vv);
-            density[vv] = v.value;
-            min_density = std::min(min_density, v.value);
-            max_density = std::max(max_density, v.value);
-
-            if (has_colors) {
-                vec3 c(v.color);
-                color[vv] = c / 255.0f;
+            for (int i = num_ic_pts; i < num_vertices && mesh.nextOutOfCorePoint(v); ++i)
+                copy_vertex(i, v);
+
+            // per-thread range merged at the end (min/max reductions are not available in OpenMP 2.0)
+            const std::vector<float> &values = density.vector();
+            float min_density = FLT_MAX;
+            float max_density = -FLT_MAX;
+#pragma omp parallel num_threads(threads)
+            {
+                float local_min = FLT_MAX;
+                float local_max = -FLT_MAX;
+#pragma omp for nowait
+                for (int i = 0; i < num_vertices; ++i) {
+                    local_min = std::min(local_min, values[i]);
+                    local_max = std::max(local_max, values[i]);
+                }
+#pragma omp critical (PoissonReconstruction_density_range)
+                {
+                    min_density = std::min(min_density, local_min);
+                    max_density = std::max(max_density, local_max);
+                }
             }
-        }
 
-        for (int i = 0; i < num_face; ++i) {
             std::vector<CoredVertexIndex> vertices;
-            mesh.nextPolygon(vertices);
-
             std::vector<SurfaceMesh::Vertex> face_vts;
-            for (unsigned int j = 0; j < vertices.size(); ++j) {
-                std::size_t id = vertices[j].idx;
-                if (!vertices[j].inCore)
-                    id += num_ic_pts;
-                face_vts.push_back(all_vertices[id]);
+            for (int i = 0; i < num_face; ++i) {
+                mesh.nextPolygon(vertices);
+                face_vts.clear();
+                for (const auto &vi : vertices)
+                    face_vts.emplace_back(vi.inCore ? vi.idx : vi.idx + num_ic_pts);
+                result->add_face(face_vts);
             }
-            result->add_face(face_vts);
-        }
 
-        LOG(INFO)
-                << "vertex property \'" << density_attr_name << "\' added with range ["
-                << min_density << ", " << max_density << "]";
-        if (has_colors)
-            LOG(INFO) << "vertex property 'v:color' added.";
+            LOG(INFO)
+                    << "vertex property \'" << density_attr_name << "\' added with range ["
+                    << min_density << ", " << max_density << "]";
+            if (has_colors)
+                LOG(INFO) << "vertex property 'v:color' added.";
 
-        return result;
+            return result;
+        }
     }
 
 
@@ -206,9 +215,36 @@ namespace easy3d {
             return nullptr;
         }
 
+        StopWatch w;
+
+        // the reconstruction domain is a cube (slightly larger than the bounding box of the point cloud)
+        const Box3 &box = cloud->bounding_box();
+        const float size = std::max(box.range(0), std::max(box.range(1), box.range(2))) * scale_;
+        const vec3 cube_min = box.center() - vec3(size * 0.5f);
+
+        PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
+        SurfaceMesh *result = reconstruct(cloud->n_vertices(), cloud->points()[0], normals.vector()[0],
+                                          colors ? colors.vector()[0].data() : nullptr, cube_min, size, density_attr_name);
+        if (!result)
+            return nullptr;
+
+        const std::string &file_name = file_system::name_less_extension(cloud->name()) + "_Poisson.ply";
+        result->set_name(file_name);
+        LOG(INFO) << "total reconstruction time: " << w.time_string();
+
+        return result;
+    }
+
+
+    SurfaceMesh *PoissonReconstruction::reconstruct(std::size_t num, const float *pts, const float *nms,
+                                                    const float *cls, const vec3 &cube_min, float cube_size,
+                                                    const std::string &density_attr_name) {
         typedef typename Octree<REAL>::template DensityEstimator<WEIGHT_DEGREE> DensityEstimator;
         typedef typename Octree<REAL>::template InterpolationInfo<false> InterpolationInfo;
 
+        // the number of threads is queried for each run so that changes to the OpenMP setting take effect
+        const int threads = threads_ > 0 ? threads_ : omp_get_max_threads();
+
         REAL isoValue = 0;
 
         //if (OctNode< TreeNodeData >::NodeAllocator.blockSize != MEMORY_ALLOCATOR_BLOCK_SIZE)
@@ -217,7 +253,7 @@ namespace easy3d {
         Reset<REAL>();
         Octree<REAL> tree;
         OctreeProfiler<REAL> profiler(tree);
-        tree.threads = threads_;
+        tree.threads = threads;
 
         int maxSolveDepth = depth_;
         int kernelDepth = depth_ - 2;
@@ -229,7 +265,9 @@ namespace easy3d {
         //////////////////////////////////////////////////////////////////////////
 
         LOG(INFO) << "Screened Poisson Reconstruction (V9.0.1)";
-        StopWatch t, w;
+        if (verbose_)
+            LOG(INFO) << " - Number of threads: " << threads;
+        StopWatch t;
 
         //////////////////////////////////////////////////////////////////////////
 
@@ -247,37 +285,20 @@ namespace easy3d {
             LOG(INFO) << "loading data into tree... ";
             t.restart();
             profiler.start();
-            const float *pts = cloud->points()[0];
-            const float *nms = normals.vector()[0];
-            const float *cls = 0;
-            PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
-            if (colors) {
-                cls = colors.vector()[0];
+            if (cls)
                 sampleData = new std::vector<ProjectiveData<Point3D<REAL>, REAL> >();
-            }
 
-            xForm = XForm4x4<REAL>::Identity();
-            {
-                const Box3 &box = cloud->bounding_box();
-
-                Point3D<REAL> min_p(box.min(0), box.min(1), box.min(2)), max_p(box.max(0), box.max(1), box.max(2));
-                Point3D<REAL> center = (max_p + min_p) / 2;
-                REAL scale = std::max<REAL>(max_p[0] - min_p[0],
-                                            std::max<REAL>(max_p[1] - min_p[1], max_p[2] - min_p[2]));
-                scale *= scale_;
-                for (int i = 0; i < 3; i++)
-                    center[i] -= scale / 2;
-                XForm4x4<REAL> tXForm = XForm4x4<REAL>::Identity(), sXForm = XForm4x4<REAL>::Identity();
-                for (int i = 0; i < 3; i++)
-                    sXForm(i, i) = (REAL) (1. / scale), tXForm(3, i) = -center[i];
-                xForm = (sXForm * tXForm) * xForm;
-            }
+            // maps the cube to the unit cube
+            XForm4x4<REAL> tXForm = XForm4x4<REAL>::Identity(), sXForm = XForm4x4<REAL>::Identity();
+            for (int i = 0; i < 3; i++)
+                sXForm(i, i) = (REAL) (1. / cube_size), tXForm(3, i) = -cube_min[i];
+            xForm = sXForm * tXForm;
 
-            pointCount = tree.init<Point3D<REAL> >(cloud->n_vertices(), pts, nms, cls, xForm, maxSolveDepth, false,
+            pointCount = tree.init<Point3D<REAL> >(num, pts, nms, cls, xForm, maxSolveDepth, false,
                                                    *samples, sampleData);
             iXForm = xForm.inverse();
 
-#pragma omp parallel for num_threads(threads_)
+#pragma omp parallel for num_threads(threads)
             for (int i = 0; i < (int) samples->size(); i++)
                 (*samples)[i].sample.data.n *= (REAL) -1;
 
@@ -403,15 +424,15 @@ namespace easy3d {
             }
         }
 
-        // 	CoredFileMeshData< PlyVertex< Real > > mesh;		// no depth recorded, so can not trim
-        // 	CoredFileMeshData< PlyColorVertex< Real > > mesh;	// no depth, but has color
-        CoredFileMeshData<PlyColorAndValueVertex<REAL> > mesh;
+        // the extracted surface is kept in memory (no temporary files): it has the density value (for trimming) and
+        // the color of each vertex.
+        CoredVectorMeshData<PlyColorAndValueVertex<REAL> > mesh;
         {
             t.restart();
             profiler.start();
             double valueSum = 0, weightSum = 0;
-            typename Octree<REAL>::template MultiThreadedEvaluator<DEGREE, BType> evaluator(&tree, solution, threads_);
-#pragma omp parallel for num_threads(threads_) reduction( + : valueSum, weightSum )
+            typename Octree<REAL>::template MultiThreadedEvaluator<DEGREE, BType> evaluator(&tree, solution, threads);
+#pragma omp parallel for num_threads(threads) reduction( + : valueSum, weightSum )
             for (int j = 0; j < samples->size(); j++) {
                 ProjectiveData<OrientedPoint3D<REAL>, REAL> &sample = (*samples)[j].sample;
                 REAL w = sample.weight;
@@ -421,8 +442,7 @@ namespace easy3d {
             }
             isoValue = (REAL) (valueSum / weightSum);
 
-            PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
-            if (!colors && samples)
+            if (!cls && samples)
                 delete samples, samples = nullptr;
             if (verbose_) {
                 profiler.print(" - Got average:          ");
@@ -482,13 +502,7 @@ namespace easy3d {
 
         //////////////////////////////////////////////////////////////////////////
 
-        PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
-        SurfaceMesh *result = convert_to_mesh(mesh, iXForm, density_attr_name, colors);
-        const std::string &file_name = file_system::name_less_extension(cloud->name()) + "_Poisson.ply";
-        result->set_name(file_name);
-        LOG(INFO) << "total reconstruction time: " << w.time_string();
-
-        return result;
+        return details::convert_to_mesh(mesh, iXForm, density_attr_name, cls != nullptr, threads);
     }
 
 
@@ -578,4 +592,326 @@ namespace easy3d {
         return trimmed_mesh;
     }
 
+
+    namespace details {
+
+        // crops the mesh to the box: a face is kept if its centroid is inside the (half-open) box [min, max)
+        void crop(SurfaceMesh *mesh, const vec3 &box_min, const vec3 &box_max) {
+            for (auto f : mesh->faces()) {
+                vec3 c(0, 0, 0);
+                int n = 0;
+                for (auto v : mesh->vertices(f)) {
+                    c += mesh->position(v);
+                    ++n;
+                }
+                c /= static_cast<float>(n);
+                for (int i = 0; i < 3; ++i) {
+                    if (c[i] < box_min[i] || c[i] >= box_max[i]) {
+                        mesh->delete_face(f);
+                        break;
+                    }
+                }
+            }
+            mesh->garbage_collection();
+        }
+
+
+        // merges the tiles into a single mesh. The border vertices of different tiles that are closer than
+        // \p tolerance are merged (using a hash grid with cell size \p tolerance).
+        SurfaceMesh *stitch_tiles(const std::vector<SurfaceMesh *> &tiles, float tolerance,
+                                  const std::string &density_attr_name) {
+            SurfaceMesh *result = new SurfaceMesh;
+            auto density = result->add_vertex_property<float>(density_attr_name);
+            SurfaceMesh::VertexProperty<vec3> color;
+            bool has_colors = !tiles.empty();
+            for (auto tile : tiles)
+                has_colors = has_colors && tile->get_vertex_property<vec3>("v:color");
+            if (has_colors)
+                color = result->add_vertex_property<vec3>("v:color");
+
+            std::size_t nv = 0, nf = 0;
+            for (auto tile : tiles) {
+                nv += tile->n_vertices();
+                nf += tile->n_faces();
+            }
+            result->reserve(nv, nv + nf, nf);
+
+            struct Candidate {
+                SurfaceMesh::Vertex v;
+                std::size_t tile;
+            };
+            std::unordered_map<std::int64_t, std::vector<Candidate> > grid;
+            auto cell = [tolerance](const vec3 &p, int i) -> std::int64_t {
+                return static_cast<std::int64_t>(std::floor(p[i] / tolerance));
+            };
+            auto key = [](std::int64_t x, std::int64_t y, std::int64_t z) -> std::int64_t {
+                return ((x & 0x1FFFFF) << 42) | ((y & 0x1FFFFF) << 21) | (z & 0x1FFFFF);
+            };
+
+            std::size_t num_merged = 0, num_failed = 0;
+            std::vector<SurfaceMesh::Vertex> face_vts;
+            for (std::size_t t = 0; t < tiles.size(); ++t) {
+                SurfaceMesh *tile = tiles[t];
+                auto tile_density = tile->get_vertex_property<float>(density_attr_name);
+                auto tile_color = tile->get_vertex_property<vec3>("v:color");
+
+                std::vector<SurfaceMesh::Vertex> vmap(tile->vertices_size());
+                for (auto v : tile->vertices()) {
+                    const vec3 &p = tile->position(v);
+                    if (tile->is_boundary(v)) { // the seams can only be on the border of the tiles
+                        const std::int64_t x = cell(p, 0), y = cell(p, 1), z = cell(p, 2);
+                        float min_dist = tolerance;
+                        for (std::int64_t i = x - 1; i <= x + 1; ++i) {
+                            for (std::int64_t j = y - 1; j <= y + 1; ++j) {
+                                for (std::int64_t k = z - 1; k <= z + 1; ++k) {
+                                    auto pos = grid.find(key(i, j, k));
+                                    if (pos == grid.end())
+                                        continue;
+                                    for (const auto &c : pos->second) {
+                                        const float d = distance(p, result->position(c.v));
+                                        if (c.tile != t && d < min_dist) {
+                                            min_dist = d;
+                                            vmap[v.idx()] = c.v;
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                        if (vmap[v.idx()].is_valid()) {
+                            ++num_merged;
+                            continue;
+                        }
+                        vmap[v.idx()] = result->add_vertex(p);
+                        grid[key(x, y, z)].push_back({vmap[v.idx()], t});
+                    } else
+                        vmap[v.idx()] = result->add_vertex(p);
+
+                    if (tile_density)
+                        density[vmap[v.idx()]] = tile_density[v];
+                    if (has_colors)
+                        color[vmap[v.idx()]] = tile_color[v];
+                }
+
+                for (auto f : tile->faces()) {
+                    face_vts.clear();
+                    for (auto v : tile->vertices(f))
+                        face_vts.push_back(vmap[v.idx()]);
+                    // a face may collapse if two of its vertices have been merged
+                    std::vector<SurfaceMesh::Vertex> sorted = face_vts;
+                    std::sort(sorted.begin(), sorted.end());
+                    if (std::unique(sorted.begin(), sorted.end()) != sorted.end() || !result->add_face(face_vts).is_valid())
+                        ++num_failed;
+                }
+            }
+
+            // remove the vertices that are not used by any faces
+            for (auto v : result->vertices()) {
+                if (result->is_isolated(v))
+                    result->delete_vertex(v);
+            }
+            result->garbage_collection();
+
+            LOG(INFO) << "tiles stitched: " << num_merged << " vertices merged along the seams";
+            if (num_failed > 0)
+                LOG(WARNING) << num_failed << " faces could not be added (degenerate or non-manifold after merging)";
+            return result;
+        }
+    }
+
+
+    bool PoissonReconstruction::reconstruct_tiles(const PointCloud *cloud, float tile_size, float overlap,
+                                                  float trim_value, float area_ratio,
+                                                  const std::string &density_attr_name,
+                                                  std::vector<SurfaceMesh *> &tiles, float &cell_size) {
+        if (!cloud) {
+            LOG(ERROR) << "nullptr point cloud";
+            return false;
+        }
+
+        PointCloud::VertexProperty<vec3> normals = cloud->get_vertex_property<vec3>("v:normal");
+        if (!normals) {
+            LOG(ERROR) << "normals are required";
+            return false;
+        }
+
+        if (tile_size <= 0 || overlap < 0) {
+            LOG(ERROR) << "invalid tile size (" << tile_size << ") or overlap (" << overlap << ")";
+            return false;
+        }
+
+        // The tiles share the same grid of the finest octree cells: a tile is a block of n^3 cells and it is
+        // reconstructed within a cube that is m cells larger on each side, i.e., the octree of each tile has
+        // n + 2m = 2^depth cells along each axis.
+        const int resolution = 1 << depth_;
+        cell_size = tile_size * (1.0f + 2.0f * overlap) / static_cast<float>(resolution);
+        const int m = std::max(1, static_cast<int>(std::ceil(overlap * tile_size / cell_size)));
+        const int n = resolution - 2 * m;
+        if (n <= 0) {
+            LOG(ERROR) << "overlap (" << overlap << ") is too large";
+            return false;
+        }
+        const float step = static_cast<float>(n) * cell_size;
+        const float margin = static_cast<float>(m) * cell_size;
+        const float cube_size = static_cast<float>(resolution) * cell_size;
+
+        const Box3 &box = cloud->bounding_box();
+        const vec3 origin = box.min();
+        int dims[3];
+        for (int i = 0; i < 3; ++i)
+            dims[i] = std::max(1, static_cast<int>(std::ceil(box.range(i) / step)));
+        const int num_tiles = dims[0] * dims[1] * dims[2];
+        LOG(INFO) << "tiled reconstruction: " << dims[0] << " x " << dims[1] << " x " << dims[2] << " tiles";
+
+        // bucket the points by the tiles containing them (counting sort)
+        const std::vector<vec3> &points = cloud->points();
+        const int num = static_cast<int>(points.size());
+        auto tile_coord = [&](const vec3 &p, int i) -> int {
+            const int c = static_cast<int>(std::floor((p[i] - origin[i]) / step));
+            return std::min(std::max(c, 0), dims[i] - 1);
+        };
+        std::vector<int> point_tile(num);
+        std::vector<int> offsets(num_tiles + 1, 0);
+        for (int i = 0; i < num; ++i) {
+            const vec3 &p = points[i];
+            point_tile[i] = (tile_coord(p, 2) * dims[1] + tile_coord(p, 1)) * dims[0] + tile_coord(p, 0);
+            ++offsets[point_tile[i] + 1];
+        }
+        for (int i = 0; i < num_tiles; ++i)
+            offsets[i + 1] += offsets[i];
+        std::vector<int> order(num);
+        {
+            std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+            for (int i = 0; i < num; ++i)
+                order[fill[point_tile[i]]++] = i;
+        }
+        std::vector<int>().swap(point_tile);
+
+        const std::vector<vec3> &nms = normals.vector();
+        PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
+        const int reach = static_cast<int>(std::ceil(margin / step)); // the neighboring tiles covered by the margin
+
+        // The octree of the Poisson reconstruction numbers its nodes with a process-wide counter, so only one tile
+        // can be reconstructed at a time (using all threads). The serial post-processing of a tile (trimming and
+        // cropping) runs in another thread while the next tile is being reconstructed.
+        StopWatch w;
+        std::vector<SurfaceMesh *> results(num_tiles, nullptr);
+        std::thread post_processing;
+        std::vector<vec3> tile_points, tile_normals, tile_colors;
+        for (int k = 0; k < dims[2]; ++k) {
+            for (int j = 0; j < dims[1]; ++j) {
+                for (int i = 0; i < dims[0]; ++i) {
+                    const int id = (k * dims[1] + j) * dims[0] + i;
+                    if (offsets[id] == offsets[id + 1])
+                        continue;
+
+                    const vec3 core_min = origin + vec3(i, j, k) * step;
+                    const vec3 cube_min = core_min - vec3(margin);
+                    const vec3 cube_max = cube_min + vec3(cube_size);
+
+                    // the tile is cropped along the seams only: the surface may extend beyond the bounding box
+                    vec3 crop_min(-FLT_MAX), crop_max(FLT_MAX);
+                    const int coord[3] = {i, j, k};
+                    for (int d = 0; d < 3; ++d) {
+                        if (coord[d] > 0)
+                            crop_min[d] = core_min[d];
+                        if (coord[d] < dims[d] - 1)
+                            crop_max[d] = core_min[d] + step;
+                    }
+
+                    // collect the points inside the cube
+                    tile_points.clear();
+                    tile_normals.clear();
+                    tile_colors.clear();
+                    for (int nk = std::max(0, k - reach); nk <= std::min(dims[2] - 1, k + reach); ++nk) {
+                        for (int nj = std::max(0, j - reach); nj <= std::min(dims[1] - 1, j + reach); ++nj) {
+                            for (int ni = std::max(0, i - reach); ni <= std::min(dims[0] - 1, i + reach); ++ni) {
+                                const int nid = (nk * dims[1] + nj) * dims[0] + ni;
+                                for (int idx = offsets[nid]; idx < offsets[nid + 1]; ++idx) {
+                                    const int pid = order[idx];
+                                    const vec3 &p = points[pid];
+                                    if (p.x <= cube_min.x || p.y <= cube_min.y || p.z <= cube_min.z ||
+                                        p.x >= cube_max.x || p.y >= cube_max.y || p.z >= cube_max.z)
+                                        continue;
+                                    tile_points.push_back(p);
+                                    tile_normals.push_back(nms[pid]);
+                                    if (colors)
+                                        tile_colors.push_back(colors[PointCloud::Vertex(pid)]);
+                                }
+                            }
+                        }
+                    }
+
+                    LOG(INFO) << "reconstructing tile (" << i << ", " << j << ", " << k << ") with "
+                              << tile_points.size() << " points...";
+                    SurfaceMesh *mesh = reconstruct(tile_points.size(), tile_points[0], tile_normals[0],
+                                                    colors ? tile_colors[0].data() : nullptr, cube_min, cube_size,
+                                                    density_attr_name);
+                    if (!mesh)
+                        continue;
+
+                    const std::string name = file_system::name_less_extension(cloud->name()) + "_Poisson_tile_" +
+                                             std::to_string(i) + "_" + std::to_string(j) + "_" + std::to_string(k) +
+                                             ".ply";
+                    if (post_processing.joinable())
+                        post_processing.join();
+                    post_processing = std::thread([=, &results, &density_attr_name]() {
+                        SurfaceMesh *result = mesh;
+                        if (trim_value > 0) {
+                            result = trim(mesh, density_attr_name, trim_value, area_ratio, triangulate_mesh_);
+                            delete mesh;
+                        }
+                        details::crop(result, crop_min, crop_max);
+                        if (result->n_faces() == 0) {
+                            delete result;
+                            return;
+                        }
+                        result->set_name(name);
+                        results[id] = result;
+                    });
+                }
+            }
+        }
+        if (post_processing.joinable())
+            post_processing.join();
+
+        for (auto mesh : results) {
+            if (mesh)
+                tiles.push_back(mesh);
+        }
+
+        LOG(INFO) << tiles.size() << " tiles reconstructed. " << w.time_string();
+        return !tiles.empty();
+    }
+
+
+    bool PoissonReconstruction::apply_tiled(const PointCloud *cloud, float tile_size,
+                                            std::vector<SurfaceMesh *> &tiles, float overlap, float trim_value,
+                                            float area_ratio, const std::string &density_attr_name) {
+        float cell_size = 0;
+        return reconstruct_tiles(cloud, tile_size, overlap, trim_value, area_ratio, density_attr_name, tiles,
+                                 cell_size);
+    }
+
+
+    SurfaceMesh *PoissonReconstruction::apply_tiled(const PointCloud *cloud, float tile_size, float overlap,
+                                                    float trim_value, float area_ratio,
+                                                    const std::string &density_attr_name) {
+        std::vector<SurfaceMesh *> tiles;
+        float cell_size = 0;
+        if (!reconstruct_tiles(cloud, tile_size, overlap, trim_value, area_ratio, density_attr_name, tiles,
+                               cell_size))
+            return nullptr;
+
+        // the vertices on a seam usually lie on the same edges of the shared octree grid in both tiles and only differ
+        // slightly in their positions. Those further apart are not merged, leaving a crack.
+        SurfaceMesh *result = details::stitch_tiles(tiles, 0.25f * cell_size, density_attr_name);
+        for (auto tile : tiles)
+            delete tile;
+
+        const std::string &file_name = file_system::name_less_extension(cloud->name()) + "_Poisson.ply";
+        result->set_name(file_name);
+        return result;
+    }
+
+
 } // namespace easy3d
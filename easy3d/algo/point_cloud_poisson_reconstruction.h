@@ -27,6 +27,9 @@
 
 
 #include <string>
+#include <vector>
+
+#include <easy3d/core/types.h>
 
 
 namespace easy3d {
@@ -46,6 +49,30 @@ namespace easy3d {
         // reconstruction
         SurfaceMesh *apply(const PointCloud *cloud, const std::string &density_attr_name = "v:density");
 
+        // tiled reconstruction, for point clouds that are too large to be reconstructed in a single octree.
+        // The bounding box of the point cloud is partitioned into cubic tiles with edge length (about) \p tile_size.
+        // Each tile is reconstructed from the points within the tile enlarged by \p overlap (relative to the tile
+        // size) on each side, trimmed using trim() if \p trim_value > 0, and cropped back to the tile along the seams
+        // with its neighbors (a face is kept by the tile containing its centroid). The depth set by set_depth()
+        // applies to each tile, and all tiles share the same octree grid. However, each tile solves its own system
+        // from its own points, so the surfaces of neighboring tiles may cross the same grid edge at (slightly)
+        // different positions and the tiles do not exactly agree along the seams. The tiles are reconstructed one
+        // after another (each one using all threads), and the trimming and cropping of a tile overlap with the
+        // reconstruction of the next one. The peak memory is thus determined by the tile size (and not the size of
+        // the point cloud). Tiles without points are skipped.
+        // This function returns the reconstructed tiles, which are owned by the caller.
+        bool apply_tiled(const PointCloud *cloud, float tile_size, std::vector<SurfaceMesh *> &tiles,
+                         float overlap = 0.1f, float trim_value = 0.0f, float area_ratio = 0.001f,
+                         const std::string &density_attr_name = "v:density");
+
+        // tiled reconstruction that stitches the tiles into a single mesh: the border vertices of neighboring tiles
+        // that are within a quarter of the finest octree cell are merged. The seams are thus welded only where the
+        // vertices of both tiles fall within this tolerance, and small cracks may remain elsewhere (i.e., a closed
+        // surface may not be closed in the result).
+        SurfaceMesh *apply_tiled(const PointCloud *cloud, float tile_size, float overlap = 0.1f,
+                                 float trim_value = 0.0f, float area_ratio = 0.001f,
+                                 const std::string &density_attr_name = "v:density");
+
         // trimming
         static SurfaceMesh *trim(
                 SurfaceMesh *mesh,
@@ -64,6 +91,19 @@ namespace easy3d {
         void set_confidence(bool v) { confidence_ = v; }
         void set_normal_weight(bool v) { normalWeight_ = v; }
         void set_verbose(bool v) { verbose_ = v; }
+        // the number of threads. A value <= 0 (default) follows the OpenMP setting, i.e., omp_get_max_threads().
+        void set_threads(int v) { threads_ = v; }
+
+    private:
+        // reconstructs a surface from the \p num points within the cube specified by \p cube_min and \p cube_size.
+        // \p colors can be nullptr.
+        SurfaceMesh *reconstruct(std::size_t num, const float *points, const float *normals, const float *colors,
+                                 const vec3 &cube_min, float cube_size, const std::string &density_attr_name);
+
+        // the tiled reconstruction. \p cell_size returns the size of the finest octree cells.
+        bool reconstruct_tiles(const PointCloud *cloud, float tile_size, float overlap, float trim_value,
+                               float area_ratio, const std::string &density_attr_name,
+                               std::vector<SurfaceMesh *> &tiles, float &cell_size);
 
     private:
         /*
@@ -26,8 +26,10 @@
 
 #include <set>
 #include <list>
+#include <cmath>
 
 #include <easy3d/core/point_cloud.h>
+#include <easy3d/util/stop_watch.h>
 
 #include <3rd_party/RANSAC-1.1/RansacShapeDetector.h>
 #include <3rd_party/RANSAC-1.1/PlanePrimitiveShapeConstructor.h>
@@ -40,6 +42,7 @@
 #include <3rd_party/RANSAC-1.1/CylinderPrimitiveShape.h>
 #include <3rd_party/RANSAC-1.1/ConePrimitiveShape.h>
 #include <3rd_party/RANSAC-1.1/TorusPrimitiveShape.h>
+#include <3rd_party/RANSAC-1.1/MiscLib/Random.h>
 
 //OMG, there is class with exactly the same name in RANSAC!!!
 typedef ::PointCloud PointCloud_Ransac;
@@ -47,6 +50,37 @@ typedef ::PointCloud PointCloud_Ransac;
 namespace easy3d {
 
 
+    namespace details {
+
+        // adds the constructors of the primitive types to the detector
+        void add_constructors(RansacShapeDetector &detector, const std::set<PrimitivesRansac::PrimType> &types) {
+            std::set<PrimitivesRansac::PrimType>::const_iterator it = types.begin();
+            for (; it != types.end(); ++it) {
+                switch (*it) {
+                    case PrimitivesRansac::PLANE:
+                        detector.Add(new PlanePrimitiveShapeConstructor());
+                        break;
+                    case PrimitivesRansac::CYLINDER:
+                        detector.Add(new CylinderPrimitiveShapeConstructor());
+                        break;
+                    case PrimitivesRansac::SPHERE:
+                        detector.Add(new SpherePrimitiveShapeConstructor());
+                        break;
+                    case PrimitivesRansac::CONE:
+                        detector.Add(new ConePrimitiveShapeConstructor());
+                        break;
+                    case PrimitivesRansac::TORUS:
+                        detector.Add(new TorusPrimitiveShapeConstructor());
+                        break;
+                    case PrimitivesRansac::UNKNOWN:
+                        break;
+                }
+            }
+        }
+
+    }
+
+
     // returns the number of detected primitives
     int do_detect(
             PointCloud *cloud,
@@ -79,28 +113,7 @@ namespace easy3d {
         RansacShapeDetector detector(ransacOptions); // the detector object
 
         // set which primitives are to be detected by adding the respective constructors
-        std::set<PrimitivesRansac::PrimType>::const_iterator it = types.begin();
-        for (; it != types.end(); ++it) {
-            switch (*it) {
-                case PrimitivesRansac::PLANE:
-                    detector.Add(new PlanePrimitiveShapeConstructor());
-                    break;
-                case PrimitivesRansac::CYLINDER:
-                    detector.Add(new CylinderPrimitiveShapeConstructor());
-                    break;
-                case PrimitivesRansac::SPHERE:
-                    detector.Add(new SpherePrimitiveShapeConstructor());
-                    break;
-                case PrimitivesRansac::CONE:
-                    detector.Add(new ConePrimitiveShapeConstructor());
-                    break;
-                case PrimitivesRansac::TORUS:
-                    detector.Add(new TorusPrimitiveShapeConstructor());
-                    break;
-                case PrimitivesRansac::UNKNOWN:
-                    break;
-            }
-        }
+        details::add_constructors(detector, types);
 
         MiscLib::Vector<std::pair<MiscLib::RefCountPtr<PrimitiveShape>, size_t> > shapes; // stores the detected shapes
         // returns number of unassigned points
@@ -328,4 +341,381 @@ namespace easy3d {
         return do_detect(cloud, pc, types_, min_support, dist_thresh, bitmap_reso, normal_thresh, overlook_prob);
     }
 
+
+    namespace details {
+
+        // a primitive detected in a tile
+        struct TilePrimitive {
+            int type;
+            int tile;
+            vec3 position;      // plane: a point on the plane; sphere/torus: center; cylinder: a point on the axis; cone: apex
+            vec3 direction;     // plane: normal; cylinder/cone/torus: axis
+            float radius;       // sphere/cylinder: radius; cone: angle; torus: major radius
+            float minor_radius; // torus: minor radius
+            std::vector<int> points;    // sorted
+        };
+
+
+        // extracts the parameters of a detected primitive
+        void extract_parameters(const PrimitiveShape *primitive, TilePrimitive &p) {
+            p.type = static_cast<int>(primitive->Identifier());
+            p.radius = p.minor_radius = 0.0f;
+            switch (p.type) {
+                case PrimitivesRansac::PLANE: {
+                    const Plane &pl = dynamic_cast<const PlanePrimitiveShape *>(primitive)->Internal();
+                    p.position = vec3(pl.getPosition().getValue());
+                    p.direction = vec3(pl.getNormal().getValue());
+                    break;
+                }
+                case PrimitivesRansac::SPHERE: {
+                    const Sphere &sphere = dynamic_cast<const SpherePrimitiveShape *>(primitive)->Internal();
+                    p.position = vec3(sphere.Center().getValue());
+                    p.direction = vec3(0, 0, 1);
+                    p.radius = sphere.Radius();
+                    break;
+                }
+                case PrimitivesRansac::CYLINDER: {
+                    const Cylinder &cylinder = dynamic_cast<const CylinderPrimitiveShape *>(primitive)->Internal();
+                    p.position = vec3(cylinder.AxisPosition().getValue());
+                    p.direction = vec3(cylinder.AxisDirection().getValue());
+                    p.radius = cylinder.Radius();
+                    break;
+                }
+                case PrimitivesRansac::CONE: {
+                    const Cone &cone = dynamic_cast<const ConePrimitiveShape *>(primitive)->Internal();
+                    p.position = vec3(cone.Center().getValue());
+                    p.direction = vec3(cone.AxisDirection().getValue());
+                    p.radius = cone.Angle();
+                    break;
+                }
+                case PrimitivesRansac::TORUS: {
+                    const Torus &torus = dynamic_cast<const TorusPrimitiveShape *>(primitive)->Internal();
+                    p.position = vec3(torus.Center().getValue());
+                    p.direction = vec3(torus.AxisDirection().getValue());
+                    p.radius = torus.MajorRadius();
+                    p.minor_radius = torus.MinorRadius();
+                    break;
+                }
+                default:
+                    break;
+            }
+            p.direction = normalize(p.direction);
+        }
+
+
+        // checks if two primitives (of the same type) describe the same surface, i.e., they are coplanar, coaxial
+        // (with the same radius), or co-spherical.
+        bool same_primitive(const TilePrimitive &a, const TilePrimitive &b, float epsilon, float normal_thresh) {
+            if (a.type != b.type)
+                return false;
+            const float cos_angle = std::abs(dot(a.direction, b.direction));
+            switch (a.type) {
+                case PrimitivesRansac::PLANE:
+                    return cos_angle >= normal_thresh &&
+                           std::abs(dot(a.direction, b.position - a.position)) < epsilon &&
+                           std::abs(dot(b.direction, a.position - b.position)) < epsilon;
+                case PrimitivesRansac::SPHERE:
+                    return distance(a.position, b.position) < epsilon && std::abs(a.radius - b.radius) < epsilon;
+                case PrimitivesRansac::CYLINDER: {
+                    const vec3 d = b.position - a.position;
+                    const float dist_to_axis = length(d - dot(d, a.direction) * a.direction);
+                    return cos_angle >= normal_thresh && dist_to_axis < epsilon &&
+                           std::abs(a.radius - b.radius) < epsilon;
+                }
+                case PrimitivesRansac::CONE:
+                    return cos_angle >= normal_thresh && dot(a.direction, b.direction) > 0 &&
+                           distance(a.position, b.position) < epsilon &&
+                           std::abs(a.radius - b.radius) < std::acos(std::min(1.0f, normal_thresh));
+                case PrimitivesRansac::TORUS:
+                    return cos_angle >= normal_thresh && distance(a.position, b.position) < epsilon &&
+                           std::abs(a.radius - b.radius) < epsilon &&
+                           std::abs(a.minor_radius - b.minor_radius) < epsilon;
+                default:
+                    return false;
+            }
+        }
+
+
+        // checks if two primitives share any points (each of them has sorted points)
+        bool share_points(const TilePrimitive &a, const TilePrimitive &b) {
+            auto i = a.points.begin(), j = b.points.begin();
+            while (i != a.points.end() && j != b.points.end()) {
+                if (*i < *j)
+                    ++i;
+                else if (*j < *i)
+                    ++j;
+                else
+                    return true;
+            }
+            return false;
+        }
+
+
+        inline int find_root(std::vector<int> &parent, int i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        }
+
+    }
+
+
+    int PrimitivesRansac::detect_tiled(
+            PointCloud *cloud,
+            float tile_size /* = 0.25f */,
+            float overlap /* = 0.1f */,
+            unsigned int min_support /* = 1000 */,
+            float dist_thresh /* = 0.005 */,
+            float bitmap_reso /* = 0.02 */,
+            float normal_thresh /* = 0.8 */,
+            float overlook_prob /* = 0.001 */ ) {
+        if (!cloud) {
+            LOG(ERROR) << "no data exists";
+            return 0;
+        }
+
+        if (cloud->n_vertices() < 3) {
+            LOG(ERROR) << "point set has less than 3 points";
+            return 0;
+        }
+
+        if (types_.empty()) {
+            LOG(ERROR) << "no primitive types specified";
+            return 0;
+        }
+
+        PointCloud::VertexProperty<vec3> normals = cloud->get_vertex_property<vec3>("v:normal");
+        if (!normals) {
+            LOG(ERROR) << "RANSAC Detector requires point cloud normals";
+            return 0;
+        }
+
+        if (tile_size <= 0 || overlap < 0) {
+            LOG(ERROR) << "invalid tile size (" << tile_size << ") or overlap (" << overlap << ")";
+            return 0;
+        }
+
+        StopWatch w;
+
+        // the thresholds are relative to the bounding box of the entire point cloud, so all tiles use the same
+        // (absolute) thresholds.
+        const Box3 &box = cloud->bounding_box();
+        const float scale = std::max(box.range(0), std::max(box.range(1), box.range(2)));
+        const float epsilon = dist_thresh * scale;
+        const float bitmap_epsilon = bitmap_reso * scale;
+        const float step = tile_size * scale;
+        const float margin = overlap * step;
+
+        int dims[3];
+        for (int i = 0; i < 3; ++i)
+            dims[i] = std::max(1, static_cast<int>(std::ceil(box.range(i) / step)));
+        const int num_tiles = dims[0] * dims[1] * dims[2];
+
+        // bucket the points by the tiles containing them (counting sort)
+        const std::vector<vec3> &pts = cloud->points();
+        const std::vector<vec3> &nms = normals.vector();
+        const int num = static_cast<int>(pts.size());
+        auto tile_coord = [&](const vec3 &p, int i) -> int {
+            const int c = static_cast<int>(std::floor((p[i] - box.min(i)) / step));
+            return std::min(std::max(c, 0), dims[i] - 1);
+        };
+        std::vector<int> point_tile(num);
+        std::vector<int> offsets(num_tiles + 1, 0);
+        for (int i = 0; i < num; ++i) {
+            const vec3 &p = pts[i];
+            point_tile[i] = (tile_coord(p, 2) * dims[1] + tile_coord(p, 1)) * dims[0] + tile_coord(p, 0);
+            ++offsets[point_tile[i] + 1];
+        }
+        for (int i = 0; i < num_tiles; ++i)
+            offsets[i + 1] += offsets[i];
+        std::vector<int> order(num);
+        {
+            std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+            for (int i = 0; i < num; ++i)
+                order[fill[point_tile[i]]++] = i;
+        }
+
+        LOG(INFO) << "detecting primitives in " << dims[0] << " x " << dims[1] << " x " << dims[2] << " tiles...";
+
+        // detect the primitives in each tile (in parallel)
+        const int reach = static_cast<int>(std::ceil(margin / step));
+        std::vector<std::vector<details::TilePrimitive> > tile_primitives(num_tiles);
+#pragma omp parallel for schedule(dynamic)
+        for (int id = 0; id < num_tiles; ++id) {
+            if (offsets[id + 1] - offsets[id] < static_cast<int>(min_support))
+                continue;
+            const int ti = id % dims[0], tj = (id / dims[0]) % dims[1], tk = id / (dims[0] * dims[1]);
+            const vec3 tile_min = vec3(box.min(0), box.min(1), box.min(2)) + vec3(ti, tj, tk) * step - vec3(margin);
+            const vec3 tile_max = tile_min + vec3(step + 2 * margin);
+
+            PointCloud_Ransac pc;
+            for (int k = std::max(0, tk - reach); k <= std::min(dims[2] - 1, tk + reach); ++k) {
+                for (int j = std::max(0, tj - reach); j <= std::min(dims[1] - 1, tj + reach); ++j) {
+                    for (int i = std::max(0, ti - reach); i <= std::min(dims[0] - 1, ti + reach); ++i) {
+                        const int nid = (k * dims[1] + j) * dims[0] + i;
+                        for (int idx = offsets[nid]; idx < offsets[nid + 1]; ++idx) {
+                            const int v = order[idx];
+                            const vec3 &p = pts[v];
+                            if (p.x < tile_min.x || p.y < tile_min.y || p.z < tile_min.z ||
+                                p.x > tile_max.x || p.y > tile_max.y || p.z > tile_max.z)
+                                continue;
+                            const vec3 &n = nms[v];
+                            Point point(Vec3f(p.x, p.y, p.z), Vec3f(n.x, n.y, n.z));
+                            point.index = v;
+                            pc.push_back(point);
+                        }
+                    }
+                }
+            }
+            pc.setBBox(Vec3f(tile_min.x, tile_min.y, tile_min.z), Vec3f(tile_max.x, tile_max.y, tile_max.z));
+
+            RansacShapeDetector::Options ransacOptions;
+            ransacOptions.m_minSupport = min_support;
+            ransacOptions.m_epsilon = epsilon;
+            ransacOptions.m_bitmapEpsilon = bitmap_epsilon;
+            ransacOptions.m_normalThresh = normal_thresh;
+            ransacOptions.m_probability = overlook_prob;
+            RansacShapeDetector detector(ransacOptions);
+            details::add_constructors(detector, types_);
+
+            // each tile has its own random sequence, so the result does not depend on the scheduling of the threads
+            MiscLib::rn_setseed(static_cast<std::size_t>(id));
+
+            MiscLib::Vector<std::pair<MiscLib::RefCountPtr<PrimitiveShape>, size_t> > shapes;
+            detector.Detect(pc, 0, pc.size(), &shapes);
+
+            // see do_detect() for how the points of the shapes are stored
+            PointCloud_Ransac::reverse_iterator point_itr = pc.rbegin();
+            for (std::size_t s = 0; s < shapes.size(); ++s) {
+                const std::size_t support = shapes[s].second;
+                details::TilePrimitive primitive;
+                primitive.tile = id;
+                for (std::size_t count = 0; count < support; ++count, ++point_itr)
+                    primitive.points.push_back(static_cast<int>(point_itr->index));
+                if (support < min_support)
+                    continue;
+                details::extract_parameters(shapes[s].first, primitive);
+                std::sort(primitive.points.begin(), primitive.points.end());
+                tile_primitives[id].push_back(std::move(primitive));
+            }
+        }
+
+        // gather the primitives in the order of the tiles (so the result is deterministic). The primitives of tile
+        // t are [tile_offsets[t], tile_offsets[t + 1]).
+        std::vector<details::TilePrimitive> primitives;
+        std::vector<int> tile_offsets(num_tiles + 1, 0);
+        for (int id = 0; id < num_tiles; ++id) {
+            for (auto &p : tile_primitives[id])
+                primitives.push_back(std::move(p));
+            tile_offsets[id + 1] = static_cast<int>(primitives.size());
+        }
+        std::vector<std::vector<details::TilePrimitive> >().swap(tile_primitives);
+        const int num_primitives = static_cast<int>(primitives.size());
+
+        // merge the coplanar/coaxial/co-spherical primitives detected in neighboring tiles. Two primitives are merged
+        // only if they also share points in the overlap of their tiles, so disconnected parts of the same surface
+        // (e.g., coplanar facades of different buildings) stay separated, as in detect(). Only the primitives of
+        // adjacent tiles are compared (each pair of tiles once), and the candidate pairs of the tiles are collected in
+        // parallel. RANSAC has already separated the primitives within a tile.
+        const float merge_epsilon = 3.0f * epsilon; // the same as the internal distance threshold of RANSAC
+        std::vector<std::vector<std::pair<int, int> > > same_pairs(num_tiles);
+#pragma omp parallel for schedule(dynamic)
+        for (int ta = 0; ta < num_tiles; ++ta) {
+            if (tile_offsets[ta] == tile_offsets[ta + 1])
+                continue;
+            const int ti = ta % dims[0], tj = (ta / dims[0]) % dims[1], tk = ta / (dims[0] * dims[1]);
+            for (int k = std::max(0, tk - 1); k <= std::min(dims[2] - 1, tk + 1); ++k) {
+                for (int j = std::max(0, tj - 1); j <= std::min(dims[1] - 1, tj + 1); ++j) {
+                    for (int i = std::max(0, ti - 1); i <= std::min(dims[0] - 1, ti + 1); ++i) {
+                        const int tb = (k * dims[1] + j) * dims[0] + i;
+                        if (tb <= ta)
+                            continue;
+                        for (int a = tile_offsets[ta]; a < tile_offsets[ta + 1]; ++a) {
+                            for (int b = tile_offsets[tb]; b < tile_offsets[tb + 1]; ++b) {
+                                if (details::same_primitive(primitives[a], primitives[b], merge_epsilon, normal_thresh) &&
+                                    details::share_points(primitives[a], primitives[b]))
+                                    same_pairs[ta].emplace_back(a, b);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<int> parent(num_primitives);
+        for (int i = 0; i < num_primitives; ++i)
+            parent[i] = i;
+        for (const auto &pairs : same_pairs) {
+            for (const auto &pair : pairs) {
+                const int ra = details::find_root(parent, pair.first);
+                const int rb = details::find_root(parent, pair.second);
+                if (ra != rb)
+                    parent[std::max(ra, rb)] = std::min(ra, rb);
+            }
+        }
+
+        // label the points. A point in the overlap of several tiles may have been assigned to several primitives: the
+        // assignment made in the tile containing the point takes precedence.
+        auto primitive_types = cloud->vertex_property<int>("v:primitive_type", PrimitivesRansac::UNKNOWN);
+        auto primitive_indices = cloud->vertex_property<int>("v:primitive_index", -1);
+        primitive_types.vector().assign(cloud->n_vertices(), PrimitivesRansac::UNKNOWN);
+        primitive_indices.vector().assign(cloud->n_vertices(), -1);
+
+        std::vector<int> index(num_primitives, -1);
+        int count = 0;
+        for (int i = 0; i < num_primitives; ++i) {
+            const int root = details::find_root(parent, i);
+            if (index[root] == -1)
+                index[root] = count++;
+            index[i] = index[root];
+        }
+
+        std::vector<char> owned(num, 0);
+        for (int i = 0; i < num_primitives; ++i) {
+            const details::TilePrimitive &primitive = primitives[i];
+            for (int v : primitive.points) {
+                const bool own = (point_tile[v] == primitive.tile);
+                if (owned[v] && !own)
+                    continue;
+                const PointCloud::Vertex vertex(v);
+                if (primitive_indices[vertex] != -1 && !own && !owned[v])
+                    continue; // first come first served among the tiles not containing the point
+                primitive_types[vertex] = primitive.type;
+                primitive_indices[vertex] = index[i];
+                owned[v] = own;
+            }
+        }
+
+        // the merged primitives may have lost points to other primitives in the overlapping regions
+        std::vector<std::size_t> support(count, 0);
+        for (int v = 0; v < num; ++v) {
+            const int idx = primitive_indices.vector()[v];
+            if (idx != -1)
+                ++support[idx];
+        }
+        std::vector<int> final_index(count, -1);
+        int num_final = 0;
+        for (int i = 0; i < count; ++i) {
+            if (support[i] >= min_support)
+                final_index[i] = num_final++;
+        }
+        std::size_t remaining = 0;
+        for (int v = 0; v < num; ++v) {
+            int &idx = primitive_indices.vector()[v];
+            if (idx != -1)
+                idx = final_index[idx];
+            if (idx == -1) {
+                primitive_types.vector()[v] = PrimitivesRansac::UNKNOWN;
+                ++remaining;
+            }
+        }
+
+        LOG(INFO) << num_final << " primitives extracted (merged from " << num_primitives << " primitives in the tiles). "
+                  << remaining << " points remained. " << w.time_string();
+        return num_final;
+    }
+
+
 }
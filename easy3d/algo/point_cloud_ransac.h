@@ -86,6 +86,27 @@ namespace easy3d {
                 float overlook_prob = 0.001f    // the probability with which a primitive is overlooked
         );
 
+        // extract primitives from the entire point cloud, tile by tile (in parallel). This is intended for large point
+        // clouds, for which detection on the entire point cloud is slow and memory demanding.
+        // The bounding box is partitioned into cubic tiles of size \p tile_size (relative to the bounding box width),
+        // and primitives are detected from the points in each tile enlarged by \p overlap (relative to the tile size)
+        // on each side. The coplanar, coaxial, and co-spherical primitives detected in neighboring tiles are then
+        // merged if they share points in the overlapping regions, and a point in the overlapping regions belongs to
+        // the primitive detected in the tile containing it.
+        // The other parameters are the same as in detect(), but the thresholds are still relative to the bounding box
+        // of the entire point cloud. NOTE: min_support applies to each tile.
+        // returns the number of extracted primitives, which are stored as properties in the same way as detect().
+        int detect_tiled(
+                PointCloud *cloud,
+                float tile_size = 0.25f,    // relative to the bounding box width
+                float overlap = 0.1f,       // relative to the tile size
+                unsigned int min_support = 1000,
+                float dist_thresh = 0.005f,
+                float bitmap_reso = 0.02f,
+                float normal_thresh = 0.8f,
+                float overlook_prob = 0.001f
+        );
+
     private:
         std::set<PrimType> types_;
     };
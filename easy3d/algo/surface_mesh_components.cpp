@@ -27,6 +27,8 @@
 #include <easy3d/algo/surface_mesh_enumerator.h>
 #include <easy3d/algo/tessellator.h>
 
+#include <algorithm>
+
 
 namespace easy3d {
 
@@ -128,36 +130,52 @@ namespace easy3d {
     }
 
 
-    std::vector<SurfaceMeshComponent> SurfaceMeshComponent::extract(SurfaceMesh *mesh) {
-        auto component_id = mesh->add_vertex_property<int>("SurfaceMeshComponentExtractor::extract::component_id");
-        int nb_components = SurfaceMeshEnumerator::enumerate_connected_components(mesh, component_id);
-        std::vector<SurfaceMeshComponent> result;
-        for (int i = 0; i < nb_components; i++) {
-            result.emplace_back(SurfaceMeshComponent(mesh));
-        }
+    namespace details {
 
-        for (auto v : mesh->vertices()) {
-            int idx = component_id[v];
-            result[idx].vertices_.push_back(v);
+        // distributes the elements into the components in a single pass (and in the order of the elements)
+        template<typename Element, typename Elements, typename ComponentOf>
+        void bucket(const Elements &elements, int num_components, std::vector<std::vector<Element> *> &buckets,
+                    ComponentOf component_of) {
+            std::vector<std::size_t> sizes(num_components, 0);
+            for (auto e : elements)
+                ++sizes[component_of(e)];
+            for (int i = 0; i < num_components; ++i)
+                buckets[i]->reserve(sizes[i]);
+            for (auto e : elements)
+                buckets[component_of(e)]->push_back(e);
         }
 
-        for (auto f : mesh->faces()) {
-            auto v = mesh->vertices(f).begin();
-            int idx = component_id[*v];
-            result[idx].faces_.push_back(f);
-        }
+    }
 
-        for (auto e : mesh->edges()) {
-            auto v = mesh->vertex(e, 0);
-            int idx = component_id[v];
-            result[idx].edges_.push_back(e);
-        }
 
-        for (auto h : mesh->halfedges()) {
-            auto v = mesh->to_vertex(h);
-            int idx = component_id[v];
-            result[idx].halfedges_.push_back(h);
-        }
+    std::vector<SurfaceMeshComponent> SurfaceMeshComponent::extract(SurfaceMesh *mesh) {
+        auto component_id = mesh->add_vertex_property<int>("SurfaceMeshComponentExtractor::extract::component_id");
+        int nb_components = SurfaceMeshEnumerator::enumerate_connected_components(mesh, component_id);
+        std::vector<SurfaceMeshComponent> result(nb_components, SurfaceMeshComponent(mesh));
+
+        std::vector<std::vector<Vertex> *> vertices(nb_components);
+        std::vector<std::vector<Face> *> faces(nb_components);
+        std::vector<std::vector<Edge> *> edges(nb_components);
+        std::vector<std::vector<Halfedge> *> halfedges(nb_components);
+        for (int i = 0; i < nb_components; i++) {
+            vertices[i] = &result[i].vertices_;
+            faces[i] = &result[i].faces_;
+            edges[i] = &result[i].edges_;
+            halfedges[i] = &result[i].halfedges_;
+        }
+
+        details::bucket(mesh->vertices(), nb_components, vertices, [&](Vertex v) {
+            return component_id[v];
+        });
+        details::bucket(mesh->faces(), nb_components, faces, [&](Face f) {
+            return component_id[mesh->to_vertex(mesh->halfedge(f))];
+        });
+        details::bucket(mesh->edges(), nb_components, edges, [&](Edge e) {
+            return component_id[mesh->vertex(e, 0)];
+        });
+        details::bucket(mesh->halfedges(), nb_components, halfedges, [&](Halfedge h) {
+            return component_id[mesh->to_vertex(h)];
+        });
 
         mesh->remove_vertex_property(component_id);
 
@@ -166,69 +184,42 @@ namespace easy3d {
 
 
     SurfaceMeshComponent SurfaceMeshComponent::extract(SurfaceMesh *mesh, SurfaceMesh::Face face) {
-        auto component_id = mesh->add_vertex_property<int>("SurfaceMeshComponentExtractor::extract::component_id");
-        SurfaceMeshEnumerator::enumerate_connected_components(mesh, component_id);
-
-        SurfaceMeshComponent result(mesh);
         auto vertex = mesh->vertices(face).begin();
-        int comp_id = component_id[*vertex];
-
-        for (auto v : mesh->vertices()) {
-            if (component_id[v] == comp_id)
-                result.vertices_.push_back(v);
-        }
-
-        for (auto f : mesh->faces()) {
-            auto v = mesh->vertices(f).begin();
-            if (component_id[*v] == comp_id)
-                result.faces_.push_back(f);
-        }
-
-        for (auto e : mesh->edges()) {
-            auto v = mesh->vertex(e, 0);
-            if (component_id[v] == comp_id)
-                result.edges_.push_back(e);
-        }
-
-        for (auto h : mesh->halfedges()) {
-            auto v = mesh->to_vertex(h);
-            if (component_id[v] == comp_id)
-                result.halfedges_.push_back(h);
-        }
-
-        return result;
+        return extract(mesh, *vertex);
     }
 
 
     SurfaceMeshComponent SurfaceMeshComponent::extract(SurfaceMesh *mesh, SurfaceMesh::Vertex vertex) {
-        auto component_id = mesh->add_vertex_property<int>("SurfaceMeshComponentExtractor::extract::component_id");
-        SurfaceMeshEnumerator::enumerate_connected_components(mesh, component_id);
+        // only the component containing the seed is visited (breadth-first)
+        auto visited = mesh->add_vertex_property<bool>("SurfaceMeshComponentExtractor::extract::visited", false);
 
         SurfaceMeshComponent result(mesh);
-        int comp_id = component_id[vertex];
-
-        for (auto v : mesh->vertices()) {
-            if (component_id[v] == comp_id)
-                result.vertices_.push_back(v);
-        }
-
-        for (auto f : mesh->faces()) {
-            auto v = mesh->vertices(f).begin();
-            if (component_id[*v] == comp_id)
-                result.faces_.push_back(f);
-        }
-
-        for (auto e : mesh->edges()) {
-            auto v = mesh->vertex(e, 0);
-            if (component_id[v] == comp_id)
-                result.edges_.push_back(e);
+        result.vertices_.push_back(vertex);
+        visited[vertex] = true;
+        for (std::size_t i = 0; i < result.vertices_.size(); ++i) {
+            const Vertex v = result.vertices_[i];
+            for (auto h : mesh->halfedges(v)) {
+                const Vertex t = mesh->to_vertex(h);
+                if (!visited[t]) {
+                    visited[t] = true;
+                    result.vertices_.push_back(t);
+                }
+                // each halfedge/edge/face is collected from a unique vertex
+                result.halfedges_.push_back(mesh->opposite_halfedge(h));
+                if (h.idx() < mesh->opposite_halfedge(h).idx())
+                    result.edges_.push_back(mesh->edge(h));
+                const Face f = mesh->face(h);
+                if (f.is_valid() && mesh->halfedge(f) == h)
+                    result.faces_.push_back(f);
+            }
         }
+        mesh->remove_vertex_property(visited);
 
-        for (auto h : mesh->halfedges()) {
-            auto v = mesh->to_vertex(h);
-            if (component_id[v] == comp_id)
-                result.halfedges_.push_back(h);
-        }
+        // keep the elements in the order of the mesh
+        std::sort(result.vertices_.begin(), result.vertices_.end());
+        std::sort(result.faces_.begin(), result.faces_.end());
+        std::sort(result.edges_.begin(), result.edges_.end());
+        std::sort(result.halfedges_.begin(), result.halfedges_.end());
 
         return result;
     }
@@ -24,6 +24,7 @@
 
 
 #include <easy3d/algo/surface_mesh_enumerator.h>
+#include <easy3d/algo/union_find.h>
 
 #include <stack>
 
@@ -51,16 +52,22 @@ namespace easy3d {
 
 
     int SurfaceMeshEnumerator::enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::VertexProperty<int> id) {
-        id.vector().assign(mesh->n_vertices(), -1);
+        const int num_edges = static_cast<int>(mesh->edges_size());
+        UnionFind uf(mesh->vertices_size());
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (!mesh->is_deleted(e))
+                uf.unite(mesh->vertex(e, 0).idx(), mesh->vertex(e, 1).idx());
+        }
 
-        int cur_id = 0;
-        for (auto v : mesh->vertices()) {
-            if (id[v] == -1) {
-                propagate_connected_component(mesh, id, v, cur_id);
-                ++cur_id;
-            }
+        std::vector<bool> deleted;
+        if (mesh->n_vertices() != mesh->vertices_size()) {  // there are deleted vertices
+            deleted.resize(mesh->vertices_size());
+            for (unsigned int i = 0; i < mesh->vertices_size(); ++i)
+                deleted[i] = mesh->is_deleted(SurfaceMesh::Vertex(i));
         }
-        return cur_id;
+        return uf.label(id.vector(), deleted);
     }
 
 
@@ -90,16 +97,26 @@ namespace easy3d {
 
 
     int SurfaceMeshEnumerator::enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::FaceProperty<int> id) {
-        id.vector().assign(mesh->n_faces(), -1);
+        const int num_edges = static_cast<int>(mesh->edges_size());
+        UnionFind uf(mesh->faces_size());
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (mesh->is_deleted(e))
+                continue;
+            const auto f0 = mesh->face(mesh->halfedge(e, 0));
+            const auto f1 = mesh->face(mesh->halfedge(e, 1));
+            if (f0.is_valid() && f1.is_valid())
+                uf.unite(f0.idx(), f1.idx());
+        }
 
-        int cur_id = 0;
-        for (auto f : mesh->faces()) {
-            if (id[f] == -1) {
-                propagate_connected_component(mesh, id, f, cur_id);
-                ++cur_id;
-            }
+        std::vector<bool> deleted;
+        if (mesh->n_faces() != mesh->faces_size()) {  // there are deleted faces
+            deleted.resize(mesh->faces_size());
+            for (unsigned int i = 0; i < mesh->faces_size(); ++i)
+                deleted[i] = mesh->is_deleted(SurfaceMesh::Face(i));
         }
-        return cur_id;
+        return uf.label(id.vector(), deleted);
     }
 
-}
\ No newline at end of file
+}
@@ -60,6 +60,9 @@ namespace easy3d {
 
         /**
          * Enumerates the connected components of a surface mesh from its vertices.
+         * The components are labeled by a parallel union-find over the edges. They are numbered in the order of
+         * their first vertices, i.e., the result is the same as propagating the components from the vertices in
+         * order. Deleted vertices are labeled as -1.
          * @param mesh The input mesh.
          * @param id The vertex property storing the result.
          * @return The number of connected components.
@@ -67,7 +70,9 @@ namespace easy3d {
         static int enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::VertexProperty<int> id);
 
         /**
-         * Enumerates the connected components of a surface mesh from its faces.
+         * Enumerates the connected components of a surface mesh from its faces (two faces are connected if they
+         * share an edge). The components are labeled by a parallel union-find over the edges. They are numbered in
+         * the order of their first faces. Deleted faces are labeled as -1.
          * @param mesh The input mesh.
          * @param id The face property storing the result.
          * @return The number of connected components.
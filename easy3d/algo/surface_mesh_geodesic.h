@@ -39,6 +39,7 @@ namespace easy3d {
      * heap structure. See the following paper for more details:
      *  - Kimmel and Sethian. Computing geodesic paths on manifolds. Proceedings of the National Academy of Sciences,
      *    95(15):8431–8435, 1998.
+     * \sa SurfaceMeshGeodesicHeat, which is more efficient if distances from many different seed sets are needed.
      */
     class SurfaceMeshGeodesic {
     public:
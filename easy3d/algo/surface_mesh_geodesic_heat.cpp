@@ -0,0 +1,346 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <easy3d/algo/surface_mesh_geodesic_heat.h>
+#include <easy3d/util/logging.h>
+#include <easy3d/util/stop_watch.h>
+
+#include <cfloat>
+#include <Eigen/Sparse>
+
+
+namespace easy3d {
+
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+    using Triplet = Eigen::Triplet<double>;
+
+
+    struct SurfaceMeshGeodesicHeat::Operators {
+        // vertex index -> row of the systems (-1 for isolated/deleted vertices)
+        std::vector<int> row;
+        // row -> connected component
+        std::vector<int> component;
+        int num_components;
+
+        // per face (3 entries each): the rows of the corners, the gradient basis (n x e_i / 2A), and the vectors
+        // whose dot product with the per-face vector field gives the integrated divergence at the corners.
+        std::vector<int> corners;
+        std::vector<dvec3> gradient;
+        std::vector<dvec3> divergence;
+
+        Eigen::SimplicialLDLT<SparseMatrix> heat;
+        Eigen::SimplicialLDLT<SparseMatrix> poisson;
+    };
+
+    //-----------------------------------------------------------------------------
+
+    SurfaceMeshGeodesicHeat::SurfaceMeshGeodesicHeat(SurfaceMesh *mesh, float time_factor)
+            : mesh_(mesh), time_factor_(time_factor), operators_(nullptr) {
+        distance_ = mesh_->vertex_property<float>("v:geodesic:distance");
+        precompute();
+    }
+
+    //-----------------------------------------------------------------------------
+
+    SurfaceMeshGeodesicHeat::~SurfaceMeshGeodesicHeat() {
+        delete operators_;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshGeodesicHeat::precompute() {
+        delete operators_;
+        operators_ = nullptr;
+
+        if (!mesh_->is_triangle_mesh()) {
+            LOG(ERROR) << "heat method geodesic requires a triangle mesh";
+            return false;
+        }
+
+        StopWatch w;
+        Operators *op = new Operators;
+
+        // the rows of the systems (isolated vertices are not part of the systems)
+        op->row.assign(mesh_->vertices_size(), -1);
+        int n = 0;
+        for (auto v : mesh_->vertices()) {
+            if (!mesh_->is_isolated(v))
+                op->row[v.idx()] = n++;
+        }
+        if (n == 0) {
+            LOG(ERROR) << "mesh has no faces";
+            delete op;
+            return false;
+        }
+
+        // connected components: needed to fix the constant of the Poisson problem on each component
+        op->component.assign(n, -1);
+        op->num_components = 0;
+        std::vector<SurfaceMesh::Vertex> stack;
+        for (auto v : mesh_->vertices()) {
+            const int r = op->row[v.idx()];
+            if (r < 0 || op->component[r] >= 0)
+                continue;
+            op->component[r] = op->num_components;
+            stack.push_back(v);
+            while (!stack.empty()) {
+                auto cur = stack.back();
+                stack.pop_back();
+                for (auto vv : mesh_->vertices(cur)) {
+                    const int rr = op->row[vv.idx()];
+                    if (op->component[rr] < 0) {
+                        op->component[rr] = op->num_components;
+                        stack.push_back(vv);
+                    }
+                }
+            }
+            ++op->num_components;
+        }
+
+        // per-face differential operators, mass, and stiffness
+        const auto &points = mesh_->points();
+        std::vector<double> mass(n, 0.0);
+        std::vector<Triplet> stiffness;
+        stiffness.reserve(mesh_->n_faces() * 12);
+        op->corners.reserve(mesh_->n_faces() * 3);
+        op->gradient.reserve(mesh_->n_faces() * 3);
+        op->divergence.reserve(mesh_->n_faces() * 3);
+
+        double sum_edge_length = 0.0;
+        for (auto e : mesh_->edges())
+            sum_edge_length += mesh_->edge_length(e);
+        const double h = sum_edge_length / mesh_->n_edges();
+
+        for (auto f : mesh_->faces()) {
+            int id[3];
+            dvec3 p[3];
+            int k = 0;
+            for (auto v : mesh_->vertices(f)) {
+                id[k] = op->row[v.idx()];
+                p[k] = dvec3(points[v.idx()]);
+                ++k;
+            }
+
+            const dvec3 normal = cross(p[1] - p[0], p[2] - p[0]);
+            const double area2 = norm(normal); // twice the face area
+
+            // cotangents of the angles at the corners
+            double cot[3] = {0.0, 0.0, 0.0};
+            dvec3 grad[3] = {dvec3(0, 0, 0), dvec3(0, 0, 0), dvec3(0, 0, 0)};
+            if (area2 > std::numeric_limits<double>::min()) {
+                const dvec3 n = normal / area2;
+                for (int i = 0; i < 3; ++i) {
+                    const dvec3 &pi = p[i];
+                    const dvec3 &pj = p[(i + 1) % 3];
+                    const dvec3 &pk = p[(i + 2) % 3];
+                    cot[i] = dot(pj - pi, pk - pi) / area2;
+                    grad[i] = cross(n, pk - pj) / area2;
+                }
+            }
+
+            for (int i = 0; i < 3; ++i) {
+                const int j = (i + 1) % 3;
+                const int l = (i + 2) % 3;
+                op->corners.push_back(id[i]);
+                op->gradient.push_back(grad[i]);
+                op->divergence.push_back(0.5 * (cot[l] * (p[j] - p[i]) + cot[j] * (p[l] - p[i])));
+
+                mass[id[i]] += area2 / 6.0;
+
+                // edge (j, l) is opposite to corner i
+                const double w = 0.5 * cot[i];
+                stiffness.emplace_back(id[j], id[j], w);
+                stiffness.emplace_back(id[l], id[l], w);
+                stiffness.emplace_back(id[j], id[l], -w);
+                stiffness.emplace_back(id[l], id[j], -w);
+            }
+        }
+
+        SparseMatrix K(n, n);
+        K.setFromTriplets(stiffness.begin(), stiffness.end());
+
+        // heat flow: (M + tK) u = u0
+        const double t = time_factor_ * h * h;
+        SparseMatrix A = t * K;
+        for (int i = 0; i < n; ++i)
+            A.coeffRef(i, i) += mass[i];
+        op->heat.compute(A);
+        if (op->heat.info() != Eigen::Success) {
+            LOG(ERROR) << "failed to factorize the heat flow system";
+            delete op;
+            return false;
+        }
+
+        // Poisson: K is only semi-definite, so a tiny regularization makes the factorization succeed. The right-hand
+        // side is made compatible per component in solve(), and the remaining constant is fixed by the seeds.
+        double diag = 0.0;
+        for (int i = 0; i < n; ++i)
+            diag += K.coeff(i, i);
+        const double eps = 1e-8 * diag / n;
+        for (int i = 0; i < n; ++i)
+            K.coeffRef(i, i) += eps;
+        op->poisson.compute(K);
+        if (op->poisson.info() != Eigen::Success) {
+            LOG(ERROR) << "failed to factorize the Poisson system";
+            delete op;
+            return false;
+        }
+
+        operators_ = op;
+        LOG(INFO) << "heat method geodesic: operators factorized. " << w.time_string();
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshGeodesicHeat::solve(const std::vector<SurfaceMesh::Vertex> &seed, std::vector<float> &distance) const {
+        const Operators *op = operators_;
+        const int n = static_cast<int>(op->component.size());
+
+        // step 1: heat flow
+        Eigen::VectorXd u0 = Eigen::VectorXd::Zero(n);
+        std::vector<bool> has_seed(op->num_components, false);
+        for (auto v : seed) {
+            const int r = op->row[v.idx()];
+            if (r >= 0) {
+                u0[r] = 1.0;
+                has_seed[op->component[r]] = true;
+            }
+        }
+        const Eigen::VectorXd u = op->heat.solve(u0);
+        if (op->heat.info() != Eigen::Success)
+            return false;
+
+        // step 2: normalized (negated) gradient per face, and its integrated divergence per vertex
+        Eigen::VectorXd div = Eigen::VectorXd::Zero(n);
+        const std::size_t num_corners = op->corners.size();
+        for (std::size_t c = 0; c < num_corners; c += 3) {
+            const dvec3 g = u[op->corners[c]] * op->gradient[c] +
+                            u[op->corners[c + 1]] * op->gradient[c + 1] +
+                            u[op->corners[c + 2]] * op->gradient[c + 2];
+            const double len = norm(g);
+            if (len < std::numeric_limits<double>::min())
+                continue;
+            const dvec3 X = -g / len;
+            for (std::size_t i = c; i < c + 3; ++i)
+                div[op->corners[i]] += dot(op->divergence[i], X);
+        }
+
+        // make the right-hand side compatible with the (pure Neumann) Poisson problem on each component
+        std::vector<double> sum(op->num_components, 0.0);
+        std::vector<int> count(op->num_components, 0);
+        for (int i = 0; i < n; ++i) {
+            sum[op->component[i]] += div[i];
+            ++count[op->component[i]];
+        }
+        for (int i = 0; i < n; ++i)
+            div[i] -= sum[op->component[i]] / count[op->component[i]];
+
+        // step 3: recover the distance by solving K phi = -div
+        const Eigen::VectorXd phi = op->poisson.solve(-div);
+        if (op->poisson.info() != Eigen::Success)
+            return false;
+
+        // shift such that the smallest distance of each component is zero
+        std::vector<double> shift(op->num_components, DBL_MAX);
+        for (int i = 0; i < n; ++i)
+            shift[op->component[i]] = std::min(shift[op->component[i]], phi[i]);
+
+        distance.assign(op->row.size(), FLT_MAX);
+        for (std::size_t idx = 0; idx < op->row.size(); ++idx) {
+            const int r = op->row[idx];
+            if (r >= 0 && has_seed[op->component[r]])
+                distance[idx] = static_cast<float>(phi[r] - shift[op->component[r]]);
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshGeodesicHeat::compute(const std::vector<SurfaceMesh::Vertex> &seed) {
+        if (!operators_ || operators_->row.size() != mesh_->vertices_size()) {
+            LOG(ERROR) << "operators not available or out of date (call precompute() first)";
+            return false;
+        }
+
+        std::vector<float> distance;
+        if (!solve(seed, distance)) {
+            LOG(ERROR) << "failed computing geodesic distances";
+            return false;
+        }
+
+        distance_.vector() = distance;
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshGeodesicHeat::compute(const std::vector<std::vector<SurfaceMesh::Vertex> > &seeds,
+                                          std::vector<std::vector<float> > &distances) const {
+        if (!operators_ || operators_->row.size() != mesh_->vertices_size()) {
+            LOG(ERROR) << "operators not available or out of date (call precompute() first)";
+            return false;
+        }
+
+        distances.resize(seeds.size());
+        const int num = static_cast<int>(seeds.size());
+        int failed = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : failed)
+        for (int i = 0; i < num; ++i) {
+            if (!solve(seeds[i], distances[i]))
+                ++failed;
+        }
+
+        if (failed > 0) {
+            LOG(ERROR) << "failed computing geodesic distances for " << failed << " (out of " << num << ") seed sets";
+            return false;
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    void SurfaceMeshGeodesicHeat::distance_to_texture_coordinates() {
+        // find maximum distance
+        float maxdist(0);
+        for (auto v : mesh_->vertices()) {
+            if (distance_[v] < FLT_MAX) {
+                maxdist = std::max(maxdist, distance_[v]);
+            }
+        }
+
+        auto tex = mesh_->vertex_property<vec2>("v:texcoord");
+        for (auto v : mesh_->vertices()) {
+            if (distance_[v] < FLT_MAX) {
+                tex[v] = vec2(distance_[v] / maxdist, 0.0);
+            } else {
+                tex[v] = vec2(1.0, 0.0);
+            }
+        }
+    }
+
+//=============================================================================
+} // namespace easy3d
+//=============================================================================
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASY3D_ALGO_SURFACE_MESH_GEODESIC_HEAT_H
+#define EASY3D_ALGO_SURFACE_MESH_GEODESIC_HEAT_H
+
+#include <easy3d/core/surface_mesh.h>
+#include <vector>
+
+
+namespace easy3d {
+
+    /**
+     * \brief This class computes geodesic distance from a set of seed vertices using the heat method.
+     * \details The heat flow and the Poisson systems are factorized once (in the constructor or in precompute()).
+     * After that, each query only requires two back-substitutions and a few linear passes over the faces, which
+     * makes this class the method of choice for computing distances from many different seed sets on the same mesh.
+     * Queries given as a batch (see compute(const std::vector< std::vector<SurfaceMesh::Vertex> >&, ...)) are
+     * solved in parallel. See the following paper for more details:
+     *  - Keenan Crane, Clarisse Weischedel, and Max Wardetzky. Geodesics in heat: a new approach to computing
+     *    distance based on heat flow. ACM Transactions on Graphics, 32(5), 2013.
+     * \note The mesh must be a triangle mesh. The factorization is invalidated by any change to the mesh geometry
+     *      or connectivity, in which case precompute() has to be called again.
+     * \sa SurfaceMeshGeodesic, which computes (exact along the front) distances by fast marching and supports
+     *      early termination by \c maxdist and \c maxnum.
+     */
+    class SurfaceMeshGeodesicHeat {
+    public:
+        //! \brief Construct from mesh and factorize the heat and Poisson systems.
+        //! \param mesh The mesh on which to compute the geodesic distances.
+        //! \param time_factor The time step of the heat flow is \p time_factor * h^2, where h is the mean edge length.
+        //!     Larger values result in smoother (but less accurate) distances. Default: 1.0.
+        SurfaceMeshGeodesicHeat(SurfaceMesh *mesh, float time_factor = 1.0f);
+
+        // destructor
+        ~SurfaceMeshGeodesicHeat();
+
+        //! \brief (Re)build and factorize the operators. Call this after the mesh has been modified.
+        //! \return \c true on success.
+        bool precompute();
+
+        //! \brief Compute geodesic distances from specified seed points.
+        //! \details The result is stored in the vertex property "v:geodesic:distance", i.e., the same property used
+        //!     by SurfaceMeshGeodesic, and can be accessed through operator().
+        //! \param[in] seed The vector of seed vertices.
+        //! \return \c true on success.
+        bool compute(const std::vector<SurfaceMesh::Vertex> &seed);
+
+        //! \brief Compute geodesic distances for a batch of seed sets in parallel.
+        //! \details This function does not touch the properties of the mesh and can be called concurrently.
+        //! \param[in] seeds The seed sets. Each seed set results in one distance field.
+        //! \param[out] distances The distance fields. distances[i][v.idx()] is the geodesic distance of vertex v
+        //!     with respect to the i-th seed set.
+        //! \return \c true on success.
+        bool compute(const std::vector< std::vector<SurfaceMesh::Vertex> > &seeds,
+                     std::vector< std::vector<float> > &distances) const;
+
+        //! \brief Access the computed geodesic distance.
+        //! \param[in] v The vertex for which to return the geodesic distance.
+        //! \return The geodesic distance of vertex \p v.
+        //! \pre The function compute() has been called before.
+        float operator()(SurfaceMesh::Vertex v) const { return distance_[v]; }
+
+        //! \brief Use the normalized distances as texture coordinates
+        //! \details Stores the normalized distances in a vertex property of type
+        //! TexCoord named "v:texcoord". Re-uses any existing vertex property of the
+        //! same type and name.
+        void distance_to_texture_coordinates();
+
+    private:
+        // computes the distance field of a single seed set. The result is indexed by vertex index.
+        bool solve(const std::vector<SurfaceMesh::Vertex> &seed, std::vector<float> &distance) const;
+
+        // no copy
+        SurfaceMeshGeodesicHeat(const SurfaceMeshGeodesicHeat &);
+        SurfaceMeshGeodesicHeat &operator=(const SurfaceMeshGeodesicHeat &);
+
+    private:
+        SurfaceMesh *mesh_;
+        float time_factor_;
+
+        SurfaceMesh::VertexProperty<float> distance_;
+
+        // the factorized heat flow and Poisson systems (hides Eigen from the interface)
+        struct Operators;
+        Operators *operators_;
+    };
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_SURFACE_MESH_GEODESIC_HEAT_H
@@ -25,77 +25,199 @@
 
 #include <easy3d/algo/surface_mesh_planar_partition.h>
 
-#include <set>
-#include <stack>
+#include <algorithm>
 
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/algo/surface_mesh_curvature.h>
 #include <easy3d/algo/surface_mesh_geometry.h>
+#include <easy3d/algo/union_find.h>
 #include <easy3d/util/logging.h>
 
 
 namespace easy3d {
 
-    SurfaceMeshPlanarPartition::SurfaceMeshPlanarPartition(SurfaceMesh *mesh)
-            : mesh_(mesh) {
-        mesh_->update_vertex_normals();
-        vertex_normal_ = mesh_->get_vertex_property<vec3>("v:normal");
-    }
+    namespace details {
 
+        // the connectivity and geometry of the faces stored in flat arrays (indexed by face/vertex indices).
+        struct FlatMesh {
+            const std::vector<vec3> *points;
+            std::vector<int> face_vertex_ptr, face_vertices;    // CSR: the vertices of each face
+            std::vector<int> face_adj_ptr, face_adj;            // CSR: the faces sharing an edge with each face
+            std::vector<int> vertex_face_ptr, vertex_faces;     // CSR: the faces incident to each vertex
+            std::vector<float> areas;
+            std::vector<vec3> normals;
+            std::vector<vec3> centroids;
+        };
 
-    SurfaceMeshPlanarPartition::~SurfaceMeshPlanarPartition(void) {
-    }
 
+        void build_flat_mesh(SurfaceMesh *mesh, FlatMesh &fm) {
+            const int nf = static_cast<int>(mesh->faces_size());
+            const int nv = static_cast<int>(mesh->vertices_size());
+            fm.points = &mesh->points();
+
+            fm.face_vertex_ptr.assign(nf + 1, 0);
+            fm.face_adj_ptr.assign(nf + 1, 0);
+            fm.vertex_face_ptr.assign(nv + 1, 0);
+            for (auto f : mesh->faces()) {
+                const int valence = static_cast<int>(mesh->valence(f));
+                fm.face_vertex_ptr[f.idx() + 1] = valence;
+                for (auto h : mesh->halfedges(f)) {
+                    if (!mesh->is_boundary(mesh->opposite_halfedge(h)))
+                        ++fm.face_adj_ptr[f.idx() + 1];
+                    ++fm.vertex_face_ptr[mesh->to_vertex(h).idx() + 1];
+                }
+            }
+            for (int i = 0; i < nf; ++i) {
+                fm.face_vertex_ptr[i + 1] += fm.face_vertex_ptr[i];
+                fm.face_adj_ptr[i + 1] += fm.face_adj_ptr[i];
+            }
+            for (int i = 0; i < nv; ++i)
+                fm.vertex_face_ptr[i + 1] += fm.vertex_face_ptr[i];
+
+            fm.face_vertices.resize(fm.face_vertex_ptr[nf]);
+            fm.face_adj.resize(fm.face_adj_ptr[nf]);
+            fm.areas.assign(nf, 0.0f);
+            fm.normals.assign(nf, vec3(0, 0, 0));
+            fm.centroids.assign(nf, vec3(0, 0, 0));
+            const auto &points = *fm.points;
+#pragma omp parallel for
+            for (int i = 0; i < nf; ++i) {
+                const SurfaceMesh::Face f(i);
+                if (mesh->is_deleted(f))
+                    continue;
+                int *vts = &fm.face_vertices[fm.face_vertex_ptr[i]];
+                int *adj = &fm.face_adj[fm.face_adj_ptr[i]];
+                for (auto h : mesh->halfedges(f)) {
+                    *vts++ = mesh->to_vertex(h).idx();
+                    const auto op = mesh->opposite_halfedge(h);
+                    if (!mesh->is_boundary(op))
+                        *adj++ = mesh->face(op).idx();
+                }
+
+                // area, normal, and centroid of the (possibly non-planar) polygon by fanning it into triangles
+                const int begin = fm.face_vertex_ptr[i], end = fm.face_vertex_ptr[i + 1];
+                const vec3 &p0 = points[fm.face_vertices[begin]];
+                vec3 area_normal(0, 0, 0), centroid(0, 0, 0);
+                float area = 0.0f;
+                for (int j = begin + 1; j + 1 < end; ++j) {
+                    const vec3 &p1 = points[fm.face_vertices[j]];
+                    const vec3 &p2 = points[fm.face_vertices[j + 1]];
+                    const vec3 n = cross(p1 - p0, p2 - p0);
+                    const float a = n.length() * 0.5f;
+                    area_normal += n;
+                    centroid += (p0 + p1 + p2) * (a / 3.0f);
+                    area += a;
+                }
+                fm.areas[i] = area;
+                fm.normals[i] = normalize(area_normal);
+                if (area > 0.0f)
+                    fm.centroids[i] = centroid / area;
+                else {
+                    for (int j = begin; j < end; ++j)
+                        fm.centroids[i] += points[fm.face_vertices[j]];
+                    fm.centroids[i] /= static_cast<float>(end - begin);
+                }
+            }
 
-    bool SurfaceMeshPlanarPartition::can_grow(SurfaceMesh::Vertex v) const {
-        for (auto f : mesh_->faces(v)) {
-            if (planar_segments_[f] == -1)
-                return true;
+            // the incident faces of the vertices (in the order of the faces)
+            std::vector<int> pos(fm.vertex_face_ptr.begin(), fm.vertex_face_ptr.end() - 1);
+            fm.vertex_faces.resize(fm.vertex_face_ptr[nv]);
+            for (int i = 0; i < nf; ++i) {
+                for (int j = fm.face_vertex_ptr[i]; j < fm.face_vertex_ptr[i + 1]; ++j)
+                    fm.vertex_faces[pos[fm.face_vertices[j]]++] = i;
+            }
         }
-        return false;
-    }
 
 
-    float SurfaceMeshPlanarPartition::max_squared_dist_to_plane(SurfaceMesh::Face f, const Plane3& plane) const {
-        float max_sd = -FLT_MAX;
-        for (auto v : mesh_->vertices(f)) {
-            float sd = plane.squared_ditance(mesh_->position(v));
-            if (sd > max_sd)
-                max_sd = sd;
+        // can grow if one of its incident faces has not been grouped into a planar segment.
+        inline bool can_grow(const FlatMesh &fm, int v, const std::vector<int> &segments) {
+            for (int j = fm.vertex_face_ptr[v]; j < fm.vertex_face_ptr[v + 1]; ++j) {
+                if (segments[fm.vertex_faces[j]] == -1)
+                    return true;
+            }
+            return false;
         }
-        return max_sd;
-    }
 
 
-    void SurfaceMeshPlanarPartition::propagate(SurfaceMesh::Vertex v, int id, float max_allowed_squared_deviation) {
-        std::stack<SurfaceMesh::Face> stack;
-        for (auto f : mesh_->faces(v))
-            stack.push(f);
+        // for all the vertices in a face
+        inline float max_squared_dist_to_plane(const FlatMesh &fm, int f, const Plane3 &plane) {
+            float max_sd = -FLT_MAX;
+            for (int j = fm.face_vertex_ptr[f]; j < fm.face_vertex_ptr[f + 1]; ++j)
+                max_sd = std::max(max_sd, plane.squared_ditance((*fm.points)[fm.face_vertices[j]]));
+            return max_sd;
+        }
 
-        const Plane3 plane(mesh_->position(v), vertex_normal_[v]);
 
-        while (!stack.empty()) {
-            SurfaceMesh::Face top = stack.top();
-            stack.pop();
+        // Collects the faces of the planar segment grown from the seed vertex v: all the faces that are connected to
+        // v through faces within the max allowed deviation from the plane at v, and not belonging to any segment.
+        // The 'visited' flags are all false before and after the call.
+        void grow(const FlatMesh &fm, int v, const vec3 &normal, float max_allowed_squared_deviation,
+                  const std::vector<int> &segments, std::vector<char> &visited, std::vector<int> &region) {
+            region.clear();
+            const Plane3 plane((*fm.points)[v], normal);
 
-            if (planar_segments_[top] == -1 && max_squared_dist_to_plane(top, plane) <= max_allowed_squared_deviation) {
-                planar_segments_[top] = id;
+            std::vector<int> stack;
+            for (int j = fm.vertex_face_ptr[v]; j < fm.vertex_face_ptr[v + 1]; ++j)
+                stack.push_back(fm.vertex_faces[j]);
 
-                for (auto h : mesh_->halfedges(top)) {
-                    auto op = mesh_->opposite_halfedge(h);
-                    if (!mesh_->is_boundary(op)) {
-                        auto f = mesh_->face(op);
-                        if (planar_segments_[f] == -1) {
-                            stack.push(f);
-                        }
-                    }
+            while (!stack.empty()) {
+                const int top = stack.back();
+                stack.pop_back();
+                if (visited[top] || segments[top] != -1)
+                    continue;
+                if (max_squared_dist_to_plane(fm, top, plane) > max_allowed_squared_deviation)
+                    continue;   // may be reached again from another face, but it will be rejected again
+
+                visited[top] = 1;
+                region.push_back(top);
+                for (int j = fm.face_adj_ptr[top]; j < fm.face_adj_ptr[top + 1]; ++j) {
+                    const int f = fm.face_adj[j];
+                    if (!visited[f] && segments[f] == -1)
+                        stack.push_back(f);
                 }
             }
+
+            for (auto f : region)
+                visited[f] = 0;
+        }
+
+
+        // the supporting planes of the segments (area-weighted centroids and normals)
+        void fit_planes(const FlatMesh &fm, const std::vector<int> &segments, int num_segments,
+                        std::vector<Plane3> &planes, std::vector<vec3> &centers) {
+            std::vector<vec3> centroids(num_segments, vec3(0, 0, 0)), normals(num_segments, vec3(0, 0, 0));
+            std::vector<float> areas(num_segments, 0.0f);
+            for (std::size_t f = 0; f < segments.size(); ++f) {
+                const int id = segments[f];
+                if (id < 0)
+                    continue;
+                centroids[id] += fm.centroids[f] * fm.areas[f];
+                normals[id] += fm.normals[f] * fm.areas[f];
+                areas[id] += fm.areas[f];
+            }
+            planes.resize(num_segments);
+            centers.resize(num_segments);
+            for (int i = 0; i < num_segments; ++i) {
+                centers[i] = areas[i] > 0.0f ? centroids[i] / areas[i] : centroids[i];
+                planes[i] = Plane3(centers[i], normalize(normals[i]));
+            }
         }
+
+    }
+
+
+    SurfaceMeshPlanarPartition::SurfaceMeshPlanarPartition(SurfaceMesh *mesh)
+            : mesh_(mesh) {
+        mesh_->update_vertex_normals();
+        vertex_normal_ = mesh_->get_vertex_property<vec3>("v:normal");
     }
 
 
-    void SurfaceMeshPlanarPartition::apply(const std::string& partition_name) {
+    SurfaceMeshPlanarPartition::~SurfaceMeshPlanarPartition(void) {
+    }
+
+
+    void SurfaceMeshPlanarPartition::apply(const std::string& partition_name, bool merge_coplanar, float angle_threshold) {
         // we use (1 - max_abs_curvature) as a metric to measure the planarity.
         const unsigned int iter_smooth = 5;
         const bool two_ring = true;
@@ -109,46 +231,100 @@ namespace easy3d {
             curvature[v] = curv;
         }
 
-        // functor for comparing two vertices w.r.t. their planarity
-        class VertexCmp {
-        public:
-            VertexCmp(const SurfaceMesh::VertexProperty<float>& planarity) : planarity_(planarity) {}
-            bool operator()(SurfaceMesh::Vertex v0, SurfaceMesh::Vertex v1) const {
-                return ((planarity_[v0] == planarity_[v1]) ? (v0.idx() > v1.idx()) : (planarity_[v0] > planarity_[v1]));
-            }
-        private:
-            const SurfaceMesh::VertexProperty<float> planarity_;
-        };
-        // priority queue using planarity as sorting criterion
-        typedef std::set<SurfaceMesh::Vertex, VertexCmp> PriorityQueue;
-
         auto planarity = mesh_->vertex_property<float>("v:planarity");
         for (auto v : mesh_->vertices())
             planarity[v] = max_curvature - curvature[v];
         mesh_->remove_vertex_property(curvature);
 
-        PriorityQueue priority_queue(planarity);
-        for (auto v :mesh_->vertices())
-            priority_queue.insert(v);
+        // bucketed priority queue using planarity as sorting criterion: the vertices are distributed into buckets
+        // of similar planarity, and only the (small) buckets are sorted. Vertices with the same planarity are
+        // ordered by decreasing index.
+        std::vector<int> order;
+        {
+            const int num_buckets = 4096;
+            const float scale = max_curvature > 0.0f ? (num_buckets - 1) / max_curvature : 0.0f;
+            std::vector<std::vector<int> > buckets(num_buckets);
+            for (auto v : mesh_->vertices()) {
+                const int b = std::min(std::max(static_cast<int>(planarity[v] * scale), 0), num_buckets - 1);
+                buckets[b].push_back(v.idx());
+            }
+            order.reserve(mesh_->n_vertices());
+            for (int b = num_buckets - 1; b >= 0; --b) {
+                auto &bucket = buckets[b];
+                std::sort(bucket.begin(), bucket.end(), [&planarity](int v0, int v1) {
+                    const float p0 = planarity[SurfaceMesh::Vertex(v0)], p1 = planarity[SurfaceMesh::Vertex(v1)];
+                    return (p0 == p1) ? (v0 > v1) : (p0 > p1);
+                });
+                order.insert(order.end(), bucket.begin(), bucket.end());
+            }
+        }
+
+        details::FlatMesh fm;
+        details::build_flat_mesh(mesh_, fm);
 
         auto locked = mesh_->vertex_property<bool>("v:locked", false);
-        std::vector<SurfaceMesh::Vertex> seeds;
 
         float dist = mesh_->bounding_box().diagonal() * 0.005f;
         float max_allowed_sq_dist = dist * dist;
 
         planar_segments_ = mesh_->face_property<int>(partition_name);
-        planar_segments_.vector().assign(mesh_->n_faces(), -1);
+        auto &segments = planar_segments_.vector();
+        segments.assign(mesh_->faces_size(), -1);
+
+        // the segments are grown one after another (in the order of the planarity of their seeds). A segment is
+        // typically small and its growth is cheap compared with the fork/join of a parallel region.
+        std::vector<char> visited(segments.size(), 0);
+        std::vector<int> region;
         int id = 0;
-        for (auto v : priority_queue) {
-            if (can_grow(v)) {
-                locked[v] = true;
-                seeds.push_back(v);
-                propagate(v, id, max_allowed_sq_dist);
-                ++id;
-            }
+        for (auto v : order) {
+            if (!details::can_grow(fm, v, segments))
+                continue;
+            details::grow(fm, v, vertex_normal_[SurfaceMesh::Vertex(v)], max_allowed_sq_dist, segments, visited,
+                          region);
+            for (auto f : region)
+                segments[f] = id;
+            locked[SurfaceMesh::Vertex(v)] = true;
+            ++id;
         }
         LOG(INFO) << "accumulated " << id << " planar segments";
+
+        std::vector<vec3> centers;
+        details::fit_planes(fm, segments, id, planes_, centers);
+
+        if (merge_coplanar && id > 1) {
+            // adjacent segments with similar normals and lying on each other's planes
+            const float min_cos = std::cos(geom::to_radians(angle_threshold));
+            UnionFind uf(id);
+            const int nf = static_cast<int>(segments.size());
+#pragma omp parallel for schedule(dynamic, 4096)
+            for (int f = 0; f < nf; ++f) {
+                const int a = segments[f];
+                if (a < 0)
+                    continue;
+                for (int j = fm.face_adj_ptr[f]; j < fm.face_adj_ptr[f + 1]; ++j) {
+                    const int b = segments[fm.face_adj[j]];
+                    if (b <= a)
+                        continue;
+                    const Plane3 &pa = planes_[a], &pb = planes_[b];
+                    if (std::abs(dot(pa.normal(), pb.normal())) < min_cos)
+                        continue;
+                    if (pa.squared_ditance(centers[b]) <= max_allowed_sq_dist &&
+                        pb.squared_ditance(centers[a]) <= max_allowed_sq_dist)
+                        uf.unite(a, b);
+                }
+            }
+
+            std::vector<int> labels;
+            const int num = uf.label(labels);
+            if (num < id) {
+                for (auto &s : segments) {
+                    if (s >= 0)
+                        s = labels[s];
+                }
+                details::fit_planes(fm, segments, num, planes_, centers);
+                LOG(INFO) << "merged into " << num << " planar segments";
+            }
+        }
     }
 
-}
\ No newline at end of file
+}
@@ -29,6 +29,7 @@
 #include <easy3d/core/surface_mesh.h>
 
 #include <string>
+#include <vector>
 
 
 namespace easy3d {
@@ -40,26 +41,26 @@ namespace easy3d {
 
         /**
          * Result will save as an <int> type face property.
+         * The planar segments are grown from seed vertices in the order of their planarity.
          * @param partition_name The name of the result face property.
+         * @param merge_coplanar If true, adjacent segments lying on (nearly) the same plane are merged afterwards.
+         * @param angle_threshold The max angle (in degrees) between the normals of two segments to be merged.
          */
-        void apply(const std::string& partition_name);
+        void apply(const std::string& partition_name, bool merge_coplanar = false, float angle_threshold = 5.0f);
 
-    private:
-
-        // max_allowed_squared_deviation: for all the 1-ring neighbors of v
-        void propagate(SurfaceMesh::Vertex v, int id, float max_allowed_squared_deviation);
-
-        // can grow if one of its incident faces has not been grouped into a planar segment.
-        bool can_grow(SurfaceMesh::Vertex v) const;
-
-        // for all the vertices in a face
-        float max_squared_dist_to_plane(SurfaceMesh::Face f, const Plane3& plane) const;
+        /**
+         * The supporting planes of the segments (indexed by the segment ids), available after apply(). The plane of
+         * a segment passes through its area-weighted centroid and is orthogonal to its area-weighted normal.
+         */
+        const std::vector<Plane3>& planes() const { return planes_; }
 
     private:
         SurfaceMesh *mesh_;
 
         SurfaceMesh::FaceProperty<int> planar_segments_;
         SurfaceMesh::VertexProperty<vec3> vertex_normal_;
+
+        std::vector<Plane3> planes_;
     };
 
 
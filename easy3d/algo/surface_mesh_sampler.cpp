@@ -26,121 +26,346 @@
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/util/file_system.h>
+#include <easy3d/util/logging.h>
 #include <easy3d/util/progress.h>
 
+#include <cmath>
+#include <queue>
+#include <numeric>
+#include <algorithm>
+
 
 namespace easy3d {
 
+    namespace details {
+
+        // counter-based random number generator: the i-th number of a stream only depends on the seed and i.
+        // This is the finalizer of SplitMix64.
+        inline uint64_t hash64(uint64_t x) {
+            x += 0x9e3779b97f4a7c15ull;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        }
+
+        // a uniformly distributed random number in [0, 1)
+        inline double uniform(uint64_t seed, uint64_t counter) {
+            return static_cast<double>(hash64(hash64(seed) ^ counter) >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+
+        // the triangles of a (polygonal) mesh, stored flat.
+        struct Triangles {
+            std::vector<SurfaceMesh::Vertex> corners;   // 3 corners per triangle
+            std::vector<SurfaceMesh::Face> faces;       // the face each triangle comes from
+            std::vector<vec3> normals;                  // the normal of each triangle
+            std::vector<double> areas;                  // prefix sum of the areas (size is #triangles + 1)
+        };
+
+
+        void collect_triangles(const SurfaceMesh *mesh, Triangles &triangles) {
+            auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
+            auto mesh_face_normals = mesh->get_face_property<vec3>("f:normal");
+
+            triangles.areas.push_back(0.0);
+            for (auto f : mesh->faces()) {
+                const vec3 &n = mesh_face_normals ? mesh_face_normals[f] : mesh->compute_face_normal(f);
+
+                SurfaceMesh::Halfedge start = mesh->halfedge(f);
+                SurfaceMesh::Halfedge cur = mesh->next_halfedge(mesh->next_halfedge(start));
+                SurfaceMesh::Vertex va = mesh->to_vertex(start);
+                while (cur != start) {
+                    SurfaceMesh::Vertex vb = mesh->from_vertex(cur);
+                    SurfaceMesh::Vertex vc = mesh->to_vertex(cur);
+                    triangles.corners.push_back(va);
+                    triangles.corners.push_back(vb);
+                    triangles.corners.push_back(vc);
+                    triangles.faces.push_back(f);
+                    triangles.normals.push_back(n);
+                    const float area = geom::triangle_area(mesh_points[va], mesh_points[vb], mesh_points[vc]);
+                    triangles.areas.push_back(triangles.areas.back() + area);
+                    cur = mesh->next_halfedge(cur);
+                }
+            }
+        }
+
+
+        // generates num random samples on the triangles and stores them in the vertices [offset, offset + num) of
+        // the point cloud (which must have been resized accordingly). The number of samples of each triangle is
+        // proportional to its area (the rounding errors are diffused along the triangles).
+        void generate_samples(const SurfaceMesh *mesh, const Triangles &triangles, std::size_t num, unsigned int seed,
+                              PointCloud *cloud, std::size_t offset) {
+            const double surface_area = triangles.areas.back();
+            const int num_triangles = static_cast<int>(triangles.faces.size());
+            if (num == 0 || num_triangles == 0 || surface_area <= 0.0)
+                return;
+
+            // the first sample of each triangle
+            std::vector<std::size_t> first(num_triangles + 1, 0);
+            const double density = static_cast<double>(num) / surface_area;
+            for (int i = 0; i < num_triangles; ++i)
+                first[i + 1] = std::min(static_cast<std::size_t>(triangles.areas[i + 1] * density), num);
+            first[num_triangles] = num; // the last triangle gathers all remaining samples
+
+            auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
+            auto mesh_colors = mesh->get_vertex_property<vec3>("v:color");
+            auto mesh_face_colors = mesh->get_face_property<vec3>("f:color");
+            auto mesh_texcoords = mesh->get_vertex_property<vec2>("v:texcoord");
+
+            auto normals = cloud->vertex_property<vec3>("v:normal");
+            PointCloud::VertexProperty<vec3> colors;
+            if (mesh_colors || mesh_face_colors)
+                colors = cloud->vertex_property<vec3>("v:color");
+            PointCloud::VertexProperty<vec2> texcoords;
+            if (mesh_texcoords)
+                texcoords = cloud->vertex_property<vec2>("v:texcoord");
+            auto &points = cloud->points();
+
+            // the triangles are processed in chunks (each one in parallel), and the progress is reported in between
+            ProgressLogger progress(num_triangles, "Sampling mesh");
+            const int chunk_size = std::max(num_triangles / 100, 4096);
+            for (int begin = 0; begin < num_triangles; begin += chunk_size) {
+                const int end = std::min(begin + chunk_size, num_triangles);
+#pragma omp parallel for schedule(dynamic, 1024)
+                for (int idx = begin; idx < end; ++idx) {
+                    const SurfaceMesh::Vertex *tri = &triangles.corners[idx * 3];
+                    for (std::size_t j = first[idx]; j < first[idx + 1]; ++j) {
+                        // compute barycentric coords
+                        const double s = std::sqrt(uniform(seed, 2 * j));
+                        const double t = uniform(seed, 2 * j + 1);
+                        const float c[3] = {
+                                static_cast<float>(1.0 - s),
+                                static_cast<float>(s * (1.0 - t)),
+                                static_cast<float>(s * t)
+                        };
+
+                        const PointCloud::Vertex v(static_cast<int>(offset + j));
+                        points[v.idx()] = c[0] * mesh_points[tri[0]] + c[1] * mesh_points[tri[1]] + c[2] * mesh_points[tri[2]];
+                        normals[v] = triangles.normals[idx];
+                        if (mesh_colors)
+                            colors[v] = c[0] * mesh_colors[tri[0]] + c[1] * mesh_colors[tri[1]] + c[2] * mesh_colors[tri[2]];
+                        else if (mesh_face_colors)
+                            colors[v] = mesh_face_colors[triangles.faces[idx]];
+                        if (mesh_texcoords)
+                            texcoords[v] = c[0] * mesh_texcoords[tri[0]] + c[1] * mesh_texcoords[tri[1]] + c[2] * mesh_texcoords[tri[2]];
+                    }
+                }
+                progress.notify(end);
+            }
+        }
+
+
+        // Weighted sample elimination [Yuksel 2015]: removes the points with the largest weights (i.e., in the
+        // densest regions) until num points are left. Returns for each point whether it has been eliminated.
+        std::vector<bool> eliminate_samples(const std::vector<vec3> &points, std::size_t num, double surface_area) {
+            const int count = static_cast<int>(points.size());
+            std::vector<bool> eliminated(count, false);
+            if (num >= points.size())
+                return eliminated;
 
-    PointCloud *SurfaceMeshSampler::apply(const SurfaceMesh *mesh, int num /* = 1000000 */) {
+            // the maximum Poisson-disk radius for num samples on a surface (hexagonal packing)
+            const double r_max = std::sqrt(surface_area / (2.0 * std::sqrt(3.0) * num));
+            const double r_min = r_max * (1.0 - std::pow(static_cast<double>(num) / count, 1.5)) * 0.65;
+            const double diameter = 2.0 * r_max;
+            const double alpha = 8.0;
+
+            // a grid with cells of the size of the neighborhood
+            Box3 box;
+            for (const auto &p : points)
+                box.add_point(p);
+            const int kCellBits = 21;
+            const int kMaxCells = (1 << kCellBits) - 1;
+            const float extent = std::max(box.range(0), std::max(box.range(1), box.range(2)));
+            const float cell_size = std::max(static_cast<float>(diameter), extent / (kMaxCells - 1));
+            const vec3 origin = box.min();
+            auto cell_of = [&](const vec3 &p, int *c) {
+                for (int k = 0; k < 3; ++k)
+                    c[k] = std::min(std::max(static_cast<int>(std::floor((p[k] - origin[k]) / cell_size)), 0), kMaxCells);
+            };
+            auto key_of = [kCellBits](int x, int y, int z) -> uint64_t {
+                return (static_cast<uint64_t>(x) << (2 * kCellBits)) | (static_cast<uint64_t>(y) << kCellBits) |
+                       static_cast<uint64_t>(z);
+            };
+
+            std::vector<uint64_t> keys(count);
+#pragma omp parallel for
+            for (int i = 0; i < count; ++i) {
+                int c[3];
+                cell_of(points[i], c);
+                keys[i] = key_of(c[0], c[1], c[2]);
+            }
+            std::vector<int> order(count);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&keys](int a, int b) {
+                return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+            });
+            std::vector<uint64_t> sorted_keys(count);
+            for (int i = 0; i < count; ++i)
+                sorted_keys[i] = keys[order[i]];
+
+            // the neighbors (within the diameter) of each point and the weights
+            std::vector<std::vector<std::pair<int, double> > > neighbors(count);
+            std::vector<double> weights(count, 0.0);
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (int i = 0; i < count; ++i) {
+                int c[3];
+                cell_of(points[i], c);
+                auto &nbs = neighbors[i];
+                for (int x = std::max(c[0] - 1, 0); x <= std::min(c[0] + 1, kMaxCells); ++x) {
+                    for (int y = std::max(c[1] - 1, 0); y <= std::min(c[1] + 1, kMaxCells); ++y) {
+                        for (int z = std::max(c[2] - 1, 0); z <= std::min(c[2] + 1, kMaxCells); ++z) {
+                            const uint64_t key = key_of(x, y, z);
+                            auto it = std::lower_bound(sorted_keys.begin(), sorted_keys.end(), key);
+                            for (; it != sorted_keys.end() && *it == key; ++it) {
+                                const int j = order[it - sorted_keys.begin()];
+                                if (j == i)
+                                    continue;
+                                const double d = distance(dvec3(points[i]), dvec3(points[j]));
+                                if (d >= diameter)
+                                    continue;
+                                const double w = std::pow(1.0 - std::max(d, r_min) / diameter, alpha);
+                                nbs.emplace_back(j, w);
+                            }
+                        }
+                    }
+                }
+                std::sort(nbs.begin(), nbs.end());
+                for (const auto &nb : nbs)
+                    weights[i] += nb.second;
+            }
+
+            // eliminate the points with the largest weights (ties are resolved by the index)
+            std::priority_queue<std::pair<double, int> > heap;
+            for (int i = 0; i < count; ++i)
+                heap.emplace(weights[i], i);
+            std::size_t remaining = points.size();
+            while (remaining > num && !heap.empty()) {
+                const auto top = heap.top();
+                heap.pop();
+                const int i = top.second;
+                if (eliminated[i] || top.first != weights[i])
+                    continue;   // outdated entry
+                eliminated[i] = true;
+                --remaining;
+                for (const auto &nb : neighbors[i]) {
+                    const int j = nb.first;
+                    if (eliminated[j])
+                        continue;
+                    weights[j] -= nb.second;
+                    heap.emplace(weights[j], j);
+                }
+            }
+            return eliminated;
+        }
+
+    }
+
+
+    PointCloud *SurfaceMeshSampler::apply(const SurfaceMesh *mesh, int num /* = 1000000 */, unsigned int seed /* = 0 */) {
         PointCloud *cloud = new PointCloud;
         const std::string &name = file_system::name_less_extension(mesh->name()) + "_sampled.ply";
         cloud->set_name(name);
 
-        PointCloud::VertexProperty<vec3> normals = cloud->add_vertex_property<vec3>("v:normal");
-
         LOG(INFO) << "sampling surface...";
 
         // add all mesh vertices (even the requestred number is smaller than the
         // number of vertices in the mesh.
+        const int num_vertices = static_cast<int>(mesh->n_vertices());
+        const int num_needed = std::max(num - num_vertices, 0);
+        cloud->resize(num_vertices + num_needed);
 
         auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
         auto mesh_vertex_normals = mesh->get_vertex_property<vec3>("v:normal");
-        for (auto p : mesh->vertices()) {
-            PointCloud::Vertex v = cloud->add_vertex(mesh_points[p]);
-            if (mesh_vertex_normals)
-                normals[v] = mesh_vertex_normals[p];
-            else
-                normals[v] = mesh->compute_vertex_normal(p);
-        }
+        auto mesh_colors = mesh->get_vertex_property<vec3>("v:color");
+        auto mesh_face_colors = mesh->get_face_property<vec3>("f:color");
+        auto mesh_texcoords = mesh->get_vertex_property<vec2>("v:texcoord");
 
-        // now we may still need some points
-        int num_needed = num - cloud->n_vertices();
-        if (num_needed <= 0)
-            return cloud;   // we got enougth points already
-
-        // collect triangles and compute their areas
-        struct Triangle : std::vector<SurfaceMesh::Vertex> {
-        };
+        auto &points = cloud->points();
+        auto normals = cloud->add_vertex_property<vec3>("v:normal");
+        PointCloud::VertexProperty<vec3> colors;
+        if (mesh_colors || mesh_face_colors)
+            colors = cloud->add_vertex_property<vec3>("v:color");
+        PointCloud::VertexProperty<vec2> texcoords;
+        if (mesh_texcoords)
+            texcoords = cloud->add_vertex_property<vec2>("v:texcoord");
 
-        std::vector<Triangle> triangles;
-        std::vector<float> triangle_areas;
-        std::vector<vec3> triangle_normals;
-
-        auto mesh_face_normals = mesh->get_face_property<vec3>("f:normal");
-        float surface_area = 0.0;
-        for (auto f : mesh->faces()) {
-            const vec3 &n = mesh_face_normals ? mesh_face_normals[f] : mesh->compute_face_normal(f);
-
-            SurfaceMesh::Halfedge start = mesh->halfedge(f);
-            SurfaceMesh::Halfedge cur = mesh->next_halfedge(mesh->next_halfedge(start));
-            SurfaceMesh::Vertex va = mesh->to_vertex(start);
-            while (cur != start) {
-                SurfaceMesh::Vertex vb = mesh->from_vertex(cur);
-                SurfaceMesh::Vertex vc = mesh->to_vertex(cur);
-
-                Triangle tri;
-                tri.push_back(va);
-                tri.push_back(vb);
-                tri.push_back(vc);
-                triangles.push_back(tri);
-                float area = geom::triangle_area(mesh_points[va], mesh_points[vb], mesh_points[vc]);
-                triangle_areas.push_back(area);
-                triangle_normals.push_back(n);
-                surface_area += area;
-
-                cur = mesh->next_halfedge(cur);
+        // the mesh vertices are indexed contiguously only if there is no garbage
+        std::vector<SurfaceMesh::Vertex> vertices;
+        vertices.reserve(num_vertices);
+        for (auto v : mesh->vertices())
+            vertices.push_back(v);
+#pragma omp parallel for
+        for (int i = 0; i < num_vertices; ++i) {
+            const SurfaceMesh::Vertex p = vertices[i];
+            const PointCloud::Vertex v(i);
+            points[i] = mesh_points[p];
+            normals[v] = mesh_vertex_normals ? mesh_vertex_normals[p] : mesh->compute_vertex_normal(p);
+            if (mesh_colors)
+                colors[v] = mesh_colors[p];
+            else if (mesh_face_colors) { // the average color of the incident faces
+                vec3 color(0, 0, 0);
+                int count = 0;
+                for (auto f : mesh->faces(p)) {
+                    color += mesh_face_colors[f];
+                    ++count;
+                }
+                if (count > 0)
+                    colors[v] = color / static_cast<float>(count);
             }
+            if (mesh_texcoords)
+                texcoords[v] = mesh_texcoords[p];
         }
 
-        float density = num_needed / surface_area;
-        float samples_error = 0.0;
-        std::size_t triangle_num = triangles.size();
-        std::size_t num_generated = 0;
-        std::size_t triangles_done = 0;
-        ProgressLogger progress(triangle_num, "Sampling mesh");
-        for (std::size_t idx = 0; idx < triangle_num; ++idx) {
-            const Triangle &tri = triangles[idx];
-            const vec3 &n = triangle_normals[idx];
-
-            // samples number considering the facet size (i.e., area)
-            float samples_num = triangle_areas[idx] * density;
-            std::size_t quant_samples_num = (std::size_t) samples_num;
-
-            // adjust w.r.t. accumulated error
-            samples_error += samples_num - quant_samples_num;
-            if (samples_error > 1.0) {
-                samples_error -= 1.0;
-                quant_samples_num++;
+        // now we may still need some points
+        if (num_needed > 0) {
+            details::Triangles triangles;
+            details::collect_triangles(mesh, triangles);
+            if (triangles.areas.back() > 0.0)
+                details::generate_samples(mesh, triangles, num_needed, seed, cloud, num_vertices);
+            else {
+                LOG(WARNING) << "the surface has a zero area";
+                cloud->resize(num_vertices);
             }
+        }
 
-            if (triangles_done ==
-                triangle_num - 1)        // override number to gather all remaining points if last facet
-                quant_samples_num = num_needed - num_generated;
+        LOG(INFO) << "done. resulted point cloud has " << cloud->n_vertices() << " points";
+        return cloud;
+    }
 
-            // generate points
-            for (unsigned int j = 0; j < quant_samples_num; j++) {
-                // compute barycentric coords
-                double s = sqrt((double) rand() / (double) RAND_MAX);
-                double t = (double) rand() / (double) RAND_MAX;
-                double c[3];
 
-                c[0] = 1.0 - s;
-                c[1] = s * (1.0 - t);
-                c[2] = s * t;
+    PointCloud *SurfaceMeshSampler::apply_blue_noise(const SurfaceMesh *mesh, int num /* = 100000 */,
+                                                     int oversampling /* = 5 */, unsigned int seed /* = 0 */) {
+        if (num <= 0) {
+            LOG(WARNING) << "the number of samples must be positive";
+            return nullptr;
+        }
 
-                vec3 p;
-                for (std::size_t i = 0; i < 3; i++)
-                    p = p + c[i] * mesh_points[tri[i]];
+        details::Triangles triangles;
+        details::collect_triangles(mesh, triangles);
+        const double surface_area = triangles.areas.back();
+        if (surface_area <= 0.0) {
+            LOG(WARNING) << "the surface has a zero area";
+            return nullptr;
+        }
 
-                PointCloud::Vertex v = cloud->add_vertex(p);
-                normals[v] = n;
-            }
+        LOG(INFO) << "blue-noise sampling surface...";
+
+        PointCloud *cloud = new PointCloud;
+        const std::string &name = file_system::name_less_extension(mesh->name()) + "_sampled.ply";
+        cloud->set_name(name);
+
+        // random candidates, from which the evenly spaced ones are selected
+        const std::size_t num_candidates = static_cast<std::size_t>(num) * std::max(oversampling, 1);
+        cloud->resize(num_candidates);
+        cloud->add_vertex_property<vec3>("v:normal");
+        details::generate_samples(mesh, triangles, num_candidates, seed, cloud, 0);
 
-            num_generated += quant_samples_num;
-            triangles_done++;
-            progress.next();
+        const auto &eliminated = details::eliminate_samples(cloud->points(), num, surface_area);
+        for (auto v : cloud->vertices()) {
+            if (eliminated[v.idx()])
+                cloud->delete_vertex(v);
         }
+        cloud->garbage_collection();
 
         LOG(INFO) << "done. resulted point cloud has " << cloud->n_vertices() << " points";
         return cloud;
@@ -33,11 +33,28 @@ namespace easy3d {
 
     // surface sampling algorithm.
     // the result is a (near uniform) point set.
+    //
+    // The samples are generated in parallel. Each sample draws its random numbers from a counter-based generator
+    // keyed by the seed and the index of the sample, so the result only depends on the input and the seed (i.e.,
+    // it is reproducible regardless of the number of threads). Besides the normals, the vertex colors ("v:color")
+    // or face colors ("f:color"), and the vertex texture coordinates ("v:texcoord") of the mesh are carried over
+    // to the point cloud. With face colors, a point copied from a mesh vertex has the average color of its faces.
 
     class SurfaceMeshSampler {
     public:
         // param num: expected point number
-        PointCloud *apply(const SurfaceMesh *mesh, int num = 1000000);
+        // param seed: the seed of the random number generator
+        PointCloud *apply(const SurfaceMesh *mesh, int num = 1000000, unsigned int seed = 0);
+
+        // blue-noise sampling: the samples are evenly spaced (i.e., a Poisson-disk distribution) on the surface.
+        // Random samples (oversampling times the requested number) are first generated, from which the ones in
+        // the densest regions are eliminated until exactly num samples are left. See
+        //  - Cem Yuksel. Sample elimination for generating Poisson disk sample sets. Eurographics 2015.
+        // param num: the exact point number (the mesh vertices are not included in the result)
+        // param oversampling: number of random samples generated per output sample
+        // param seed: the seed of the random number generator
+        PointCloud *apply_blue_noise(const SurfaceMesh *mesh, int num = 100000, int oversampling = 5,
+                                     unsigned int seed = 0);
     };
 
 } // namespace easy3d
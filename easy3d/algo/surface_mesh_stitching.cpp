@@ -23,111 +23,97 @@
  */
 
 #include <algorithm>
+#include <numeric>
+#include <cmath>
 #include <cassert>
 
 #include <easy3d/algo/surface_mesh_stitching.h>
 #include <easy3d/core/surface_mesh.h>
-
-#include <3rd_party/kd_tree/ANN/ANN.h>
-
-
-using namespace ANN;
-
-#define get_tree(x) (reinterpret_cast<ANNkd_tree*>(x))
+#include <easy3d/util/logging.h>
 
 
 namespace easy3d {
 
-    SurfaceMeshStitching::SurfaceMeshStitching(SurfaceMesh *mesh)
-            : mesh_(mesh), coordinates_(nullptr), tree_(nullptr), k_for_radius_search_(4) {
-        for (auto h : mesh_->halfedges()) {
-            if (mesh_->is_boundary(h))
-                border_edges_.push_back(h);
-        }
-
-        if (border_edges_.empty())
-            return;
+    namespace details {
+        // number of bits per axis of a cell key
+        const int kCellBits = 21;
+        const int kMaxCells = (1 << kCellBits) - 1;
+    }
 
-        coordinates_ = annAllocPts(border_edges_.size(), 6);
-        for (std::size_t i = 0; i < border_edges_.size(); ++i)
-            assign_edge_coordinate(coordinates_[i], border_edges_[i]);
 
-        tree_ = new ANNkd_tree(coordinates_, border_edges_.size(), 6);
+    SurfaceMeshStitching::SurfaceMeshStitching(SurfaceMesh *mesh)
+            : mesh_(mesh), grid_origin_(0, 0, 0), cell_size_(0) {
     }
 
 
     SurfaceMeshStitching::~SurfaceMeshStitching() {
-        if (coordinates_)
-            annDeallocPts(coordinates_);
+    }
+
 
-        delete get_tree(tree_);
-        annClose();
+    vec3 SurfaceMeshStitching::midpoint(SurfaceMesh::Halfedge h) const {
+        return (mesh_->position(mesh_->from_vertex(h)) + mesh_->position(mesh_->to_vertex(h))) * 0.5f;
     }
 
 
-    bool SurfaceMeshStitching::lexicographically_smaller(const vec3 &p0, const vec3 &p1) const {
-        if (p0.x > p1.x)
-            return false;
-        else if (p0.x < p1.x)
-            return true;
-        else {
-            if (p0.y > p1.y)
-                return false;
-            else if (p0.y < p1.y)
-                return true;
-            else {
-                if (p0.z > p1.z)
-                    return false;
-                else if (p0.z < p1.z)
-                    return true;
-                else
-                    return false;
-            }
-        }
-        assert(false);
-        return true;
-    };
-
-
-    void SurfaceMeshStitching::assign_edge_coordinate(float *coords, SurfaceMesh::Halfedge h) const {
-        const auto vs = mesh_->from_vertex(h);
-        const auto vt = mesh_->to_vertex(h);
-        const vec3 &s = mesh_->position(vs);
-        const vec3 &t = mesh_->position(vt);
-        if (lexicographically_smaller(s, t)) {
-            for (std::size_t j = 0; j < 3; ++j) {
-                coords[j] = s[j];
-                coords[j + 3] = t[j];
-            }
-        } else {
-            for (std::size_t j = 0; j < 3; ++j) {
-                coords[j] = t[j];
-                coords[j + 3] = s[j];
-            }
-        }
+    void SurfaceMeshStitching::cell_of(const vec3 &p, int &x, int &y, int &z) const {
+        x = std::min(std::max(static_cast<int>(std::floor((p.x - grid_origin_.x) / cell_size_)), 0), details::kMaxCells);
+        y = std::min(std::max(static_cast<int>(std::floor((p.y - grid_origin_.y) / cell_size_)), 0), details::kMaxCells);
+        z = std::min(std::max(static_cast<int>(std::floor((p.z - grid_origin_.z) / cell_size_)), 0), details::kMaxCells);
     }
 
 
-    void SurfaceMeshStitching::borders_in_range(
-            SurfaceMesh::Halfedge h, float squared_dist_threshold,
-            std::vector<SurfaceMesh::Halfedge> &neighbors
-    ) const {
-        ANNcoord ann_p[6];
-        assign_edge_coordinate(ann_p, h);
+    uint64_t SurfaceMeshStitching::cell_key(int x, int y, int z) {
+        return (static_cast<uint64_t>(x) << (2 * details::kCellBits)) |
+               (static_cast<uint64_t>(y) << details::kCellBits) |
+               static_cast<uint64_t>(z);
+    }
 
-        std::vector<int> pts_indices(k_for_radius_search_);               // neighbor indices
-        std::vector<float> pts_squared_distances(k_for_radius_search_);     // neighbor (squared) distances
-        const int n = get_tree(tree_)->annkFRSearch(ann_p, squared_dist_threshold, k_for_radius_search_,
-                                                    pts_indices.data(), pts_squared_distances.data());
 
-        const int num = std::min(n, k_for_radius_search_);
-        neighbors.reserve(num);
+    void SurfaceMeshStitching::build_index(float dist_threshold) {
+        border_edges_.clear();
+        cell_keys_.clear();
+        cell_edges_.clear();
+        for (auto h : mesh_->halfedges()) {
+            if (mesh_->is_boundary(h))
+                border_edges_.push_back(h);
+        }
+        if (border_edges_.empty())
+            return;
+
+        const int num = static_cast<int>(border_edges_.size());
+        std::vector<vec3> midpoints(num);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+            midpoints[i] = midpoint(border_edges_[i]);
+
+        Box3 box;
+        for (const auto &p : midpoints)
+            box.add_point(p);
+
+        // the cells must not be smaller than the threshold (to find all matches in the neighboring cells), and the
+        // number of cells along each axis must fit in the key
+        const float extent = std::max(box.range(0), std::max(box.range(1), box.range(2)));
+        cell_size_ = std::max(dist_threshold, extent / (details::kMaxCells - 1));
+        if (cell_size_ <= 0.0f)
+            cell_size_ = 1.0f; // all midpoints coincide
+        grid_origin_ = box.min();
+
+        std::vector<uint64_t> keys(num);
+#pragma omp parallel for
         for (int i = 0; i < num; ++i) {
-            auto idx = pts_indices[i];
-            if (border_edges_[idx] != h) {  // exclude it self
-                neighbors.push_back(border_edges_[idx]);
-            }
+            int x, y, z;
+            cell_of(midpoints[i], x, y, z);
+            keys[i] = cell_key(x, y, z);
         }
+
+        cell_edges_.resize(num);
+        std::iota(cell_edges_.begin(), cell_edges_.end(), 0);
+        std::sort(cell_edges_.begin(), cell_edges_.end(), [&keys](int a, int b) {
+            return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+        });
+        cell_keys_.resize(num);
+        for (int i = 0; i < num; ++i)
+            cell_keys_[i] = keys[cell_edges_[i]];
     }
 
 
@@ -144,33 +130,59 @@ namespace easy3d {
 
     SurfaceMesh::Halfedge
     SurfaceMeshStitching::matched_border(SurfaceMesh::Halfedge h, float squared_dist_threshold) const {
-        std::vector<SurfaceMesh::Halfedge> neighbors;
-        borders_in_range(h, squared_dist_threshold, neighbors);
+        // If both end points of two edges are within the threshold, so are their midpoints. Since the cells are not
+        // smaller than the threshold, all candidates are in the 3x3x3 cells around the cell of h.
+        int cx, cy, cz;
+        cell_of(midpoint(h), cx, cy, cz);
 
         float min_sd = squared_dist_threshold;
-        SurfaceMesh::Halfedge best_match;
-
-        for (int i = 0; i < neighbors.size(); ++i) {
-            auto h2 = neighbors[i];
-            float sd = squared_distance(h, h2);
-            if (sd < min_sd) {
-                min_sd = sd;
-                best_match = h2;
+        int best_match = -1;
+        for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, details::kMaxCells); ++x) {
+            for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, details::kMaxCells); ++y) {
+                for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, details::kMaxCells); ++z) {
+                    const uint64_t key = cell_key(x, y, z);
+                    auto begin = std::lower_bound(cell_keys_.begin(), cell_keys_.end(), key);
+                    for (auto it = begin; it != cell_keys_.end() && *it == key; ++it) {
+                        const int idx = cell_edges_[it - cell_keys_.begin()];
+                        auto h2 = border_edges_[idx];
+                        if (h2 == h)  // exclude it self
+                            continue;
+                        const float sd = squared_distance(h, h2);
+                        if (sd < min_sd || (sd == min_sd && best_match != -1 && idx < best_match)) {
+                            min_sd = sd;
+                            best_match = idx;
+                        }
+                    }
+                }
             }
         }
 
-        return best_match;
+        return best_match == -1 ? SurfaceMesh::Halfedge() : border_edges_[best_match];
     }
 
 
     void SurfaceMeshStitching::apply(float dist_threshold) {
-        auto scheduled = mesh_->add_halfedge_property<bool>("h::scheduled::SurfaceMeshStitching::apply", false);
-        std::vector<std::pair<SurfaceMesh::Halfedge, SurfaceMesh::Halfedge> > to_stitch;
+        build_index(dist_threshold);
+        if (border_edges_.empty()) {
+            LOG(WARNING) << "no coincident edges can be found for stitching";
+            return;
+        }
 
+        // find the best match of each border edge (in parallel)
         const float squared_dist_threshold = dist_threshold * dist_threshold;
-        for (auto h : border_edges_) {
+        const int num = static_cast<int>(border_edges_.size());
+        std::vector<SurfaceMesh::Halfedge> matches(num);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < num; ++i)
+            matches[i] = matched_border(border_edges_[i], squared_dist_threshold);
+
+        // resolve the conflicts in the order of the border edges, so the result doesn't depend on the scheduling
+        auto scheduled = mesh_->add_halfedge_property<bool>("h::scheduled::SurfaceMeshStitching::apply", false);
+        std::vector<std::pair<SurfaceMesh::Halfedge, SurfaceMesh::Halfedge> > to_stitch;
+        for (int i = 0; i < num; ++i) {
+            auto h = border_edges_[i];
             if (!scheduled[h]) {
-                auto h2 = matched_border(h, squared_dist_threshold);
+                auto h2 = matches[i];
                 if (h2.is_valid() && !scheduled[h2]) {
                     to_stitch.emplace_back(std::make_pair(h, h2));
                     scheduled[h] = true;
@@ -27,6 +27,7 @@
 
 
 #include <vector>
+#include <cstdint>
 #include <easy3d/core/surface_mesh.h>
 
 namespace easy3d {
@@ -41,22 +42,24 @@ namespace easy3d {
 
     private:
 
+        // collect the border edges and (re)build the spatial index on their midpoints. The cells of the index are
+        // not smaller than the distance threshold, so all matches of an edge are found in the 27 cells around it.
+        void build_index(float dist_threshold);
+
         // given a border halfedge h (its face is nullptr), return the matched border halfedge.
-        //  - if multiple edges match, return the closest one;
+        //  - if multiple edges match, return the closest one (ties are resolved by the order of the border edges);
         //  - if could not found, return an invalid halfedge.
+        // All border edges within the distance threshold are considered (i.e., the result is not affected by the
+        // density of the border edges around h).
         SurfaceMesh::Halfedge matched_border(SurfaceMesh::Halfedge h, float squared_dist_threshold) const;
 
-        // given a border halfedge, return all border halfedges that are within a distance threshold.
-        void borders_in_range(
-                SurfaceMesh::Halfedge h, float squared_dist_threshold,
-                std::vector<SurfaceMesh::Halfedge> &neighbors
-        ) const;
+        // the midpoint of a halfedge
+        vec3 midpoint(SurfaceMesh::Halfedge h) const;
 
-        // the coordinates of an halfedge: represented by its two end points going from the xyz-lexicographically
-        // smaller endpoint toward the xyz-lexicographically larger end point.
-        void assign_edge_coordinate(float* coords, SurfaceMesh::Halfedge) const;
+        // the grid cell containing point p
+        void cell_of(const vec3 &p, int &x, int &y, int &z) const;
 
-        bool lexicographically_smaller(const vec3 &p0, const vec3 &p1) const;
+        static uint64_t cell_key(int x, int y, int z);
 
         float squared_distance(SurfaceMesh::Halfedge h1, SurfaceMesh::Halfedge h2) const;
 
@@ -65,12 +68,12 @@ namespace easy3d {
 
         std::vector<SurfaceMesh::Halfedge> border_edges_;
 
-        // the coordinates of all the border edges. Each halfedge is represented by its two end points going from the
-        // xyz-lexicographically smaller endpoint toward the xyz-lexicographically larger end point.
-        float **coordinates_;
-
-        void *tree_;
-        int k_for_radius_search_;
+        // the spatial index: the border edges sorted by the keys of the grid cells containing their midpoints.
+        // The entries only refer to border_edges_, i.e., no coordinates are copied.
+        std::vector<uint64_t> cell_keys_;   // sorted
+        std::vector<int> cell_edges_;       // cell_edges_[i] is the index of the border edge in cell cell_keys_[i]
+        vec3 grid_origin_;
+        float cell_size_;
     };
 
 } // namespace easy3d
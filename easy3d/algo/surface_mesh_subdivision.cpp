@@ -26,6 +26,8 @@
 #include <easy3d/algo/surface_mesh_subdivision.h>
 #include <easy3d/core/surface_mesh.h>
 
+#include <typeinfo>
+
 
 namespace easy3d {
 
@@ -413,4 +415,749 @@ namespace easy3d {
         return true;
     }
 
+
+    namespace details {
+
+        // The out-of-place schemes index the refined elements directly from the input elements, so that the refined
+        // connectivity and attributes can be written in parallel into pre-sized arrays.
+        //  - An input halfedge h is split at the midpoint of its edge into two halves: first_half(h) starts at the
+        //    origin of h and second_half(h) ends at the target of h. The halves of edge e are the edges 2e and 2e+1.
+        //  - The corners (i.e., interior halfedges) of the input faces are numbered face after face. They index the
+        //    refined faces and the new edges inside the input faces.
+        inline int first_half(int h) { return (h & 1) ? 2 * h + 1 : 2 * h; }
+
+        inline int second_half(int h) { return (h & 1) ? 2 * h - 1 : 2 * h + 2; }
+
+
+        struct Corners {
+            std::vector<int> offset;   // face f owns the corners [offset[f], offset[f + 1])
+            std::vector<int> halfedge; // the k-th corner of f is the k-th halfedge starting from halfedge(f)
+        };
+
+
+        void collect_corners(const SurfaceMesh *mesh, Corners &corners) {
+            const int nf = static_cast<int>(mesh->faces_size());
+            corners.offset.resize(nf + 1);
+            corners.offset[0] = 0;
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f)
+                corners.offset[f + 1] = static_cast<int>(mesh->valence(SurfaceMesh::Face(f)));
+            for (int f = 0; f < nf; ++f)
+                corners.offset[f + 1] += corners.offset[f];
+
+            corners.halfedge.resize(corners.offset[nf]);
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f) {
+                int c = corners.offset[f];
+                for (auto h : mesh->halfedges(SurfaceMesh::Face(f)))
+                    corners.halfedge[c++] = h.idx();
+            }
+        }
+
+
+        // A refined corner takes its attribute value from the input corners h0 and h1 (averaged; h0 == h1 for a
+        // plain copy), or from the average of all corners of the input face (if face >= 0).
+        struct CornerRule {
+            CornerRule(int a = -1, int b = -1, int f = -1) : h0(a), h1(b), face(f) {}
+            int h0, h1, face;
+        };
+
+
+        // the connectivity shared by Catmull-Clark and Loop: each edge e is split at the new vertex nv + e
+        void split_edges(const SurfaceMesh *mesh, SurfaceMesh *result) {
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nh = static_cast<int>(mesh->halfedges_size());
+
+#pragma omp parallel for
+            for (int i = 0; i < nh; ++i) {
+                const SurfaceMesh::Halfedge h(i);
+                const SurfaceMesh::Halfedge h0(first_half(i)), h1(second_half(i));
+                result->set_vertex(h0, SurfaceMesh::Vertex(nv + i / 2));
+                result->set_vertex(h1, mesh->to_vertex(h));
+                if (mesh->is_boundary(h)) {
+                    result->set_next_halfedge(h0, h1);
+                    result->set_next_halfedge(h1, SurfaceMesh::Halfedge(first_half(mesh->next_halfedge(h).idx())));
+                }
+            }
+
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i) {
+                const SurfaceMesh::Halfedge h = mesh->halfedge(SurfaceMesh::Vertex(i));
+                if (h.is_valid())
+                    result->set_halfedge(SurfaceMesh::Vertex(i), SurfaceMesh::Halfedge(first_half(h.idx())));
+            }
+
+#pragma omp parallel for
+            for (int i = 0; i < ne; ++i) {
+                // the outgoing halfedge of a boundary vertex must be a boundary halfedge
+                const int h = mesh->is_boundary(SurfaceMesh::Halfedge(2 * i + 1)) ? 2 * i + 1 : 2 * i;
+                result->set_halfedge(SurfaceMesh::Vertex(nv + i), SurfaceMesh::Halfedge(second_half(h)));
+            }
+        }
+
+
+        void catmull_clark_connectivity(const SurfaceMesh *mesh, const Corners &corners, SurfaceMesh *result,
+                                        std::vector<CornerRule> *rules) {
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+
+            split_edges(mesh, result);
+
+            // face f is split into one quad per corner. The new edge 2ne + c connects the face point and the edge
+            // point of corner c. Its halfedge 2(2ne + c) points to the face point.
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f) {
+                const int begin = corners.offset[f];
+                const int deg = corners.offset[f + 1] - begin;
+                const SurfaceMesh::Vertex vf(nv + ne + f);
+                for (int k = 0; k < deg; ++k) {
+                    const int prev = corners.halfedge[begin + (k + deg - 1) % deg];
+                    const int curr = corners.halfedge[begin + k];
+                    const int next = corners.halfedge[begin + (k + 1) % deg];
+                    const SurfaceMesh::Halfedge a(second_half(curr));
+                    const SurfaceMesh::Halfedge b(first_half(next));
+                    const SurfaceMesh::Halfedge c(2 * (2 * ne + begin + (k + 1) % deg));
+                    const SurfaceMesh::Halfedge d(2 * (2 * ne + begin + k) + 1);
+                    result->set_vertex(c, vf);
+                    result->set_vertex(d, SurfaceMesh::Vertex(nv + curr / 2));
+                    result->set_next_halfedge(a, b);
+                    result->set_next_halfedge(b, c);
+                    result->set_next_halfedge(c, d);
+                    result->set_next_halfedge(d, a);
+
+                    const SurfaceMesh::Face q(begin + k);
+                    result->set_face(a, q);
+                    result->set_face(b, q);
+                    result->set_face(c, q);
+                    result->set_face(d, q);
+                    result->set_halfedge(q, a);
+
+                    if (rules) {
+                        (*rules)[a.idx()] = CornerRule(curr, curr);
+                        (*rules)[b.idx()] = CornerRule(curr, next);
+                        (*rules)[c.idx()] = CornerRule(-1, -1, f);
+                        (*rules)[d.idx()] = CornerRule(prev, curr);
+                    }
+                }
+                result->set_halfedge(vf, SurfaceMesh::Halfedge(2 * (2 * ne + begin) + 1));
+            }
+        }
+
+
+        void loop_connectivity(const SurfaceMesh *mesh, const Corners &corners, SurfaceMesh *result,
+                               std::vector<CornerRule> *rules) {
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+
+            split_edges(mesh, result);
+
+            // triangle f is split into the corner triangles 4f + k and the center triangle 4f + 3. The new edge
+            // 2ne + 3f + k connects the edge points of corners k and k + 1. Its halfedge 2(2ne + 3f + k) points to
+            // the edge point of corner k.
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f) {
+                const int begin = corners.offset[f];
+                SurfaceMesh::Halfedge center[3];
+                for (int k = 0; k < 3; ++k) {
+                    const int prev = corners.halfedge[begin + (k + 2) % 3];
+                    const int curr = corners.halfedge[begin + k];
+                    const int next = corners.halfedge[begin + (k + 1) % 3];
+                    const SurfaceMesh::Halfedge a(second_half(curr));
+                    const SurfaceMesh::Halfedge b(first_half(next));
+                    const SurfaceMesh::Halfedge c(2 * (2 * ne + begin + k));
+                    center[k] = SurfaceMesh::Halfedge(2 * (2 * ne + begin + k) + 1);
+                    result->set_vertex(c, SurfaceMesh::Vertex(nv + curr / 2));
+                    result->set_vertex(center[k], SurfaceMesh::Vertex(nv + next / 2));
+                    result->set_next_halfedge(a, b);
+                    result->set_next_halfedge(b, c);
+                    result->set_next_halfedge(c, a);
+
+                    const SurfaceMesh::Face t(4 * f + k);
+                    result->set_face(a, t);
+                    result->set_face(b, t);
+                    result->set_face(c, t);
+                    result->set_halfedge(t, a);
+
+                    if (rules) {
+                        (*rules)[a.idx()] = CornerRule(curr, curr);
+                        (*rules)[b.idx()] = CornerRule(curr, next);
+                        (*rules)[c.idx()] = CornerRule(prev, curr);
+                        (*rules)[center[k].idx()] = CornerRule(curr, next);
+                    }
+                }
+
+                const SurfaceMesh::Face t(4 * f + 3);
+                for (int k = 0; k < 3; ++k) {
+                    result->set_next_halfedge(center[k], center[(k + 1) % 3]);
+                    result->set_face(center[k], t);
+                }
+                result->set_halfedge(t, center[0]);
+            }
+        }
+
+
+        void sqrt3_connectivity(const SurfaceMesh *mesh, const Corners &corners, SurfaceMesh *result,
+                                std::vector<CornerRule> *rules) {
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+            const int nh = static_cast<int>(mesh->halfedges_size());
+
+            std::vector<int> corner_of(nh, -1);
+#pragma omp parallel for
+            for (int c = 0; c < static_cast<int>(corners.halfedge.size()); ++c)
+                corner_of[corners.halfedge[c]] = c;
+
+            // The new edge ne + c connects the center of the face and the origin of corner c. Its halfedge
+            // 2(ne + c) points to the origin. An interior edge e is flipped to connect the centers of its two faces,
+            // and the refined halfedge h then points to the center of the face of the input halfedge h.
+            // Boundary edges are kept. Each corner c results in the triangle c.
+#pragma omp parallel for
+            for (int i = 0; i < nh; ++i) {
+                const SurfaceMesh::Halfedge h(i);
+                const int c = corner_of[i];
+                if (c < 0) { // boundary halfedge: unchanged
+                    result->set_vertex(h, mesh->to_vertex(h));
+                    result->set_next_halfedge(h, mesh->next_halfedge(h));
+                    continue;
+                }
+
+                const int f = mesh->face(h).idx();
+                const SurfaceMesh::Halfedge opp = mesh->opposite_halfedge(h);
+                const int prev = mesh->prev_halfedge(h).idx();
+                SurfaceMesh::Halfedge x, y, z;
+                if (!mesh->is_boundary(opp)) { // triangle (center of f, origin of h, center of opposite face)
+                    const int g = mesh->face(opp).idx();
+                    x = SurfaceMesh::Halfedge(2 * (ne + c));
+                    y = SurfaceMesh::Halfedge(2 * (ne + corner_of[mesh->next_halfedge(opp).idx()]) + 1);
+                    z = h;
+                    result->set_vertex(x, mesh->from_vertex(h));
+                    result->set_vertex(y, SurfaceMesh::Vertex(nv + g));
+                    result->set_vertex(z, SurfaceMesh::Vertex(nv + f));
+                    if (rules) {
+                        (*rules)[x.idx()] = CornerRule(prev, opp.idx());
+                        (*rules)[y.idx()] = CornerRule(-1, -1, g);
+                        (*rules)[z.idx()] = CornerRule(-1, -1, f);
+                    }
+                } else { // triangle (origin of h, target of h, center of f)
+                    x = h;
+                    y = SurfaceMesh::Halfedge(2 * (ne + corner_of[mesh->next_halfedge(h).idx()]) + 1);
+                    z = SurfaceMesh::Halfedge(2 * (ne + c));
+                    result->set_vertex(x, mesh->to_vertex(h));
+                    result->set_vertex(y, SurfaceMesh::Vertex(nv + f));
+                    result->set_vertex(z, mesh->from_vertex(h));
+                    if (rules) {
+                        (*rules)[x.idx()] = CornerRule(i, i);
+                        (*rules)[y.idx()] = CornerRule(-1, -1, f);
+                        (*rules)[z.idx()] = CornerRule(prev, prev);
+                    }
+                }
+                result->set_next_halfedge(x, y);
+                result->set_next_halfedge(y, z);
+                result->set_next_halfedge(z, x);
+
+                const SurfaceMesh::Face t(c);
+                result->set_face(x, t);
+                result->set_face(y, t);
+                result->set_face(z, t);
+                result->set_halfedge(t, x);
+            }
+
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i) {
+                const SurfaceMesh::Vertex v(i);
+                const SurfaceMesh::Halfedge h = mesh->halfedge(v);
+                if (mesh->is_boundary(v)) // also covers isolated vertices
+                    result->set_halfedge(v, h);
+                else
+                    result->set_halfedge(v, SurfaceMesh::Halfedge(2 * (ne + corner_of[h.idx()]) + 1));
+            }
+
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f)
+                result->set_halfedge(SurfaceMesh::Vertex(nv + f), SurfaceMesh::Halfedge(2 * (ne + corners.offset[f])));
+        }
+
+
+        // The vertex stencils. They are applied to the positions and to all other vertex attributes that can be
+        // interpolated. The results of the old vertices are followed by those of the new vertices.
+
+        struct CatmullClarkStencil {
+            template<typename T>
+            void operator()(const SurfaceMesh *mesh, const Corners &corners, const std::vector<T> &in,
+                            std::vector<T> &out) const {
+                const int nv = static_cast<int>(mesh->vertices_size());
+                const int ne = static_cast<int>(mesh->edges_size());
+                const int nf = static_cast<int>(mesh->faces_size());
+                auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+                auto efeature = mesh->get_edge_property<bool>("e:feature");
+
+                // face points
+#pragma omp parallel for
+                for (int f = 0; f < nf; ++f) {
+                    T p = T();
+                    for (int c = corners.offset[f]; c < corners.offset[f + 1]; ++c)
+                        p += in[mesh->to_vertex(SurfaceMesh::Halfedge(corners.halfedge[c])).idx()];
+                    p /= float(corners.offset[f + 1] - corners.offset[f]);
+                    out[nv + ne + f] = p;
+                }
+
+                // edge points
+#pragma omp parallel for
+                for (int i = 0; i < ne; ++i) {
+                    const SurfaceMesh::Edge e(i);
+                    const T &p0 = in[mesh->vertex(e, 0).idx()];
+                    const T &p1 = in[mesh->vertex(e, 1).idx()];
+                    // boundary or feature edge?
+                    if (mesh->is_boundary(e) || (efeature && efeature[e]))
+                        out[nv + i] = 0.5f * (p0 + p1);
+                    else // interior edge
+                        out[nv + i] = 0.25f * (p0 + p1 + out[nv + ne + mesh->face(e, 0).idx()] +
+                                               out[nv + ne + mesh->face(e, 1).idx()]);
+                }
+
+                // old vertices
+#pragma omp parallel for
+                for (int i = 0; i < nv; ++i) {
+                    const SurfaceMesh::Vertex v(i);
+                    // isolated vertex?
+                    if (mesh->is_isolated(v))
+                        out[i] = in[i];
+
+                    // boundary vertex?
+                    else if (mesh->is_boundary(v)) {
+                        auto h1 = mesh->halfedge(v);
+                        auto h0 = mesh->prev_halfedge(h1);
+                        out[i] = 0.125f * (6.0f * in[i] + in[mesh->to_vertex(h1).idx()] +
+                                           in[mesh->from_vertex(h0).idx()]);
+                    }
+
+                    // interior feature vertex?
+                    else if (vfeature && vfeature[v]) {
+                        T p = 6.0f * in[i];
+                        int count(0);
+                        for (auto h : mesh->halfedges(v)) {
+                            if (efeature[mesh->edge(h)]) {
+                                p += in[mesh->to_vertex(h).idx()];
+                                ++count;
+                            }
+                        }
+                        out[i] = (count == 2) ? 0.125f * p : in[i]; // on feature edge, otherwise keep fixed
+                    }
+
+                    // interior vertex (weights from "Subdivision Surfaces in Character Animation")
+                    else {
+                        const float k = mesh->valence(v);
+                        T p = T();
+                        for (auto vv : mesh->vertices(v))
+                            p += in[vv.idx()];
+                        for (auto f : mesh->faces(v))
+                            p += out[nv + ne + f.idx()];
+                        p /= (k * k);
+                        p += ((k - 2.0f) / k) * in[i];
+                        out[i] = p;
+                    }
+                }
+            }
+        };
+
+
+        struct LoopStencil {
+            template<typename T>
+            void operator()(const SurfaceMesh *mesh, const Corners &, const std::vector<T> &in,
+                            std::vector<T> &out) const {
+                const int nv = static_cast<int>(mesh->vertices_size());
+                const int ne = static_cast<int>(mesh->edges_size());
+                auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+                auto efeature = mesh->get_edge_property<bool>("e:feature");
+
+                // old vertices
+#pragma omp parallel for
+                for (int i = 0; i < nv; ++i) {
+                    const SurfaceMesh::Vertex v(i);
+                    // isolated vertex?
+                    if (mesh->is_isolated(v))
+                        out[i] = in[i];
+
+                    // boundary vertex?
+                    else if (mesh->is_boundary(v)) {
+                        auto h1 = mesh->halfedge(v);
+                        auto h0 = mesh->prev_halfedge(h1);
+                        out[i] = 0.125f * (6.0f * in[i] + in[mesh->to_vertex(h1).idx()] +
+                                           in[mesh->from_vertex(h0).idx()]);
+                    }
+
+                    // interior feature vertex?
+                    else if (vfeature && vfeature[v]) {
+                        T p = 6.0f * in[i];
+                        int count(0);
+                        for (auto h : mesh->halfedges(v)) {
+                            if (efeature[mesh->edge(h)]) {
+                                p += in[mesh->to_vertex(h).idx()];
+                                ++count;
+                            }
+                        }
+                        out[i] = (count == 2) ? 0.125f * p : in[i]; // on feature edge, otherwise keep fixed
+                    }
+
+                    // interior vertex
+                    else {
+                        T p = T();
+                        float k(0);
+                        for (auto vv : mesh->vertices(v)) {
+                            p += in[vv.idx()];
+                            ++k;
+                        }
+                        p /= k;
+                        const float beta = (0.625 - pow(0.375 + 0.25 * cos(2.0 * M_PI / k), 2.0));
+                        out[i] = (1.0f - beta) * in[i] + beta * p;
+                    }
+                }
+
+                // edge points
+#pragma omp parallel for
+                for (int i = 0; i < ne; ++i) {
+                    const SurfaceMesh::Edge e(i);
+                    auto h0 = mesh->halfedge(e, 0);
+                    auto h1 = mesh->halfedge(e, 1);
+                    const T &p0 = in[mesh->to_vertex(h0).idx()];
+                    const T &p1 = in[mesh->to_vertex(h1).idx()];
+                    // boundary or feature edge?
+                    if (mesh->is_boundary(e) || (efeature && efeature[e]))
+                        out[nv + i] = 0.5f * (p0 + p1);
+                    else // interior edge
+                        out[nv + i] = 0.375f * (p0 + p1) +
+                                      0.125f * (in[mesh->to_vertex(mesh->next_halfedge(h0)).idx()] +
+                                                in[mesh->to_vertex(mesh->next_halfedge(h1)).idx()]);
+                }
+            }
+        };
+
+
+        struct Sqrt3Stencil {
+            template<typename T>
+            void operator()(const SurfaceMesh *mesh, const Corners &corners, const std::vector<T> &in,
+                            std::vector<T> &out) const {
+                const int nv = static_cast<int>(mesh->vertices_size());
+                const int nf = static_cast<int>(mesh->faces_size());
+
+                // old vertices (boundary vertices are kept)
+#pragma omp parallel for
+                for (int i = 0; i < nv; ++i) {
+                    const SurfaceMesh::Vertex v(i);
+                    if (mesh->is_boundary(v))
+                        out[i] = in[i];
+                    else {
+                        const float n = mesh->valence(v);
+                        const float alpha = (4.0 - 2.0 * cos(2.0 * M_PI / n)) / 9.0;
+                        T p = T();
+                        for (auto vv : mesh->vertices(v))
+                            p += in[vv.idx()];
+                        out[i] = (1.0f - alpha) * in[i] + (alpha / n) * p;
+                    }
+                }
+
+                // face centers
+#pragma omp parallel for
+                for (int f = 0; f < nf; ++f) {
+                    T p = T();
+                    for (int c = corners.offset[f]; c < corners.offset[f + 1]; ++c)
+                        p += in[mesh->to_vertex(SurfaceMesh::Halfedge(corners.halfedge[c])).idx()];
+                    p /= float(corners.offset[f + 1] - corners.offset[f]);
+                    out[nv + f] = p;
+                }
+            }
+        };
+
+
+        // property transfer
+
+        template<typename T>
+        void inherit(const std::vector<T> &src, std::vector<T> &dst, const std::vector<int> &parent) {
+            for (std::size_t i = 0; i < parent.size(); ++i)
+                dst[i] = (parent[i] >= 0) ? src[parent[i]] : T();
+        }
+
+
+        template<typename T>
+        bool inherit_vertex_property(const SurfaceMesh *mesh, SurfaceMesh *result, const std::string &name,
+                                     const std::vector<int> &parent) {
+            if (mesh->get_vertex_property_type(name) != typeid(T))
+                return false;
+            inherit(mesh->get_vertex_property<T>(name).vector(), result->vertex_property<T>(name).vector(), parent);
+            return true;
+        }
+
+
+        template<typename T>
+        bool inherit_edge_property(const SurfaceMesh *mesh, SurfaceMesh *result, const std::string &name,
+                                   const std::vector<int> &parent) {
+            if (mesh->get_edge_property_type(name) != typeid(T))
+                return false;
+            inherit(mesh->get_edge_property<T>(name).vector(), result->edge_property<T>(name).vector(), parent);
+            return true;
+        }
+
+
+        template<typename T>
+        bool inherit_face_property(const SurfaceMesh *mesh, SurfaceMesh *result, const std::string &name,
+                                   const std::vector<int> &parent) {
+            if (mesh->get_face_property_type(name) != typeid(T))
+                return false;
+            inherit(mesh->get_face_property<T>(name).vector(), result->face_property<T>(name).vector(), parent);
+            return true;
+        }
+
+
+        template<typename T, typename Stencil>
+        bool subdivide_vertex_property(const SurfaceMesh *mesh, SurfaceMesh *result, const std::string &name,
+                                       const Corners &corners, const Stencil &stencil) {
+            if (mesh->get_vertex_property_type(name) != typeid(T))
+                return false;
+            stencil(mesh, corners, mesh->get_vertex_property<T>(name).vector(), result->vertex_property<T>(name).vector());
+            return true;
+        }
+
+
+        template<typename T>
+        bool interpolate_halfedge_property(const SurfaceMesh *mesh, SurfaceMesh *result, const std::string &name,
+                                           const Corners &corners, const std::vector<CornerRule> &rules) {
+            if (mesh->get_halfedge_property_type(name) != typeid(T))
+                return false;
+            const std::vector<T> &src = mesh->get_halfedge_property<T>(name).vector();
+            std::vector<T> &dst = result->halfedge_property<T>(name).vector();
+            const int num = static_cast<int>(rules.size());
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const CornerRule &r = rules[i];
+                if (r.face >= 0) {
+                    T p = T();
+                    for (int c = corners.offset[r.face]; c < corners.offset[r.face + 1]; ++c)
+                        p += src[corners.halfedge[c]];
+                    p /= float(corners.offset[r.face + 1] - corners.offset[r.face]);
+                    dst[i] = p;
+                } else if (r.h0 >= 0)
+                    dst[i] = 0.5f * (src[r.h0] + src[r.h1]);
+                else // boundary
+                    dst[i] = T();
+            }
+            return true;
+        }
+
+
+        bool has_interpolable_halfedge_property(const SurfaceMesh *mesh) {
+            for (const auto &name : mesh->halfedge_properties()) {
+                const std::type_info &type = mesh->get_halfedge_property_type(name);
+                if (type == typeid(float) || type == typeid(double) || type == typeid(vec2) ||
+                    type == typeid(vec3) || type == typeid(vec4))
+                    return true;
+            }
+            return false;
+        }
+
+
+        template<typename Stencil>
+        void transfer_properties(const SurfaceMesh *mesh, SurfaceMesh *result, const Corners &corners,
+                                 const Stencil &stencil, const std::vector<int> &vertex_parent,
+                                 const std::vector<int> &edge_parent, const std::vector<int> &face_parent,
+                                 const std::vector<CornerRule> &rules) {
+            // normals are outdated after refinement and are thus not transferred
+            for (const auto &name : mesh->vertex_properties()) {
+                if (name == "v:connectivity" || name == "v:deleted" || name == "v:normal")
+                    continue;
+                subdivide_vertex_property<vec3>(mesh, result, name, corners, stencil) ||
+                subdivide_vertex_property<vec2>(mesh, result, name, corners, stencil) ||
+                subdivide_vertex_property<vec4>(mesh, result, name, corners, stencil) ||
+                subdivide_vertex_property<float>(mesh, result, name, corners, stencil) ||
+                subdivide_vertex_property<double>(mesh, result, name, corners, stencil) ||
+                inherit_vertex_property<bool>(mesh, result, name, vertex_parent) ||
+                inherit_vertex_property<int>(mesh, result, name, vertex_parent);
+            }
+
+            if (!rules.empty()) {
+                for (const auto &name : mesh->halfedge_properties()) {
+                    interpolate_halfedge_property<vec2>(mesh, result, name, corners, rules) ||
+                    interpolate_halfedge_property<vec3>(mesh, result, name, corners, rules) ||
+                    interpolate_halfedge_property<vec4>(mesh, result, name, corners, rules) ||
+                    interpolate_halfedge_property<float>(mesh, result, name, corners, rules) ||
+                    interpolate_halfedge_property<double>(mesh, result, name, corners, rules);
+                }
+            }
+
+            for (const auto &name : mesh->edge_properties()) {
+                if (name == "e:deleted")
+                    continue;
+                inherit_edge_property<bool>(mesh, result, name, edge_parent) ||
+                inherit_edge_property<int>(mesh, result, name, edge_parent) ||
+                inherit_edge_property<float>(mesh, result, name, edge_parent) ||
+                inherit_edge_property<double>(mesh, result, name, edge_parent) ||
+                inherit_edge_property<vec2>(mesh, result, name, edge_parent) ||
+                inherit_edge_property<vec3>(mesh, result, name, edge_parent) ||
+                inherit_edge_property<vec4>(mesh, result, name, edge_parent);
+            }
+
+            for (const auto &name : mesh->face_properties()) {
+                if (name == "f:connectivity" || name == "f:deleted" || name == "f:normal")
+                    continue;
+                inherit_face_property<bool>(mesh, result, name, face_parent) ||
+                inherit_face_property<int>(mesh, result, name, face_parent) ||
+                inherit_face_property<float>(mesh, result, name, face_parent) ||
+                inherit_face_property<double>(mesh, result, name, face_parent) ||
+                inherit_face_property<vec2>(mesh, result, name, face_parent) ||
+                inherit_face_property<vec3>(mesh, result, name, face_parent) ||
+                inherit_face_property<vec4>(mesh, result, name, face_parent);
+            }
+        }
+
+
+        // one level of Catmull-Clark or Loop subdivision (they only differ in the faces and the stencils)
+        template<typename Connectivity, typename Stencil>
+        void split_and_refine(const SurfaceMesh *mesh, SurfaceMesh *result, bool is_catmull_clark,
+                              Connectivity connectivity, const Stencil &stencil) {
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+
+            Corners corners;
+            collect_corners(mesh, corners);
+            const int nc = static_cast<int>(corners.halfedge.size());
+
+            // Catmull-Clark: a face point per face, one quad and one new edge per corner.
+            // Loop: four triangles and three new edges per face.
+            const int new_vertices = nv + ne + (is_catmull_clark ? nf : 0);
+            const int new_edges = 2 * ne + (is_catmull_clark ? nc : 3 * nf);
+            const int new_faces = is_catmull_clark ? nc : 4 * nf;
+
+            *result = SurfaceMesh();
+            result->resize(new_vertices, new_edges, new_faces);
+
+            std::vector<CornerRule> rules;
+            if (has_interpolable_halfedge_property(mesh))
+                rules.resize(result->halfedges_size());
+            connectivity(mesh, corners, result, rules.empty() ? nullptr : &rules);
+
+            std::vector<int> vertex_parent(new_vertices, -1);
+            for (int i = 0; i < nv; ++i)
+                vertex_parent[i] = i;
+            std::vector<int> edge_parent(new_edges, -1);
+            for (int i = 0; i < 2 * ne; ++i)
+                edge_parent[i] = i / 2;
+            std::vector<int> face_parent(new_faces);
+            for (int f = 0; f < nf; ++f) {
+                const int begin = is_catmull_clark ? corners.offset[f] : 4 * f;
+                const int end = is_catmull_clark ? corners.offset[f + 1] : 4 * (f + 1);
+                for (int i = begin; i < end; ++i)
+                    face_parent[i] = f;
+            }
+            transfer_properties(mesh, result, corners, stencil, vertex_parent, edge_parent, face_parent, rules);
+
+            // the edge points of feature edges are feature vertices
+            auto efeature = mesh->get_edge_property<bool>("e:feature");
+            auto vfeature = result->get_vertex_property<bool>("v:feature");
+            if (efeature && vfeature) {
+                for (int i = 0; i < ne; ++i) {
+                    if (efeature[SurfaceMesh::Edge(i)])
+                        vfeature[SurfaceMesh::Vertex(nv + i)] = true;
+                }
+            }
+        }
+
+
+        void catmull_clark(const SurfaceMesh *mesh, SurfaceMesh *result) {
+            split_and_refine(mesh, result, true, catmull_clark_connectivity, CatmullClarkStencil());
+        }
+
+
+        void loop(const SurfaceMesh *mesh, SurfaceMesh *result) {
+            split_and_refine(mesh, result, false, loop_connectivity, LoopStencil());
+        }
+
+
+        void sqrt3(const SurfaceMesh *mesh, SurfaceMesh *result) {
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+
+            Corners corners;
+            collect_corners(mesh, corners);
+            const int nc = static_cast<int>(corners.halfedge.size());
+
+            *result = SurfaceMesh();
+            result->resize(nv + nf, ne + nc, nc);
+
+            std::vector<CornerRule> rules;
+            if (has_interpolable_halfedge_property(mesh))
+                rules.resize(result->halfedges_size());
+            sqrt3_connectivity(mesh, corners, result, rules.empty() ? nullptr : &rules);
+
+            std::vector<int> vertex_parent(result->vertices_size(), -1);
+            for (int i = 0; i < nv; ++i)
+                vertex_parent[i] = i;
+            // only boundary edges remain (interior edges are flipped)
+            std::vector<int> edge_parent(result->edges_size(), -1);
+            for (int i = 0; i < ne; ++i) {
+                if (mesh->is_boundary(SurfaceMesh::Edge(i)))
+                    edge_parent[i] = i;
+            }
+            std::vector<int> face_parent(nc);
+            for (int f = 0; f < nf; ++f) {
+                for (int c = corners.offset[f]; c < corners.offset[f + 1]; ++c)
+                    face_parent[c] = f;
+            }
+            transfer_properties(mesh, result, corners, Sqrt3Stencil(), vertex_parent, edge_parent, face_parent, rules);
+        }
+
+
+        template<typename Scheme>
+        bool subdivide(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels, Scheme scheme) {
+            if (!mesh || !result || mesh == result) {
+                LOG(WARNING) << "invalid input/output mesh for out-of-place subdivision";
+                return false;
+            }
+            if (mesh->n_vertices() != mesh->vertices_size() || mesh->n_edges() != mesh->edges_size() ||
+                mesh->n_faces() != mesh->faces_size()) {
+                LOG(WARNING) << "mesh has deleted elements (call garbage_collection() first)";
+                return false;
+            }
+
+            if (levels == 0) {
+                *result = *mesh;
+                return true;
+            }
+
+            // the intermediate levels alternate between two buffers
+            SurfaceMesh buffer[2];
+            const SurfaceMesh *src = mesh;
+            for (unsigned int i = 0; i < levels; ++i) {
+                SurfaceMesh *dst = (i + 1 == levels) ? result : &buffer[i % 2];
+                scheme(src, dst);
+                src = dst;
+            }
+            return true;
+        }
+
+    } // namespace details
+
+
+    bool SurfaceMeshSubdivision::catmull_clark(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels) {
+        return details::subdivide(mesh, result, levels, details::catmull_clark);
+    }
+
+
+    bool SurfaceMeshSubdivision::loop(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels) {
+        if (mesh && !mesh->is_triangle_mesh()) {
+            LOG(WARNING) << "the Loop subdivision method works only for triangle meshes";
+            return false;
+        }
+        return details::subdivide(mesh, result, levels, details::loop);
+    }
+
+
+    bool SurfaceMeshSubdivision::sqrt3(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels) {
+        return details::subdivide(mesh, result, levels, details::sqrt3);
+    }
+
 } // namespace easy3d
\ No newline at end of file
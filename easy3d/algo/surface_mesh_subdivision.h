@@ -40,6 +40,30 @@ namespace easy3d {
 
         /** The sqrt3 subdivision. */
         static bool sqrt3(SurfaceMesh *mesh);
+
+        /**
+         * \name Out-of-place subdivision
+         * These variants leave the input mesh untouched and write the refined mesh into \p result. The refined
+         * vertex positions are computed by parallel stencil passes, and the refined connectivity is written directly
+         * into pre-sized arrays (i.e., no incremental split/insert/flip operations). Vertex properties of type
+         * float/vec2/vec3/vec4 (e.g., "v:color", "v:texcoord") are subdivided using the same stencils as the
+         * positions, halfedge properties of these types (e.g., "h:texcoord") are interpolated within the faces, and
+         * face/edge properties are inherited from their parents. Normals are not carried over.
+         * @param mesh The input mesh. It must not contain deleted elements (call garbage_collection() first).
+         * @param result The refined mesh. Its previous content is discarded. It must not be the input mesh.
+         * @param levels The number of subdivision levels.
+         * @return \c true on success.
+         */
+        //@{
+        /** The Catmull-Clark subdivision. */
+        static bool catmull_clark(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels = 1);
+
+        /** The Loop subdivision. */
+        static bool loop(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels = 1);
+
+        /** The sqrt3 subdivision. */
+        static bool sqrt3(const SurfaceMesh *mesh, SurfaceMesh *result, unsigned int levels = 1);
+        //@}
     };
 
 } // namespace easy3d
@@ -39,6 +39,7 @@ namespace easy3d {
      * \details Tringulate n-gons into n-2 triangles. Find the triangulation that minimizes the sum of squared triangle
      * areas. See the following paper for more details:
      *  - Peter Liepa. Filling holes in meshes. SGP, 2003.
+     * \sa BatchTriangulator, which triangulates all faces in parallel into an index array (without modifying the mesh).
      */
     class SurfaceMeshTriangulation {
     public:
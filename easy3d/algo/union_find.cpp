@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <easy3d/algo/union_find.h>
+
+
+namespace easy3d {
+
+    UnionFind::UnionFind(std::size_t n) : size_(0) {
+        reset(n);
+    }
+
+
+    void UnionFind::reset(std::size_t n) {
+        parent_.reset(new std::atomic<int>[n]);
+        size_ = n;
+        const int num = static_cast<int>(n);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+            parent_[i].store(i, std::memory_order_relaxed);
+    }
+
+
+    int UnionFind::find(int x) {
+        // path halving: every other node on the path is linked to its grandparent. The parent of a node only ever
+        // decreases, so a failed CAS (i.e., another thread was faster) is harmless.
+        while (true) {
+            int p = parent_[x].load(std::memory_order_relaxed);
+            const int gp = parent_[p].load(std::memory_order_relaxed);
+            if (p == gp)
+                return p;
+            parent_[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            x = gp;
+        }
+    }
+
+
+    bool UnionFind::unite(int a, int b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return false;
+            if (a < b)
+                std::swap(a, b);
+            // link the larger root to the smaller one. This fails if a is no longer a root, in which case we retry.
+            int expected = a;
+            if (parent_[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+                return true;
+        }
+    }
+
+
+    int UnionFind::label(std::vector<int> &labels, const std::vector<bool> &excluded) {
+        const int num = static_cast<int>(size_);
+        labels.assign(size_, -1);
+
+        // the roots are numbered in increasing order
+        int count = 0;
+        for (int i = 0; i < num; ++i) {
+            if (excluded.empty() || !excluded[i]) {
+                if (find(i) == i)
+                    labels[i] = count++;
+            }
+        }
+
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            if (excluded.empty() || !excluded[i])
+                labels[i] = labels[find(i)];
+        }
+        return count;
+    }
+
+}
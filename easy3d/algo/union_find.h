@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASY3D_ALGO_UNION_FIND_H
+#define EASY3D_ALGO_UNION_FIND_H
+
+
+#include <vector>
+#include <atomic>
+#include <memory>
+
+
+namespace easy3d {
+
+    /**
+     * A disjoint-set forest for labeling connected components. find() and unite() are lock-free and can be called
+     * concurrently (e.g., from an OpenMP parallel loop over the edges of a graph).
+     * The root of each set is always its smallest element, so the labels produced by label() do not depend on the
+     * order in which the elements were united.
+     */
+    class UnionFind {
+    public:
+        /** Creates n singleton sets {0}, {1}, ..., {n - 1}. */
+        explicit UnionFind(std::size_t n = 0);
+
+        /** Resets to n singleton sets. */
+        void reset(std::size_t n);
+
+        /** Returns the number of elements. */
+        std::size_t size() const { return size_; }
+
+        /** Returns the root (i.e., the smallest element) of the set containing x. Thread-safe. */
+        int find(int x);
+
+        /**
+         * Merges the sets containing a and b. Thread-safe.
+         * @return true if the two elements were in different sets.
+         */
+        bool unite(int a, int b);
+
+        /**
+         * Labels the elements with the indices of the sets containing them. The indices are consecutive, starting
+         * from 0, in the order of the smallest elements of the sets.
+         * @param labels The labels of the elements.
+         * @param excluded The elements to be ignored (e.g., deleted vertices), which will be labeled as -1. Empty
+         *      means no element is excluded. Excluded elements must not have been united with others.
+         * @return The number of sets.
+         */
+        int label(std::vector<int> &labels, const std::vector<bool> &excluded = std::vector<bool>());
+
+    private:
+        std::unique_ptr<std::atomic<int>[]> parent_;
+        std::size_t size_;
+    };
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_UNION_FIND_H
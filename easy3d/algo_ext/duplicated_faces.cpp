@@ -25,6 +25,8 @@
 #include <easy3d/algo_ext/duplicated_faces.h>
 
 #include <set>
+#include <array>
+#include <algorithm>
 #include <unordered_map>
 
 #include <easy3d/core/surface_mesh.h>
@@ -106,6 +108,88 @@ namespace easy3d {
     }
 
 
+    namespace details {
+
+        // The sorted corner positions of a triangle. Two non-degenerate triangles are exact duplicates (either
+        // combinatorially or geometrically) if and only if their keys are equal.
+        typedef std::array<float, 9> TriangleKey;
+
+        struct TriangleKeyHash {
+            std::size_t operator()(const TriangleKey& key) const {
+                std::size_t seed = 0;
+                for (auto v : key) // hash_combine() from boost
+                    seed ^= std::hash<float>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                return seed;
+            }
+        };
+
+        inline bool make_key(const vec3& a, const vec3& b, const vec3& c, TriangleKey& key) {
+            if (a == b || b == c || c == a)
+                return false;
+            // the same degeneracy criterion (up to rounding) as CGAL's Triangle_3::is_degenerate()
+            const dvec3 da(a), db(b), dc(c);
+            const dvec3 n = cross(db - da, dc - da);
+            if (n.x == 0.0 && n.y == 0.0 && n.z == 0.0)
+                return false;
+
+            std::array<const vec3*, 3> corners = { &a, &b, &c };
+            std::sort(corners.begin(), corners.end(), [](const vec3* p, const vec3* q) {
+                return std::lexicographical_compare(p->data(), p->data() + 3, q->data(), q->data() + 3);
+            });
+            for (std::size_t i = 0; i < 3; ++i)
+                std::copy(corners[i]->data(), corners[i]->data() + 3, key.data() + i * 3);
+            return true;
+        }
+
+    }
+
+
+    std::vector< std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> > >
+    DuplicatedFaces::detect_exact(SurfaceMesh* mesh)
+    {
+        std::vector< std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> > > result;
+
+        auto prop = mesh->get_vertex_property<vec3>("v:point");
+
+        // faces with the same key form a duplication set
+        std::unordered_map<details::TriangleKey, std::vector<SurfaceMesh::Face>, details::TriangleKeyHash> groups;
+        groups.reserve(mesh->n_faces());
+        for (auto f : mesh->faces()) {
+            auto h = mesh->halfedge(f);
+            const vec3& a = prop[mesh->to_vertex(h)];  h = mesh->next_halfedge(h);
+            const vec3& b = prop[mesh->to_vertex(h)];  h = mesh->next_halfedge(h);
+            const vec3& c = prop[mesh->to_vertex(h)];
+            details::TriangleKey key;
+            if (details::make_key(a, b, c, key))
+                groups[key].push_back(f);
+        }
+
+        for (const auto& group : groups) {
+            const auto& faces = group.second;
+            if (faces.size() < 2)
+                continue;
+            for (auto f : faces) {
+                std::vector<SurfaceMesh::Face> others;
+                others.reserve(faces.size() - 1);
+                for (auto g : faces) {
+                    if (g != f)
+                        others.push_back(g);
+                }
+                result.emplace_back(f, others);
+            }
+        }
+
+        // report in the order of the faces (independent of the hash table)
+        std::sort(result.begin(), result.end(), [](
+                const std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> >& x,
+                const std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> >& y) {
+            return x.first < y.first;
+        });
+
+        return result;
+    }
+
+
     std::vector< std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> > >
     DuplicatedFaces::detect(SurfaceMesh* mesh, bool exact, double dist_threshold)
     {
@@ -118,6 +202,9 @@ namespace easy3d {
             LOG(WARNING) << "input mesh triangulated to perform duplication detection";
         }
 
+        if (exact)
+            return detect_exact(mesh);
+
         triangle_faces_ = mesh_to_cgal_triangle_list(mesh);
 
         // bounding boxes of the triangles
@@ -51,7 +51,8 @@ namespace easy3d {
         // exact == true: do exact predict; otherwise use the distance threshold.
         // upon return, the second component of each entry contains the set of faces
         // duplicating the one stored as the first component.
-        // TODO: implement using threshold (now only 'exact' is implemented).
+        // NOTE: exact duplicates are found in linear time by hashing the faces (no CGAL
+        //       involved). Only the tolerance-based matching relies on CGAL.
         std::vector< std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> > >
         detect(SurfaceMesh* mesh, bool exact = false, double dist_threshold = 1e-6);
 
@@ -85,6 +86,10 @@ namespace easy3d {
         // test if two triangles duplicate
         bool do_duplicate(const Triangle& A, const Triangle& B, bool exact, double sqr_eps);
 
+        // detect exactly duplicated faces using a hash table keyed by the sorted corner positions
+        std::vector< std::pair<SurfaceMesh::Face, std::vector<SurfaceMesh::Face> > >
+        detect_exact(SurfaceMesh* mesh);
+
         Triangles triangle_faces_;
     };
 
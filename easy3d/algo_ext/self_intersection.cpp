@@ -27,6 +27,8 @@
 #include <easy3d/util/logging.h>
 
 #include <queue>
+#include <cmath>
+#include <algorithm>
 
 #define REMESH_INTERSECTIONS_TIMING
 
@@ -39,6 +41,70 @@
 namespace easy3d {
 
 
+    namespace details {
+
+        // The orientation of point d with respect to the plane through a, b, and c, evaluated in floating point.
+        // Returns +1/-1 if the sign is certain, and 0 if the result is within the error bound (and thus undecided).
+        // The static error bound is the one of Shewchuk's orient3d (stage A).
+        inline int orient3d_filtered(const double *a, const double *b, const double *c, const double *d) {
+            const double adx = a[0] - d[0], bdx = b[0] - d[0], cdx = c[0] - d[0];
+            const double ady = a[1] - d[1], bdy = b[1] - d[1], cdy = c[1] - d[1];
+            const double adz = a[2] - d[2], bdz = b[2] - d[2], cdz = c[2] - d[2];
+
+            const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+            const double cdxady = cdx * ady, adxcdy = adx * cdy;
+            const double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+            const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+            const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz)
+                                     + (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz)
+                                     + (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+            const double errbound = 7.7715611723761027e-16 * permanent;
+            if (det > errbound) return 1;
+            if (-det > errbound) return -1;
+            return 0;
+        }
+
+        // Returns true if triangle B lies strictly on one side of the supporting plane of triangle A (so the two
+        // triangles can not intersect besides their shared vertices). Vertices of B shared with A (combinatorially
+        // or geometrically) lie exactly on the plane and are skipped. A return value of false means "don't know",
+        // and the pair has to be tested by the exact kernel.
+        template<typename Triangle>
+        inline bool separated(const Triangle &A, const Triangle &B) {
+            int side = 0;
+            for (unsigned short i = 0; i < 3; ++i) {
+                const double *q = B.coords[i];
+                bool shared = false;
+                for (unsigned short j = 0; j < 3 && !shared; ++j) {
+                    const double *p = A.coords[j];
+                    shared = (B.vertices[i] == A.vertices[j]) || (q[0] == p[0] && q[1] == p[1] && q[2] == p[2]);
+                }
+                if (shared)
+                    continue;
+                const int s = orient3d_filtered(A.coords[0], A.coords[1], A.coords[2], q);
+                if (s == 0 || (side != 0 && s != side))
+                    return false;
+                side = s;
+            }
+            return side != 0;
+        }
+
+        // Rebuilds a triangle from its double coordinates, so it shares no lazy-exact representation with the input.
+        template<typename Triangle, typename Point_3>
+        inline Triangle copy_triangle(const Triangle &t) {
+            Triangle copy(Point_3(t.coords[0][0], t.coords[0][1], t.coords[0][2]),
+                          Point_3(t.coords[1][0], t.coords[1][1], t.coords[1][2]),
+                          Point_3(t.coords[2][0], t.coords[2][1], t.coords[2][2]),
+                          t.face);
+            copy.index = t.index;
+            copy.vertices = t.vertices;
+            std::copy(&t.coords[0][0], &t.coords[0][0] + 9, &copy.coords[0][0]);
+            return copy;
+        }
+
+    }
+
+
     void SelfIntersection::mark_offensive(int f) {
         if (offending_.count(f) == 0) {
             // first time marking, initialize with new id and empty list
@@ -54,7 +120,8 @@ namespace easy3d {
     bool SelfIntersection::double_shared_vertex(
             const Triangle &A,
             const Triangle &B,
-            const std::vector<std::pair<int, int> > &shared) {
+            const std::vector<std::pair<int, int> > &shared,
+            PairRecord &record) const {
         // must be co-planar
         if (
                 A.triangle.supporting_plane() != B.triangle.supporting_plane() &&
@@ -101,7 +168,7 @@ namespace easy3d {
         }
 
         // there is an intersection indeed
-        count_intersection(A.index, B.index);
+        record.offending = true;
         if (!construct_intersection_)
             return true;
 
@@ -119,11 +186,8 @@ namespace easy3d {
                     assert(false && "Co-planar non-degenerate triangles should intersect over triangle");
                     return false;
                 } else {
-                    const int fa = A.index;
-                    const int fb = B.index;
                     // Triangle object
-                    offending_[fa].push_back({fb, result});
-                    offending_[fb].push_back({fa, result});
+                    record.object = result;
                     return true;
                 }
             } else {
@@ -147,16 +211,13 @@ namespace easy3d {
 
     bool SelfIntersection::single_shared_vertex(
             const Triangle &A, const Triangle &B,
-            int va, int vb) {
-        if (single_shared_vertex(A, B, va))
+            int va, int vb, PairRecord &record) const {
+        if (single_shared_vertex(A, B, va, record))
             return true;
-        return single_shared_vertex(B, A, vb);
+        return single_shared_vertex(B, A, vb, record);
     }
 
-    bool SelfIntersection::single_shared_vertex(const Triangle &A, const Triangle &B, int va) {
-        const int fa = A.index;
-        const int fb = B.index;
-
+    bool SelfIntersection::single_shared_vertex(const Triangle &A, const Triangle &B, int va, PairRecord &record) const {
         // This was not a good idea. It will not handle coplanar triangles well.
         Segment_3 sa(A.triangle.vertex((va + 1) % 3), A.triangle.vertex((va + 2) % 3));
 
@@ -164,20 +225,18 @@ namespace easy3d {
             // can't put count_intersection(fa,fb) here since we use intersect below
             // and then it will be counted twice.
             if (!construct_intersection_) {
-                count_intersection(fa, fb);
+                record.offending = true;
                 return true;
             }
             CGAL::Object result = CGAL::intersection(sa, B.triangle);
             if (const Point_3 *p = CGAL::object_cast<Point_3>(&result)) {
                 // Single intersection --> segment from shared point to intersection
-                CGAL::Object seg = CGAL::make_object(Segment_3(A.triangle.vertex(va), *p));
-                count_intersection(fa, fb);
-                offending_[fa].push_back({fb, seg});
-                offending_[fb].push_back({fa, seg});
+                record.offending = true;
+                record.object = CGAL::make_object(Segment_3(A.triangle.vertex(va), *p));
                 return true;
             } else if (CGAL::object_cast<Segment_3>(&result)) {
                 // Need to do full test. Intersection could be a general poly.
-                bool test = intersect(A, B);
+                bool test = intersect(A, B, record);
                 ((void) test);
                 assert(test && "intersect should agree with do_intersect");
                 return true;
@@ -191,26 +250,21 @@ namespace easy3d {
     }
 
 
-    bool SelfIntersection::intersect(const Triangle &A, const Triangle &B) {
-        const int fa = A.index;
-        const int fb = B.index;
-
+    bool SelfIntersection::intersect(const Triangle &A, const Triangle &B, PairRecord &record) const {
         // Determine whether there is an intersection
         if (!CGAL::do_intersect(A.triangle, B.triangle))
             return false;
 
-        count_intersection(fa, fb);
+        record.offending = true;
         if (construct_intersection_) {
             // Construct intersection
-            CGAL::Object result = CGAL::intersection(A.triangle, B.triangle);
-            offending_[fa].push_back({fb, result});
-            offending_[fb].push_back({fa, result});
+            record.object = CGAL::intersection(A.triangle, B.triangle);
         }
         return true;
     }
 
 
-    bool SelfIntersection::do_intersect(const Triangle &A, const Triangle &B) {
+    bool SelfIntersection::do_intersect(const Triangle &A, const Triangle &B, PairRecord &record) const {
         // Number of combinatorially shared vertices
         int num_comb_shared_vertices = 0;
 
@@ -234,13 +288,13 @@ namespace easy3d {
         if (num_comb_shared_vertices == 3) {
             assert(shared.size() == 3);
             // Combinatorially duplicated faces should be removed before calling SelftIntersection.
-            ++total_comb_duplicated_faces_;
+            record.comb_duplicated = true;
             return false;
         }
         if (total_shared_vertices == 3) {
             assert(shared.size() == 3);
             // Geometrically duplicate faces should be removed before calling SelftIntersection.
-            ++total_geom_duplicated_faces_;
+            record.geom_duplicated = true;
             return false;
         }
         if (total_shared_vertices == 2) {
@@ -253,13 +307,13 @@ namespace easy3d {
             // | /\ |
             // |/  \|
             // o----o
-            return double_shared_vertex(A, B, shared);
+            return double_shared_vertex(A, B, shared, record);
         }
         assert(total_shared_vertices <= 1);
         if (total_shared_vertices == 1)
-            return single_shared_vertex(A, B, shared[0].first, shared[0].second);
+            return single_shared_vertex(A, B, shared[0].first, shared[0].second, record);
         else
-            return intersect(A, B);
+            return intersect(A, B, record);
     }
 
 
@@ -293,11 +347,46 @@ namespace easy3d {
         };
         CGAL::box_self_intersection_d(boxes.begin(), boxes.end(), cb);
 
-        for (const auto &b : intersecting_boxes) {
-            const Triangle &ta = *b.first;
-            const Triangle &tb = *b.second;
-            if (do_intersect(ta, tb))
-                result.emplace_back(std::make_pair(ta.face, tb.face));
+        // Test the candidate pairs in parallel. The lazy-exact number type of the kernel is not thread-safe when
+        // its representations are shared (e.g., reference counting and the lazy evaluation of the exact values).
+        // So the exact tests of a pair are carried out on private copies of the triangles rebuilt from the (exact)
+        // double coordinates, and the outcome is recorded per pair and merged afterwards. The exact tests still rely
+        // on the static state of the kernel, which is only thread-safe in CGAL 5.5 and later built with thread
+        // support (see the CDTs below). Otherwise, this loop runs serially.
+        const int num_candidates = static_cast<int>(intersecting_boxes.size());
+        std::vector<PairRecord> records(num_candidates);
+#if defined(CGAL_HAS_THREADS) && (CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(5, 5, 0))
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (int i = 0; i < num_candidates; ++i) {
+            const Triangle &ta = *intersecting_boxes[i].first;
+            const Triangle &tb = *intersecting_boxes[i].second;
+            // cheap floating-point test first: most candidates are separated by the supporting plane of either
+            // triangle and never reach the exact kernel.
+            if (details::separated(ta, tb) || details::separated(tb, ta))
+                continue;
+            const Triangle a = details::copy_triangle<Triangle, Point_3>(ta);
+            const Triangle b = details::copy_triangle<Triangle, Point_3>(tb);
+            records[i].intersect = do_intersect(a, b, records[i]);
+        }
+
+        // merge the records in the order of the candidates, which makes the result deterministic
+        for (int i = 0; i < num_candidates; ++i) {
+            const PairRecord &record = records[i];
+            const int fa = intersecting_boxes[i].first->index;
+            const int fb = intersecting_boxes[i].second->index;
+            if (record.comb_duplicated)
+                ++total_comb_duplicated_faces_;
+            if (record.geom_duplicated)
+                ++total_geom_duplicated_faces_;
+            if (record.offending)
+                count_intersection(fa, fb);
+            if (!record.object.empty()) {
+                offending_[fa].push_back({fb, record.object});
+                offending_[fb].push_back({fa, record.object});
+            }
+            if (record.intersect)
+                result.emplace_back(std::make_pair(intersecting_boxes[i].first->face, intersecting_boxes[i].second->face));
         }
 
         std::string msg("");
@@ -332,6 +421,12 @@ namespace easy3d {
                 Triangle t(points[0], points[1], points[2], f);
                 t.index = f.idx();
                 t.vertices = vertices;
+                for (unsigned short i = 0; i < 3; ++i) {
+                    const vec3 &p = prop[vertices[i]];
+                    t.coords[i][0] = p.x;
+                    t.coords[i][1] = p.y;
+                    t.coords[i][2] = p.z;
+                }
                 triangles.push_back(t);
             } else {
                 LOG_FIRST_N(WARNING, 1) << "only triangular meshes can be processed (this is the first record)";
@@ -342,7 +437,7 @@ namespace easy3d {
     }
 
 
-    void SelfIntersection::insert_into_cdt(const CGAL::Object &obj, const Plane_3 &P, CDT_plus_2 &cdt) {
+    void SelfIntersection::insert_into_cdt(const CGAL::Object &obj, const Plane_3 &P, CDT_plus_2 &cdt) const {
         if (const Segment_3 *iseg = CGAL::object_cast<Segment_3>(&obj)) {
             // Add segment constraint
             cdt.insert_constraint(P.to_2d(iseg->vertex(0)), P.to_2d(iseg->vertex(1)));
@@ -373,7 +468,7 @@ namespace easy3d {
             const std::vector<CGAL::Object> &objects,
             const Plane_3 &P,
             std::vector<Point_3> &vertices,
-            std::vector<std::vector<int> > &faces) {
+            std::vector<std::vector<int> > &faces) const {
         CDT_plus_2 cdt;
         for (const auto &obj : objects)
             insert_into_cdt(obj, P, cdt);
@@ -691,20 +786,19 @@ namespace easy3d {
         std::vector<std::vector<Point_3> > cdt_vertices(num_cdts);
         std::vector<std::vector<std::vector<int> > > cdt_faces(num_cdts);
 
-        //// Not clear whether this is safe because of reference counting on Point_3
-        //// objects...
-        ////
-        //// I tried it and got random segfaults (via MATLAB). Seems this is not
-        //// safe.
-        //igl::parallel_for(num_cdts,[&](int i)
-        for (std::size_t i = 0; i < num_cdts; i++) {
+        // The CDTs of different faces (or co-planar clusters) are independent and are computed in parallel. The
+        // intersection objects are shared by the CDTs of the two faces involved, which is only safe if the lazy-exact
+        // kernel is thread-safe (CGAL 5.5 and later, built with thread support). Otherwise, this loop runs serially.
+#if defined(CGAL_HAS_THREADS) && (CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(5, 5, 0))
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int i = 0; i < static_cast<int>(num_cdts); i++) {
             auto &vertices = cdt_vertices[i];
             auto &faces = cdt_faces[i];
             const auto &P = cdt_inputs[i].first;
             const auto &involved_faces = cdt_inputs[i].second;
             delaunay_triangulation(P, involved_faces, vertices, faces);
         }
-        //,1000);
 #ifdef REMESH_INTERSECTIONS_TIMING
         LOG(INFO) << "done. " << w.time_string();
 
@@ -108,6 +108,19 @@ namespace easy3d {
             SurfaceMesh::Face face;
             int index;    // face index
             std::vector<SurfaceMesh::Vertex> vertices;
+            double coords[3][3]; // the corners in plain doubles (used by the floating-point filter)
+        };
+
+        // The outcome of testing a single candidate pair. The pairs are tested in parallel and the records are
+        // merged (in the order of the candidates) afterwards, so the helpers below never touch shared state.
+        struct PairRecord {
+            PairRecord() : intersect(false), offending(false), comb_duplicated(false), geom_duplicated(false) {}
+
+            bool intersect;         // the two triangles intersect (besides shared vertices/edges)
+            bool offending;         // both faces have to be marked offensive
+            bool comb_duplicated;   // the two faces are combinatorially duplicated
+            bool geom_duplicated;   // the two faces are geometrically duplicated
+            CGAL::Object object;    // the intersection (only if construct_intersection_ is true)
         };
 
         // Axis-align boxes for all-pairs self-intersection detection
@@ -120,7 +133,7 @@ namespace easy3d {
         Triangles mesh_to_cgal_triangle_list(SurfaceMesh *mesh);
 
         // test if two triangles intersect
-        bool do_intersect(const Triangle &A, const Triangle &B);
+        bool do_intersect(const Triangle &A, const Triangle &B, PairRecord &record) const;
 
         // Given a list of objects (e.g., resulting from intersecting a triangle
         // with many other triangles), construct a constrained Delaunay
@@ -141,7 +154,7 @@ namespace easy3d {
                 const Plane_3 &P,
                 std::vector<Point_3> &vertices,
                 std::vector<std::vector<int> > &faces
-        );
+        ) const;
 
         // Given a current 2D constrained Delaunay triangulation (cdt), insert a
         // 3D "object" (e.g., resulting from intersecting two triangles) into the
@@ -157,7 +170,7 @@ namespace easy3d {
         // Outputs:
         //   cdt  CDT updated to contain constraints for the given object
         //
-        void insert_into_cdt(const CGAL::Object &obj, const Plane_3 &P, CDT_plus_2 &cdt);
+        void insert_into_cdt(const CGAL::Object &obj, const Plane_3 &P, CDT_plus_2 &cdt) const;
 
     private:
         // Helper function to mark a face as offensive
@@ -169,13 +182,14 @@ namespace easy3d {
         inline void count_intersection(int fa, int fb);
 
         // Helper function for box_intersect. Intersect two triangles A and B,
-        // append the intersection object (point,segment,triangle) to a running
-        // list for A and B
+        // and record the intersection object (point,segment,triangle)
         // Inputs:
         //   A  triangle in 3D
         //   B  triangle in 3D
+        // Outputs:
+        //   record  the outcome of the test
         // Returns true only if A intersects B
-        inline bool intersect(const Triangle &A, const Triangle &B);
+        inline bool intersect(const Triangle &A, const Triangle &B, PairRecord &record) const;
 
         // Helper function for box_intersect. In the case where A and B have
         // already been identified to share a vertex, then we only want to
@@ -187,10 +201,10 @@ namespace easy3d {
         //   va  shared vertex in A (and key into offending)
         //   vb  shared vertex in B (and key into offending)
         //   Returns true if intersection (besides shared point)
-        inline bool single_shared_vertex(const Triangle &A, const Triangle &B, int va, int vb);
+        inline bool single_shared_vertex(const Triangle &A, const Triangle &B, int va, int vb, PairRecord &record) const;
 
         // Helper handling one direction
-        inline bool single_shared_vertex(const Triangle &A, const Triangle &B, int va);
+        inline bool single_shared_vertex(const Triangle &A, const Triangle &B, int va, PairRecord &record) const;
 
         // Helper function for box_intersect. In the case where A and B have
         // already been identified to share two vertices, then we only want
@@ -199,8 +213,9 @@ namespace easy3d {
         inline bool double_shared_vertex(
                 const Triangle &A,
                 const Triangle &B,
-                const std::vector<std::pair<int, int> > &shared
-        );
+                const std::vector<std::pair<int, int> > &shared,
+                PairRecord &record
+        ) const;
 
     private:
         bool construct_intersection_;
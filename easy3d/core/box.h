@@ -55,7 +55,9 @@ namespace easy3d {
         }
 
         /** Construct a box from its diagonal corners. */
-        GenericBox(const Point &pmin, const Point &pmax) {
+        GenericBox(const Point &pmin, const Point &pmax)
+                : min_(std::numeric_limits<FT>::max())
+                , max_(-std::numeric_limits<FT>::max()) {
             // the user might provide wrong order
             // min_ = pmin;
             // max_ = pmax;
@@ -61,6 +61,7 @@ namespace easy3d {
 
         deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
         garbage_ = false;
+        connectivity_version_ = 0;
     }
 
 
@@ -107,6 +108,9 @@ namespace easy3d {
             deleted_edges_    = rhs.deleted_edges_;
             deleted_faces_    = rhs.deleted_faces_;
             garbage_          = rhs.garbage_;
+
+            // the model properties (which may hold data derived from the connectivity) are copied as well
+            connectivity_version_ = rhs.connectivity_version_;
         }
 
         return *this;
@@ -163,6 +167,7 @@ namespace easy3d {
             deleted_edges_    = rhs.deleted_edges_;
             deleted_faces_    = rhs.deleted_faces_;
             garbage_          = rhs.garbage_;
+            ++connectivity_version_;
         }
 
         return *this;
@@ -186,6 +191,7 @@ namespace easy3d {
 
         deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
         garbage_ = false;
+        ++connectivity_version_;
     }
 
 
@@ -1211,6 +1217,7 @@ namespace easy3d {
 
         //let's make it sure it is actually checked
         assert(is_flip_ok(e));
+        ++connectivity_version_;
 
         Halfedge a0 = halfedge(e, 0);
         Halfedge b0 = halfedge(e, 1);
@@ -1346,6 +1353,7 @@ namespace easy3d {
 
         //let's make it sure it is actually checked
         assert(is_stitch_ok(h0, h1));
+        ++connectivity_version_;
 
         // the new position of the end points
         auto org0 = from_vertex(h0);
@@ -1518,6 +1526,7 @@ namespace easy3d {
     {
         //let's make it sure it is actually checked
         assert(is_collapse_ok(h));
+        ++connectivity_version_;
 
         Halfedge h0 = h;
         Halfedge h1 = prev_halfedge(h0);
@@ -1653,6 +1662,7 @@ namespace easy3d {
     delete_vertex(Vertex v)
     {
         if (vdeleted_[v])  return;
+        ++connectivity_version_;
 
         // collect incident faces
         std::vector<Face> incident_faces;
@@ -1692,6 +1702,7 @@ namespace easy3d {
     delete_edge(Edge e)
     {
         if (edeleted_[e])  return;
+        ++connectivity_version_;
 
         Face f0 = face(halfedge(e, 0));
         Face f1 = face(halfedge(e, 1));
@@ -1708,6 +1719,7 @@ namespace easy3d {
     delete_face(Face f)
     {
         if (fdeleted_[f])  return;
+        ++connectivity_version_;
 
         // mark face deleted
         if (!fdeleted_[f])
@@ -1957,6 +1969,7 @@ namespace easy3d {
 
         deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
         garbage_ = false;
+        ++connectivity_version_;
 
 #if 1
         // [Liangliang]: It seems the outgoing halfedges of the vertices may be broken after garbage collection, e.g.,
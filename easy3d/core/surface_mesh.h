@@ -1014,11 +1014,20 @@ namespace easy3d {
             hprops_.resize(2 * ne);
             eprops_.resize(ne);
             fprops_.resize(nf);
+            ++connectivity_version_;
         }
 
         /// remove deleted vertices/edges/faces
         void garbage_collection();
 
+        /// returns the version of the connectivity of the mesh. The version changes whenever elements are added or
+        /// removed, or when the connectivity is modified by a topological operation (e.g., split, flip, collapse,
+        /// garbage_collection()). Data derived from the connectivity alone (e.g., the triangulation of the faces for
+        /// rendering) can be cached together with this version and reused as long as it has not changed.
+        /// \note The low-level setters (e.g., set_next_halfedge()) do not change the version. They are meant for
+        ///     building a mesh after resize(), which does.
+        unsigned int connectivity_version() const { return connectivity_version_; }
+
 
         /// returns whether vertex \c v is deleted
         /// \sa garbage_collection()
@@ -1816,6 +1825,7 @@ namespace easy3d {
         Vertex new_vertex()
         {
             vprops_.push_back();
+            ++connectivity_version_;
             return Vertex(vertices_size()-1);
         }
 
@@ -1827,6 +1837,7 @@ namespace easy3d {
             eprops_.push_back();
             hprops_.push_back();
             hprops_.push_back();
+            ++connectivity_version_;
 
             Halfedge h0(halfedges_size()-2);
             Halfedge h1(halfedges_size()-1);
@@ -1841,6 +1852,7 @@ namespace easy3d {
         Face new_face()
         {
             fprops_.push_back();
+            ++connectivity_version_;
             return Face(faces_size()-1);
         }
 
@@ -1897,6 +1909,8 @@ namespace easy3d {
         unsigned int deleted_faces_;
         bool garbage_;
 
+        unsigned int connectivity_version_;
+
         // helper data for add_face()
         typedef std::pair<Halfedge, Halfedge>  NextCacheEntry;
         typedef std::vector<NextCacheEntry>    NextCache;
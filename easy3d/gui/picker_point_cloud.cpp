@@ -50,12 +50,17 @@ namespace easy3d {
 
         if (use_gpu_if_supported_) {
             if (OpenglInfo::gl_version_number() >= 4.3) {
-                auto program = ShaderManager::get_program("selection/selection_pointcloud_rect");
+                // the shader variant must match the vertex format of the drawable (e.g., quantized positions)
+                auto drawable = model->renderer()->get_points_drawable("vertices");
+                const std::vector<std::string> defines =
+                        drawable ? drawable->vertex_format_defines() : std::vector<std::string>();
+                auto program = ShaderManager::get_program("selection/selection_pointcloud_rect", defines);
                 if (!program) {
                     std::vector<ShaderProgram::Attribute> attributes;
                     attributes.push_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
                     program = ShaderManager::create_program_from_files("selection/selection_pointcloud_rect",
-                                                                       attributes);
+                                                                       attributes, std::vector<std::string>(),
+                                                                       false, defines);
                 }
                 if (program)
                     return pick_vertices_gpu(model, rect, deselect, program);
@@ -82,12 +87,17 @@ namespace easy3d {
 
         if (use_gpu_if_supported_) {
             if (OpenglInfo::gl_version_number() >= 4.3) {
-                auto program = ShaderManager::get_program("selection/selection_pointcloud_lasso");
+                // the shader variant must match the vertex format of the drawable (e.g., quantized positions)
+                auto drawable = model->renderer()->get_points_drawable("vertices");
+                const std::vector<std::string> defines =
+                        drawable ? drawable->vertex_format_defines() : std::vector<std::string>();
+                auto program = ShaderManager::get_program("selection/selection_pointcloud_lasso", defines);
                 if (!program) {
                     std::vector<ShaderProgram::Attribute> attributes;
                     attributes.push_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
                     program = ShaderManager::create_program_from_files("selection/selection_pointcloud_lasso",
-                                                                       attributes);
+                                                                       attributes, std::vector<std::string>(),
+                                                                       false, defines);
                 }
                 if (program)
                     return pick_vertices_gpu(model, plg, deselect, program);
@@ -167,6 +177,7 @@ namespace easy3d {
         const mat4 &MVP = camera()->modelViewProjectionMatrix();
 
         program->bind();
+        drawable->set_vertex_format_uniforms(program);
         program->set_uniform("viewport", viewport);
         program->set_uniform("MVP", MVP);
         program->set_uniform("rect", rectangle);
@@ -271,6 +282,7 @@ namespace easy3d {
         glGetIntegerv(GL_VIEWPORT, viewport);
 
         program->bind();
+        drawable->set_vertex_format_uniforms(program);
         program->set_uniform("viewport", viewport);
         program->set_uniform("MVP", camera()->modelViewProjectionMatrix());
         program->set_uniform("deselect", deselect);
@@ -160,19 +160,6 @@ namespace easy3d {
 
     void AmbientOcclusion::geometry_pass(const std::vector<Model*>& models) {
         static const std::string name = "ssao/geometry_pass";
-        ShaderProgram* program = ShaderManager::get_program(name);
-        if (!program) {
-            std::vector<ShaderProgram::Attribute> attributes = {
-                ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"),
-                ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal")
-            };
-            std::vector<std::string> outputs;
-            outputs.push_back("gPosition");
-            outputs.push_back("gNormal");
-            program = ShaderManager::create_program_from_files(name, attributes, outputs);
-        }
-        if (!program)
-            return;
 
         geom_fbo_->bind(); easy3d_debug_log_gl_error
         geom_fbo_->activate_draw_buffers(0, 1);
@@ -181,31 +168,62 @@ namespace easy3d {
         const mat4& MV = camera_->modelViewMatrix();
         const mat4& PROJ = camera_->projectionMatrix();
 
-        program->bind();
-        program->set_uniform("MV", MV);
-        program->set_uniform("invMV", transform::normal_matrix(MV));
-        program->set_uniform("PROJ", PROJ); easy3d_debug_log_gl_error
+        // the program variant must match the vertex format of each drawable (e.g., quantized positions and normals),
+        // so the program may change from one drawable to the next
+        ShaderProgram* current = nullptr;
+        auto bind_program = [&](const Drawable* d) -> ShaderProgram* {
+            const std::vector<std::string> defines = d->vertex_format_defines();
+            ShaderProgram* program = ShaderManager::get_program(name, defines);
+            if (!program) {
+                std::vector<ShaderProgram::Attribute> attributes = {
+                    ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"),
+                    ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal")
+                };
+                std::vector<std::string> outputs;
+                outputs.push_back("gPosition");
+                outputs.push_back("gNormal");
+                program = ShaderManager::create_program_from_files(name, attributes, outputs, false, defines);
+            }
+            if (!program)
+                return nullptr;
+
+            if (program != current) {
+                if (current)
+                    current->release();
+                program->bind();
+                program->set_uniform("MV", MV);
+                program->set_uniform("invMV", transform::normal_matrix(MV));
+                program->set_uniform("PROJ", PROJ); easy3d_debug_log_gl_error
+                current = program;
+            }
+            d->set_vertex_format_uniforms(program);
+            return program;
+        };
 
         for (auto model : models) {
             if (model->renderer()->is_visible()) {
                 for (auto d : model->renderer()->points_drawables()) {
-                    if (d->is_visible())
+                    if (d->is_visible() && bind_program(d))
                         d->gl_draw(false); easy3d_debug_log_gl_error
                 }
                 for (auto d : model->renderer()->triangles_drawables()) {
                     if (d->is_visible()) {
-                        program->set_uniform("smooth_shading", d->smooth_shading());
-                        d->gl_draw(false); easy3d_debug_log_gl_error
+                        ShaderProgram* program = bind_program(d);
+                        if (program) {
+                            program->set_uniform("smooth_shading", d->smooth_shading());
+                            d->gl_draw(false); easy3d_debug_log_gl_error
+                        }
                     }
                 }
                 for (auto d : model->renderer()->lines_drawables()) {
-                    if (d->is_visible())
+                    if (d->is_visible() && bind_program(d))
                         d->gl_draw(false); easy3d_debug_log_gl_error
                 }
             }
         }
 
-        program->release();
+        if (current)
+            current->release();
         geom_fbo_->release(); easy3d_debug_log_gl_error;
 
 #ifdef SNAPSHOT_BUFFERS
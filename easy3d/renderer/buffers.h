@@ -27,6 +27,12 @@
 
 
 #include <string>
+#include <vector>
+
+#include <easy3d/renderer/drawable.h>
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/renderer/buffers_chunks.h>
+#include <easy3d/renderer/buffers_quantization.h>
 
 namespace easy3d {
 
@@ -34,7 +40,6 @@ namespace easy3d {
     class Graph;
     class PointCloud;
     class SurfaceMesh;
-    class Drawable;
     class PointsDrawable;
     class LinesDrawable;
     class TrianglesDrawable;
@@ -51,6 +56,61 @@ namespace easy3d {
         void update(Model* model, Drawable* drawable);
 
 
+        /**
+         * @brief The buffers of a drawable prepared on the CPU, ready to be uploaded to the GPU.
+         * @details The buffers are prepared w.r.t. a snapshot of the drawable (its type, name, state, chunk size, and
+         *          vertex format) taken on construction, so the drawable can still be modified and drawn while its
+         *          buffers are being prepared in another thread.
+         */
+        struct StagingBuffers {
+            explicit StagingBuffers(const Drawable* drawable);
+
+            // the snapshot of the drawable
+            Drawable::Type type;
+            std::string name;
+            State state;
+            std::size_t chunk_size;
+            Drawable::VertexFormat vertex_format;
+
+            // the prepared buffers
+            BufferData data;
+            std::vector<Chunk> chunks;
+            QuantizedVertices quantized;    // replaces the points, normals, and colors if not empty
+            bool impostors;                 // the points (lines) are rendered as spheres (cylinders)
+
+            // the changes of the model, recorded by commit()
+            FaceTriangles triangles;        // the triangles of the faces of a surface mesh (in the order of chunks)
+            bool committed;
+        };
+
+        /**
+         * @brief The CPU part of update(): packs the model, splits the primitives into chunks, and quantizes the
+         *        vertices w.r.t. the snapshot of the drawable.
+         * @details It accesses neither the GPU nor the drawable, so it can run in a worker thread (see AsyncUpdater),
+         *          as long as the model is not modified meanwhile. It does not modify the model either (apart from
+         *          the vertex normals of a surface mesh): what has to be recorded in the model (e.g., the triangles of
+         *          each face for picking) is kept in the staging buffers until commit().
+         * @attention The staging buffers may refer to the properties of the model (see BufferData::Array::refer()),
+         *          so the model must not be modified until they are uploaded.
+         * @return \c false if the model has no geometry or cannot be rendered by the drawable.
+         */
+        bool prepare(Model* model, StagingBuffers& staging);
+
+        /**
+         * @brief Records the changes of the model resulting from prepare() (e.g., the triangles of each face, see
+         *        pack_triangles()), so that they match the buffers being uploaded. This is done by upload(), and
+         *        calling it again does nothing. It must be called from the thread using the model (e.g., for picking).
+         */
+        void commit(Model* model, StagingBuffers& staging);
+
+        /**
+         * @brief The GPU part of update(): records the changes of the model (see commit()) and uploads the staging
+         *        buffers to the drawable. It must be called from the rendering thread (i.e., with the OpenGL context
+         *        current).
+         */
+        void upload(Drawable* drawable, StagingBuffers& staging);
+
+
         // PointCloud -------------------------------------------------------------------------------------------------
 
         /**
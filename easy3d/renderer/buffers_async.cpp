@@ -0,0 +1,336 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <easy3d/renderer/buffers_async.h>
+
+#include <deque>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+#include <easy3d/renderer/buffers.h>
+#include <easy3d/renderer/drawable.h>
+#include <easy3d/core/model.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    namespace buffers {
+
+
+        namespace details {
+
+            struct Job {
+                Job() : drawable(nullptr), model(nullptr), success(false) {}
+                Drawable *drawable;
+                Model *model;
+                std::unique_ptr<StagingBuffers> staging;
+                bool success;
+            };
+
+
+            // The worker thread and the jobs. The jobs are queued, then prepared (one at a time) by the worker thread,
+            // and finally wait to be uploaded by the rendering thread. A drawable has at most one job at a time.
+            class Worker {
+            public:
+                static Worker &instance() {
+                    static Worker worker;
+                    return worker;
+                }
+
+                ~Worker() { stop(); }
+
+                void start() {
+                    if (!thread_.joinable())
+                        thread_ = std::thread(&Worker::run, this);
+                }
+
+                void stop() {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stopped_ = true;
+                        cancelled_ = true;
+                    }
+                    job_queued_.notify_all();
+                    if (thread_.joinable())
+                        thread_.join();
+                    stopped_ = false;
+                }
+
+                void run() {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    while (true) {
+                        job_queued_.wait(lock, [this]() { return stopped_ || !queued_.empty(); });
+                        if (stopped_)
+                            break;
+
+                        running_ = std::move(queued_.front());
+                        queued_.pop_front();
+                        cancelled_ = false;
+
+                        lock.unlock();
+                        const bool success = buffers::prepare(running_.model, *running_.staging);
+                        lock.lock();
+
+                        std::function<void()> callback;
+                        if (!cancelled_) {
+                            running_.success = success;
+                            ready_.push_back(std::move(running_));
+                            // a failed job is not worth a redraw: it is dropped at the next upload
+                            if (success)
+                                callback = ready_callback_;
+                        }
+                        running_ = Job();
+                        job_done_.notify_all();
+
+                        if (callback) {
+                            lock.unlock();
+                            callback();
+                            lock.lock();
+                        }
+                    }
+                }
+
+                std::mutex mutex_;
+                std::condition_variable job_queued_;
+                std::condition_variable job_done_;
+
+                std::deque<Job> queued_;
+                std::deque<Job> ready_;
+                Job running_;
+                bool cancelled_ = false;    // the result of the running job is dropped
+                bool stopped_ = false;
+
+                std::function<void()> ready_callback_;
+
+            private:
+                Worker() = default;
+                std::thread thread_;
+            };
+
+
+            // does uploading the buffers of the job record changes in its model (see buffers::commit())?
+            inline bool modifies_model(const Job &job) {
+                return job.success && (job.staging->triangles.triangulation || !job.staging->triangles.ranges.empty());
+            }
+
+
+            // removes the job of a drawable (if any) from the jobs
+            inline void remove(std::deque<Job> &jobs, const Drawable *drawable) {
+                for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+                    if (it->drawable == drawable) {
+                        jobs.erase(it);
+                        return;
+                    }
+                }
+            }
+
+        }
+
+
+        bool AsyncUpdater::enabled_ = false;
+        double AsyncUpdater::upload_budget_ = 4.0;
+
+
+        void AsyncUpdater::set_enabled(bool b) {
+            enabled_ = b;
+        }
+
+
+        bool AsyncUpdater::is_enabled() {
+            return enabled_;
+        }
+
+
+        void AsyncUpdater::set_upload_budget(double ms) {
+            upload_budget_ = ms;
+        }
+
+
+        double AsyncUpdater::upload_budget() {
+            return upload_budget_;
+        }
+
+
+        void AsyncUpdater::set_ready_callback(const std::function<void()> &callback) {
+            details::Worker &worker = details::Worker::instance();
+            std::lock_guard<std::mutex> lock(worker.mutex_);
+            worker.ready_callback_ = callback;
+        }
+
+
+        void AsyncUpdater::request(Drawable *drawable) {
+            if (!drawable->model_) {
+                LOG(ERROR) << "drawable '" << drawable->name() << "' is not associated with a model";
+                return;
+            }
+
+            // the snapshot of the drawable is taken here, so the drawable can be modified meanwhile
+            std::unique_ptr<StagingBuffers> staging(new StagingBuffers(drawable));
+
+            details::Worker &worker = details::Worker::instance();
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex_);
+                // the buffers being prepared or ready are outdated
+                details::remove(worker.ready_, drawable);
+                if (worker.running_.drawable == drawable)
+                    worker.cancelled_ = true;
+
+                auto pos = std::find_if(worker.queued_.begin(), worker.queued_.end(),
+                                        [drawable](const details::Job &job) { return job.drawable == drawable; });
+                if (pos == worker.queued_.end()) {
+                    details::Job job;
+                    job.drawable = drawable;
+                    pos = worker.queued_.insert(worker.queued_.end(), std::move(job));
+                }
+                pos->model = drawable->model_;
+                pos->staging = std::move(staging);
+
+                worker.start();
+            }
+            worker.job_queued_.notify_one();
+            drawable->update_pending_ = true;
+        }
+
+
+        bool AsyncUpdater::is_pending(const Drawable *drawable) {
+            return drawable->update_pending_;
+        }
+
+
+        std::size_t AsyncUpdater::num_pending() {
+            details::Worker &worker = details::Worker::instance();
+            std::lock_guard<std::mutex> lock(worker.mutex_);
+            return worker.queued_.size() + (worker.running_.drawable ? 1 : 0);
+        }
+
+
+        std::size_t AsyncUpdater::num_ready() {
+            details::Worker &worker = details::Worker::instance();
+            std::lock_guard<std::mutex> lock(worker.mutex_);
+            return worker.ready_.size();
+        }
+
+
+        std::size_t AsyncUpdater::upload(double budget) {
+            details::Worker &worker = details::Worker::instance();
+            const auto start = std::chrono::steady_clock::now();
+            std::size_t count = 0;
+            while (true) {
+                details::Job job;
+                {
+                    std::lock_guard<std::mutex> lock(worker.mutex_);
+                    // the changes of a model are not recorded while the worker is reading the model, i.e., such a job
+                    // waits until the worker is done with the model
+                    const Model *reading = worker.running_.model;
+                    auto pos = std::find_if(worker.ready_.begin(), worker.ready_.end(),
+                                            [reading](const details::Job &j) {
+                                                return j.model != reading || !details::modifies_model(j);
+                                            });
+                    if (pos == worker.ready_.end())
+                        break;
+                    job = std::move(*pos);
+                    worker.ready_.erase(pos);
+                    // recorded with the lock held, so the worker does not start preparing the model meanwhile
+                    if (details::modifies_model(job))
+                        buffers::commit(job.model, *job.staging);
+                }
+
+                job.drawable->update_pending_ = false;
+                if (!job.success)
+                    continue;
+                buffers::upload(job.drawable, *job.staging);
+                ++count;
+
+                const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                if (elapsed.count() >= budget)
+                    break;
+            }
+            return count;
+        }
+
+
+        std::size_t AsyncUpdater::upload() {
+            return upload(upload_budget_);
+        }
+
+
+        void AsyncUpdater::finish() {
+            details::Worker &worker = details::Worker::instance();
+            {
+                std::unique_lock<std::mutex> lock(worker.mutex_);
+                worker.job_done_.wait(lock, [&worker]() {
+                    return worker.queued_.empty() && worker.running_.drawable == nullptr;
+                });
+            }
+            upload(std::numeric_limits<double>::max());
+        }
+
+
+        void AsyncUpdater::cancel(const Drawable *drawable) {
+            details::Worker &worker = details::Worker::instance();
+            {
+                std::unique_lock<std::mutex> lock(worker.mutex_);
+                details::remove(worker.queued_, drawable);
+                details::remove(worker.ready_, drawable);
+                if (worker.running_.drawable == drawable) {
+                    worker.cancelled_ = true;
+                    // the drawable (and its model) may be deleted once the job is done
+                    worker.job_done_.wait(lock, [&worker, drawable]() { return worker.running_.drawable != drawable; });
+                }
+            }
+            const_cast<Drawable *>(drawable)->update_pending_ = false;
+        }
+
+
+        void AsyncUpdater::terminate() {
+            details::Worker &worker = details::Worker::instance();
+            Drawable *running = nullptr;
+            std::deque<details::Job> jobs;
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex_);
+                running = worker.running_.drawable;
+                std::swap(jobs, worker.queued_);
+                for (auto &job : worker.ready_)
+                    jobs.push_back(std::move(job));
+                worker.ready_.clear();
+            }
+            worker.stop();
+
+            for (auto &job : jobs)
+                job.drawable->update_pending_ = false;
+            if (running)
+                running->update_pending_ = false;
+        }
+
+    }
+
+}
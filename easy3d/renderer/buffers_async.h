@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_BUFFERS_ASYNC_H
+#define EASY3D_RENDERER_BUFFERS_ASYNC_H
+
+
+#include <cstddef>
+#include <functional>
+
+
+// NOTE: make sure to call terminate() before the models and the OpenGL context are deleted.
+
+
+namespace easy3d {
+
+    class Drawable;
+
+    namespace buffers {
+
+        /**
+         * @brief Updates the buffers of drawables asynchronously: the CPU work (packing, splitting into chunks,
+         *        quantizing, see buffers::prepare()) is done in a worker thread, and only the uploads are left to the
+         *        rendering thread, spread over the frames under a time budget.
+         * @details When enabled, the standard drawables request an asynchronous update instead of updating their
+         *        buffers when they are drawn (see Drawable::update()). A drawable keeps rendering its previous buffers
+         *        (if any) until the new ones are uploaded. The application calls upload() once per frame, e.g., at the
+         *        beginning of drawing, and redraws when the ready callback is called.
+         *        Jobs are processed one after another (packing is already parallelized), in the order they have been
+         *        requested. A job requested again before it is done is replaced by the new one.
+         *        The worker thread does not modify the models (apart from the vertex normals of surface meshes): the
+         *        triangles of each face (used for picking faces, see buffers::commit()) are recorded in the model when
+         *        the buffers are uploaded, so they match the buffers being rendered and picked.
+         * @attention The model must not be modified while the buffers of its drawables are being prepared or waiting
+         *        to be uploaded. Call finish() before modifying it (or cancel() for each of its drawables).
+         * @attention All the functions but the ready callback are called from the rendering thread.
+         */
+        class AsyncUpdater {
+        public:
+            /// Enables/Disables the asynchronous update of the drawables. It is disabled by default.
+            static void set_enabled(bool b);
+            static bool is_enabled();
+
+            /// The time (in milliseconds) upload() can take in a frame. At least one drawable is uploaded per call.
+            static void set_upload_budget(double ms);
+            static double upload_budget();
+
+            /**
+             * @brief Sets the function called (from the worker thread) when the buffers of a drawable are ready to be
+             *        uploaded, typically to request a redraw of the viewer.
+             */
+            static void set_ready_callback(const std::function<void()> &callback);
+
+            /**
+             * @brief Requests the buffers of a drawable to be prepared w.r.t. its model and its current state. The
+             *        drawable must be associated with a model.
+             */
+            static void request(Drawable *drawable);
+
+            /// Returns whether the new buffers of a drawable are being prepared or waiting to be uploaded.
+            static bool is_pending(const Drawable *drawable);
+
+            /// Returns the number of jobs being prepared.
+            static std::size_t num_pending();
+            /// Returns the number of jobs waiting to be uploaded.
+            static std::size_t num_ready();
+
+            /**
+             * @brief Uploads the buffers ready, until the time budget of the frame is exceeded.
+             * @return The number of drawables uploaded.
+             */
+            static std::size_t upload();
+
+            /// Waits until all jobs are done and uploads all the buffers, e.g., before taking a snapshot.
+            static void finish();
+
+            /// Cancels the job of a drawable (if any). It waits if the buffers of the drawable are being prepared.
+            static void cancel(const Drawable *drawable);
+
+            /// Cancels all jobs and stops the worker thread.
+            static void terminate();
+
+        private:
+            static std::size_t upload(double budget);
+
+            static bool enabled_;
+            static double upload_budget_;
+        };
+
+    } // namespace buffers
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_RENDERER_BUFFERS_ASYNC_H
@@ -0,0 +1,241 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include <easy3d/renderer/buffers_chunks.h>
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/renderer/camera.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+
+namespace easy3d {
+
+    namespace buffers {
+
+
+        namespace details {
+
+            // inserts two zero bits after each of the lower 21 bits of v
+            inline uint64_t expand_bits(uint64_t v) {
+                v &= 0x1fffff;
+                v = (v | v << 32) & 0x1f00000000ffffull;
+                v = (v | v << 16) & 0x1f0000ff0000ffull;
+                v = (v | v << 8) & 0x100f00f00f00f00full;
+                v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+                v = (v | v << 2) & 0x1249249249249249ull;
+                return v;
+            }
+
+            // the 63-bit Morton code of a point given by its coordinates normalized to [0, 1]
+            inline uint64_t morton_code(const vec3 &p) {
+                uint64_t code = 0;
+                for (int d = 0; d < 3; ++d) {
+                    const float v = std::min(std::max(p[d] * 2097151.0f, 0.0f), 2097151.0f);
+                    code |= expand_bits(static_cast<uint64_t>(v)) << d;
+                }
+                return code;
+            }
+
+        }
+
+
+        bool split_into_chunks(BufferData &data, int primitive_size, std::size_t max_primitives,
+                               std::vector<Chunk> &chunks, std::vector<std::pair<int, int> > *groups) {
+            chunks.clear();
+            const std::vector<vec3> &points = data.points.vector();
+            const bool indexed = data.indices.in_use();
+            const std::vector<unsigned int> &indices = data.indices.vector();
+            const std::size_t num_elements = indexed ? indices.size() : points.size();
+            if (primitive_size < 1 || max_primitives == 0 || num_elements < std::size_t(primitive_size)) {
+                LOG(WARNING) << "no primitives to split into chunks";
+                return false;
+            }
+            const int num_primitives = static_cast<int>(num_elements / primitive_size);
+            auto element = [&](std::size_t i) -> unsigned int {
+                return indexed ? indices[i] : static_cast<unsigned int>(i);
+            };
+
+            // the groups of primitives, each primitive being a group by default
+            const int num_groups = groups ? static_cast<int>(groups->size()) : num_primitives;
+            std::vector<int> first(num_groups), count(num_groups);
+            int expected = 0;
+            for (int g = 0; g < num_groups; ++g) {
+                first[g] = groups ? (*groups)[g].first : g;
+                count[g] = groups ? std::max((*groups)[g].second - (*groups)[g].first + 1, 0) : 1;
+                if (count[g] > 0) {
+                    if (first[g] != expected) {
+                        LOG(WARNING) << "the groups do not match the primitives";
+                        return false;
+                    }
+                    expected += count[g];
+                }
+            }
+            if (expected != num_primitives) {
+                LOG(WARNING) << "the groups do not match the primitives";
+                return false;
+            }
+
+            // the center of a group is approximated by the center of its first primitive
+            std::vector<vec3> centers(num_groups);
+#pragma omp parallel for
+            for (int g = 0; g < num_groups; ++g) {
+                if (count[g] == 0)
+                    continue;
+                vec3 c(0, 0, 0);
+                for (int k = 0; k < primitive_size; ++k)
+                    c += points[element(std::size_t(first[g]) * primitive_size + k)];
+                centers[g] = c / static_cast<float>(primitive_size);
+            }
+
+            Box3 box;
+            for (int g = 0; g < num_groups; ++g) {
+                if (count[g] > 0)
+                    box.add_point(centers[g]);
+            }
+            // the same scale for all axes, such that the codes follow the cubic cells of an octree (scaling each
+            // axis separately would split, e.g., a flat city model into horizontal layers first)
+            const vec3 origin = box.min();
+            const float extent = std::max(box.range(0), std::max(box.range(1), box.range(2)));
+            const float scale = extent > 0.0f ? 1.0f / extent : 0.0f;
+
+            std::vector<std::pair<uint64_t, int> > keys(num_groups);
+#pragma omp parallel for
+            for (int g = 0; g < num_groups; ++g) {
+                const vec3 &c = centers[g];
+                keys[g] = std::make_pair(details::morton_code((c - origin) * scale), g);
+            }
+            std::sort(keys.begin(), keys.end());
+
+            // the new position of each group
+            std::vector<int> new_first(num_groups);
+            int position = 0;
+            for (const auto &key : keys) {
+                new_first[key.second] = position;
+                position += count[key.second];
+            }
+
+            // The sorted groups are split recursively at the highest bit in which the codes of a range differ, i.e.,
+            // along the cells of an octree, until a range has at most max_primitives primitives. Splitting the curve
+            // at arbitrary positions would give chunks spanning its jumps between distant cells.
+            std::vector<std::pair<int, int> > stack(1, std::make_pair(0, num_groups));
+            while (!stack.empty()) {
+                const int b = stack.back().first, e = stack.back().second;
+                stack.pop_back();
+                const int begin = new_first[keys[b].second];
+                const int end = (e < num_groups) ? new_first[keys[e].second] : num_primitives;
+                if (end == begin)
+                    continue;
+                if (std::size_t(end - begin) <= max_primitives || e - b == 1) {
+                    Chunk chunk;
+                    chunk.first = std::size_t(begin) * primitive_size;
+                    chunk.count = std::size_t(end - begin) * primitive_size;
+                    chunks.push_back(chunk);
+                    continue;
+                }
+
+                int split = b + (e - b) / 2;
+                const uint64_t diff = keys[b].first ^ keys[e - 1].first;
+                if (diff != 0) {
+                    int bit = 63;
+                    while (!(diff >> bit))
+                        --bit;
+                    // the first code with the bit set
+                    const uint64_t mask = ~((uint64_t(1) << bit) - 1);
+                    const uint64_t prefix = (keys[e - 1].first & mask);
+                    split = static_cast<int>(std::lower_bound(keys.begin() + b, keys.begin() + e,
+                                                              std::make_pair(prefix, -1)) - keys.begin());
+                }
+                // the left range is processed first, so the chunks follow the order of the element buffer
+                stack.emplace_back(split, e);
+                stack.emplace_back(b, split);
+            }
+
+            std::vector<unsigned int> sorted(std::size_t(num_primitives) * primitive_size);
+#pragma omp parallel for
+            for (int g = 0; g < num_groups; ++g) {
+                const std::size_t src = std::size_t(first[g]) * primitive_size;
+                const std::size_t dst = std::size_t(new_first[g]) * primitive_size;
+                for (std::size_t i = 0; i < std::size_t(count[g]) * primitive_size; ++i)
+                    sorted[dst + i] = element(src + i);
+            }
+
+            const int num_chunks = static_cast<int>(chunks.size());
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < num_chunks; ++i) {
+                Chunk &c = chunks[i];
+                for (std::size_t j = c.first; j < c.first + c.count; ++j)
+                    c.box.add_point(points[sorted[j]]);
+            }
+
+            if (groups) {
+                for (int g = 0; g < num_groups; ++g)
+                    (*groups)[g] = std::make_pair(new_first[g], new_first[g] + count[g] - 1);
+            }
+
+            data.indices.owned().swap(sorted);
+            return true;
+        }
+
+
+        ChunkCuller::ChunkCuller(const Camera *camera)
+                : frustum_(camera)
+                , position_(camera->position())
+                , perspective_(camera->type() == Camera::PERSPECTIVE)
+                , pixels_per_unit_(0.0f)
+        {
+            if (perspective_)
+                pixels_per_unit_ = camera->screenHeight() / (2.0f * std::tan(camera->fieldOfView() * 0.5f));
+            else {
+                float half_width = 0.0f, half_height = 0.0f;
+                camera->getOrthoWidthHeight(half_width, half_height);
+                pixels_per_unit_ = camera->screenHeight() / (2.0f * half_height);
+            }
+        }
+
+
+        bool ChunkCuller::is_visible(const Box3 &box, float threshold) const {
+            if (!frustum_.intersects(box))
+                return false;
+            if (threshold > 0.0f) {
+                // the projected diameter of the bounding sphere of the box
+                const float diameter = 2.0f * box.radius();
+                if (perspective_) {
+                    const float distance = length(box.center() - position_);
+                    if (distance > diameter * 0.5f && diameter * pixels_per_unit_ < threshold * distance)
+                        return false;
+                } else if (diameter * pixels_per_unit_ < threshold)
+                    return false;
+            }
+            return true;
+        }
+
+    }   // namespaces buffers
+
+}   // namespaces easy3d
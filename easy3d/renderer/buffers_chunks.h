@@ -0,0 +1,101 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_BUFFERS_CHUNKS_H
+#define EASY3D_RENDERER_BUFFERS_CHUNKS_H
+
+
+#include <vector>
+#include <utility>
+
+#include <easy3d/core/types.h>
+#include <easy3d/renderer/frustum.h>
+
+
+namespace easy3d {
+
+    namespace buffers {
+
+        struct BufferData;
+
+        /**
+         * @brief A spatially coherent part of a drawable: a range of its element buffer and the bounding box of the
+         *      primitives in the range. The chunks of a drawable are culled individually when it is rendered (see
+         *      Drawable::set_chunk_size()).
+         */
+        struct Chunk {
+            Box3 box;
+            std::size_t first;  // the first element (i.e., index) of the range
+            std::size_t count;  // the number of elements of the range
+        };
+
+        /**
+         * @brief Sorts the primitives of the packed buffers in the Morton order of their centers and splits them into
+         *      chunks of (at most) \p max_primitives primitives.
+         * @details Primitives that are close in the Morton order are close in space, so the chunks are compact and
+         *      can be culled w.r.t. their bounding boxes. The vertex arrays are not modified: the primitives are
+         *      reordered in the element buffer, which is created if the data has none (i.e., the drawable is then
+         *      always rendered with an element buffer).
+         * @param data The packed buffers.
+         * @param primitive_size The number of vertices of a primitive: 1 for points, 2 for lines, 3 for triangles.
+         * @param max_primitives The maximum number of primitives of a chunk. A larger group (see below) makes a chunk
+         *      of its own.
+         * @param chunks The chunks, in the order of the element buffer.
+         * @param groups (Optional) The primitives that are kept together and in their order, e.g., the triangles of
+         *      each polygonal face (see "f:triangle_range"). Each group is given by its first and last primitive (an
+         *      empty group has last < first) and the groups cover the primitives in order. On return, the groups
+         *      give the new positions of their primitives.
+         * @return \c false if there are no primitives or the groups do not match the primitives.
+         */
+        bool split_into_chunks(BufferData &data, int primitive_size, std::size_t max_primitives,
+                               std::vector<Chunk> &chunks, std::vector<std::pair<int, int> > *groups = nullptr);
+
+        /**
+         * @brief Decides which chunks (or any other parts given by their bounding boxes) are drawn for a camera.
+         * @details A box is culled if it is outside the viewing frustum of the camera, or if its projection on the
+         *      screen is smaller than a threshold. The culler is created for each frame, as it takes a snapshot of
+         *      the camera.
+         */
+        class ChunkCuller {
+        public:
+            explicit ChunkCuller(const Camera *camera);
+
+            /// Is the \p box visible? Boxes whose projected diameter is smaller than \p threshold (in pixels) are
+            /// culled. A threshold of 0 disables the small-feature culling.
+            bool is_visible(const Box3 &box, float threshold) const;
+
+        private:
+            Frustum frustum_;
+            vec3 position_;
+            bool perspective_;
+            float pixels_per_unit_;  // at unit distance (perspective) or anywhere (orthographic)
+        };
+
+    }   // namespaces buffers
+
+}   // namespaces easy3d
+
+
+#endif  // EASY3D_RENDERER_BUFFERS_CHUNKS_H
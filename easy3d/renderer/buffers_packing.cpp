@@ -0,0 +1,965 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/core/graph.h>
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/renderer/state.h>
+#include <easy3d/algo/batch_triangulator.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+
+namespace easy3d {
+
+    namespace buffers {
+
+
+        namespace details {
+
+            // clamps scalar field values by the percentages specified by dummy_lower and dummy_upper.
+            // min_value and max_value return the expected value range.
+            template<typename FT>
+            inline void
+            clamp_scalar_field(const std::vector<FT> &property, float &min_value, float &max_value, float dummy_lower_percent,
+                               float dummy_upper_percent) {
+                if (property.empty()) {
+                    LOG(WARNING) << "empty property";
+                    return;
+                }
+
+                // only two order statistics are needed, so a full sort is not necessary
+                std::vector<FT> values = property;
+                const std::size_t n = values.size() - 1;
+                const std::size_t index_lower = n * dummy_lower_percent;
+                const std::size_t index_upper = n - n * dummy_upper_percent;
+                std::nth_element(values.begin(), values.begin() + index_lower, values.end());
+                min_value = values[index_lower];
+                std::nth_element(values.begin(), values.begin() + index_upper, values.end());
+                max_value = values[index_upper];
+
+                const int lower = static_cast<int>(dummy_lower_percent * 100);
+                const int upper = static_cast<int>(dummy_upper_percent * 100);
+                if (lower > 0 || upper > 0) {
+                    const auto range = std::minmax_element(property.begin(), property.end());
+                    LOG(INFO) << "scalar field range ["
+                              << static_cast<float>(*range.first) << ", " << static_cast<float>(*range.second) << "]"
+                              << " clamped (" << lower << "%, " << upper << "%) to [" << min_value << ", " << max_value
+                              << "]";
+                }
+            }
+
+
+            // maps the values of a scalar field to the texture coordinate (i.e., u) used for rendering
+            template<typename FT>
+            inline void scalar_coordinates(const std::vector<FT> &values, const State &state, std::vector<float> &coords) {
+                const float dummy_lower = (state.clamp_range() ? state.clamp_lower() : 0.0f);
+                const float dummy_upper = (state.clamp_range() ? state.clamp_upper() : 0.0f);
+                float min_value = std::numeric_limits<float>::max();
+                float max_value = -std::numeric_limits<float>::max();
+                clamp_scalar_field(values, min_value, max_value, dummy_lower, dummy_upper);
+
+                const int num = static_cast<int>(values.size());
+                coords.resize(num);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                    coords[i] = (values[i] - min_value) / (max_value - min_value);
+            }
+
+
+            // the accessors of the properties defined on the different types of elements
+            struct OnVertices {
+                template<typename T, typename Model>
+                static auto get(Model *model, const std::string &name)
+                -> decltype(model->template get_vertex_property<T>(name)) {
+                    return model->template get_vertex_property<T>(name);
+                }
+            };
+
+            struct OnEdges {
+                template<typename T, typename Model>
+                static auto get(Model *model, const std::string &name)
+                -> decltype(model->template get_edge_property<T>(name)) {
+                    return model->template get_edge_property<T>(name);
+                }
+            };
+
+            struct OnFaces {
+                template<typename T, typename Model>
+                static auto get(Model *model, const std::string &name)
+                -> decltype(model->template get_face_property<T>(name)) {
+                    return model->template get_face_property<T>(name);
+                }
+            };
+
+
+            // computes the texture coordinates (i.e., u) of the elements from the scalar field with the given name.
+            // Fields of 8-bit types are only considered if 'small_types' is true.
+            // Returns false if no such scalar field exists.
+            template<typename Location, typename Model>
+            inline bool scalar_field(Model *model, const std::string &name, const State &state, bool small_types,
+                                     std::vector<float> &coords) {
+                auto prop_float = Location::template get<float>(model, name);
+                if (prop_float) {
+                    scalar_coordinates(prop_float.vector(), state, coords);
+                    return true;
+                }
+                auto prop_double = Location::template get<double>(model, name);
+                if (prop_double) {
+                    scalar_coordinates(prop_double.vector(), state, coords);
+                    return true;
+                }
+                auto prop_int = Location::template get<int>(model, name);
+                if (prop_int) {
+                    scalar_coordinates(prop_int.vector(), state, coords);
+                    return true;
+                }
+                auto prop_uint = Location::template get<unsigned int>(model, name);
+                if (prop_uint) {
+                    scalar_coordinates(prop_uint.vector(), state, coords);
+                    return true;
+                }
+                if (!small_types)
+                    return false;
+                auto prop_char = Location::template get<char>(model, name);
+                if (prop_char) {
+                    scalar_coordinates(prop_char.vector(), state, coords);
+                    return true;
+                }
+                auto prop_uchar = Location::template get<unsigned char>(model, name);
+                if (prop_uchar) {
+                    scalar_coordinates(prop_uchar.vector(), state, coords);
+                    return true;
+                }
+                return false;
+            }
+
+
+            inline void to_texcoords(const std::vector<float> &coords, std::vector<vec2> &texcoords) {
+                const int num = static_cast<int>(coords.size());
+                texcoords.resize(num);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                    texcoords[i] = vec2(coords[i], 0.5f);
+            }
+
+
+            // collects the indices of the (non-deleted) elements of a range
+            template<typename Range>
+            inline void indices_of(const Range &range, std::vector<int> &ids) {
+                ids.clear();
+                for (auto e : range)
+                    ids.push_back(e.idx());
+            }
+
+
+            // the vertex indices of the edges (2 per edge)
+            template<typename Model>
+            inline void edge_indices(const Model *model, const std::vector<int> &edges, std::vector<unsigned int> &indices) {
+                const int num = static_cast<int>(edges.size());
+                indices.resize(num * 2);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i) {
+                    const typename Model::Edge e(edges[i]);
+                    indices[i * 2] = model->vertex(e, 0).idx();
+                    indices[i * 2 + 1] = model->vertex(e, 1).idx();
+                }
+            }
+
+
+            // a value per end point of the edges (2 per edge)
+            template<typename Model, typename T, typename Func>
+            inline void expand_edges(const Model *model, const std::vector<int> &edges, std::vector<T> &out, Func value) {
+                const int num = static_cast<int>(edges.size());
+                out.resize(num * 2);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i) {
+                    const typename Model::Edge e(edges[i]);
+                    out[i * 2] = value(e, model->vertex(e, 0));
+                    out[i * 2 + 1] = value(e, model->vertex(e, 1));
+                }
+            }
+
+
+            // the offsets of the corners of each face in the packed arrays (of size faces_size() + 1; deleted faces
+            // have no corners)
+            inline void corner_offsets(const SurfaceMesh *model, std::vector<unsigned int> &offsets) {
+                const int num = static_cast<int>(model->faces_size());
+                offsets.assign(num + 1, 0);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i) {
+                    const SurfaceMesh::Face f(i);
+                    offsets[i + 1] = model->is_deleted(f) ? 0 : model->valence(f);
+                }
+                for (int i = 0; i < num; ++i)
+                    offsets[i + 1] += offsets[i];
+            }
+
+
+            // a value per corner of the faces
+            template<typename T, typename Func>
+            inline void expand_corners(const SurfaceMesh *model, const std::vector<unsigned int> &offsets,
+                                       std::vector<T> &out, Func value) {
+                const int num = static_cast<int>(model->faces_size());
+                out.resize(offsets[num]);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i) {
+                    const SurfaceMesh::Face f(i);
+                    if (model->is_deleted(f))
+                        continue;
+                    T *o = out.data() + offsets[i];
+                    for (auto h : model->halfedges(f))
+                        *o++ = value(f, h);
+                }
+            }
+
+
+            /**
+             * For non-triangular surface meshes, all polygonal faces are internally triangulated to allow a unified
+             * rendering APIs. Thus for performance reasons, the selection of polygonal faces is also internally
+             * implemented by selecting triangle primitives using shaders. This allows data uploaded to the GPU
+             * for the rendering purpose be shared for selection. Yeah, performance gain!
+             */
+            inline void triangle_ranges(const std::vector<unsigned int> &triangle_offsets,
+                                        std::vector<std::pair<int, int> > &ranges) {
+                const int num = static_cast<int>(triangle_offsets.size()) - 1;
+                ranges.resize(num);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i) {
+                    ranges[i] = std::make_pair(static_cast<int>(triangle_offsets[i]),
+                                               static_cast<int>(triangle_offsets[i + 1]) - 1);
+                }
+            }
+
+
+            /**
+             * The triangulation of the faces of a surface mesh. It is computed once per connectivity version (see
+             * SurfaceMesh::connectivity_version()) and cached in the model as a model property (see
+             * record_triangles()), so updating the buffers for a different coloring (or after editing the vertex
+             * positions) does not triangulate the faces again. The packed buffers may refer to its arrays, so it is
+             * shared by the cache and the buffers until they are uploaded. The triangles are available in two forms:
+             *  - by the vertex indices, used when all the attributes are defined on the vertices;
+             *  - by the corner indices, used when some attribute is defined on the faces or halfedges, in which case
+             *    each corner of a face has its own entry in the vertex arrays. This form is only computed on demand,
+             *    once, even if several threads pack the buffers of the same mesh (e.g., by the AsyncUpdater and by a
+             *    synchronous update of another drawable).
+             */
+            struct Triangulation {
+                Triangulation() : valid(false), version(0) {}
+
+                bool valid;
+                unsigned int version;
+                // the corners of the i-th face are [corner_offsets[i], corner_offsets[i + 1])
+                std::vector<unsigned int> corner_offsets;
+                // the vertex (index) of each corner
+                std::vector<unsigned int> corner_vertices;
+                // the triangles of the i-th face are [triangle_offsets[i], triangle_offsets[i + 1]) (empty for
+                // triangle meshes, whose faces are not triangulated)
+                std::vector<unsigned int> triangle_offsets;
+                std::vector<unsigned int> vertex_triangles;
+                std::vector<unsigned int> corner_triangles;
+                std::once_flag corner_triangles_computed;
+            };
+
+
+            // returns the cached triangulation of the faces of the mesh, or a new one if the connectivity has changed
+            // (the model is not modified)
+            inline std::shared_ptr<Triangulation> triangulation(const SurfaceMesh *model) {
+                auto prop = model->get_model_property<std::shared_ptr<Triangulation> >("m:triangulation");
+                if (prop && !prop.vector().empty() && prop[0] && prop[0]->valid &&
+                    prop[0]->version == model->connectivity_version())
+                    return prop[0];
+
+                std::shared_ptr<Triangulation> triangulation = std::make_shared<Triangulation>();
+                Triangulation &t = *triangulation;
+                corner_offsets(model, t.corner_offsets);
+                const std::vector<unsigned int> &offsets = t.corner_offsets;
+                std::vector<unsigned int> &corner_vertices = t.corner_vertices;
+                const int num = static_cast<int>(model->faces_size());
+                corner_vertices.resize(offsets[num]);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i) {
+                    const SurfaceMesh::Face f(i);
+                    if (model->is_deleted(f))
+                        continue;
+                    unsigned int *o = corner_vertices.data() + offsets[i];
+                    for (auto v : model->vertices(f))
+                        *o++ = v.idx();
+                }
+
+                if (model->is_triangle_mesh()) {
+                    // the corners of a triangle mesh are already triangles
+                    t.vertex_triangles = corner_vertices;
+                    t.triangle_offsets.clear();
+                } else {
+                    BatchTriangulator::triangulate(model->points(), offsets, corner_vertices, t.vertex_triangles,
+                                                   t.triangle_offsets);
+                }
+
+                t.version = model->connectivity_version();
+                t.valid = true;
+                return triangulation;
+            }
+
+
+            // the triangles by the corner indices (empty for triangle meshes, whose corners are drawn in order)
+            inline const std::vector<unsigned int> &corner_triangles(Triangulation &t) {
+                if (t.triangle_offsets.empty())
+                    return t.corner_triangles;
+
+                std::call_once(t.corner_triangles_computed, [&t]() {
+                    // each triangle vertex is mapped to the corner of its face referring to the same vertex
+                    const std::vector<unsigned int> &offsets = t.corner_offsets;
+                    const std::vector<unsigned int> &corner_vertices = t.corner_vertices;
+                    const std::vector<unsigned int> &triangle_offsets = t.triangle_offsets;
+                    t.corner_triangles.resize(t.vertex_triangles.size());
+                    const int num = static_cast<int>(offsets.size()) - 1;
+#pragma omp parallel for
+                    for (int i = 0; i < num; ++i) {
+                        const unsigned int *first = corner_vertices.data() + offsets[i];
+                        const unsigned int *last = corner_vertices.data() + offsets[i + 1];
+                        for (unsigned int j = triangle_offsets[i] * 3; j < triangle_offsets[i + 1] * 3; ++j) {
+                            const unsigned int *c = std::find(first, last, t.vertex_triangles[j]);
+                            t.corner_triangles[j] = static_cast<unsigned int>(c - corner_vertices.data());
+                        }
+                    }
+                });
+                return t.corner_triangles;
+            }
+
+
+            // a value per corner of the faces, gathered from a vertex property
+            template<typename T>
+            inline void gather_corners(const std::vector<unsigned int> &corner_vertices, const std::vector<T> &values,
+                                       std::vector<T> &out) {
+                const int num = static_cast<int>(corner_vertices.size());
+                out.resize(num);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                    out[i] = values[corner_vertices[i]];
+            }
+
+
+            // a value per corner of the faces, taken from a face property
+            template<typename T, typename Func>
+            inline void expand_faces(const std::vector<unsigned int> &offsets, std::vector<T> &out, Func value) {
+                const int num = static_cast<int>(offsets.size()) - 1;
+                out.resize(offsets[num]);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                    std::fill(out.begin() + offsets[i], out.begin() + offsets[i + 1], value(SurfaceMesh::Face(i)));
+            }
+
+
+            template<typename Model>
+            inline bool pack_points(Model *model, const State &state, bool with_normals, BufferData &data) {
+                data.clear();
+                if (model->empty()) {
+                    LOG(WARNING) << "model has no valid geometry";
+                    return false;
+                }
+
+                const std::string &name = state.property_name();
+                switch (state.coloring_method()) {
+                    case State::TEXTURED: {
+                        auto texcoord = model->template get_vertex_property<vec2>(name);
+                        if (!texcoord) {
+                            LOG(WARNING) << "texcoord property not found: " << name;
+                            return false;
+                        }
+                        data.texcoords.refer(texcoord.vector());
+                        break;
+                    }
+
+                    case State::COLOR_PROPERTY: {
+                        auto colors = model->template get_vertex_property<vec3>(name);
+                        if (!colors) {
+                            LOG(WARNING) << "color property not found: " << name;
+                            return false;
+                        }
+                        data.colors.refer(colors.vector());
+                        break;
+                    }
+
+                    case State::SCALAR_FIELD: {
+                        std::vector<float> coords;
+                        if (!scalar_field<OnVertices>(model, name, state, true, coords)) {
+                            LOG(WARNING) << "scalar field not found: " << name;
+                            return false;
+                        }
+                        to_texcoords(coords, data.texcoords.owned());
+                        break;
+                    }
+
+                    default: // uniform color
+                        break;
+                }
+
+                auto points = model->template get_vertex_property<vec3>("v:point");
+                data.points.refer(points.vector());
+                if (with_normals) {
+                    auto normals = model->template get_vertex_property<vec3>("v:normal");
+                    if (normals)
+                        data.normals.refer(normals.vector());
+                }
+
+                // the arrays are indexed by vertex index (deleted vertices included), so the deleted vertices (if
+                // any) are skipped by drawing the remaining ones with an element buffer
+                if (model->n_vertices() != model->vertices_size()) {
+                    std::vector<unsigned int> &indices = data.indices.owned();
+                    indices.reserve(model->n_vertices());
+                    for (auto v : model->vertices())
+                        indices.push_back(static_cast<unsigned int>(v.idx()));
+                }
+                return true;
+            }
+
+
+            template<typename Model>
+            inline bool pack_lines(Model *model, const State &state, BufferData &data) {
+                data.clear();
+                if (model->empty()) {
+                    LOG(WARNING) << "model has no valid geometry";
+                    return false;
+                }
+
+                typedef typename Model::Edge Edge;
+                typedef typename Model::Vertex Vertex;
+
+                auto points = model->template get_vertex_property<vec3>("v:point");
+                std::vector<int> edges;
+                indices_of(model->edges(), edges);
+
+                // Properties defined on the vertices are rendered with an element buffer indexing the vertices.
+                // Properties defined on the edges require both end points to be duplicated for each edge.
+                bool on_edges = false;
+                const std::string &name = state.property_name();
+                switch (state.coloring_method()) {
+                    case State::TEXTURED: {
+                        switch (state.property_location()) {
+                            case State::EDGE: {
+                                auto texcoord = model->template get_edge_property<vec2>(name);
+                                if (!texcoord) {
+                                    LOG(WARNING) << "texcoord property not found on edges: " << name;
+                                    return false;
+                                }
+                                expand_edges(model, edges, data.texcoords.owned(),
+                                             [&](Edge e, Vertex) { return texcoord[e]; });
+                                on_edges = true;
+                                break;
+                            }
+                            case State::VERTEX: {
+                                auto texcoord = model->template get_vertex_property<vec2>(name);
+                                if (!texcoord) {
+                                    LOG(WARNING) << "texcoord property not found on vertices: " << name;
+                                    return false;
+                                }
+                                data.texcoords.refer(texcoord.vector());
+                                break;
+                            }
+                            case State::FACE:
+                            case State::HALFEDGE:
+                                LOG(WARNING) << "should not happen" << name;
+                                return false;
+                        }
+                        break;
+                    }
+
+                    case State::COLOR_PROPERTY: {
+                        switch (state.property_location()) {
+                            case State::EDGE: {
+                                auto colors = model->template get_edge_property<vec3>(name);
+                                if (!colors) {
+                                    LOG(WARNING) << "color property not found: " << name;
+                                    return false;
+                                }
+                                expand_edges(model, edges, data.colors.owned(),
+                                             [&](Edge e, Vertex) { return colors[e]; });
+                                on_edges = true;
+                                break;
+                            }
+                            case State::VERTEX: {
+                                auto colors = model->template get_vertex_property<vec3>(name);
+                                if (!colors) {
+                                    LOG(WARNING) << "color property not found: " << name;
+                                    return false;
+                                }
+                                data.colors.refer(colors.vector());
+                                break;
+                            }
+                            case State::FACE:
+                            case State::HALFEDGE:
+                                LOG(WARNING) << "should not happen" << name;
+                                return false;
+                        }
+                        break;
+                    }
+
+                    case State::SCALAR_FIELD: {
+                        std::vector<float> coords;
+                        switch (state.property_location()) {
+                            case State::EDGE: {
+                                if (!scalar_field<OnEdges>(model, name, state, false, coords)) {
+                                    LOG(WARNING) << "scalar field not found on edges: " << name;
+                                    return false;
+                                }
+                                expand_edges(model, edges, data.texcoords.owned(),
+                                             [&](Edge e, Vertex) { return vec2(coords[e.idx()], 0.5f); });
+                                on_edges = true;
+                                break;
+                            }
+                            case State::VERTEX: {
+                                if (!scalar_field<OnVertices>(model, name, state, true, coords)) {
+                                    LOG(WARNING) << "scalar field not found on vertices: " << name;
+                                    return false;
+                                }
+                                to_texcoords(coords, data.texcoords.owned());
+                                break;
+                            }
+                            case State::FACE:
+                            case State::HALFEDGE:
+                                LOG(WARNING) << "should not happen" << name;
+                                return false;
+                        }
+                        break;
+                    }
+
+                    default: // uniform color
+                        break;
+                }
+
+                if (on_edges)
+                    expand_edges(model, edges, data.points.owned(), [&](Edge, Vertex v) { return points[v]; });
+                else {
+                    data.points.refer(points.vector());
+                    edge_indices(model, edges, data.indices.owned());
+                }
+                return true;
+            }
+
+        }
+
+
+        // -------------------------------------------------------------------------------------------------------------
+
+
+        bool pack_points(PointCloud *model, const State &state, BufferData &data) {
+            assert(model);
+            return details::pack_points(model, state, true, data);
+        }
+
+
+        bool pack_vector_field(PointCloud *model, const std::string &field, float scale, BufferData &data) {
+            assert(model);
+            data.clear();
+            if (model->empty()) {
+                LOG(WARNING) << "model has no valid geometry";
+                return false;
+            }
+
+            auto prop = model->get_vertex_property<vec3>(field);
+            if (!prop) {
+                LOG(ERROR) << "vector filed '" << field << " ' not found on the point cloud (wrong name?)";
+                return false;
+            }
+
+            auto points = model->get_vertex_property<vec3>("v:point");
+            const float length = model->bounding_box().diagonal() * 0.5f * 0.01f * scale;
+
+            std::vector<int> vertices;
+            details::indices_of(model->vertices(), vertices);
+            const int num = static_cast<int>(vertices.size());
+            std::vector<vec3> &d_points = data.points.owned();
+            d_points.resize(num * 2);
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const PointCloud::Vertex v(vertices[i]);
+                d_points[i * 2] = points[v];
+                d_points[i * 2 + 1] = points[v] + prop[v] * length;
+            }
+            return true;
+        }
+
+
+        // -------------------------------------------------------------------------------------------------------------
+
+
+        bool pack_points(SurfaceMesh *model, const State &state, BufferData &data) {
+            assert(model);
+            return details::pack_points(model, state, true, data);
+        }
+
+
+        bool pack_lines(SurfaceMesh *model, const State &state, BufferData &data) {
+            assert(model);
+            return details::pack_lines(model, state, data);
+        }
+
+
+        bool pack_triangles(SurfaceMesh *model, const State &state, BufferData &data) {
+            FaceTriangles triangles;
+            if (!pack_triangles(model, state, data, triangles))
+                return false;
+            record_triangles(model, triangles);
+            return true;
+        }
+
+
+        bool pack_triangles(SurfaceMesh *model, const State &state, BufferData &data, FaceTriangles &triangles) {
+            assert(model);
+            data.clear();
+            triangles.triangulation.reset();
+            triangles.ranges.clear();
+            if (model->empty()) {
+                LOG(WARNING) << "model has no valid geometry";
+                return false;
+            }
+
+            typedef SurfaceMesh::Face Face;
+            typedef SurfaceMesh::Halfedge Halfedge;
+
+            /**
+             * Efficiency in switching between flat and smooth shading.
+             * Easy3d always transfer vertex normals to GPU and the normals for flat shading are computed on the fly in
+             * the fragment shader:
+             *          normal = normalize(cross(dFdx(DataIn.position), dFdy(DataIn.position)));
+             * Then, by adding a boolean uniform 'smooth_shading' to the fragment shader, client code can easily switch
+             * between flat and smooth shading without transferring different data to the GPU.
+             */
+            auto points = model->get_vertex_property<vec3>("v:point");
+            model->update_vertex_normals();
+            auto normals = model->get_vertex_property<vec3>("v:normal");
+
+            // Properties defined on the vertices are rendered with an element buffer indexing the vertices of the
+            // model. Properties defined on the faces or halfedges require a separate vertex for each face corner.
+            // In both cases, the triangulation is taken from the cache and only the coloring attribute is packed.
+            triangles.triangulation = details::triangulation(model);
+            details::Triangulation &triangulation = *triangles.triangulation;
+            const std::vector<unsigned int> &corners = triangulation.corner_offsets;
+            // the triangles of the faces (the faces of a triangle mesh are not triangulated)
+            if (!triangulation.triangle_offsets.empty())
+                details::triangle_ranges(triangulation.triangle_offsets, triangles.ranges);
+            bool on_corners = false;
+
+            const std::string &name = state.property_name();
+            switch (state.coloring_method()) {
+                case State::TEXTURED: {
+                    switch (state.property_location()) {
+                        case State::VERTEX: {
+                            auto texcoord = model->get_vertex_property<vec2>(name);
+                            if (!texcoord) {
+                                LOG(WARNING) << "texcoord property not found on vertices: " << name;
+                                return false;
+                            }
+                            data.texcoords.refer(texcoord.vector());
+                            break;
+                        }
+                        case State::HALFEDGE: {
+                            auto texcoord = model->get_halfedge_property<vec2>(name);
+                            if (!texcoord) {
+                                LOG(WARNING) << "texcoord property not found on halfedges: " << name;
+                                return false;
+                            }
+                            details::expand_corners(model, corners, data.texcoords.owned(),
+                                                    [&](Face, Halfedge h) { return texcoord[h]; });
+                            on_corners = true;
+                            break;
+                        }
+                        case State::FACE:
+                        case State::EDGE:
+                            LOG(WARNING) << "should not happen" << name;
+                            return false;
+                    }
+                    break;
+                }
+
+                case State::COLOR_PROPERTY: {
+                    switch (state.property_location()) {
+                        case State::FACE: {
+                            auto colors = model->get_face_property<vec3>(name);
+                            if (!colors) {
+                                LOG(WARNING) << "color property not found: " << name;
+                                return false;
+                            }
+                            details::expand_faces(corners, data.colors.owned(), [&](Face f) { return colors[f]; });
+                            on_corners = true;
+                            break;
+                        }
+                        case State::VERTEX: {
+                            auto colors = model->get_vertex_property<vec3>(name);
+                            if (!colors) {
+                                LOG(WARNING) << "color property not found: " << name;
+                                return false;
+                            }
+                            data.colors.refer(colors.vector());
+                            break;
+                        }
+                        case State::EDGE:
+                        case State::HALFEDGE:
+                            LOG(WARNING) << "should not happen" << name;
+                            return false;
+                    }
+                    break;
+                }
+
+                case State::SCALAR_FIELD: {
+                    std::vector<float> coords;
+                    switch (state.property_location()) {
+                        case State::FACE: {
+                            if (!details::scalar_field<details::OnFaces>(model, name, state, false, coords)) {
+                                LOG(WARNING) << "scalar field not found on faces: " << name;
+                                return false;
+                            }
+                            details::expand_faces(corners, data.texcoords.owned(),
+                                                  [&](Face f) { return vec2(coords[f.idx()], 0.5f); });
+                            on_corners = true;
+                            break;
+                        }
+                        case State::VERTEX: {
+                            if (!details::scalar_field<details::OnVertices>(model, name, state, true, coords)) {
+                                LOG(WARNING) << "scalar field not found on vertices: " << name;
+                                return false;
+                            }
+                            details::to_texcoords(coords, data.texcoords.owned());
+                            break;
+                        }
+                        case State::EDGE:
+                        case State::HALFEDGE:
+                            LOG(WARNING) << "should not happen" << name;
+                            return false;
+                    }
+                    break;
+                }
+
+                default: // uniform color
+                    break;
+            }
+
+            if (on_corners) {
+                details::gather_corners(triangulation.corner_vertices, points.vector(), data.points.owned());
+                details::gather_corners(triangulation.corner_vertices, normals.vector(), data.normals.owned());
+                // the corners of a triangle mesh are already triangles
+                if (!triangulation.triangle_offsets.empty())
+                    data.indices.refer(details::corner_triangles(triangulation));
+            } else {
+                data.points.refer(points.vector());
+                data.normals.refer(normals.vector());
+                data.indices.refer(triangulation.vertex_triangles);
+            }
+            return true;
+        }
+
+
+        void record_triangles(SurfaceMesh *model, const FaceTriangles &triangles) {
+            assert(model);
+            // the triangulation is cached unless the connectivity has changed since packing
+            if (triangles.triangulation && triangles.triangulation->version == model->connectivity_version()) {
+                auto cache = model->model_property<std::shared_ptr<details::Triangulation> >("m:triangulation");
+                if (cache.vector().empty()) // the model properties have been cleared
+                    cache.vector().push_back(nullptr);
+                cache[0] = triangles.triangulation;
+            }
+
+            if (triangles.ranges.empty())
+                return;
+            if (triangles.ranges.size() != model->faces_size()) {
+                LOG(WARNING) << "the faces have changed since packing, triangle ranges not recorded";
+                return;
+            }
+            auto triangle_range = model->face_property<std::pair<int, int> >("f:triangle_range");
+            triangle_range.vector() = triangles.ranges;
+        }
+
+
+        bool pack_vector_field(SurfaceMesh *model, const std::string &field, int location, float scale,
+                               BufferData &data) {
+            assert(model);
+            data.clear();
+            if (model->empty()) {
+                LOG(WARNING) << "model has no valid geometry";
+                return false;
+            }
+
+            switch (location) {
+                case 0:
+                    if (!model->get_face_property<vec3>(field)) {
+                        LOG(ERROR) << "vector field '" << field << "' not found on the mesh faces (wrong name?)";
+                        return false;
+                    }
+                    break;
+                case 1:
+                    if (!model->get_vertex_property<vec3>(field)) {
+                        LOG(ERROR) << "vector field '" << field << "' not found on the mesh vertices (wrong name?)";
+                        return false;
+                    }
+                    break;
+                case 2:
+                    if (!model->get_edge_property<vec3>(field)) {
+                        LOG(ERROR) << "vector field '" << field << "' not found on the mesh edges (wrong name?)";
+                        return false;
+                    }
+                    break;
+                default:
+                    LOG(ERROR) << "vector field '" << field << "' not found (wrong name?)";
+                    return false;
+            }
+
+            auto points = model->get_vertex_property<vec3>("v:point");
+
+            // use a limited number of edge to compute the length of the vectors.
+            float avg_edge_length = 0.0f;
+            const unsigned int num_edges = std::min(static_cast<unsigned int>(500), model->n_edges());
+            for (unsigned int i = 0; i < num_edges; ++i) {
+                SurfaceMesh::Edge edge(i);
+                auto vs = model->vertex(edge, 0);
+                auto vt = model->vertex(edge, 1);
+                avg_edge_length += distance(points[vs], points[vt]);
+            }
+            avg_edge_length /= num_edges;
+            const float length = avg_edge_length * scale;
+
+            std::vector<int> ids;
+            std::vector<vec3> &d_points = data.points.owned();
+            switch (location) {
+                case 0: {   // on faces
+                    auto prop = model->get_face_property<vec3>(field);
+                    details::indices_of(model->faces(), ids);
+                    const int num = static_cast<int>(ids.size());
+                    d_points.resize(num * 2);
+#pragma omp parallel for
+                    for (int i = 0; i < num; ++i) {
+                        const SurfaceMesh::Face f(ids[i]);
+                        vec3 center(0.0f, 0.0f, 0.0f);
+                        int size = 0;
+                        for (auto v: model->vertices(f)) {
+                            center += points[v];
+                            ++size;
+                        }
+                        center /= size;
+                        d_points[i * 2] = center;
+                        d_points[i * 2 + 1] = center + prop[f] * length;
+                    }
+                    break;
+                }
+                case 1: {   // on vertices
+                    auto prop = model->get_vertex_property<vec3>(field);
+                    details::indices_of(model->vertices(), ids);
+                    const int num = static_cast<int>(ids.size());
+                    d_points.resize(num * 2);
+#pragma omp parallel for
+                    for (int i = 0; i < num; ++i) {
+                        const SurfaceMesh::Vertex v(ids[i]);
+                        d_points[i * 2] = points[v];
+                        d_points[i * 2 + 1] = points[v] + prop[v] * length;
+                    }
+                    break;
+                }
+                case 2: {   // on edges
+                    auto prop = model->get_edge_property<vec3>(field);
+                    details::indices_of(model->edges(), ids);
+                    const int num = static_cast<int>(ids.size());
+                    d_points.resize(num * 2);
+#pragma omp parallel for
+                    for (int i = 0; i < num; ++i) {
+                        const SurfaceMesh::Edge e(ids[i]);
+                        const vec3 p = (points[model->vertex(e, 0)] + points[model->vertex(e, 1)]) * 0.5f;
+                        d_points[i * 2] = p;
+                        d_points[i * 2 + 1] = p + prop[e] * length;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            return true;
+        }
+
+
+        bool pack_borders(SurfaceMesh *model, BufferData &data) {
+            assert(model);
+            data.clear();
+            if (model->empty()) {
+                LOG(WARNING) << "model has no valid geometry";
+                return false;
+            }
+
+            auto points = model->get_vertex_property<vec3>("v:point");
+            data.points.refer(points.vector());
+            std::vector<unsigned int> &indices = data.indices.owned();
+            for (auto e : model->edges()) {
+                if (model->is_boundary(e)) {
+                    indices.push_back(model->vertex(e, 0).idx());
+                    indices.push_back(model->vertex(e, 1).idx());
+                }
+            }
+            return true;
+        }
+
+
+        bool pack_locked_vertices(SurfaceMesh *model, BufferData &data) {
+            assert(model);
+            data.clear();
+            if (model->empty()) {
+                LOG(WARNING) << "model has no valid geometry";
+                return false;
+            }
+
+            auto locked = model->get_vertex_property<bool>("v:locked");
+            if (!locked)
+                return false;
+
+            auto prop = model->get_vertex_property<vec3>("v:point");
+            std::vector<vec3> &points = data.points.owned();
+            for (auto v : model->vertices()) {
+                if (locked[v])
+                    points.push_back(prop[v]);
+            }
+            return true;
+        }
+
+
+        // -------------------------------------------------------------------------------------------------------------
+
+
+        bool pack_points(Graph *model, const State &state, BufferData &data) {
+            assert(model);
+            return details::pack_points(model, state, false, data);
+        }
+
+
+        bool pack_lines(Graph *model, const State &state, BufferData &data) {
+            assert(model);
+            return details::pack_lines(model, state, data);
+        }
+
+    }
+
+}
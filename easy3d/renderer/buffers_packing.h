@@ -0,0 +1,236 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_BUFFERS_PACKING_H
+#define EASY3D_RENDERER_BUFFERS_PACKING_H
+
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    class Graph;
+    class PointCloud;
+    class SurfaceMesh;
+    class State;
+
+    namespace buffers {
+
+        /**
+         * @brief The CPU side of the render buffers of a drawable, i.e., the arrays ready to be uploaded to the GPU.
+         * @details Only the arrays in use (see Array::in_use()) are uploaded, the other buffers of the drawable are
+         *      not touched. If \c indices is not in use, the primitives are drawn directly from the vertex arrays
+         *      (i.e., without an element buffer). BufferData is produced by the pack_*() functions, which do not make
+         *      any OpenGL calls and thus can be used (and benchmarked) without a rendering context and outside the
+         *      rendering thread.
+         */
+        struct BufferData {
+            /**
+             * @brief An array that either owns its data or refers to an array owned by someone else. Arrays that
+             *      already exist in the model in the right layout (e.g., the vertex positions) are referred to
+             *      instead of being copied, so they remain valid only as long as the model is not modified.
+             */
+            template<typename T>
+            class Array {
+            public:
+                Array() : shared_(nullptr), in_use_(false) {}
+
+                /// the content of the array
+                const std::vector<T> &vector() const { return shared_ ? *shared_ : owned_; }
+                /// the storage owned by the array (any referred array is dropped). The array is then in use.
+                std::vector<T> &owned() { shared_ = nullptr; in_use_ = true; return owned_; }
+                /// refers to an existing array instead of owning a copy. The array is then in use.
+                void refer(const std::vector<T> &v) { shared_ = &v; owned_.clear(); in_use_ = true; }
+
+                /// does the array refer to an existing array (e.g., a property of the model)?
+                bool is_reference() const { return shared_ != nullptr; }
+                /// is the array in use (it might still be empty, e.g., for a mesh without faces)?
+                bool in_use() const { return in_use_; }
+                bool empty() const { return vector().empty(); }
+                std::size_t size() const { return vector().size(); }
+                void clear() { shared_ = nullptr; owned_.clear(); in_use_ = false; }
+
+            private:
+                const std::vector<T> *shared_;
+                std::vector<T> owned_;
+                bool in_use_;
+            };
+
+            Array<vec3> points;
+            Array<vec3> normals;
+            Array<vec3> colors;
+            Array<vec2> texcoords;
+            Array<unsigned int> indices;
+
+            void clear() {
+                points.clear();
+                normals.clear();
+                colors.clear();
+                texcoords.clear();
+                indices.clear();
+            }
+        };
+
+
+        // PointCloud -------------------------------------------------------------------------------------------------
+
+        /**
+         * @brief Packs the buffers for rendering the vertices of a point cloud.
+         * @param model     The model.
+         * @param state     The rendering state (i.e., the coloring scheme) of the drawable.
+         * @param data      The packed buffers.
+         * @return \c true on success, \c false if the model is empty or the coloring property does not exist.
+         */
+        bool pack_points(PointCloud *model, const State &state, BufferData &data);
+
+        /**
+         * @brief Packs the buffers (line segments) for rendering a vector field defined on a point cloud.
+         * @param model     The model.
+         * @param field     The name of the vector field.
+         * @param scale     The length scale of the vectors w.r.t. (0.01 * radius) of the model's bounding sphere.
+         * @param data      The packed buffers.
+         * @return \c true on success.
+         */
+        bool pack_vector_field(PointCloud *model, const std::string &field, float scale, BufferData &data);
+
+
+        // SurfaceMesh ------------------------------------------------------------------------------------------------
+
+        /**
+         * @brief Packs the buffers for rendering the vertices of a surface mesh.
+         * @param model     The model.
+         * @param state     The rendering state (i.e., the coloring scheme) of the drawable.
+         * @param data      The packed buffers.
+         * @return \c true on success, \c false if the model is empty or the coloring property does not exist.
+         */
+        bool pack_points(SurfaceMesh *model, const State &state, BufferData &data);
+
+        /**
+         * @brief Packs the buffers for rendering the edges of a surface mesh.
+         * @param model     The model.
+         * @param state     The rendering state (i.e., the coloring scheme) of the drawable.
+         * @param data      The packed buffers.
+         * @return \c true on success, \c false if the model is empty or the coloring property does not exist.
+         */
+        bool pack_lines(SurfaceMesh *model, const State &state, BufferData &data);
+
+        /**
+         * @brief Packs the buffers for rendering the faces of a surface mesh.
+         * @details Polygonal faces are triangulated (see BatchTriangulator) and the triangles of each face are
+         *      recorded in the face property "f:triangle_range" for selecting faces using the rendering buffers.
+         *      The triangulation is cached in the model and only recomputed after the connectivity of the model has
+         *      changed (see SurfaceMesh::connectivity_version()), so packing the buffers for another coloring only
+         *      packs the new coloring attribute. The vertex normals of the model are updated.
+         * @param model     The model.
+         * @param state     The rendering state (i.e., the coloring scheme) of the drawable.
+         * @param data      The packed buffers.
+         * @return \c true on success, \c false if the model is empty or the coloring property does not exist.
+         */
+        bool pack_triangles(SurfaceMesh *model, const State &state, BufferData &data);
+
+        namespace details {
+            struct Triangulation;
+        }
+
+        /**
+         * @brief The triangles of the faces of a surface mesh packed by pack_triangles(), to be recorded in the model
+         *      by record_triangles().
+         */
+        struct FaceTriangles {
+            // the triangulation of the faces, which the packed buffers may refer to
+            std::shared_ptr<details::Triangulation> triangulation;
+            // the triangles [first, last] of each face (empty for triangle meshes, whose faces are not triangulated)
+            std::vector<std::pair<int, int> > ranges;
+        };
+
+        /**
+         * @brief Same as above, but the triangulation and the triangles of each face are returned in \p triangles
+         *      instead of being recorded in the model, e.g., for packing in a worker thread while the rendering thread
+         *      picks faces. The model is not modified, apart from its vertex normals.
+         */
+        bool pack_triangles(SurfaceMesh *model, const State &state, BufferData &data, FaceTriangles &triangles);
+
+        /**
+         * @brief Records the triangles returned by pack_triangles() in the model: caches the triangulation and sets
+         *      the face property "f:triangle_range".
+         */
+        void record_triangles(SurfaceMesh *model, const FaceTriangles &triangles);
+
+        /**
+         * @brief Packs the buffers (line segments) for rendering a vector field defined on a surface mesh.
+         * @param model     The model.
+         * @param field     The name of the vector field.
+         * @param location  The location where the vector is defined (0: on faces; 1: on vertices; 2: one edges).
+         * @param scale     The scale of the vector length w.r.t. the average edge length of the surface mesh.
+         * @param data      The packed buffers.
+         * @return \c true on success.
+         */
+        bool pack_vector_field(SurfaceMesh *model, const std::string &field, int location, float scale,
+                               BufferData &data);
+
+        /**
+         * @brief Packs the buffers (line segments) for rendering the border edges of a surface mesh. The vertex
+         *      positions of the model are referred to and the border edges are given by the indices.
+         */
+        bool pack_borders(SurfaceMesh *model, BufferData &data);
+
+        /**
+         * @brief Packs the buffers for rendering the locked vertices (i.e., property "v:locked") of a surface mesh.
+         */
+        bool pack_locked_vertices(SurfaceMesh *model, BufferData &data);
+
+
+        // Graph ------------------------------------------------------------------------------------------------------
+
+        /**
+         * @brief Packs the buffers for rendering the vertices of a graph.
+         * @param model     The model.
+         * @param state     The rendering state (i.e., the coloring scheme) of the drawable.
+         * @param data      The packed buffers.
+         * @return \c true on success, \c false if the model is empty or the coloring property does not exist.
+         */
+        bool pack_points(Graph *model, const State &state, BufferData &data);
+
+        /**
+         * @brief Packs the buffers for rendering the edges of a graph.
+         * @param model     The model.
+         * @param state     The rendering state (i.e., the coloring scheme) of the drawable.
+         * @param data      The packed buffers.
+         * @return \c true on success, \c false if the model is empty or the coloring property does not exist.
+         */
+        bool pack_lines(Graph *model, const State &state, BufferData &data);
+
+    }   // namespaces buffers
+
+}   // namespaces easy3d
+
+
+#endif  // EASY3D_RENDERER_BUFFERS_PACKING_H
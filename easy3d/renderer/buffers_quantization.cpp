@@ -0,0 +1,297 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include <easy3d/renderer/buffers_quantization.h>
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/util/logging.h>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+
+namespace easy3d {
+
+    namespace buffers {
+
+
+        namespace details {
+
+            // The kernels below are free of branches and of floating-point comparisons (which are not if-converted
+            // unless -fno-trapping-math), e.g., the values are clamped as integers. The encoders apply them to
+            // blocks of contiguous elements so that the loops are vectorized by the compiler, and the records are
+            // interleaved afterwards (a plain copy).
+
+            inline uint16_t quantize_unorm16(float v) {
+                int q = static_cast<int>(v * 65535.0f + 0.5f);
+                q = q < 0 ? 0 : q;
+                q = q > 65535 ? 65535 : q;
+                return static_cast<uint16_t>(q);
+            }
+
+            inline int16_t quantize_snorm16(float v) {
+                // the offset makes the truncation a rounding for v in [-1, 1]
+                int q = static_cast<int>(v * 32767.0f + 32768.5f) - 32768;
+                q = q < -32767 ? -32767 : q;
+                q = q > 32767 ? 32767 : q;
+                return static_cast<int16_t>(q);
+            }
+
+            inline uint8_t quantize_unorm8(float v) {
+                int q = static_cast<int>(v * 255.0f + 0.5f);
+                q = q < 0 ? 0 : q;
+                q = q > 255 ? 255 : q;
+                return static_cast<uint8_t>(q);
+            }
+
+            inline void encode_octahedral(float x, float y, float z, int16_t &ex, int16_t &ey) {
+                // the tiny epsilon maps a zero vector to (0, 0)
+                const float inv = 1.0f / (std::abs(x) + std::abs(y) + std::abs(z) + 1e-30f);
+                const float px = x * inv;
+                const float py = y * inv;
+                // the lower hemisphere is folded onto the outer triangles of the square
+                const float fx = std::copysign(1.0f - std::abs(py), px);
+                const float fy = std::copysign(1.0f - std::abs(px), py);
+                const float lower = static_cast<float>(z < 0.0f);
+                ex = quantize_snorm16(px + lower * (fx - px));
+                ey = quantize_snorm16(py + lower * (fy - py));
+            }
+
+            // the number of elements encoded at a time
+            const int block_size = 1024;
+
+            // the tile indices are stored in 16 bits
+            const int max_tiles = 65535;
+
+            // Splits a box of the given extent into a grid of (roughly) cubic tiles, as many as the 16-bit tile
+            // indices allow. A flat dimension has a single tile.
+            inline void tile_grid(const float extent[3], int tiles[3]) {
+                double volume = 1.0;
+                int dims = 0;
+                for (int k = 0; k < 3; ++k) {
+                    tiles[k] = 1;
+                    if (extent[k] > 0.0f) {
+                        volume *= extent[k];
+                        ++dims;
+                    }
+                }
+                if (dims == 0)
+                    return;
+
+                // the side length of max_tiles cubes filling the box, enlarged until the tiles are not too many
+                double side = std::pow(volume / max_tiles, 1.0 / dims);
+                while (true) {
+                    double num = 1.0;
+                    for (int k = 0; k < 3; ++k) {
+                        if (extent[k] > 0.0f) {
+                            const double n = std::ceil(extent[k] / side);
+                            tiles[k] = static_cast<int>(std::max(1.0, std::min(n, static_cast<double>(max_tiles))));
+                        }
+                        num *= tiles[k];
+                    }
+                    if (num <= max_tiles)
+                        return;
+                    side *= 1.01;
+                }
+            }
+
+        }
+
+
+        void encode_octahedral(const vec3 &n, int16_t &x, int16_t &y) {
+            details::encode_octahedral(n.x, n.y, n.z, x, y);
+        }
+
+
+        vec3 decode_octahedral(int16_t x, int16_t y) {
+            // the same as the decoding in the shaders
+            vec3 n(std::max(x / 32767.0f, -1.0f), std::max(y / 32767.0f, -1.0f), 0.0f);
+            n.z = 1.0f - std::abs(n.x) - std::abs(n.y);
+            const float t = std::max(-n.z, 0.0f);
+            n.x += n.x >= 0.0f ? -t : t;
+            n.y += n.y >= 0.0f ? -t : t;
+            return normalize(n);
+        }
+
+
+        vec3 QuantizedVertices::position(std::size_t i) const {
+            uint16_t q[4];
+            std::memcpy(q, data.data() + i * stride, sizeof(q));
+            const int tx = q[3] % tiles.x;
+            const int ty = (q[3] / tiles.x) % tiles.y;
+            const int tz = q[3] / (tiles.x * tiles.y);
+            return vec3(offset.x + scale.x * (static_cast<float>(tx) + q[0] / 65535.0f),
+                        offset.y + scale.y * (static_cast<float>(ty) + q[1] / 65535.0f),
+                        offset.z + scale.z * (static_cast<float>(tz) + q[2] / 65535.0f));
+        }
+
+
+        vec3 QuantizedVertices::normal(std::size_t i) const {
+            if (!has_normals())
+                return vec3(0, 0, 0);
+            int16_t q[2];
+            std::memcpy(q, data.data() + i * stride + normal_offset, sizeof(q));
+            return decode_octahedral(q[0], q[1]);
+        }
+
+
+        vec3 QuantizedVertices::color(std::size_t i) const {
+            if (!has_colors())
+                return vec3(0, 0, 0);
+            const unsigned char *q = data.data() + i * stride + color_offset;
+            return vec3(q[0] / 255.0f, q[1] / 255.0f, q[2] / 255.0f);
+        }
+
+
+        bool quantize(const BufferData &data, QuantizedVertices &vertices) {
+            const std::vector<vec3> &points = data.points.vector();
+            const std::vector<vec3> &normals = data.normals.vector();
+            const std::vector<vec3> &colors = data.colors.vector();
+            if (points.empty()) {
+                LOG(WARNING) << "no points to quantize";
+                return false;
+            }
+            const bool with_normals = data.normals.in_use();
+            if (with_normals && normals.size() != points.size()) {
+                LOG(ERROR) << "the number of normals (" << normals.size() << ") does not match the number of points ("
+                           << points.size() << ")";
+                return false;
+            }
+            const bool with_colors = data.colors.in_use();
+            if (with_colors && colors.size() != points.size()) {
+                LOG(ERROR) << "the number of colors (" << colors.size() << ") does not match the number of points ("
+                           << points.size() << ")";
+                return false;
+            }
+
+            // the tiles split the bounding box of the points
+            const float *coords = points[0].data();
+            const int num = static_cast<int>(points.size());
+            float bmin[3] = {coords[0], coords[1], coords[2]};
+            float bmax[3] = {coords[0], coords[1], coords[2]};
+            for (int i = 0; i < num; ++i) {
+                for (int k = 0; k < 3; ++k) {
+                    bmin[k] = std::min(bmin[k], coords[i * 3 + k]);
+                    bmax[k] = std::max(bmax[k], coords[i * 3 + k]);
+                }
+            }
+            float extent[3];
+            for (int k = 0; k < 3; ++k)
+                extent[k] = bmax[k] - bmin[k];
+            int tiles[3];
+            details::tile_grid(extent, tiles);
+
+            float offset[3], inv_scale[3];
+            for (int k = 0; k < 3; ++k) {
+                offset[k] = bmin[k];
+                vertices.offset[k] = bmin[k];
+                vertices.tiles[k] = tiles[k];
+                vertices.scale[k] = extent[k] / tiles[k];
+                // a flat dimension is mapped to 0, but its scale must not vanish
+                if (vertices.scale[k] <= 0.0f)
+                    vertices.scale[k] = 1.0f;
+                inv_scale[k] = 1.0f / vertices.scale[k];
+            }
+
+            // records are aligned to 4 bytes: position (8), normal (4), color (4)
+            vertices.stride = 8;
+            vertices.normal_offset = with_normals ? vertices.stride : 0;
+            vertices.stride += with_normals ? 4 : 0;
+            vertices.color_offset = with_colors ? vertices.stride : 0;
+            vertices.stride += with_colors ? 4 : 0;
+
+            const std::size_t stride = vertices.stride;
+            const std::size_t normal_offset = vertices.normal_offset;
+            const std::size_t color_offset = vertices.color_offset;
+            vertices.data.resize(num * stride);
+            unsigned char *records = vertices.data.data();
+
+            const int num_blocks = (num + details::block_size - 1) / details::block_size;
+#pragma omp parallel for
+            for (int b = 0; b < num_blocks; ++b) {
+                const int first = b * details::block_size;
+                const int count = std::min(details::block_size, num - first);
+
+                uint16_t position[details::block_size][4];
+                int tile[3][details::block_size];
+                const float *p = coords + first * 3;
+                for (int k = 0; k < 3; ++k) {
+                    // the coordinate in units of tiles, split into the tile and the position relative to it (the
+                    // points on the max side of the box belong to the last tile)
+                    const int last = tiles[k] - 1;
+                    for (int i = 0; i < count; ++i) {
+                        const float t = (p[i * 3 + k] - offset[k]) * inv_scale[k];
+                        int n = static_cast<int>(t);
+                        n = n < 0 ? 0 : n;
+                        n = n > last ? last : n;
+                        position[i][k] = details::quantize_unorm16(t - static_cast<float>(n));
+                        tile[k][i] = n;
+                    }
+                }
+                for (int i = 0; i < count; ++i) {
+                    const int index = tile[0][i] + tiles[0] * (tile[1][i] + tiles[1] * tile[2][i]);
+                    position[i][3] = static_cast<uint16_t>(index);
+                }
+                for (int i = 0; i < count; ++i)
+                    std::memcpy(records + (first + i) * stride, position[i], sizeof(position[i]));
+
+                if (with_normals) {
+                    // de-interleaving the components first allows vectorizing the encoding
+                    float x[details::block_size], y[details::block_size], z[details::block_size];
+                    const float *n = normals[first].data();
+                    for (int i = 0; i < count; ++i) {
+                        x[i] = n[i * 3 + 0];
+                        y[i] = n[i * 3 + 1];
+                        z[i] = n[i * 3 + 2];
+                    }
+                    int16_t normal[details::block_size][2];
+                    for (int i = 0; i < count; ++i)
+                        details::encode_octahedral(x[i], y[i], z[i], normal[i][0], normal[i][1]);
+                    for (int i = 0; i < count; ++i)
+                        std::memcpy(records + (first + i) * stride + normal_offset, normal[i], sizeof(normal[i]));
+                }
+
+                if (with_colors) {
+                    uint8_t color[details::block_size][4];
+                    const float *c = colors[first].data();
+                    for (int i = 0; i < count; ++i) {
+                        color[i][0] = details::quantize_unorm8(c[i * 3 + 0]);
+                        color[i][1] = details::quantize_unorm8(c[i * 3 + 1]);
+                        color[i][2] = details::quantize_unorm8(c[i * 3 + 2]);
+                        color[i][3] = 255;
+                    }
+                    for (int i = 0; i < count; ++i)
+                        std::memcpy(records + (first + i) * stride + color_offset, color[i], sizeof(color[i]));
+                }
+            }
+
+            return true;
+        }
+
+    }   // namespaces buffers
+
+}   // namespaces easy3d
@@ -0,0 +1,98 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_BUFFERS_QUANTIZATION_H
+#define EASY3D_RENDERER_BUFFERS_QUANTIZATION_H
+
+
+#include <vector>
+#include <cstdint>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    namespace buffers {
+
+        struct BufferData;
+
+        /**
+         * @brief The vertex attributes of a drawable in a compact, interleaved layout, i.e., one array with a record
+         *      per vertex, instead of separate arrays of floats.
+         * @details Each record holds
+         *      - the position: 3 x 16-bit unsigned integers relative to the tile containing the point, and the
+         *        (16-bit) index of that tile. The bounding box of the points is split into a regular grid of up to
+         *        65535 tiles, the i-th along each axis spanning [offset + i * scale, offset + (i + 1) * scale], i.e.,
+         *        position = offset + scale * (tile + q / 65535). The quantization step is thus (1/65535) of the
+         *        extent of a tile (instead of the whole bounding box) along each axis;
+         *      - the normal (optional): 2 x 16-bit signed integers, the octahedral encoding of the unit normal;
+         *      - the color (optional): 4 x 8-bit unsigned integers (RGB + padding).
+         *      A record takes at most 16 bytes, while the float arrays of the position, normal, and color of a vertex
+         *      take 36 bytes. The attributes are fed to the shaders as normalized integers (see
+         *      VertexArrayObject::bind_array_buffer()) and decoded by the shader variants compiled with
+         *      "QUANTIZED_VERTEX" defined (see ShaderManager).
+         */
+        struct QuantizedVertices {
+            QuantizedVertices() : stride(0), normal_offset(0), color_offset(0), offset(0, 0, 0), scale(1, 1, 1),
+                                  tiles(1, 1, 1) {}
+
+            std::vector<unsigned char> data;  // the interleaved records
+            std::size_t stride;               // the size of a record in bytes
+            std::size_t normal_offset;        // the byte offset of the normal in a record (0: no normals)
+            std::size_t color_offset;         // the byte offset of the color in a record (0: no colors)
+            vec3 offset;                      // the origin of the tiles (i.e., the min corner of the bounding box)
+            vec3 scale;                       // the extent of a tile
+            ivec3 tiles;                      // the number of tiles along each axis
+
+            std::size_t size() const { return stride == 0 ? 0 : data.size() / stride; }
+            bool has_normals() const { return normal_offset != 0; }
+            bool has_colors() const { return color_offset != 0; }
+
+            /// the decoded attributes of the \p i-th vertex (e.g., for measuring the quantization error)
+            vec3 position(std::size_t i) const;
+            vec3 normal(std::size_t i) const;
+            vec3 color(std::size_t i) const;
+        };
+
+        /**
+         * @brief Quantizes and interleaves the points, normals (if in use), and colors (if in use) of the packed
+         *      buffers. The texture coordinates and the indices are not affected. The encoders are branch-free loops
+         *      that are vectorized by the compiler and run in parallel.
+         * @return \c false if there are no points or if the normals/colors do not match the points.
+         */
+        bool quantize(const BufferData &data, QuantizedVertices &vertices);
+
+        /// the octahedral encoding of a unit vector, as two normalized 16-bit signed integers
+        void encode_octahedral(const vec3 &n, int16_t &x, int16_t &y);
+        /// decodes the octahedral encoding of a unit vector
+        vec3 decode_octahedral(int16_t x, int16_t y);
+
+    }   // namespaces buffers
+
+}   // namespaces easy3d
+
+
+#endif  // EASY3D_RENDERER_BUFFERS_QUANTIZATION_H
@@ -25,6 +25,9 @@
 #include <easy3d/renderer/drawable.h>
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
 
 #include <easy3d/core/model.h>
 #include <easy3d/renderer/opengl.h>
@@ -33,6 +36,9 @@
 #include <easy3d/renderer/texture_manager.h>
 #include <easy3d/renderer/opengl_error.h>
 #include <easy3d/renderer/buffers.h>
+#include <easy3d/renderer/buffers_async.h>
+#include <easy3d/renderer/buffers_quantization.h>
+#include <easy3d/renderer/renderer.h>
 #include <easy3d/renderer/setting.h>
 #include <easy3d/util/logging.h>
 #include <easy3d/util/stop_watch.h>
@@ -40,11 +46,117 @@
 
 namespace easy3d {
 
+
+    void DirtyRanges::add(std::size_t first, std::size_t count) {
+        if (count == 0)
+            return;
+        const std::size_t last = first + count;
+        // consecutive edits are merged on the fly
+        if (!ranges_.empty() && first <= ranges_.back().second && last >= ranges_.back().first) {
+            ranges_.back().first = std::min(ranges_.back().first, first);
+            ranges_.back().second = std::max(ranges_.back().second, last);
+        } else
+            ranges_.emplace_back(first, last);
+    }
+
+
+    std::vector<DirtyRanges::Range> DirtyRanges::ranges(std::size_t gap) const {
+        std::vector<Range> sorted = ranges_;
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<Range> merged;
+        for (const auto &r : sorted) {
+            if (!merged.empty() && r.first <= merged.back().second + gap)
+                merged.back().second = std::max(merged.back().second, r.second);
+            else
+                merged.push_back(r);
+        }
+        return merged;
+    }
+
+
+    namespace details {
+
+        // the versions of the buffers are taken from a global counter, so they are unique among all drawables
+        unsigned int next_buffers_version() {
+            static std::atomic<unsigned int> counter(0);
+            return ++counter;
+        }
+
+
+        // Uploads the modified ranges of an attribute buffer. Returns false if the whole buffer has to be rewritten
+        // instead, i.e., if it does not exist, if its size has changed, or if most of it has been modified.
+        template<typename T>
+        bool update_ranges(VertexArrayObject *vao, unsigned int buffer, std::size_t num, const std::vector<T> &data,
+                           const DirtyRanges &ranges) {
+            if (buffer == 0 || data.size() != num)
+                return false;
+
+            // ranges closer than this (in number of elements) are uploaded together
+            const std::size_t gap = 256;
+            std::vector<DirtyRanges::Range> merged = ranges.ranges(gap);
+            std::size_t modified = 0;
+            for (auto &r : merged) {
+                r.second = std::min(r.second, data.size());
+                if (r.first < r.second)
+                    modified += r.second - r.first;
+            }
+            if (modified * 2 > data.size())
+                return false;
+
+            for (const auto &r : merged) {
+                if (r.first >= r.second)
+                    continue;
+                if (!vao->update_array_buffer(buffer, r.first * sizeof(T), (r.second - r.first) * sizeof(T),
+                                              data.data() + r.first)) {
+                    LOG(ERROR) << "failed updating buffer range [" << r.first << ", " << r.second << ")";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+
+        // Collects the element ranges of the chunks that are inside the viewing frustum of the camera and not smaller
+        // than the threshold (in pixels) on the screen. Consecutive visible chunks are merged into a single range.
+        // Returns the number of elements in the ranges.
+        std::size_t visible_ranges(const std::vector<buffers::Chunk> &chunks, const Camera *camera, float threshold,
+                                   std::vector<int> &counts, std::vector<const void *> &offsets) {
+            counts.clear();
+            offsets.clear();
+
+            const buffers::ChunkCuller culler(camera);
+            std::size_t num = 0;
+            std::size_t end = 0;  // the end of the last range
+            for (const auto &chunk : chunks) {
+                if (!culler.is_visible(chunk.box, threshold))
+                    continue;
+
+                if (!counts.empty() && chunk.first == end)
+                    counts.back() += static_cast<int>(chunk.count);
+                else {
+                    counts.push_back(static_cast<int>(chunk.count));
+                    offsets.push_back(reinterpret_cast<const void *>(chunk.first * sizeof(unsigned int)));
+                }
+                end = chunk.first + chunk.count;
+                num += chunk.count;
+            }
+            return num;
+        }
+
+    }
+
+
     Drawable::Drawable(const std::string &name, Model *model)
             : name_(name), model_(model), vao_(nullptr), num_vertices_(0), num_indices_(0),
-              update_needed_(false), update_func_(nullptr), vertex_buffer_(0), color_buffer_(0), normal_buffer_(0),
-              texcoord_buffer_(0), element_buffer_(0), storage_buffer_(0), current_storage_buffer_size_(0),
-              selection_buffer_(0), current_selection_buffer_size_(0) {
+              update_needed_(false), update_pending_(false), update_func_(nullptr), vertex_buffer_(0),
+              color_buffer_(0), normal_buffer_(0), texcoord_buffer_(0), element_buffer_(0),
+              shared_vertex_buffer_(false), shared_color_buffer_(false), shared_normal_buffer_(false),
+              shared_texcoord_buffer_(false), vertex_format_(VF_FLOAT),
+              quantized_buffer_(false), quantization_offset_(0, 0, 0), quantization_scale_(1, 1, 1),
+              quantization_tiles_(1, 1, 1), chunk_size_(0),
+              small_feature_threshold_(1.0f), num_drawn_elements_(0), storage_buffer_(0),
+              current_storage_buffer_size_(0), selection_buffer_(0), current_selection_buffer_size_(0),
+              buffers_version_(details::next_buffers_version()) {
         vao_ = new VertexArrayObject;
         material_ = Material(setting::material_ambient, setting::material_specular, setting::material_shininess);
         lighting_two_sides_ = setting::light_two_sides;
@@ -54,6 +166,8 @@ namespace easy3d {
 
 
     Drawable::~Drawable() {
+        if (update_pending_)
+            buffers::AsyncUpdater::cancel(this);
         clear();
         delete vao_;
     }
@@ -68,16 +182,27 @@ namespace easy3d {
 
 
     void Drawable::buffer_stats(std::ostream &output) const {
-        if (vertex_buffer()) {
+        if (quantized_buffer_) {
+            std::size_t stride = 8;
+            if (normal_buffer())
+                stride += 4;
+            if (color_buffer())
+                stride += 4;
+            std::cout << "\t" << name() << std::endl;
+            output << "\t\tquantized buffer:  " << num_vertices_ << " vertices (positions"
+                   << (normal_buffer() ? ", normals" : "") << (color_buffer() ? ", colors" : "") << "), "
+                   << num_vertices_ * stride << " bytes" << std::endl;
+        }
+        else if (vertex_buffer()) {
             std::cout << "\t" << name() << std::endl;
             output << "\t\tvertex buffer:     " << num_vertices_ << " vertices, "
                    << num_vertices_ * sizeof(vec3) << " bytes" << std::endl;
         }
-        if (normal_buffer()) {
+        if (normal_buffer() && !quantized_buffer_) {
             output << "\t\tnormal buffer:     " << num_vertices_ << " normals, "
                    << num_vertices_ * sizeof(vec3) << " bytes" << std::endl;
         }
-        if (color_buffer()) {
+        if (color_buffer() && !quantized_buffer_) {
             output << "\t\tcolor buffer:      " << num_vertices_ << " colors, "
                    << num_vertices_ * sizeof(vec3) << " bytes" << std::endl;
         }
@@ -95,26 +220,194 @@ namespace easy3d {
     void Drawable::update() {
         bbox_.clear();
         update_needed_ = true;
+        // the buffers shared with the other drawables of the model have to be uploaded again
+        if (model_ && model_->renderer())
+            model_->renderer()->invalidate_shared_buffers();
+    }
+
+
+    void Drawable::set_vertex_format(VertexFormat format) {
+        if (format != vertex_format_) {
+            vertex_format_ = format;
+            update_needed_ = true;
+        }
+    }
+
+
+    void Drawable::set_chunk_size(std::size_t max_primitives) {
+        if (max_primitives != chunk_size_) {
+            chunk_size_ = max_primitives;
+            update_needed_ = true;
+        }
     }
 
 
     void Drawable::clear() {
-        VertexArrayObject::release_buffer(vertex_buffer_);
-        VertexArrayObject::release_buffer(color_buffer_);
-        VertexArrayObject::release_buffer(normal_buffer_);
-        VertexArrayObject::release_buffer(texcoord_buffer_);
+        release_quantized_buffer();
+        release_buffer(vertex_buffer_, shared_vertex_buffer_);
+        release_buffer(color_buffer_, shared_color_buffer_);
+        release_buffer(normal_buffer_, shared_normal_buffer_);
+        release_buffer(texcoord_buffer_, shared_texcoord_buffer_);
         VertexArrayObject::release_buffer(element_buffer_);
         VertexArrayObject::release_buffer(storage_buffer_);
         VertexArrayObject::release_buffer(selection_buffer_);
+        chunks_.clear();
 
         num_vertices_ = 0;
         num_indices_ = 0;
         bbox_.clear();
+        buffers_modified();
+    }
+
+
+    void Drawable::buffers_modified() {
+        buffers_version_ = details::next_buffers_version();
     }
 
 
     void Drawable::release_element_buffer() {
         VertexArrayObject::release_buffer(element_buffer_);
+        chunks_.clear();
+        buffers_modified();
+    }
+
+
+    void Drawable::release_buffer(unsigned int &buffer, bool &shared) {
+        if (shared) {
+            if (model_ && model_->renderer())
+                model_->renderer()->release_shared_buffer(buffer);
+            buffer = 0;
+            shared = false;
+        } else
+            VertexArrayObject::release_buffer(buffer);
+    }
+
+
+    void Drawable::release_quantized_buffer() {
+        if (!quantized_buffer_)
+            return;
+        // the normal and color buffers are the same buffer object
+        VertexArrayObject::release_buffer(vertex_buffer_);
+        normal_buffer_ = 0;
+        color_buffer_ = 0;
+        quantized_buffer_ = false;
+    }
+
+
+    void Drawable::update_quantized_buffer(const buffers::QuantizedVertices &vertices) {
+        assert(vao_);
+        if (!quantized_buffer_) {
+            // the separate (own or shared) buffers are replaced by the interleaved buffer
+            release_buffer(vertex_buffer_, shared_vertex_buffer_);
+            release_buffer(normal_buffer_, shared_normal_buffer_);
+            release_buffer(color_buffer_, shared_color_buffer_);
+        }
+
+        bool success = VertexArrayObject::create_buffer(vertex_buffer_, vertices.data.data(), vertices.data.size());
+        if (success) {
+            quantized_buffer_ = true;
+            // the fourth component of a position is the index of its tile
+            success = vao_->bind_array_buffer(vertex_buffer_, ShaderProgram::POSITION, 4, GL_UNSIGNED_SHORT, true,
+                                              vertices.stride, 0);
+            normal_buffer_ = vertices.has_normals() ? vertex_buffer_ : 0;
+            if (success && normal_buffer_)
+                success = vao_->bind_array_buffer(vertex_buffer_, ShaderProgram::NORMAL, 2, GL_SHORT, true,
+                                                  vertices.stride, vertices.normal_offset);
+            color_buffer_ = vertices.has_colors() ? vertex_buffer_ : 0;
+            if (success && color_buffer_)
+                success = vao_->bind_array_buffer(vertex_buffer_, ShaderProgram::COLOR, 3, GL_UNSIGNED_BYTE, true,
+                                                  vertices.stride, vertices.color_offset);
+        }
+        LOG_IF(ERROR, !success) << "failed creating quantized buffer";
+
+        if (!success) {
+            release_quantized_buffer();
+            num_vertices_ = 0;
+        } else {
+            num_vertices_ = vertices.size();
+            quantization_offset_ = vertices.offset;
+            quantization_scale_ = vertices.scale;
+            quantization_tiles_ = vertices.tiles;
+            if (model())
+                bbox_ = model()->bounding_box();
+            else {
+                const vec3 extent(vertices.scale.x * vertices.tiles.x, vertices.scale.y * vertices.tiles.y,
+                                  vertices.scale.z * vertices.tiles.z);
+                bbox_ = Box3(vertices.offset, vertices.offset + extent);
+            }
+        }
+        buffers_modified();
+    }
+
+
+    std::vector<std::string> Drawable::vertex_format_defines() const {
+        if (quantized_buffer_)
+            return std::vector<std::string>(1, "QUANTIZED_VERTEX");
+        return std::vector<std::string>();
+    }
+
+
+    void Drawable::set_vertex_format_uniforms(ShaderProgram *program) const {
+        if (quantized_buffer_) {
+            program->set_uniform("quantization_offset", quantization_offset_)
+                    ->set_uniform("quantization_scale", quantization_scale_)
+                    ->set_uniform("quantization_tiles", quantization_tiles_);
+        }
+    }
+
+
+    bool Drawable::share_buffer(unsigned int &buffer, bool &shared, unsigned int index, std::size_t dim,
+                                const void *array, const void *data, std::size_t size) {
+        assert(vao_);
+        Renderer *renderer = model_ ? model_->renderer() : nullptr;
+        if (!renderer)
+            return false;
+
+        // acquire before releasing the current one, which might be the same buffer
+        const unsigned int shared_buffer = renderer->acquire_shared_buffer(this, array, data, size);
+        if (shared_buffer == 0)
+            return false;
+        release_quantized_buffer();
+        release_buffer(buffer, shared);
+
+        buffer = shared_buffer;
+        shared = true;
+        const bool success = vao_->bind_array_buffer(buffer, index, dim);
+        LOG_IF(ERROR, !success) << "failed binding shared buffer";
+        buffers_modified();
+        return true;
+    }
+
+
+    void Drawable::share_vertex_buffer(const std::vector<vec3> &vertices) {
+        if (!share_buffer(vertex_buffer_, shared_vertex_buffer_, ShaderProgram::POSITION, 3, &vertices,
+                          vertices.data(), vertices.size() * sizeof(vec3))) {
+            update_vertex_buffer(vertices);
+            return;
+        }
+        num_vertices_ = vertices.size();
+        bbox_ = model()->bounding_box();
+    }
+
+
+    void Drawable::share_color_buffer(const std::vector<vec3> &colors) {
+        if (!share_buffer(color_buffer_, shared_color_buffer_, ShaderProgram::COLOR, 3, &colors,
+                          colors.data(), colors.size() * sizeof(vec3)))
+            update_color_buffer(colors);
+    }
+
+
+    void Drawable::share_normal_buffer(const std::vector<vec3> &normals) {
+        if (!share_buffer(normal_buffer_, shared_normal_buffer_, ShaderProgram::NORMAL, 3, &normals,
+                          normals.data(), normals.size() * sizeof(vec3)))
+            update_normal_buffer(normals);
+    }
+
+
+    void Drawable::share_texcoord_buffer(const std::vector<vec2> &texcoords) {
+        if (!share_buffer(texcoord_buffer_, shared_texcoord_buffer_, ShaderProgram::TEXCOORD, 2, &texcoords,
+                          texcoords.data(), texcoords.size() * sizeof(vec2)))
+            update_texcoord_buffer(texcoords);
     }
 
 
@@ -159,6 +452,10 @@ namespace easy3d {
 
 
     void Drawable::internal_update_buffers() {
+        // the new buffers are on the way
+        if (update_pending_)
+            return;
+
         if (!model_ && !update_func_) {
             LOG_FIRST_N(ERROR, 1)
                 << "updating buffers failed: drawable not associated with a model and no update function specified.";
@@ -172,6 +469,11 @@ namespace easy3d {
         StopWatch w;
         if (update_func_)
             update_func_(model_, this);
+        else if (buffers::AsyncUpdater::is_enabled()) {
+            buffers::AsyncUpdater::request(this);
+            update_needed_ = false;
+            return;
+        }
         else {
             buffers::update(model_, this);
         }
@@ -182,6 +484,9 @@ namespace easy3d {
 
     void Drawable::update_vertex_buffer(const std::vector<vec3> &vertices) {
         assert(vao_);
+        release_quantized_buffer();
+        if (shared_vertex_buffer_) // the drawable gets its own buffer
+            release_buffer(vertex_buffer_, shared_vertex_buffer_);
 
         bool success = vao_->create_array_buffer(vertex_buffer_, ShaderProgram::POSITION, vertices.data(),
                                                  vertices.size() * sizeof(vec3), 3);
@@ -202,43 +507,105 @@ namespace easy3d {
                     bbox_.add_point(p);
             }
         }
+        buffers_modified();
     }
 
 
     void Drawable::update_color_buffer(const std::vector<vec3> &colors) {
         assert(vao_);
+        release_quantized_buffer();
+        if (shared_color_buffer_) // the drawable gets its own buffer
+            release_buffer(color_buffer_, shared_color_buffer_);
 
         bool success = vao_->create_array_buffer(color_buffer_, ShaderProgram::COLOR, colors.data(),
                                                  colors.size() * sizeof(vec3), 3);
         LOG_IF(ERROR, !success) << "failed updating color buffer";
+        buffers_modified();
     }
 
 
     void Drawable::update_normal_buffer(const std::vector<vec3> &normals) {
         assert(vao_);
+        release_quantized_buffer();
+        if (shared_normal_buffer_) // the drawable gets its own buffer
+            release_buffer(normal_buffer_, shared_normal_buffer_);
         bool success = vao_->create_array_buffer(normal_buffer_, ShaderProgram::NORMAL, normals.data(),
                                                  normals.size() * sizeof(vec3), 3);
         LOG_IF(ERROR, !success) << "failed updating normal buffer";
+        buffers_modified();
     }
 
 
     void Drawable::update_texcoord_buffer(const std::vector<vec2> &texcoords) {
         assert(vao_);
+        if (shared_texcoord_buffer_) // the drawable gets its own buffer
+            release_buffer(texcoord_buffer_, shared_texcoord_buffer_);
 
         bool success = vao_->create_array_buffer(texcoord_buffer_, ShaderProgram::TEXCOORD, texcoords.data(),
                                                  texcoords.size() * sizeof(vec2), 2);
         LOG_IF(ERROR, !success) << "failed updating texcoord buffer";
+        buffers_modified();
+    }
+
+
+    void Drawable::update_vertex_buffer(const std::vector<vec3> &vertices, const DirtyRanges &ranges) {
+        assert(vao_);
+        if (ranges.empty())
+            return;
+
+        if (quantized_buffer_ || !details::update_ranges(vao_, vertex_buffer_, num_vertices_, vertices, ranges)) {
+            update_vertex_buffer(vertices);
+            return;
+        }
+
+        if (model())
+            bbox_ = model()->bounding_box();
+        else {
+            for (const auto &r : ranges.ranges()) {
+                for (std::size_t i = r.first; i < std::min(r.second, vertices.size()); ++i)
+                    bbox_.add_point(vertices[i]);
+            }
+        }
+        buffers_modified();
+    }
+
+
+    void Drawable::update_color_buffer(const std::vector<vec3> &colors, const DirtyRanges &ranges) {
+        assert(vao_);
+        if (!ranges.empty() &&
+            (quantized_buffer_ || !details::update_ranges(vao_, color_buffer_, num_vertices_, colors, ranges)))
+            update_color_buffer(colors);
+        buffers_modified();
+    }
+
+
+    void Drawable::update_normal_buffer(const std::vector<vec3> &normals, const DirtyRanges &ranges) {
+        assert(vao_);
+        if (!ranges.empty() &&
+            (quantized_buffer_ || !details::update_ranges(vao_, normal_buffer_, num_vertices_, normals, ranges)))
+            update_normal_buffer(normals);
+        buffers_modified();
+    }
+
+
+    void Drawable::update_texcoord_buffer(const std::vector<vec2> &texcoords, const DirtyRanges &ranges) {
+        assert(vao_);
+        if (!ranges.empty() && !details::update_ranges(vao_, texcoord_buffer_, num_vertices_, texcoords, ranges))
+            update_texcoord_buffer(texcoords);
+        buffers_modified();
     }
 
 
     void Drawable::update_element_buffer(const std::vector<unsigned int> &indices) {
         assert(vao_);
+        chunks_.clear();
 
         bool status = vao_->create_element_buffer(element_buffer_, indices.data(), indices.size() * sizeof(unsigned int));
         if (!status)
             num_indices_ = 0;
         else
             num_indices_ = indices.size();
+        buffers_modified();
     }
 
 
@@ -271,8 +638,29 @@ namespace easy3d {
 
 
     void Drawable::gl_draw(bool with_storage_buffer /* = false */) const {
+        gl_draw(nullptr, with_storage_buffer);
+    }
+
+
+    void Drawable::gl_draw(const Camera *camera, bool with_storage_buffer /* = false */) const {
         if (update_needed_ || vertex_buffer_ == 0)
             const_cast<Drawable*>(this)->internal_update_buffers();
+        // nothing to draw until the first buffers are uploaded
+        if (vertex_buffer_ == 0 && update_pending_)
+            return;
+
+        // only the visible chunks are drawn. The shaders highlight the primitives by gl_PrimitiveID, which restarts
+        // from 0 for each range of a multi-draw, so the lines and triangles are not culled while highlighted (the
+        // points are highlighted by their vertex index).
+        const bool highlighted = highlight() && type() != DT_POINTS;
+        const bool culled = (camera && element_buffer_ && !chunks_.empty() && !highlighted);
+        if (culled) {
+            num_drawn_elements_ = details::visible_ranges(chunks_, camera, small_feature_threshold_, draw_counts_,
+                                                          draw_offsets_);
+            if (num_drawn_elements_ == 0)
+                return;
+        } else
+            num_drawn_elements_ = element_buffer_ ? num_indices_ : num_vertices_;
 
         vao_->bind();
 
@@ -294,7 +682,12 @@ namespace easy3d {
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_);	easy3d_debug_log_gl_error;
 
             // index buffer must be bound if using glDrawElements()
-            glDrawElements(type(), GLsizei(num_indices_), GL_UNSIGNED_INT, nullptr);    easy3d_debug_log_gl_error;
+            if (culled)
+                glMultiDrawElements(type(), draw_counts_.data(), GL_UNSIGNED_INT, draw_offsets_.data(),
+                                    GLsizei(draw_counts_.size()));
+            else
+                glDrawElements(type(), GLsizei(num_indices_), GL_UNSIGNED_INT, nullptr);
+            easy3d_debug_log_gl_error;
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);	easy3d_debug_log_gl_error;
         } else
             glDrawArrays(type(), 0, GLsizei(num_vertices_));
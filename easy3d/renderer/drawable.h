@@ -31,12 +31,49 @@
 
 #include <easy3d/core/types.h>
 #include <easy3d/renderer/state.h>
+#include <easy3d/renderer/buffers_chunks.h>
 
 namespace easy3d {
 
     class Model;
     class Camera;
     class VertexArrayObject;
+    class ShaderProgram;
+    class RenderQueue;
+
+    namespace buffers {
+        struct QuantizedVertices;
+        class AsyncUpdater;
+    }
+
+
+    /**
+     * @brief Tracks the modified elements of a buffer (e.g., the indices of the vertices that have been edited), such
+     *        that only the modified parts of the buffer are uploaded to the GPU.
+     * @details The elements can be added in any order. Overlapping and adjacent ranges are merged.
+     * @related Drawable::update_vertex_buffer(const std::vector<vec3>&, const DirtyRanges&).
+     */
+    class DirtyRanges {
+    public:
+        /// a range of elements [first, last)
+        typedef std::pair<std::size_t, std::size_t> Range;
+
+        /// marks the element \p index as modified
+        void add(std::size_t index) { add(index, 1); }
+        /// marks the \p count elements starting from \p first as modified
+        void add(std::size_t first, std::size_t count);
+
+        void clear() { ranges_.clear(); }
+        bool empty() const { return ranges_.empty(); }
+
+        /// returns the sorted and merged ranges. Ranges separated by no more than \p gap elements are also merged,
+        /// which uploads a few unmodified elements but saves many small transfers.
+        std::vector<Range> ranges(std::size_t gap = 0) const;
+
+    private:
+        std::vector<Range> ranges_;
+    };
+
 
     /**
      * @brief The base class for drawable objects. A drawable represent a set of points, line segments, or triangles.
@@ -56,6 +93,12 @@ namespace easy3d {
             DT_TRIANGLES = 0x0004   // == GL_TRIANGLES
         };
 
+        // the layout of the vertex attributes in the GPU memory
+        enum VertexFormat {
+            VF_FLOAT = 0,       // a tightly packed array of floats per attribute (default)
+            VF_QUANTIZED = 1    // the positions, normals, and colors quantized and interleaved in a single array
+        };
+
     public:
         // a drawable can be stand-alone or attached to a model
         Drawable(const std::string &name = "unknown", Model *model = nullptr);
@@ -81,6 +124,17 @@ namespace easy3d {
         /// print statistics (e.g., num vertices, memory usage) of the buffers to an output stream (e.g., std::cout).
         void buffer_stats(std::ostream &output) const;
 
+        /**
+         * @brief The vertex format used when the buffers of the drawable are updated (see buffers::update()).
+         * @details VF_QUANTIZED reduces the GPU memory (and the upload time) of the positions, normals, and colors of
+         *      a vertex from 36 bytes to at most 16 bytes (see buffers::QuantizedVertices), at the cost of a
+         *      quantization error of 1/65535 of the extent of a tile (up to 65535 tiles split the drawable) along
+         *      each axis. It is currently used by PointsDrawable only, whose shaders are automatically selected to
+         *      match the vertex format (see vertex_format_defines()).
+         */
+        VertexFormat vertex_format() const { return vertex_format_; }
+        void set_vertex_format(VertexFormat format);
+
         // ------------------- buffer access and management ------------------------
 
         unsigned int vertex_buffer() const { return vertex_buffer_; }
@@ -91,6 +145,14 @@ namespace easy3d {
         unsigned int storage_buffer() const { return storage_buffer_; }
         unsigned int selection_buffer() const { return selection_buffer_; }
 
+        /// the number of vertices and indices in the buffers
+        std::size_t num_vertices() const { return num_vertices_; }
+        std::size_t num_indices() const { return num_indices_; }
+
+        /// changes whenever the buffers are modified or released. The versions are unique among all drawables, so a
+        /// drawable is never mistaken for a deleted one that occupied the same memory.
+        unsigned int buffers_version() const { return buffers_version_; }
+
         /**
          * Create/Update a single buffer.
          * Primitives like lines and triangles can be drawn with or without the element buffer.
@@ -108,6 +170,91 @@ namespace easy3d {
         // entry must have 2 or 3 elements
         void update_element_buffer(const std::vector< std::vector<unsigned int> > &elements);
 
+        /**
+         * Update the modified parts of a single buffer, e.g., after editing a few vertices or animating a scalar field.
+         * The data must have the same layout as in the last full update of the buffer (i.e., one entry per vertex of
+         * the drawable) and only the entries in \p ranges are uploaded (using glBufferSubData()). The whole buffer is
+         * rewritten instead (orphaning the old data store) if it does not exist yet, if the number of vertices has
+         * changed, or if most of it has been modified.
+         * @note If the drawable is not associated with a model, the bounding box is only enlarged by the modified
+         *       vertices. Use update_vertex_buffer(const std::vector<vec3>&) to recompute a tight bounding box.
+         *       If the buffer is shared (see share_vertex_buffer()), the modification is visible to all the drawables
+         *       sharing it.
+         */
+        void update_vertex_buffer(const std::vector<vec3> &vertices, const DirtyRanges &ranges);
+        void update_color_buffer(const std::vector<vec3> &colors, const DirtyRanges &ranges);
+        void update_normal_buffer(const std::vector<vec3> &normals, const DirtyRanges &ranges);
+        void update_texcoord_buffer(const std::vector<vec2> &texcoords, const DirtyRanges &ranges);
+
+        /**
+         * Use a buffer shared with the other drawables of the model instead of a buffer of the drawable's own.
+         * The data must be an array owned by the model (e.g., the vertex positions) and it is uploaded at most once
+         * per update of the model, no matter how many drawables refer to it (see Renderer::acquire_shared_buffer()).
+         * The drawable then differs from the others only in its element buffer (and the attributes not shared).
+         * If the drawable is not managed by the renderer of its model, the data is uploaded into its own buffer.
+         */
+        void share_vertex_buffer(const std::vector<vec3> &vertices);
+        void share_color_buffer(const std::vector<vec3> &colors);
+        void share_normal_buffer(const std::vector<vec3> &normals);
+        void share_texcoord_buffer(const std::vector<vec2> &texcoords);
+
+        /**
+         * Upload the positions, normals (if any), and colors (if any) in the quantized, interleaved layout. The
+         * vertex, normal, and color buffers then all refer to the same buffer object, and the drawable's shaders
+         * must decode the attributes (see quantized_buffer(), quantization_offset(), and quantization_scale()).
+         * Updating any of these buffers individually afterwards releases the interleaved buffer.
+         */
+        void update_quantized_buffer(const buffers::QuantizedVertices &vertices);
+
+        /// does the drawable currently store its vertex attributes in the quantized, interleaved layout?
+        bool quantized_buffer() const { return quantized_buffer_; }
+        /// the origin of the tiles the quantized positions are relative to, the extent of a tile, and the number of
+        /// tiles along each axis (see buffers::QuantizedVertices)
+        const vec3 &quantization_offset() const { return quantization_offset_; }
+        const vec3 &quantization_scale() const { return quantization_scale_; }
+        const ivec3 &quantization_tiles() const { return quantization_tiles_; }
+
+        /**
+         * The preprocessor definitions selecting the variant of a shader program that matches the current layout of
+         * the vertex attributes, i.e., "QUANTIZED_VERTEX" for a quantized buffer (see ShaderManager::get_program()).
+         * Any program drawing the drawable (e.g., for selection or screen-space effects) must use this variant, and
+         * set_vertex_format_uniforms() must be called after binding the program.
+         */
+        std::vector<std::string> vertex_format_defines() const;
+        /// sets the uniforms the shaders need for decoding the vertex attributes (if quantized)
+        void set_vertex_format_uniforms(ShaderProgram *program) const;
+
+        // ------------------- spatial chunks and culling ------------------------
+
+        /**
+         * @brief Splits the drawable into chunks of at most \p max_primitives primitives, which are culled
+         *      individually when the drawable is rendered (0 disables the chunks, which is the default).
+         * @details When the buffers are updated, the primitives are sorted in the Morton order of their centers and
+         *      split into chunks, each with its own bounding box and range of the element buffer (see
+         *      buffers::split_into_chunks()). The chunks outside the viewing frustum or smaller than the small-feature
+         *      threshold on the screen are then skipped (see gl_draw(const Camera*, bool)), e.g., a city model seen
+         *      from the street level only issues the few chunks around the camera.
+         *      The triangles of a polygonal face remain contiguous and "f:triangle_range" gives their new positions,
+         *      so selecting faces still works. Lines and triangles are not culled while highlighted, because the
+         *      primitive IDs restart for each draw range. A chunk of a few thousand primitives is a good trade-off
+         *      between the culling accuracy and the number of draw ranges.
+         */
+        std::size_t chunk_size() const { return chunk_size_; }
+        void set_chunk_size(std::size_t max_primitives);
+
+        /// the chunks of the drawable (empty if the drawable is not split into chunks)
+        const std::vector<buffers::Chunk> &chunks() const { return chunks_; }
+        /// sets the chunks (done by buffers::update()). The chunks refer to the current element buffer, so they are
+        /// cleared when the element buffer is updated or released.
+        void set_chunks(const std::vector<buffers::Chunk> &chunks) { chunks_ = chunks; }
+
+        /// the chunks whose projection on the screen is smaller than this (in pixels) are not rendered (default: 1)
+        float small_feature_threshold() const { return small_feature_threshold_; }
+        void set_small_feature_threshold(float pixels) { small_feature_threshold_ = pixels; }
+
+        /// the number of elements (i.e., indices or vertices) issued by the last call of gl_draw()
+        std::size_t num_drawn_elements() const { return num_drawn_elements_; }
+
         /// selection buffer (internally based on a shader storage buffer)
         /// @param index: the index of the binding point.
         /// NOTE: the buffers should also be bound to this point in all shader code
@@ -135,10 +282,16 @@ namespace easy3d {
         ///		 i.e., between glUseProgram(id) and glUseProgram(0);
         void gl_draw(bool with_storage_buffer = false) const;
 
+        /// Same as gl_draw(bool) but only the chunks visible from the \p camera are drawn (all the primitives are
+        /// drawn if the drawable has no chunks). Used by the draw() methods, while picking draws all the primitives.
+        void gl_draw(const Camera *camera, bool with_storage_buffer = false) const;
+
         /**
          * @brief Requests an update of the OpenGL buffers.
          * @details This function sets the status to trigger an update of the OpenGL buffers. The actual update does not
-         *          occur immediately but is deferred to the rendering phase.
+         *          occur immediately but is deferred to the rendering phase. If buffers::AsyncUpdater is enabled, the
+         *          buffers of a standard drawable are then prepared in a worker thread, and the previous buffers are
+         *          rendered until the new ones are uploaded.
          * @attention This method works for standard drawables (no update function required) and non-standard drawable
          *            (update function required). Standard drawables include:
          *              - SurfaceMesh: "faces", "edges", "vertices", "borders", "locks";
@@ -162,6 +315,17 @@ namespace easy3d {
 
         void clear();
 
+        // attaches the buffer shared by the drawables of the model to a generic vertex attribute.
+        // Returns false if the data cannot be shared.
+        bool share_buffer(unsigned int &buffer, bool &shared, unsigned int index, std::size_t dim,
+                          const void *array, const void *data, std::size_t size);
+        // releases a buffer: a shared buffer is given back to the renderer, the drawable's own one is deleted
+        void release_buffer(unsigned int &buffer, bool &shared);
+        // releases the interleaved buffer (if any), which the vertex, normal, and color buffers refer to
+        void release_quantized_buffer();
+        // gives the buffers a new version
+        void buffers_modified();
+
     protected:
         std::string name_;
         Model *model_;
@@ -174,6 +338,7 @@ namespace easy3d {
         std::size_t num_indices_;
 
         bool update_needed_;
+        bool update_pending_;   // the buffers are being updated asynchronously (see buffers::AsyncUpdater)
         std::function<void(Model*, Drawable*)> update_func_;
 
         unsigned int vertex_buffer_;
@@ -182,11 +347,38 @@ namespace easy3d {
         unsigned int texcoord_buffer_;
         unsigned int element_buffer_;
 
+        // is the buffer shared with the other drawables of the model?
+        bool shared_vertex_buffer_;
+        bool shared_color_buffer_;
+        bool shared_normal_buffer_;
+        bool shared_texcoord_buffer_;
+
+        VertexFormat vertex_format_;
+        // the vertex, normal, and color buffers refer to an interleaved buffer of quantized attributes
+        bool quantized_buffer_;
+        vec3 quantization_offset_;
+        vec3 quantization_scale_;
+        ivec3 quantization_tiles_;
+
+        std::size_t chunk_size_;
+        std::vector<buffers::Chunk> chunks_;
+        float small_feature_threshold_;
+        // the ranges of the visible chunks (reused by each draw)
+        mutable std::vector<int> draw_counts_;
+        mutable std::vector<const void *> draw_offsets_;
+        mutable std::size_t num_drawn_elements_;
+
         unsigned int storage_buffer_;
         std::size_t current_storage_buffer_size_;
 
         unsigned int selection_buffer_;  // used for selection.
         std::size_t current_selection_buffer_size_; // in case the object is modified
+
+        unsigned int buffers_version_;
+
+        // the render queue copies the buffers of the drawables into its batches
+        friend class RenderQueue;
+        friend class buffers::AsyncUpdater;
     };
 
 }
@@ -49,6 +49,9 @@ namespace easy3d {
     void LinesDrawable::draw(const Camera *camera, bool with_storage_buffer /* = false */) const {
         if (update_needed_ || vertex_buffer_ == 0)
             const_cast<LinesDrawable*>(this)->internal_update_buffers();
+        // nothing to draw until the first buffers are uploaded
+        if (vertex_buffer_ == 0 && update_pending_)
+            return;
 
         switch (impostor_type_) {
             case PLAIN:
@@ -101,7 +104,7 @@ namespace easy3d {
             if (setting::clipping_plane)
                 setting::clipping_plane->set_program(program);
 
-            gl_draw(with_storage_buffer);
+            gl_draw(camera, with_storage_buffer);
             program->release();
         } else {  // use geometry shader to be able to control the line width
             ShaderProgram *program = ShaderManager::get_program("lines/lines_plain_color_width_control");
@@ -129,7 +132,7 @@ namespace easy3d {
             if (setting::clipping_plane)
                 setting::clipping_plane->set_program(program);
 
-            gl_draw(with_storage_buffer);
+            gl_draw(camera, with_storage_buffer);
             program->release();
         }
     }
@@ -172,7 +175,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
     }
 
@@ -214,7 +217,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
     }
 
@@ -251,7 +254,7 @@ namespace easy3d {
                 setting::clipping_plane->set_program(program);
 
             program->bind_texture("textureID",texture()->id(), 0);
-            gl_draw(with_storage_buffer);
+            gl_draw(camera, with_storage_buffer);
             program->release_texture();
 
             program->release();
@@ -281,7 +284,7 @@ namespace easy3d {
                 setting::clipping_plane->set_program(program);
 
             program->bind_texture("textureID",texture()->id(), 0);
-            gl_draw(with_storage_buffer);
+            gl_draw(camera, with_storage_buffer);
             program->release_texture();
 
             program->release();
@@ -332,7 +335,7 @@ namespace easy3d {
             setting::clipping_plane->set_program(program);
 
         program->bind_texture("textureID",texture()->id(), 0);
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release_texture();
 
         program->release();
@@ -383,7 +386,7 @@ namespace easy3d {
 //                ->set_uniform("hightlight_id_min",highlight_range().first)
 //                ->set_uniform("hightlight_id_max",highlight_range().second);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release_texture();
 
         program->release();
@@ -36,6 +36,7 @@
 
 namespace easy3d {
 
+
     PointsDrawable::PointsDrawable(const std::string &name /*= ""*/, Model* model)
             : Drawable(name, model), point_size_(2.0f), impostor_type_(PLAIN) {
        set_uniform_coloring(vec4(0.0f, 1.0f, 0.0f, 1.0f));
@@ -50,6 +51,9 @@ namespace easy3d {
     void PointsDrawable::draw(const Camera *camera, bool with_storage_buffer /* = false */) const {
         if (update_needed_ || vertex_buffer_ == 0)
             const_cast<PointsDrawable*>(this)->internal_update_buffers();
+        // nothing to draw until the first buffers are uploaded
+        if (vertex_buffer_ == 0 && update_pending_)
+            return;
 
         switch (impostor_type_) {
             case PLAIN:
@@ -89,13 +93,15 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_plain_color");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_plain_color", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::COLOR, "vtx_color"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal"));
-            program = ShaderManager::create_program_from_files("points/points_plain_color", attributes);
+            program = ShaderManager::create_program_from_files("points/points_plain_color", attributes,
+                                                               std::vector<std::string>(), false, defines);
         }
 
         if (!program)
@@ -112,6 +118,7 @@ namespace easy3d {
         glPointSize(point_size());
 
         program->bind();
+        set_vertex_format_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("lighting", normal_buffer() && lighting())
                 ->set_uniform("two_sides_lighting",lighting_two_sides())
@@ -132,7 +139,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
     }
 
@@ -143,12 +150,14 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_spheres_sprite_color");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_spheres_sprite_color", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::COLOR, "vtx_color"));
-            program = ShaderManager::create_program_from_files("points/points_spheres_sprite_color", attributes);
+            program = ShaderManager::create_program_from_files("points/points_spheres_sprite_color", attributes,
+                                                               std::vector<std::string>(), false, defines);
         }
 
         if (!program)
@@ -158,6 +167,7 @@ namespace easy3d {
         glEnable(GL_VERTEX_PROGRAM_POINT_SIZE); // starting from GL3.2, using GL_PROGRAM_POINT_SIZE
 
         program->bind();
+        set_vertex_format_uniforms(program);
 
         program->set_uniform("perspective", camera->type() == Camera::PERSPECTIVE)
                 ->set_uniform("MV", camera->modelViewMatrix())
@@ -182,7 +192,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
 
         glDisable(GL_VERTEX_PROGRAM_POINT_SIZE); // starting from GL3.2, using GL_PROGRAM_POINT_SIZE
@@ -195,13 +205,14 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_spheres_geometry_color");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_spheres_geometry_color", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::COLOR, "vtx_color"));
             program = ShaderManager::create_program_from_files("points/points_spheres_geometry_color", attributes,
-                                                               std::vector<std::string>(), true);
+                                                               std::vector<std::string>(), true, defines);
         }
         if (!program)
             return;
@@ -209,6 +220,7 @@ namespace easy3d {
         easy3d_debug_log_gl_error;
 
         program->bind();
+        set_vertex_format_uniforms(program);
         program->set_uniform("perspective", camera->type() == Camera::PERSPECTIVE)
                 ->set_uniform("MV", camera->modelViewMatrix())
                 ->set_uniform("PROJ", camera->projectionMatrix());
@@ -231,7 +243,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
     }
 
@@ -246,13 +258,15 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_plain_texture");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_plain_texture", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::TEXCOORD, "vtx_texcoord"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal"));
-            program = ShaderManager::create_program_from_files("points/points_plain_texture", attributes);
+            program = ShaderManager::create_program_from_files("points/points_plain_texture", attributes,
+                                                               std::vector<std::string>(), false, defines);
         }
 
         if (!program)
@@ -269,6 +283,7 @@ namespace easy3d {
         glPointSize(point_size());
 
         program->bind();
+        set_vertex_format_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("lighting", normal_buffer() && lighting())
                 ->set_uniform("two_sides_lighting",lighting_two_sides())
@@ -288,7 +303,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release_texture();
 
         program->release();
@@ -318,13 +333,14 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_spheres_geometry_texture");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_spheres_geometry_texture", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::TEXCOORD, "vtx_texcoord"));
             program = ShaderManager::create_program_from_files("points/points_spheres_geometry_texture", attributes,
-                                                               std::vector<std::string>(), true);
+                                                               std::vector<std::string>(), true, defines);
         }
         if (!program)
             return;
@@ -332,6 +348,7 @@ namespace easy3d {
         easy3d_debug_log_gl_error;
 
         program->bind();
+        set_vertex_format_uniforms(program);
         program->set_uniform("perspective", camera->type() == Camera::PERSPECTIVE)
                 ->set_uniform("MV", camera->modelViewMatrix())
                 ->set_uniform("PROJ", camera->projectionMatrix());
@@ -353,7 +370,7 @@ namespace easy3d {
             setting::clipping_plane->set_program(program);
 
         program->bind_texture("textureID",texture()->id(), 0);
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release_texture();
 
         program->release();
@@ -370,14 +387,15 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_surfel_color");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_surfel_color", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::COLOR, "vtx_color"));
             program = ShaderManager::create_program_from_files("points/points_surfel_color", attributes,
-                                                               std::vector<std::string>(), true);
+                                                               std::vector<std::string>(), true, defines);
         }
         if (!program)
             return;
@@ -390,6 +408,7 @@ namespace easy3d {
         const vec4 &wLightPos = inverse(camera->modelViewMatrix()) * setting::light_position;
 
         program->bind();
+        set_vertex_format_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("per_vertex_color",coloring_method() != State::UNIFORM_COLOR && color_buffer())
                 ->set_uniform("default_color",color());
@@ -414,7 +433,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
     }
 
@@ -433,14 +452,15 @@ namespace easy3d {
             return;
         }
 
-        ShaderProgram *program = ShaderManager::get_program("points/points_surfel_texture");
+        const std::vector<std::string> defines = vertex_format_defines();
+        ShaderProgram *program = ShaderManager::get_program("points/points_surfel_texture", defines);
         if (!program) {
             std::vector<ShaderProgram::Attribute> attributes;
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal"));
             attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::TEXCOORD, "vtx_texcoord"));
             program = ShaderManager::create_program_from_files("points/points_surfel_texture", attributes,
-                                                               std::vector<std::string>(), true);
+                                                               std::vector<std::string>(), true, defines);
         }
         if (!program)
             return;
@@ -453,6 +473,7 @@ namespace easy3d {
         const vec4 &wLightPos = inverse(camera->modelViewMatrix()) * setting::light_position;
 
         program->bind();
+        set_vertex_format_uniforms(program);
         program->set_uniform("MVP", MVP);
 
         float ratio = camera->pixelGLRatio(camera->pivotPoint());
@@ -472,7 +493,7 @@ namespace easy3d {
             setting::clipping_plane->set_program(program);
 
         program->bind_texture("textureID",texture()->id(), 0);
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release_texture();
 
         program->release();
@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include <easy3d/renderer/drawable_points_lod.h>
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/renderer/buffers_quantization.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // uploads the points of a node into the buffers of its drawable
+        void upload(PointsDrawable *drawable, const PointCloudLod::Points &points, Drawable::VertexFormat format) {
+            if (format == Drawable::VF_QUANTIZED) {
+                buffers::BufferData data;
+                data.points.refer(points.points);
+                if (!points.normals.empty())
+                    data.normals.refer(points.normals);
+                if (!points.colors.empty())
+                    data.colors.refer(points.colors);
+                buffers::QuantizedVertices vertices;
+                if (buffers::quantize(data, vertices)) {
+                    drawable->update_quantized_buffer(vertices);
+                    return;
+                }
+            }
+
+            drawable->update_vertex_buffer(points.points);
+            if (!points.normals.empty())
+                drawable->update_normal_buffer(points.normals);
+            if (!points.colors.empty())
+                drawable->update_color_buffer(points.colors);
+        }
+
+    }
+
+
+    PointsLodDrawable::PointsLodDrawable(const std::string &name)
+            : PointsDrawable(name), loader_(nullptr), point_budget_(5000000), gpu_budget_(10000000),
+              max_screen_error_(1.0f), num_resident_points_(0), frame_(0) {
+    }
+
+
+    PointsLodDrawable::~PointsLodDrawable() {
+        delete loader_;
+        release_nodes();
+    }
+
+
+    bool PointsLodDrawable::open(const std::string &file_name) {
+        delete loader_;
+        loader_ = nullptr;
+        release_nodes();
+        selected_.clear();
+
+        if (!lod_.open(file_name))
+            return false;
+
+        loader_ = new PointCloudLodLoader(&lod_);
+        bbox_ = lod_.bounding_box();
+        if (lod_.has_colors())
+            set_property_coloring(State::VERTEX, "v:color");
+        update_needed_ = false;
+        return true;
+    }
+
+
+    std::size_t PointsLodDrawable::num_pending_nodes() const {
+        std::size_t num = 0;
+        for (auto node : selected_) {
+            if (resident_.find(node) == resident_.end())
+                ++num;
+        }
+        return num;
+    }
+
+
+    void PointsLodDrawable::release_nodes() {
+        for (auto &entry : resident_)
+            delete entry.second.drawable;
+        resident_.clear();
+        num_resident_points_ = 0;
+    }
+
+
+    void PointsLodDrawable::update(const Camera *camera) {
+        if (!lod_.is_open())
+            return;
+
+        ++frame_;
+
+        // the vertex format has changed or an update was requested: all the nodes are uploaded again
+        if (update_needed_) {
+            release_nodes();
+            update_needed_ = false;
+        }
+
+        selected_ = lod_.select(camera, point_budget_, max_screen_error_);
+
+        // the nodes loaded since the last frame
+        std::vector<std::pair<int, PointCloudLod::Points> > loaded;
+        loader_->fetch(loaded);
+        for (const auto &entry : loaded) {
+            if (resident_.find(entry.first) != resident_.end())
+                continue;
+            PointsDrawable *drawable = new PointsDrawable(name() + "_node_" + std::to_string(entry.first));
+            details::upload(drawable, entry.second, vertex_format());
+            resident_[entry.first] = {drawable, frame_};
+            num_resident_points_ += entry.second.points.size();
+        }
+
+        std::vector<int> missing;
+        for (auto node : selected_) {
+            auto pos = resident_.find(node);
+            if (pos == resident_.end())
+                missing.push_back(node);
+            else
+                pos->second.last_used = frame_;
+        }
+        loader_->request(missing);
+
+        // releases the least recently used nodes (never the selected ones) until the GPU budget is met
+        if (num_resident_points_ > gpu_budget_) {
+            std::vector<std::pair<std::size_t, int> > unused;
+            for (const auto &entry : resident_) {
+                if (entry.second.last_used < frame_)
+                    unused.emplace_back(entry.second.last_used, entry.first);
+            }
+            std::sort(unused.begin(), unused.end());
+            for (std::size_t i = 0; i < unused.size() && num_resident_points_ > gpu_budget_; ++i) {
+                auto pos = resident_.find(unused[i].second);
+                num_resident_points_ -= lod_.nodes()[pos->first].size;
+                delete pos->second.drawable;
+                resident_.erase(pos);
+            }
+        }
+    }
+
+
+    void PointsLodDrawable::draw(const Camera *camera, bool with_storage_buffer /* = false */) const {
+        if (!lod_.is_open())
+            return;
+
+        for (auto node : selected_) {
+            auto pos = resident_.find(node);
+            if (pos == resident_.end())
+                continue;
+            PointsDrawable *drawable = pos->second.drawable;
+            drawable->set_state(state());
+            drawable->set_point_size(point_size());
+            drawable->set_impostor_type(impostor_type());
+            drawable->draw(camera, with_storage_buffer);
+        }
+    }
+
+}
@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_DRAWABLE_POINTS_LOD_H
+#define EASY3D_RENDERER_DRAWABLE_POINTS_LOD_H
+
+#include <unordered_map>
+
+#include <easy3d/renderer/drawable_points.h>
+#include <easy3d/renderer/point_cloud_lod.h>
+
+
+namespace easy3d {
+
+
+    /**
+     * @brief The drawable for rendering a point cloud stored in an octree file (see PointCloudLod), which can be much
+     *      larger than the GPU memory.
+     * @details Once per frame, update() selects the nodes to be rendered w.r.t. the camera and the point budget,
+     *      requests the missing ones from a background loader, and uploads the nodes loaded since the last frame (each
+     *      one into its own buffers, quantized if the vertex format is VF_QUANTIZED). draw() only renders the
+     *      selected nodes, so the drawable can be drawn in several passes of a frame. The nodes are rendered as
+     *      soon as they are available, so a view is refined progressively while the camera is still. The nodes no
+     *      longer selected remain in the GPU memory (for moving back) until the GPU budget is exceeded, in which case
+     *      the least recently used ones are released.
+     *      The drawable is stand-alone: it is not attached to a model and it can be added to the viewer using
+     *      Viewer::add_drawable(), which calls update() before drawing each frame. The uniform color, the per-vertex
+     *      colors stored in the file ("v:color"), the lighting, the point size, and the impostor type apply to all
+     *      the nodes.
+     */
+    class PointsLodDrawable : public PointsDrawable {
+    public:
+        PointsLodDrawable(const std::string &name = "");
+        ~PointsLodDrawable();
+
+        /// opens an octree file written by PointCloudLod::build()
+        bool open(const std::string &file_name);
+        const PointCloudLod &lod() const { return lod_; }
+
+        /// the maximum number of points rendered per frame (default: 5 million)
+        std::size_t point_budget() const { return point_budget_; }
+        void set_point_budget(std::size_t n) { point_budget_ = n; }
+
+        /// the maximum number of points kept in the GPU memory (default: twice the point budget)
+        std::size_t gpu_budget() const { return gpu_budget_; }
+        void set_gpu_budget(std::size_t n) { gpu_budget_ = n; }
+
+        /// the screen-space error (in pixels) below which a node is not refined (default: 1.0)
+        float max_screen_error() const { return max_screen_error_; }
+        void set_max_screen_error(float e) { max_screen_error_ = e; }
+
+        /// the nodes selected for the last frame
+        const std::vector<int> &selected_nodes() const { return selected_; }
+        /// the number of points in the GPU memory
+        std::size_t num_resident_points() const { return num_resident_points_; }
+        /// the number of selected nodes that are not in the GPU memory yet
+        std::size_t num_pending_nodes() const;
+
+        /**
+         * @brief Prepares a frame: selects the nodes for the camera, requests the missing ones, uploads the nodes
+         *      loaded since the last call, and releases the ones exceeding the GPU budget.
+         * @details This must be called once per frame (before drawing), and it requires the rendering context.
+         */
+        void update(const Camera *camera);
+        using Drawable::update;
+
+        /// renders the selected nodes that are in the GPU memory
+        void draw(const Camera *camera, bool with_storage_buffer = false) const override;
+
+    private:
+        void release_nodes();
+
+    private:
+        PointCloudLod lod_;
+        PointCloudLodLoader *loader_;
+
+        std::size_t point_budget_;
+        std::size_t gpu_budget_;
+        float max_screen_error_;
+
+        struct Resident {
+            PointsDrawable *drawable;
+            std::size_t last_used;  // the last frame in which the node was selected
+        };
+        std::unordered_map<int, Resident> resident_;
+        std::size_t num_resident_points_;
+
+        std::vector<int> selected_;
+        std::size_t frame_;
+    };
+
+}
+
+
+#endif  // EASY3D_RENDERER_DRAWABLE_POINTS_LOD_H
@@ -51,6 +51,9 @@ namespace easy3d {
     void TrianglesDrawable::draw(const Camera *camera, bool with_storage_buffer /* = false */) const {
         if (update_needed_ || vertex_buffer_ == 0)
             const_cast<TrianglesDrawable*>(this)->internal_update_buffers();
+        // nothing to draw until the first buffers are uploaded
+        if (vertex_buffer_ == 0 && update_pending_)
+            return;
 
         if (texture() && (coloring_method() == State::SCALAR_FIELD || coloring_method() == State::TEXTURED))
             _draw_triangles_with_texture(camera, with_storage_buffer);
@@ -107,7 +110,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
         program->release();
     }
 
@@ -164,7 +167,7 @@ namespace easy3d {
         if (setting::clipping_plane)
             setting::clipping_plane->set_program(program);
 
-        gl_draw(with_storage_buffer);
+        gl_draw(camera, with_storage_buffer);
 
         program->release_texture();
         program->release();
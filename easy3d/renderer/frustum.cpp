@@ -24,12 +24,14 @@
 
 #include <easy3d/renderer/frustum.h>
 #include <easy3d/renderer/transform.h>
+#include <easy3d/renderer/camera.h>
 
 
 namespace easy3d {
 
     Frustum::Frustum(ProjectionType type)
-        : type_(type)
+        : type_(type), near_(0.5f), far_(100.0f), xmin_(-1.0f), xmax_(1.0f), ymin_(-1.0f), ymax_(1.0f),
+          fovy_(float(M_PI / 4.0f)), ar_(1.0f)
     {
         orient(vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
         if (type == ORTHO)
@@ -39,11 +41,28 @@ namespace easy3d {
     }
 
 
+    Frustum::Frustum(const Camera* camera)
+        : type_(camera->type() == Camera::PERSPECTIVE ? PERSPECTIVE : ORTHO), near_(0.5f), far_(100.0f),
+          xmin_(-1.0f), xmax_(1.0f), ymin_(-1.0f), ymax_(1.0f), fovy_(float(M_PI / 4.0f)), ar_(1.0f)
+    {
+        const vec3 pos = camera->position();
+        orient(pos, pos + camera->viewDirection(), camera->upVector());
+        if (type_ == ORTHO) {
+            float half_width = 0.0f, half_height = 0.0f;
+            camera->getOrthoWidthHeight(half_width, half_height);
+            set_ortho(-half_width, half_width, -half_height, half_height, camera->zNear(), camera->zFar());
+        }
+        else
+            set_perspective(camera->fieldOfView(), camera->aspectRatio(), camera->zNear(), camera->zFar());
+    }
+
+
     void Frustum::orient(const vec3 &pos, const vec3& at, const vec3& up)
     {
         pos_ = pos;
         at_ = at;
         up_ = up;
+        update_planes();
     }
 
 
@@ -55,6 +74,7 @@ namespace easy3d {
         ymax_ = ymax;
         near_ = znear;
         far_ = zfar;
+        update_planes();
     }
 
 
@@ -72,6 +92,7 @@ namespace easy3d {
         ymin_ = -ymax_;
         xmin_ = ymin_ * aspect;
         xmax_ = ymax_ * aspect;
+        update_planes();
     }
 
 
@@ -86,6 +107,7 @@ namespace easy3d {
         xmax_ = ymax_ * ar_;
         near_ = znear;
         far_ = zfar;
+        update_planes();
     }
 
 
@@ -231,4 +253,46 @@ namespace easy3d {
         return points;
     }
 
+
+    void Frustum::update_planes() {
+        // a point p is inside if -w <= x, y, z <= w in clip space, i.e., (row3 +/- row_i) * (p, 1) >= 0
+        const mat4 m = projection_matrix() * view_matrix();
+        const vec4 r0 = m.row(0), r1 = m.row(1), r2 = m.row(2), r3 = m.row(3);
+        planes_[0] = r3 + r0;
+        planes_[1] = r3 - r0;
+        planes_[2] = r3 + r1;
+        planes_[3] = r3 - r1;
+        planes_[4] = r3 + r2;
+        planes_[5] = r3 - r2;
+        for (auto& plane : planes_) {
+            const float len = length(vec3(plane.x, plane.y, plane.z));
+            if (len > 0.0f)
+                plane /= len;
+        }
+    }
+
+
+    bool Frustum::contains(const vec3& p) const {
+        for (const auto& plane : planes_) {
+            if (plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+
+    bool Frustum::intersects(const Box3& box) const {
+        const vec3& bmin = box.min();
+        const vec3& bmax = box.max();
+        for (const auto& plane : planes_) {
+            // the corner of the box the farthest along the plane normal
+            const float x = plane.x >= 0.0f ? bmax.x : bmin.x;
+            const float y = plane.y >= 0.0f ? bmax.y : bmin.y;
+            const float z = plane.z >= 0.0f ? bmax.z : bmin.z;
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
 }
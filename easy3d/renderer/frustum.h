@@ -33,6 +33,8 @@
 
 namespace easy3d {
 
+    class Camera;
+
     class Frustum
     {
     public:
@@ -41,6 +43,9 @@ namespace easy3d {
     public:
         Frustum(ProjectionType type);
 
+        // the viewing volume of a camera (its position, orientation, field of view, and near/far planes)
+        explicit Frustum(const Camera* camera);
+
         // To define a working frustum, you need to call two functions:
         //   - orient(), defining the view matrix.
         //   - set_perspective()/set_frustum(), or set_ortho(), defining the projection matrix.
@@ -77,6 +82,20 @@ namespace easy3d {
         // compute the compute the 8 corner points in world space
         std::vector<vec3> vertices() const;
 
+        // ------------------------------- culling -------------------------------
+        // The tests use the six planes of the frustum (in world space), which are updated whenever the frustum is
+        // changed. They are conservative: a box close to a corner of the frustum may be reported as intersecting
+        // it although it is outside, but a box reported outside is definitely outside.
+
+        // is the point inside the frustum?
+        bool contains(const vec3& p) const;
+        // does the axis-aligned box intersect the frustum (or lie inside it)?
+        bool intersects(const Box3& box) const;
+
+    private:
+        // extracts the planes from the view-projection matrix
+        void update_planes();
+
     private:
         ProjectionType type_;
 
@@ -87,6 +106,9 @@ namespace easy3d {
         float near_, far_;
         float xmin_, xmax_, ymin_, ymax_;
         float fovy_, ar_;
+
+        // the planes (left, right, bottom, top, near, far) as (normal, offset), with the normals pointing inwards
+        vec4 planes_[6];
     };
 
 }
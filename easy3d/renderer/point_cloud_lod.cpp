@@ -0,0 +1,518 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include <easy3d/renderer/point_cloud_lod.h>
+#include <easy3d/renderer/camera.h>
+#include <easy3d/renderer/frustum.h>
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/util/logging.h>
+
+#include <fstream>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // the file starts with this signature (the last two characters are the version of the format)
+        const char lod_magic[8] = {'E', '3', 'D', 'L', 'O', 'D', '0', '1'};
+
+        // the maximum depth of the octree, which bounds the recursion for (nearly) duplicated points
+        const int lod_max_depth = 24;
+
+        template<typename T>
+        inline void write(std::ostream &output, const T &value) {
+            output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        inline bool read(std::istream &input, T &value) {
+            input.read(reinterpret_cast<char *>(&value), sizeof(T));
+            return input.good();
+        }
+
+        template<typename T>
+        inline void write_array(std::ostream &output, const std::vector<T> &values) {
+            output.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+        }
+
+        template<typename T>
+        inline bool read_array(std::istream &input, std::vector<T> &values, std::size_t size) {
+            values.resize(size);
+            input.read(reinterpret_cast<char *>(values.data()), size * sizeof(T));
+            return input.good();
+        }
+
+
+        // the cube of the k-th octant of a cube
+        inline Box3 octant(const Box3 &cube, int k) {
+            const vec3 c = cube.center();
+            vec3 bmin = cube.min(), bmax = cube.max();
+            for (int d = 0; d < 3; ++d) {
+                if (k & (1 << d))
+                    bmin[d] = c[d];
+                else
+                    bmax[d] = c[d];
+            }
+            return Box3(bmin, bmax);
+        }
+
+
+        // Subsamples the candidate points of a node: the point closest to the center of each cell of the node's grid
+        // is kept by the node, the others are distributed to the octants (i.e., the candidates of the children).
+        void subsample(const std::vector<vec3> &points, const std::vector<int> &candidates,
+                       const PointCloudLod::Node &node, int resolution, std::vector<int> &kept,
+                       std::vector<int> *octants) {
+            const vec3 &bmin = node.box.min();
+            const vec3 center = node.box.center();
+            const float cell = node.spacing;
+
+            std::unordered_map<uint64_t, int> best;  // the closest point of each cell
+            best.reserve(std::min(candidates.size(), std::size_t(1) << 22));
+            for (auto idx : candidates) {
+                const vec3 &p = points[idx];
+                uint64_t key = 0;
+                vec3 cell_center;
+                for (int d = 0; d < 3; ++d) {
+                    const int i = std::min(std::max(static_cast<int>((p[d] - bmin[d]) / cell), 0), resolution - 1);
+                    key = key * static_cast<uint64_t>(resolution) + static_cast<uint64_t>(i);
+                    cell_center[d] = bmin[d] + (i + 0.5f) * cell;
+                }
+                auto pos = best.find(key);
+                if (pos == best.end())
+                    best.emplace(key, idx);
+                else if (distance2(p, cell_center) < distance2(points[pos->second], cell_center))
+                    pos->second = idx;
+            }
+
+            kept.reserve(best.size());
+            for (const auto &entry : best)
+                kept.push_back(entry.second);
+            std::sort(kept.begin(), kept.end());
+
+            for (auto idx : candidates) {
+                if (std::binary_search(kept.begin(), kept.end(), idx))
+                    continue;
+                const vec3 &p = points[idx];
+                const int k = (p.x >= center.x ? 1 : 0) | (p.y >= center.y ? 2 : 0) | (p.z >= center.z ? 4 : 0);
+                octants[k].push_back(idx);
+            }
+        }
+
+    }
+
+
+    PointCloudLod::PointCloudLod()
+            : num_points_(0), has_normals_(false), has_colors_(false), data_offset_(0) {
+    }
+
+
+    bool PointCloudLod::build(const PointCloud *cloud, const std::string &file_name, std::size_t max_node_points,
+                              int grid_resolution) {
+        if (!cloud || cloud->n_vertices() == 0) {
+            LOG(ERROR) << "empty point cloud";
+            return false;
+        }
+        if (max_node_points == 0 || grid_resolution < 1) {
+            LOG(ERROR) << "invalid parameters: max_node_points = " << max_node_points << ", grid_resolution = "
+                       << grid_resolution;
+            return false;
+        }
+
+        const std::vector<vec3> &points = cloud->points();
+        auto normals = cloud->get_vertex_property<vec3>("v:normal");
+        auto colors = cloud->get_vertex_property<vec3>("v:color");
+
+        std::vector<int> all;
+        all.reserve(cloud->n_vertices());
+        Box3 bbox;
+        for (auto v : cloud->vertices()) {
+            all.push_back(v.idx());
+            bbox.add_point(points[v.idx()]);
+        }
+
+        // the root is the cube containing the bounding box (slightly enlarged to keep the points off its faces)
+        float half = 0.5f * std::max(bbox.range(0), std::max(bbox.range(1), bbox.range(2)));
+        half = std::max(half * 1.001f, 1e-6f * std::max(1.0f, length(bbox.center())));
+        const vec3 c = bbox.center();
+
+        std::vector<Node> nodes(1);
+        nodes[0].box = Box3(c - vec3(half, half, half), c + vec3(half, half, half));
+        nodes[0].spacing = 2.0f * half / grid_resolution;
+        nodes[0].depth = 0;
+        nodes[0].parent = -1;
+        std::fill(nodes[0].children, nodes[0].children + 8, -1);
+
+        // the points kept by each node and the points to be distributed in its subtree
+        std::vector<std::vector<int> > kept(1), candidates(1);
+        candidates[0].swap(all);
+
+        // the octree is built level by level, the nodes of the same level in parallel
+        std::vector<int> level(1, 0);
+        while (!level.empty()) {
+            const int num = static_cast<int>(level.size());
+            std::vector<std::vector<int> > octants(num * 8);
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < num; ++i) {
+                const int id = level[i];
+                if (candidates[id].size() <= max_node_points || nodes[id].depth >= details::lod_max_depth)
+                    kept[id].swap(candidates[id]);
+                else {
+                    details::subsample(points, candidates[id], nodes[id], grid_resolution, kept[id], &octants[i * 8]);
+                    std::vector<int>().swap(candidates[id]);
+                }
+            }
+
+            std::vector<int> next;
+            for (int i = 0; i < num; ++i) {
+                const int id = level[i];
+                for (int k = 0; k < 8; ++k) {
+                    if (octants[i * 8 + k].empty())
+                        continue;
+                    Node child;
+                    child.box = details::octant(nodes[id].box, k);
+                    child.spacing = nodes[id].spacing * 0.5f;
+                    child.depth = nodes[id].depth + 1;
+                    child.parent = id;
+                    std::fill(child.children, child.children + 8, -1);
+                    nodes[id].children[k] = static_cast<int>(nodes.size());
+                    next.push_back(static_cast<int>(nodes.size()));
+                    nodes.push_back(child);
+                    kept.emplace_back();
+                    candidates.emplace_back();
+                    candidates.back().swap(octants[i * 8 + k]);
+                }
+            }
+            level.swap(next);
+        }
+
+        uint64_t offset = 0;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].offset = offset;
+            nodes[i].size = static_cast<uint32_t>(kept[i].size());
+            offset += nodes[i].size;
+        }
+
+        std::ofstream output(file_name.c_str(), std::ios::binary);
+        if (output.fail()) {
+            LOG(ERROR) << "could not open file: " << file_name;
+            return false;
+        }
+
+        const uint32_t flags = (normals ? 1u : 0u) | (colors ? 2u : 0u);
+        output.write(details::lod_magic, sizeof(details::lod_magic));
+        details::write(output, flags);
+        details::write(output, static_cast<uint32_t>(nodes.size()));
+        details::write(output, static_cast<uint64_t>(offset));
+        details::write(output, bbox.min());
+        details::write(output, bbox.max());
+        for (const auto &node : nodes) {
+            details::write(output, node.box.min());
+            details::write(output, node.box.max());
+            details::write(output, node.spacing);
+            details::write(output, static_cast<int32_t>(node.depth));
+            details::write(output, static_cast<int32_t>(node.parent));
+            for (int k = 0; k < 8; ++k)
+                details::write(output, static_cast<int32_t>(node.children[k]));
+            details::write(output, node.offset);
+            details::write(output, node.size);
+        }
+
+        // the points of each node: positions, normals (if any), colors (if any)
+        std::vector<vec3> values;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const std::vector<int> &indices = kept[i];
+            values.resize(indices.size());
+            for (std::size_t j = 0; j < indices.size(); ++j)
+                values[j] = points[indices[j]];
+            details::write_array(output, values);
+            if (normals) {
+                for (std::size_t j = 0; j < indices.size(); ++j)
+                    values[j] = normals.vector()[indices[j]];
+                details::write_array(output, values);
+            }
+            if (colors) {
+                for (std::size_t j = 0; j < indices.size(); ++j)
+                    values[j] = colors.vector()[indices[j]];
+                details::write_array(output, values);
+            }
+        }
+
+        if (output.fail()) {
+            LOG(ERROR) << "failed writing file: " << file_name;
+            return false;
+        }
+        return true;
+    }
+
+
+    bool PointCloudLod::open(const std::string &file_name) {
+        nodes_.clear();
+        num_points_ = 0;
+
+        std::ifstream input(file_name.c_str(), std::ios::binary);
+        if (input.fail()) {
+            LOG(ERROR) << "could not open file: " << file_name;
+            return false;
+        }
+
+        char magic[8];
+        input.read(magic, sizeof(magic));
+        if (!input.good() || !std::equal(magic, magic + 8, details::lod_magic)) {
+            LOG(ERROR) << "not an octree file (or an unsupported version): " << file_name;
+            return false;
+        }
+
+        uint32_t flags = 0, num_nodes = 0;
+        uint64_t num_points = 0;
+        vec3 bmin, bmax;
+        if (!details::read(input, flags) || !details::read(input, num_nodes) || !details::read(input, num_points) ||
+            !details::read(input, bmin) || !details::read(input, bmax) || num_nodes == 0) {
+            LOG(ERROR) << "failed reading the header of file: " << file_name;
+            return false;
+        }
+
+        std::vector<Node> nodes(num_nodes);
+        for (auto &node : nodes) {
+            vec3 nmin, nmax;
+            int32_t depth = 0, parent = 0, children[8];
+            bool success = details::read(input, nmin) && details::read(input, nmax) &&
+                           details::read(input, node.spacing) && details::read(input, depth) &&
+                           details::read(input, parent);
+            for (int k = 0; k < 8; ++k)
+                success = success && details::read(input, children[k]);
+            success = success && details::read(input, node.offset) && details::read(input, node.size);
+            if (!success) {
+                LOG(ERROR) << "failed reading the nodes of file: " << file_name;
+                return false;
+            }
+            node.box = Box3(nmin, nmax);
+            node.depth = depth;
+            node.parent = parent;
+            for (int k = 0; k < 8; ++k) {
+                if (children[k] >= static_cast<int32_t>(num_nodes)) {
+                    LOG(ERROR) << "corrupted octree file: " << file_name;
+                    return false;
+                }
+                node.children[k] = children[k];
+            }
+            if (node.offset + node.size > num_points) {
+                LOG(ERROR) << "corrupted octree file: " << file_name;
+                return false;
+            }
+        }
+
+        file_name_ = file_name;
+        nodes_.swap(nodes);
+        num_points_ = num_points;
+        bbox_ = Box3(bmin, bmax);
+        has_normals_ = (flags & 1u) != 0;
+        has_colors_ = (flags & 2u) != 0;
+        data_offset_ = static_cast<uint64_t>(input.tellg());
+        return true;
+    }
+
+
+    bool PointCloudLod::load(int node, Points &points) const {
+        if (node < 0 || node >= static_cast<int>(nodes_.size())) {
+            LOG(ERROR) << "node " << node << " does not exist";
+            return false;
+        }
+
+        // each call has its own stream, so nodes can be loaded concurrently
+        std::ifstream input(file_name_.c_str(), std::ios::binary);
+        if (input.fail()) {
+            LOG(ERROR) << "could not open file: " << file_name_;
+            return false;
+        }
+
+        const Node &n = nodes_[node];
+        const uint64_t bytes_per_point = sizeof(vec3) * (1 + (has_normals_ ? 1 : 0) + (has_colors_ ? 1 : 0));
+        input.seekg(static_cast<std::streamoff>(data_offset_ + n.offset * bytes_per_point));
+
+        bool success = details::read_array(input, points.points, n.size);
+        if (has_normals_)
+            success = success && details::read_array(input, points.normals, n.size);
+        else
+            points.normals.clear();
+        if (has_colors_)
+            success = success && details::read_array(input, points.colors, n.size);
+        else
+            points.colors.clear();
+
+        LOG_IF(ERROR, !success) << "failed reading node " << node << " from file: " << file_name_;
+        return success;
+    }
+
+
+    std::vector<int> PointCloudLod::select(const Camera *camera, std::size_t point_budget,
+                                           float max_screen_error) const {
+        std::vector<int> selected;
+        if (nodes_.empty() || !camera)
+            return selected;
+
+        const Frustum frustum(camera);
+        const vec3 position = camera->position();
+        const bool perspective = (camera->type() == Camera::PERSPECTIVE);
+        // the number of pixels per unit length at unit distance (perspective) or anywhere (orthographic)
+        float pixels_per_unit = 0.0f;
+        if (perspective)
+            pixels_per_unit = camera->screenHeight() / (2.0f * std::tan(camera->fieldOfView() * 0.5f));
+        else {
+            float half_width = 0.0f, half_height = 0.0f;
+            camera->getOrthoWidthHeight(half_width, half_height);
+            pixels_per_unit = camera->screenHeight() / (2.0f * half_height);
+        }
+
+        // the projected spacing of a node, using the distance to its bounding sphere (i.e., the closest its points
+        // can be to the camera)
+        auto screen_error = [&](const Node &node) -> float {
+            if (!perspective)
+                return node.spacing * pixels_per_unit;
+            const float radius = node.box.radius();
+            const float distance = std::max(length(node.box.center() - position) - radius, 1e-6f * radius);
+            return node.spacing * pixels_per_unit / distance;
+        };
+
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry> queue;
+        if (frustum.intersects(nodes_[0].box))
+            queue.push(Entry(screen_error(nodes_[0]), 0));
+
+        std::size_t num = 0;
+        while (!queue.empty()) {
+            const Entry top = queue.top();
+            queue.pop();
+            const Node &node = nodes_[top.second];
+            if (num + node.size > point_budget)
+                break;
+            selected.push_back(top.second);
+            num += node.size;
+
+            if (top.first <= max_screen_error)
+                continue;
+            for (int k = 0; k < 8; ++k) {
+                const int child = node.children[k];
+                if (child >= 0 && frustum.intersects(nodes_[child].box))
+                    queue.push(Entry(screen_error(nodes_[child]), child));
+            }
+        }
+        return selected;
+    }
+
+
+    // ---------------------------------------------------------------------------------------------------------------
+
+
+    PointCloudLodLoader::PointCloudLodLoader(const PointCloudLod *lod)
+            : lod_(lod), loading_(-1), stop_(false) {
+        worker_ = std::thread(&PointCloudLodLoader::run, this);
+    }
+
+
+    PointCloudLodLoader::~PointCloudLodLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        worker_.join();
+    }
+
+
+    void PointCloudLodLoader::request(const std::vector<int> &nodes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.clear();
+            for (auto node : nodes) {
+                if (node == loading_ || std::find(queue_.begin(), queue_.end(), node) != queue_.end())
+                    continue;
+                bool loaded = false;
+                for (const auto &entry : loaded_) {
+                    if (entry.first == node) {
+                        loaded = true;
+                        break;
+                    }
+                }
+                if (!loaded)
+                    queue_.push_back(node);
+            }
+        }
+        wake_.notify_one();
+    }
+
+
+    void PointCloudLodLoader::fetch(std::vector<std::pair<int, PointCloudLod::Points> > &loaded) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loaded.clear();
+        loaded.swap(loaded_);
+    }
+
+
+    std::size_t PointCloudLodLoader::num_pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size() + (loading_ >= 0 ? 1 : 0);
+    }
+
+
+    void PointCloudLodLoader::wait() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this]() { return queue_.empty() && loading_ < 0; });
+    }
+
+
+    void PointCloudLodLoader::run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (stop_)
+                break;
+
+            const int node = queue_.front();
+            queue_.pop_front();
+            loading_ = node;
+
+            // the file is read without holding the lock, so requests are not blocked
+            lock.unlock();
+            PointCloudLod::Points points;
+            const bool success = lod_->load(node, points);
+            lock.lock();
+
+            if (success)
+                loaded_.emplace_back(node, std::move(points));
+            loading_ = -1;
+            if (queue_.empty())
+                idle_.notify_all();
+        }
+    }
+
+}
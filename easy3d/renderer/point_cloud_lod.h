@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_POINT_CLOUD_LOD_H
+#define EASY3D_RENDERER_POINT_CLOUD_LOD_H
+
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    class Camera;
+    class PointCloud;
+
+
+    /**
+     * @brief A multi-resolution octree of a point cloud stored in a file, for viewing point clouds that do not fit into
+     *      the GPU (or even the CPU) memory.
+     * @details Each node of the octree stores a subset of the points (similar to Potree): the root stores a coarse
+     *      subsample of the whole cloud, i.e., at most one point per cell of a grid covering its cube, each child stores
+     *      a subsample (at twice the resolution) of the remaining points in its octant, and so on, until a node has few
+     *      enough points to store them all. A node thus only adds detail to its ancestors, and a view of the cloud is
+     *      given by a subtree selected w.r.t. the screen-space error of the nodes and a point budget (see select()).
+     *      The hierarchy is small and it is read at once by open(). The points of a node are read on demand by load(),
+     *      typically in the background by a PointCloudLodLoader.
+     *      This class does not make any OpenGL calls. See PointsLodDrawable for rendering.
+     */
+    class PointCloudLod {
+    public:
+        struct Node {
+            Box3 box;           // the cube of the node
+            float spacing;      // the size of a cell of the node's grid, i.e., the distance between its points
+            int depth;
+            int parent;         // -1 for the root
+            int children[8];    // -1 if the octant has no points
+            uint64_t offset;    // the index of the first point of the node in the file
+            uint32_t size;      // the number of points of the node
+        };
+
+        // the points of a node
+        struct Points {
+            std::vector<vec3> points;
+            std::vector<vec3> normals;  // empty if the file has no normals
+            std::vector<vec3> colors;   // empty if the file has no colors
+        };
+
+    public:
+        PointCloudLod();
+
+        /**
+         * @brief Builds the octree of a point cloud and writes it into a file.
+         * @details The vertex normals ("v:normal") and colors ("v:color") are also stored if the point cloud has them.
+         *      The nodes of the same level are built in parallel.
+         * @param cloud The point cloud.
+         * @param file_name The name of the octree file.
+         * @param max_node_points The maximum number of points of a leaf node. Larger nodes are subsampled and split.
+         * @param grid_resolution The resolution of the grid subsampling a node, i.e., a node has at most
+         *      grid_resolution^3 points (in practice, about grid_resolution^2 points for scanned surfaces).
+         * @return \c true on success.
+         */
+        static bool build(const PointCloud *cloud, const std::string &file_name, std::size_t max_node_points = 20000,
+                          int grid_resolution = 128);
+
+        /// reads the hierarchy from an octree file written by build()
+        bool open(const std::string &file_name);
+        bool is_open() const { return !nodes_.empty(); }
+        const std::string &file_name() const { return file_name_; }
+
+        /// the nodes, the root being the first one and the children following their parents
+        const std::vector<Node> &nodes() const { return nodes_; }
+        std::size_t num_points() const { return num_points_; }
+        /// the bounding box of the points
+        const Box3 &bounding_box() const { return bbox_; }
+        bool has_normals() const { return has_normals_; }
+        bool has_colors() const { return has_colors_; }
+
+        /**
+         * @brief Reads the points of a node from the file. This function is thread-safe.
+         * @return \c true on success.
+         */
+        bool load(int node, Points &points) const;
+
+        /**
+         * @brief Selects the nodes to render for a view.
+         * @details The nodes in the viewing frustum of the camera are visited in the order of their screen-space
+         *      error, i.e., the projected distance between their points, such that the nodes adding the most visible
+         *      detail come first. The children of a node are only considered if its error exceeds \p max_screen_error
+         *      and the selection stops when the next node would exceed the point budget. A selected node's ancestors
+         *      are always selected.
+         * @param camera The camera (only its parameters are used, no rendering context is needed).
+         * @param point_budget The maximum number of points of the selected nodes.
+         * @param max_screen_error The screen-space error (in pixels) below which a node is not refined.
+         * @return The selected nodes, in the order of decreasing screen-space error.
+         */
+        std::vector<int> select(const Camera *camera, std::size_t point_budget, float max_screen_error = 1.0f) const;
+
+    private:
+        std::string file_name_;
+        std::vector<Node> nodes_;
+        std::size_t num_points_;
+        Box3 bbox_;
+        bool has_normals_;
+        bool has_colors_;
+        uint64_t data_offset_;  // the position of the points in the file
+    };
+
+
+    /**
+     * @brief Loads the nodes of a PointCloudLod in a background thread.
+     * @details The loader works on the latest request only: nodes requested before but no longer wanted are not
+     *      loaded. The loaded nodes are handed over by fetch(), e.g., once per frame by the rendering thread.
+     */
+    class PointCloudLodLoader {
+    public:
+        explicit PointCloudLodLoader(const PointCloudLod *lod);
+        /// stops the background thread (the node being loaded is completed first)
+        ~PointCloudLodLoader();
+
+        /**
+         * @brief Requests the nodes to be loaded, in the order of priority. This replaces the previous requests.
+         *      Nodes being loaded or loaded but not yet fetched are not loaded again.
+         */
+        void request(const std::vector<int> &nodes);
+
+        /// moves the nodes loaded since the last call into \p loaded
+        void fetch(std::vector<std::pair<int, PointCloudLod::Points> > &loaded);
+
+        /// the number of nodes requested but not loaded yet
+        std::size_t num_pending() const;
+
+        /// blocks until all the requested nodes have been loaded
+        void wait() const;
+
+    private:
+        void run();
+
+    private:
+        const PointCloudLod *lod_;
+
+        std::thread worker_;
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;          // a request arrived, or the loader is stopped
+        mutable std::condition_variable idle_;  // the queue has been emptied
+
+        std::deque<int> queue_;
+        int loading_;   // the node being loaded (-1: none)
+        std::vector<std::pair<int, PointCloudLod::Points> > loaded_;
+        bool stop_;
+    };
+
+}
+
+
+#endif  // EASY3D_RENDERER_POINT_CLOUD_LOD_H
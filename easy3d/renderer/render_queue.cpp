@@ -0,0 +1,532 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <easy3d/renderer/render_queue.h>
+
+#include <chrono>
+#include <algorithm>
+
+#include <easy3d/core/model.h>
+#include <easy3d/renderer/opengl.h>
+#include <easy3d/renderer/opengl_error.h>
+#include <easy3d/renderer/opengl_info.h>
+#include <easy3d/renderer/drawable.h>
+#include <easy3d/renderer/drawable_triangles.h>
+#include <easy3d/renderer/drawable_lines.h>
+#include <easy3d/renderer/drawable_points.h>
+#include <easy3d/renderer/buffers_chunks.h>
+#include <easy3d/renderer/renderer.h>
+#include <easy3d/renderer/camera.h>
+#include <easy3d/renderer/vertex_array_object.h>
+#include <easy3d/renderer/shader_program.h>
+#include <easy3d/renderer/shader_manager.h>
+#include <easy3d/renderer/clipping_plane.h>
+#include <easy3d/renderer/setting.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // is the drawable shown, i.e., is it visible and is the model (if any) visible?
+        inline bool is_shown(const Drawable *d) {
+            const Model *model = d->model();
+            return d->is_visible() && (!model || !model->renderer() || model->renderer()->is_visible());
+        }
+
+
+        // is the uniform color of the drawable used instead of its per-vertex colors (see _draw_triangles())?
+        inline bool uniform_color(const Drawable *d) {
+            return d->coloring_method() == State::UNIFORM_COLOR || d->color_buffer() == 0;
+        }
+
+
+        // can the drawable be merged with others into a batch? It must be rendered by the "surface/surface_color"
+        // shader with a uniform state, and its vertices must be stored in separate (not quantized) buffers.
+        inline bool is_batchable(const Drawable *d, std::size_t max_vertices) {
+            if (d->type() != Drawable::DT_TRIANGLES || d->vertex_buffer() == 0 || d->quantized_buffer())
+                return false;
+            if (d->texture() && (d->coloring_method() == State::SCALAR_FIELD || d->coloring_method() == State::TEXTURED))
+                return false;
+            // the per-vertex colors have no alpha, and the highlighted primitives are identified by gl_PrimitiveID
+            if ((uniform_color(d) && d->color().a < 1.0f) || d->highlight())
+                return false;
+            const std::size_t num = d->element_buffer() ? d->num_indices() : d->num_vertices();
+            return d->num_vertices() > 0 && d->num_vertices() <= max_vertices && num > 0;
+        }
+
+
+        template <typename KEY>
+        inline void batch_key(const TrianglesDrawable *d, bool polygon_offset, KEY &key) {
+            const State::Material &m = d->material();
+            const vec4 &back = d->back_color();
+            key = {
+                    polygon_offset ? 1.0f : 0.0f, d->lighting() ? 1.0f : 0.0f, d->lighting_two_sides() ? 1.0f : 0.0f,
+                    d->distinct_back_color() ? 1.0f : 0.0f, d->smooth_shading() ? 1.0f : 0.0f,
+                    d->normal_buffer() ? 1.0f : 0.0f, back.r, back.g, back.b, back.a,
+                    m.ambient.x, m.ambient.y, m.ambient.z, m.specular.x, m.specular.y, m.specular.z, m.shininess
+            };
+        }
+
+
+        ShaderProgram *batch_program() {
+            ShaderProgram *program = ShaderManager::get_program("surface/surface_color");
+            if (!program) {
+                std::vector<ShaderProgram::Attribute> attributes;
+                attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"));
+                attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::COLOR, "vtx_color"));
+                attributes.emplace_back(ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal"));
+                program = ShaderManager::create_program_from_files("surface/surface_color", attributes);
+            }
+            return program;
+        }
+
+
+        // copies a buffer into another one on the GPU
+        inline void copy_buffer(unsigned int source, unsigned int target, std::size_t offset, std::size_t size) {
+            glBindBuffer(GL_COPY_READ_BUFFER, source);          easy3d_debug_log_gl_error;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, target);         easy3d_debug_log_gl_error;
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, static_cast<GLintptr>(offset),
+                                static_cast<GLsizeiptr>(size));   easy3d_debug_log_gl_error;
+        }
+
+
+        // uploads data to a part of a buffer
+        inline void upload(unsigned int target, std::size_t offset, std::size_t size, const void *data) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, target);         easy3d_debug_log_gl_error;
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                            data);                              easy3d_debug_log_gl_error;
+        }
+
+    }
+
+
+    RenderQueue::RenderQueue()
+            : batching_(true)
+            , min_batch_size_(16)
+            , max_batch_vertices_(2000000)
+            , indirect_draw_(true)
+    {
+        statistics_ = {0.0, 0, 0, 0, 0, 0};
+    }
+
+
+    RenderQueue::~RenderQueue() {
+        clear();
+    }
+
+
+    void RenderQueue::add(Drawable *drawable, bool polygon_offset) {
+        if (drawable)
+            items_.push_back({drawable, polygon_offset});
+    }
+
+
+    void RenderQueue::add(Model *model) {
+        Renderer *renderer = model ? model->renderer() : nullptr;
+        if (!renderer)
+            return;
+
+        // Let's check if edges and surfaces are both shown. If true, we make the depth coordinates of the surface
+        // smaller, so that displaying the mesh and the surface together does not cause Z-fighting.
+        bool edges = false;
+        for (auto d : renderer->lines_drawables()) {
+            add(d);
+            edges = edges || d->is_visible();
+        }
+        for (auto d : renderer->points_drawables())
+            add(d);
+        for (auto d : renderer->triangles_drawables())
+            add(d, edges);
+    }
+
+
+    void RenderQueue::set_batching(bool b) {
+        if (b != batching_) {
+            batching_ = b;
+            if (!batching_)
+                clear();
+        }
+    }
+
+
+    void RenderQueue::clear() {
+        for (auto &group : batches_) {
+            for (auto batch : group.second)
+                release(batch);
+        }
+        batches_.clear();
+        groups_.clear();
+    }
+
+
+    bool RenderQueue::is_indirect_draw_supported() {
+        return OpenglInfo::is_supported("GL_VERSION_4_3") || OpenglInfo::is_supported("GL_ARB_multi_draw_indirect");
+    }
+
+
+    void RenderQueue::release(Batch *batch) {
+        VertexArrayObject::release_buffer(batch->vertex_buffer);
+        VertexArrayObject::release_buffer(batch->normal_buffer);
+        VertexArrayObject::release_buffer(batch->color_buffer);
+        VertexArrayObject::release_buffer(batch->element_buffer);
+        VertexArrayObject::release_buffer(batch->indirect_buffer);
+        delete batch->vao;
+        delete batch;
+    }
+
+
+    bool RenderQueue::is_up_to_date(const Batch *batch, const std::vector<Item> &items, std::size_t begin,
+                                    std::size_t end) {
+        if (batch->entries.size() != end - begin)
+            return false;
+        for (std::size_t i = begin; i < end; ++i) {
+            const Entry &e = batch->entries[i - begin];
+            const Drawable *d = items[i].drawable;
+            if (e.drawable != d || e.version != d->buffers_version() || e.uniform_color != details::uniform_color(d))
+                return false;
+            if (e.uniform_color && distance2(e.color, d->color()) != 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+
+    bool RenderQueue::build(Batch *batch, const std::vector<Item> &items, std::size_t begin, std::size_t end) {
+        batch->entries.clear();
+        std::size_t num_vertices = 0, num_indices = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            const Drawable *d = items[i].drawable;
+            Entry e;
+            e.drawable = d;
+            e.version = d->buffers_version();
+            e.uniform_color = details::uniform_color(d);
+            e.color = d->color();
+            e.base_vertex = num_vertices;
+            e.first_index = num_indices;
+            e.num_indices = d->element_buffer() ? d->num_indices() : d->num_vertices();
+            batch->entries.push_back(e);
+            num_vertices += d->num_vertices();
+            num_indices += e.num_indices;
+        }
+
+        const bool normals = (batch->key[5] != 0.0f);
+        bool success = VertexArrayObject::create_buffer(batch->vertex_buffer, nullptr, num_vertices * sizeof(vec3)) &&
+                       VertexArrayObject::create_buffer(batch->color_buffer, nullptr, num_vertices * sizeof(vec3)) &&
+                       VertexArrayObject::create_buffer(batch->element_buffer, nullptr, num_indices * sizeof(unsigned int));
+        if (success && normals)
+            success = VertexArrayObject::create_buffer(batch->normal_buffer, nullptr, num_vertices * sizeof(vec3));
+        if (!success) {
+            LOG(ERROR) << "failed creating the buffers of a batch (" << num_vertices << " vertices, " << num_indices
+                       << " indices)";
+            batch->entries.clear();
+            return false;
+        }
+
+        std::vector<vec3> colors;
+        std::vector<unsigned int> indices;
+        for (const auto &e : batch->entries) {
+            const Drawable *d = e.drawable;
+            const std::size_t num = d->num_vertices();
+            details::copy_buffer(d->vertex_buffer(), batch->vertex_buffer, e.base_vertex * sizeof(vec3),
+                                 num * sizeof(vec3));
+            if (normals)
+                details::copy_buffer(d->normal_buffer(), batch->normal_buffer, e.base_vertex * sizeof(vec3),
+                                     num * sizeof(vec3));
+            if (e.uniform_color) {
+                colors.assign(num, vec3(e.color.r, e.color.g, e.color.b));
+                details::upload(batch->color_buffer, e.base_vertex * sizeof(vec3), num * sizeof(vec3), colors.data());
+            } else
+                details::copy_buffer(d->color_buffer(), batch->color_buffer, e.base_vertex * sizeof(vec3),
+                                     num * sizeof(vec3));
+            // the indices are relative to the drawable (the base vertex is added by the draw commands)
+            if (d->element_buffer())
+                details::copy_buffer(d->element_buffer(), batch->element_buffer, e.first_index * sizeof(unsigned int),
+                                     e.num_indices * sizeof(unsigned int));
+            else {
+                indices.resize(e.num_indices);
+                for (std::size_t i = 0; i < e.num_indices; ++i)
+                    indices[i] = static_cast<unsigned int>(i);
+                details::upload(batch->element_buffer, e.first_index * sizeof(unsigned int),
+                                e.num_indices * sizeof(unsigned int), indices.data());
+            }
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);   easy3d_debug_log_gl_error;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);  easy3d_debug_log_gl_error;
+
+        if (!batch->vao)
+            batch->vao = new VertexArrayObject;
+        success = batch->vao->bind_array_buffer(batch->vertex_buffer, ShaderProgram::POSITION, 3) &&
+                  batch->vao->bind_array_buffer(batch->color_buffer, ShaderProgram::COLOR, 3);
+        if (success && normals)
+            success = batch->vao->bind_array_buffer(batch->normal_buffer, ShaderProgram::NORMAL, 3);
+        LOG_IF(ERROR, !success) << "failed binding the buffers of a batch";
+        return success;
+    }
+
+
+    void RenderQueue::draw(Batch *batch, const buffers::ChunkCuller &culler) {
+        // a command per visible drawable, or per range of visible chunks
+        commands_.clear();
+        for (const auto &e : batch->entries) {
+            const Drawable *d = e.drawable;
+            if (!details::is_shown(d) || !culler.is_visible(d->bounding_box(), 0.0f))
+                continue;
+            const unsigned int base = static_cast<unsigned int>(e.base_vertex);
+            const std::vector<buffers::Chunk> &chunks = d->chunks();
+            if (chunks.empty()) {
+                commands_.push_back({static_cast<unsigned int>(e.num_indices), 1u,
+                                     static_cast<unsigned int>(e.first_index), base, 0u});
+                continue;
+            }
+            std::size_t end = 0;  // the end of the last range
+            const std::size_t first_command = commands_.size();
+            for (const auto &chunk : chunks) {
+                if (!culler.is_visible(chunk.box, d->small_feature_threshold()))
+                    continue;
+                if (commands_.size() > first_command && chunk.first == end)
+                    commands_.back()[0] += static_cast<unsigned int>(chunk.count);
+                else
+                    commands_.push_back({static_cast<unsigned int>(chunk.count), 1u,
+                                         static_cast<unsigned int>(e.first_index + chunk.first), base, 0u});
+                end = chunk.first + chunk.count;
+            }
+        }
+        if (commands_.empty())
+            return;
+
+        batch->vao->bind();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch->element_buffer);     easy3d_debug_log_gl_error;
+        if (indirect_draw_ && is_indirect_draw_supported()) {
+            if (batch->indirect_buffer == 0)
+                glGenBuffers(1, &batch->indirect_buffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->indirect_buffer);    easy3d_debug_log_gl_error;
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commands_.size() * sizeof(commands_[0])),
+                         commands_.data(), GL_STREAM_DRAW);                     easy3d_debug_log_gl_error;
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, GLsizei(commands_.size()), 0);
+            easy3d_debug_log_gl_error;
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);     easy3d_debug_log_gl_error;
+        } else {
+            counts_.resize(commands_.size());
+            offsets_.resize(commands_.size());
+            base_vertices_.resize(commands_.size());
+            for (std::size_t i = 0; i < commands_.size(); ++i) {
+                counts_[i] = static_cast<int>(commands_[i][0]);
+                offsets_[i] = reinterpret_cast<void *>(commands_[i][2] * sizeof(unsigned int));
+                base_vertices_[i] = static_cast<int>(commands_[i][3]);
+            }
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts_.data(), GL_UNSIGNED_INT, offsets_.data(),
+                                          GLsizei(commands_.size()), base_vertices_.data());
+            easy3d_debug_log_gl_error;
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);     easy3d_debug_log_gl_error;
+        batch->vao->release();
+        ++statistics_.num_draw_calls;
+    }
+
+
+    void RenderQueue::draw(const Camera *camera) {
+        const auto start = std::chrono::steady_clock::now();
+        statistics_ = {0.0, items_.size(), 0, 0, 0, 0};
+
+        // the buffers have to be up to date before they can be copied into the batches
+        for (auto &group : groups_)
+            group.second.clear();
+        std::vector<Item> direct;
+        for (const auto &item : items_) {
+            Drawable *d = item.drawable;
+            if (d->update_needed_ || d->vertex_buffer_ == 0) {
+                // the buffers of hidden drawables are created when they are shown
+                if (!details::is_shown(d))
+                    continue;
+                d->internal_update_buffers();
+                // nothing to draw until the first buffers are uploaded
+                if (d->vertex_buffer_ == 0 && d->update_pending_)
+                    continue;
+            }
+            if (batching_ && details::is_batchable(d, max_batch_vertices_)) {
+                Key key;
+                details::batch_key(dynamic_cast<const TrianglesDrawable *>(d), item.polygon_offset, key);
+                groups_[key].push_back(item);
+            } else if (details::is_shown(d))
+                direct.push_back(item);
+        }
+
+        // the batches of each group, each one up to the maximum number of vertices
+        std::vector<Batch *> batches;
+        for (auto it = groups_.begin(); it != groups_.end();) {
+            const std::vector<Item> &items = it->second;
+            std::vector<Batch *> &cached = batches_[it->first];
+            std::size_t count = 0;
+            if (items.size() >= min_batch_size_) {
+                std::size_t begin = 0;
+                while (begin < items.size()) {
+                    std::size_t end = begin, num_vertices = 0;
+                    while (end < items.size() && num_vertices + items[end].drawable->num_vertices() <= max_batch_vertices_)
+                        num_vertices += items[end++].drawable->num_vertices();
+
+                    if (count == cached.size()) {
+                        Batch *batch = new Batch;
+                        batch->key = it->first;
+                        batch->vao = nullptr;
+                        batch->vertex_buffer = batch->normal_buffer = batch->color_buffer = 0;
+                        batch->element_buffer = batch->indirect_buffer = 0;
+                        cached.push_back(batch);
+                    }
+                    Batch *batch = cached[count++];
+                    if (!is_up_to_date(batch, items, begin, end)) {
+                        ++statistics_.num_rebuilt;
+                        if (!build(batch, items, begin, end)) {
+                            // draws them the usual way
+                            for (std::size_t i = begin; i < end; ++i) {
+                                if (details::is_shown(items[i].drawable))
+                                    direct.push_back(items[i]);
+                            }
+                        }
+                    }
+                    if (!batch->entries.empty()) {
+                        batches.push_back(batch);
+                        statistics_.num_batched += batch->entries.size();
+                    }
+                    begin = end;
+                }
+            } else {
+                for (const auto &item : items) {
+                    if (details::is_shown(item.drawable))
+                        direct.push_back(item);
+                }
+            }
+
+            // the batches no longer needed
+            for (std::size_t i = count; i < cached.size(); ++i)
+                release(cached[i]);
+            cached.resize(count);
+            if (items.empty()) {
+                batches_.erase(it->first);
+                it = groups_.erase(it);
+            } else
+                ++it;
+        }
+        for (auto it = batches_.begin(); it != batches_.end();) {
+            if (it->second.empty())
+                it = batches_.erase(it);
+            else
+                ++it;
+        }
+        statistics_.num_batches = batches.size();
+
+        // sorts the drawables by their pass (lines, points, and then surfaces), polygon offset, and shader (i.e.,
+        // the type and the texture).
+        std::stable_sort(direct.begin(), direct.end(), [](const Item &a, const Item &b) {
+            const int pa = (a.drawable->type() == Drawable::DT_TRIANGLES ? 2 : a.drawable->type() == Drawable::DT_POINTS);
+            const int pb = (b.drawable->type() == Drawable::DT_TRIANGLES ? 2 : b.drawable->type() == Drawable::DT_POINTS);
+            if (pa != pb)
+                return pa < pb;
+            if (a.polygon_offset != b.polygon_offset)
+                return b.polygon_offset;
+            if (a.drawable->coloring_method() != b.drawable->coloring_method())
+                return a.drawable->coloring_method() < b.drawable->coloring_method();
+            return a.drawable->texture() < b.drawable->texture();
+        });
+
+        // the lines and points
+        std::size_t next = 0;
+        for (; next < direct.size() && direct[next].drawable->type() != Drawable::DT_TRIANGLES; ++next) {
+            direct[next].drawable->draw(camera, false);     easy3d_debug_log_gl_error;
+            ++statistics_.num_draw_calls;
+        }
+
+        // the surfaces, the batches first (they are in the order of their keys, i.e., those with polygon offset last)
+        const buffers::ChunkCuller culler(camera);
+        bool polygon_offset = false;
+        auto set_polygon_offset = [&polygon_offset](bool offset) {
+            if (offset == polygon_offset)
+                return;
+            if (offset) {
+                glEnable(GL_POLYGON_OFFSET_FILL);
+                glPolygonOffset(0.5f, -0.0001f);
+            } else
+                glDisable(GL_POLYGON_OFFSET_FILL);
+            polygon_offset = offset;
+        };
+
+        if (!batches.empty()) {
+            ShaderProgram *program = details::batch_program();
+            if (program) {
+                const mat4 &MVP = camera->modelViewProjectionMatrix();
+                // camera position is defined in world coordinate system.
+                const vec3 &wCamPos = camera->position();
+                const mat4 &MV = camera->modelViewMatrix();
+                const vec4 &wLightPos = inverse(MV) * setting::light_position;
+
+                program->bind();
+                program->set_uniform("MVP", MVP)
+                        ->set_uniform("wLightPos", wLightPos)
+                        ->set_uniform("wCamPos", wCamPos)
+                        ->set_uniform("ssaoEnabled", false)
+                        ->set_uniform("per_vertex_color", true)
+                        ->set_uniform("highlight", false);
+                if (setting::clipping_plane)
+                    setting::clipping_plane->set_program(program);
+
+                const Key *current = nullptr;
+                for (auto batch : batches) {
+                    // the uniforms are the same for the batches of a group
+                    if (!current || *current != batch->key) {
+                        const TrianglesDrawable *d = dynamic_cast<const TrianglesDrawable *>(batch->entries[0].drawable);
+                        program->set_uniform("lighting", d->lighting())
+                                ->set_uniform("two_sides_lighting", d->lighting_two_sides())
+                                ->set_uniform("distinct_back_color", d->distinct_back_color())
+                                ->set_uniform("backside_color", d->back_color())
+                                ->set_uniform("smooth_shading", d->smooth_shading())
+                                ->set_block_uniform("Material", "ambient", d->material().ambient)
+                                ->set_block_uniform("Material", "specular", d->material().specular)
+                                ->set_block_uniform("Material", "shininess", &d->material().shininess);
+                        current = &batch->key;
+                    }
+                    set_polygon_offset(batch->key[0] != 0.0f);
+                    draw(batch, culler);
+                }
+                program->release();
+            }
+        }
+
+        for (; next < direct.size(); ++next) {
+            set_polygon_offset(direct[next].polygon_offset);
+            direct[next].drawable->draw(camera, false);     easy3d_debug_log_gl_error;
+            ++statistics_.num_draw_calls;
+        }
+        set_polygon_offset(false);
+
+        items_.clear();
+        statistics_.submission_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (statistics_callback_)
+            statistics_callback_(statistics_);
+    }
+
+}
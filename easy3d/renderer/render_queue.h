@@ -0,0 +1,189 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_RENDERER_RENDER_QUEUE_H
+#define EASY3D_RENDERER_RENDER_QUEUE_H
+
+#include <array>
+#include <map>
+#include <vector>
+#include <functional>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    class Model;
+    class Camera;
+    class Drawable;
+    class VertexArrayObject;
+
+    namespace buffers {
+        class ChunkCuller;
+    }
+
+
+    /**
+     * @brief Submits the drawables of a frame sorted by their shader and state, and with the surfaces of many small
+     *      models merged into a few draw calls.
+     * @details Drawing each drawable on its own costs a shader bind, a set of uniforms, and a draw call, which
+     *      dominates the frame time of scenes consisting of thousands of models (e.g., the buildings of a city). The
+     *      queue groups the triangles drawables that are rendered with the same shader and the same uniforms (i.e.,
+     *      lighting, material, back side color) and copies their buffers into the shared buffers of a batch (on
+     *      the GPU), with the uniform colors turned into per-vertex colors. Each batch is then drawn by a single
+     *      glMultiDrawElementsIndirect() call (or glMultiDrawElementsBaseVertex() if not supported), with a command
+     *      per visible drawable (or per visible chunk of a drawable, see Drawable::set_chunk_size()).
+     *      The batches are kept for the next frames, and a batch is rebuilt only if the buffers or the uniform color
+     *      of one of its drawables have changed, or if its drawables have changed.
+     *      The drawables that cannot be batched (e.g., textured surfaces, highlighted surfaces, quantized vertices,
+     *      points, and lines) are drawn as usual but in a sorted order.
+     *      Usage:
+     *      \code
+     *          for (auto m : models)
+     *              queue.add(m);
+     *          queue.draw(camera);
+     *      \endcode
+     * @note The batches store a copy of the buffers of their drawables, i.e., the GPU memory of the batched
+     *      drawables is doubled.
+     */
+    class RenderQueue {
+    public:
+        /// The cost of submitting the last frame.
+        struct Statistics {
+            double submission_time;         // the CPU time (in milliseconds) spent by draw()
+            std::size_t num_drawables;      // the drawables added to the frame
+            std::size_t num_batched;        // the drawables drawn by the batches
+            std::size_t num_batches;        // the batches
+            std::size_t num_rebuilt;        // the batches (re)built for the frame
+            std::size_t num_draw_calls;     // the draw calls (a multi-draw call counts one), including the drawables
+                                            // that are not batched
+        };
+
+    public:
+        RenderQueue();
+        ~RenderQueue();
+
+        /// Adds a drawable to the next frame. The \p polygon_offset pushes the surfaces back, so the edges drawn on
+        /// them do not cause z-fighting. Invisible drawables can be added: they are skipped by draw() but they stay
+        /// in their batch, so hiding a model does not rebuild the batches.
+        void add(Drawable *drawable, bool polygon_offset = false);
+        /// Adds all the drawables of a model, the surfaces with a polygon offset if some of its edges are visible.
+        void add(Model *model);
+
+        /// Draws the drawables added since the last call, then empties the queue (the batches are kept).
+        void draw(const Camera *camera);
+
+        /// Releases the batches (and their buffers).
+        void clear();
+
+        /// merge drawables into batches (default: true). If disabled, the drawables are only sorted.
+        bool batching() const { return batching_; }
+        void set_batching(bool b);
+
+        /// the minimum number of drawables that share the same state for them to be batched (default: 16)
+        std::size_t min_batch_size() const { return min_batch_size_; }
+        void set_min_batch_size(std::size_t n) { min_batch_size_ = n; }
+
+        /// the maximum number of vertices of a batch (default: 2 million). A modified drawable causes its batch to
+        /// be rebuilt, so smaller batches are cheaper to update but require more draw calls.
+        std::size_t max_batch_vertices() const { return max_batch_vertices_; }
+        void set_max_batch_vertices(std::size_t n) { max_batch_vertices_ = n; }
+
+        /// use glMultiDrawElementsIndirect() to draw the batches if it is supported (default: true)
+        bool indirect_draw() const { return indirect_draw_; }
+        void set_indirect_draw(bool b) { indirect_draw_ = b; }
+        static bool is_indirect_draw_supported();
+
+        /// the statistics of the last frame
+        const Statistics &statistics() const { return statistics_; }
+        /// a function called after each frame with its statistics, e.g., for profiling
+        void set_statistics_callback(std::function<void(const Statistics &)> func) { statistics_callback_ = func; }
+
+    private:
+        // the shader state shared by the drawables of a batch, i.e., polygon offset, lighting, two sides lighting,
+        // distinct back color, smooth shading, normals, back color (4), material ambient (3), specular (3), shininess
+        typedef std::array<float, 17> Key;
+
+        struct Item {
+            Drawable *drawable;
+            bool polygon_offset;
+        };
+
+        // a drawable copied into a batch
+        struct Entry {
+            const Drawable *drawable;
+            unsigned int version;   // the version of the buffers that were copied
+            bool uniform_color;     // the uniform color was copied as per-vertex colors
+            vec4 color;
+            std::size_t base_vertex;
+            std::size_t first_index;
+            std::size_t num_indices;
+        };
+
+        struct Batch {
+            Key key;
+            std::vector<Entry> entries;
+            VertexArrayObject *vao;
+            unsigned int vertex_buffer;
+            unsigned int normal_buffer;
+            unsigned int color_buffer;
+            unsigned int element_buffer;
+            unsigned int indirect_buffer;
+        };
+
+        // is the batch made of the items [begin, end), with the same buffers and colors?
+        static bool is_up_to_date(const Batch *batch, const std::vector<Item> &items, std::size_t begin,
+                                  std::size_t end);
+        // copies the buffers of the items [begin, end) into the batch
+        bool build(Batch *batch, const std::vector<Item> &items, std::size_t begin, std::size_t end);
+        static void release(Batch *batch);
+
+        void draw(Batch *batch, const buffers::ChunkCuller &culler);
+
+    private:
+        bool batching_;
+        std::size_t min_batch_size_;
+        std::size_t max_batch_vertices_;
+        bool indirect_draw_;
+
+        std::vector<Item> items_;
+        std::map<Key, std::vector<Item> > groups_;      // the batchable drawables of the frame
+        std::map<Key, std::vector<Batch *> > batches_;  // the batches, kept from frame to frame
+
+        // the draw commands (reused by each frame), {count, instance count, first index, base vertex, base instance}
+        std::vector<std::array<unsigned int, 5> > commands_;
+        std::vector<int> counts_;
+        std::vector<void *> offsets_;
+        std::vector<int> base_vertices_;
+
+        Statistics statistics_;
+        std::function<void(const Statistics &)> statistics_callback_;
+    };
+
+}
+
+
+#endif  // EASY3D_RENDERER_RENDER_QUEUE_H
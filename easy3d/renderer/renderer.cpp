@@ -30,7 +30,11 @@
 #include <easy3d/renderer/drawable_points.h>
 #include <easy3d/renderer/drawable_lines.h>
 #include <easy3d/renderer/drawable_triangles.h>
+#include <easy3d/renderer/vertex_array_object.h>
 #include <easy3d/renderer/setting.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
 
 
 namespace easy3d {
@@ -38,6 +42,7 @@ namespace easy3d {
     Renderer::Renderer(Model* model, bool create)
             : visible_(true)
             , selected_(false)
+            , shared_buffers_epoch_(0)
     {
         model_ = model;
         if (model_) {
@@ -53,6 +58,10 @@ namespace easy3d {
         for (auto d : points_drawables_)	delete d;
         for (auto d : lines_drawables_)	    delete d;
         for (auto d : triangles_drawables_)	delete d;
+
+        // all have been released by the drawables
+        for (auto &b : shared_buffers_)
+            VertexArrayObject::release_buffer(b.buffer);
     }
 
     
@@ -249,6 +258,7 @@ namespace easy3d {
 
     void Renderer::update() {
         model_->update_bounding_box();
+        invalidate_shared_buffers();
 
         for (auto d : points_drawables_)
             d->update();
@@ -259,6 +269,68 @@ namespace easy3d {
     }
 
 
+    unsigned int Renderer::acquire_shared_buffer(const Drawable *drawable, const void *array, const void *data,
+                                                 std::size_t size) {
+        // only the drawables managed by this renderer are guaranteed not to outlive the shared buffers
+        const bool managed = std::find(points_drawables_.begin(), points_drawables_.end(), drawable) != points_drawables_.end() ||
+                             std::find(lines_drawables_.begin(), lines_drawables_.end(), drawable) != lines_drawables_.end() ||
+                             std::find(triangles_drawables_.begin(), triangles_drawables_.end(), drawable) != triangles_drawables_.end();
+        if (!managed)
+            return 0;
+
+        // An outdated buffer is not overwritten but replaced by a new one: the drawables that have not been updated
+        // yet (e.g., whose buffers are still being prepared in the background) keep rendering the old content. The
+        // outdated buffer is deleted when the last of them releases it. Only a buffer referred to by no other
+        // drawable is re-specified in place.
+        const unsigned int epoch = shared_buffers_epoch_;
+        auto pos = std::find_if(shared_buffers_.begin(), shared_buffers_.end(),
+                                [array, epoch](const SharedBuffer &b) { return b.array == array && b.epoch == epoch; });
+        if (pos == shared_buffers_.end()) {
+            pos = std::find_if(shared_buffers_.begin(), shared_buffers_.end(), [array, drawable](const SharedBuffer &b) {
+                return b.array == array && b.references == 1 &&
+                       (drawable->vertex_buffer() == b.buffer || drawable->normal_buffer() == b.buffer ||
+                        drawable->color_buffer() == b.buffer || drawable->texcoord_buffer() == b.buffer);
+            });
+            if (pos != shared_buffers_.end()) {
+                // the drawable releases it right after acquiring it again (see Drawable::share_buffer())
+                pos->epoch = epoch;
+                pos->size = 0;
+            }
+        }
+        if (pos == shared_buffers_.end()) {
+            SharedBuffer b = {array, 0, 0, epoch, 0};
+            if (!VertexArrayObject::create_buffer(b.buffer, data, size)) {
+                LOG(ERROR) << "failed creating shared buffer";
+                return 0;
+            }
+            b.size = size;
+            pos = shared_buffers_.insert(shared_buffers_.end(), b);
+        } else if (pos->size != size) {
+            if (!VertexArrayObject::create_buffer(pos->buffer, data, size)) {
+                LOG(ERROR) << "failed updating shared buffer";
+                return 0;
+            }
+            pos->size = size;
+        }
+        ++pos->references;
+        return pos->buffer;
+    }
+
+
+    void Renderer::release_shared_buffer(unsigned int buffer) {
+        auto pos = std::find_if(shared_buffers_.begin(), shared_buffers_.end(),
+                                [buffer](const SharedBuffer &b) { return b.buffer == buffer; });
+        if (pos == shared_buffers_.end()) {
+            LOG(ERROR) << "not a shared buffer: " << buffer;
+            return;
+        }
+        if (--pos->references <= 0) {
+            VertexArrayObject::release_buffer(pos->buffer);
+            shared_buffers_.erase(pos);
+        }
+    }
+
+
     PointsDrawable* Renderer::get_points_drawable(const std::string& name) const {
         for (auto d : points_drawables_) {
             if (d->name() == name)
@@ -37,6 +37,7 @@ namespace easy3d {
     class Graph;
     class PointCloud;
     class SurfaceMesh;
+    class Drawable;
     class PointsDrawable;
     class LinesDrawable;
     class TrianglesDrawable;
@@ -144,6 +145,38 @@ namespace easy3d {
          */
         const std::vector<TrianglesDrawable *> &triangles_drawables() const { return triangles_drawables_; }
 
+        //-------------------- shared buffers  -----------------------
+
+        /**
+         * @brief Acquires the OpenGL buffer holding the content of an array of the model (e.g., the vertex positions)
+         *        for a drawable of this renderer.
+         * @details The drawables of a model usually render the same vertex positions (and often the same normals and
+         *        colors). Instead of uploading their own copies, they share a single buffer for each array of the
+         *        model and only have their own element buffers. A shared buffer is uploaded at most once per update
+         *        of the model (see update() and Drawable::update()), into a new buffer object, so the drawables not
+         *        updated yet keep the old one. It is reference counted and deleted when the last drawable referring to
+         *        it releases it.
+         * @param drawable The drawable requiring the buffer. It must be managed by this renderer.
+         * @param array The array of the model, whose address identifies the buffer.
+         * @param data The content of the array.
+         * @param size The size of the content in bytes.
+         * @return The name of the buffer (its reference count is increased), or 0 if the drawable is not managed by
+         *         this renderer or the buffer could not be created.
+         */
+        unsigned int acquire_shared_buffer(const Drawable *drawable, const void *array, const void *data, std::size_t size);
+
+        /**
+         * @brief Releases a buffer acquired by acquire_shared_buffer(). The buffer is deleted if it is not referred
+         *        to by any drawable any more.
+         */
+        void release_shared_buffer(unsigned int buffer);
+
+        /**
+         * @brief Marks all the shared buffers outdated, such that they will be uploaded again when they are acquired
+         *        next time. This is called whenever the rendering buffers of the model are to be updated.
+         */
+        void invalidate_shared_buffers() { ++shared_buffers_epoch_; }
+
     public:
         /**
          * @brief Create default drawables for rendering.
@@ -215,6 +248,16 @@ namespace easy3d {
         std::vector<PointsDrawable *> points_drawables_;
         std::vector<LinesDrawable *> lines_drawables_;
         std::vector<TrianglesDrawable *> triangles_drawables_;
+
+        struct SharedBuffer {
+            const void *array;
+            unsigned int buffer;
+            std::size_t size;
+            unsigned int epoch; // the epoch in which the buffer was uploaded
+            int references;
+        };
+        std::vector<SharedBuffer> shared_buffers_;
+        unsigned int shared_buffers_epoch_;
     };
 }
 
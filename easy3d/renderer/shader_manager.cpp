@@ -23,17 +23,258 @@
  */
 
 #include <easy3d/renderer/shader_manager.h>
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+#include <easy3d/core/types.h>
+#include <easy3d/core/hash.h>
+#include <easy3d/renderer/opengl.h>
+#include <easy3d/renderer/opengl_info.h>
 #include <easy3d/renderer/opengl_error.h>
 #include <easy3d/fileio/resources.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/string.h>
 #include <easy3d/util/logging.h>
 
+// The windows.h has to come after <easy3d/core/types.h>. Otherwise the compiler
+// will be confused by the min/max micros and the std::min, std::max.
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>     // for getpid()
+#endif // _WIN32
+
 
 namespace easy3d {
 
     std::unordered_map<std::string, ShaderProgram*>     ShaderManager::programs_;
     std::unordered_map<std::string, bool>				ShaderManager::attempt_load_program_; // avoid multiple attempt
+    std::string                                         ShaderManager::cache_directory_;
+
+
+    namespace details {
+
+        // the name of a variant of a program, e.g., "points/points_plain_color[QUANTIZED_VERTEX]"
+        std::string variant_name(const std::string& name, const std::vector<std::string>& defines) {
+            if (defines.empty())
+                return name;
+            std::string result = name + "[";
+            for (std::size_t i = 0; i < defines.size(); ++i)
+                result += (i == 0 ? "" : ",") + defines[i];
+            return result + "]";
+        }
+
+        // reads the code of a shader from a file, with the preprocessor definitions inserted after the #version
+        // directive (which must be the first statement of the shader).
+        std::string shader_code(const std::string& file, const std::vector<std::string>& defines) {
+            std::string code;
+            file_system::read_file_to_string(file, code);
+            if (code.empty() || defines.empty())
+                return code;
+
+            std::string lines;
+            for (const auto& d : defines)
+                lines += "#define " + d + "\n";
+            std::size_t pos = 0;
+            const std::size_t version = code.find("#version");
+            if (version != std::string::npos) {
+                pos = code.find('\n', version);
+                if (pos == std::string::npos) {
+                    code += '\n';
+                    pos = code.size();
+                } else
+                    ++pos;
+            }
+            code.insert(pos, lines);
+            return code;
+        }
+
+
+        typedef std::vector< std::pair<ShaderProgram::ShaderType, std::string> > ShaderCodes;
+
+        // ------------------------------------------------------------------------------------------------------------
+        // The program binary cache. Each program is stored in a file named after the hash of its sources, attribute
+        // bindings, and outputs. The file also records the identity of the OpenGL driver that has created it, because
+        // a binary is only valid for the same driver (vendor, renderer, and version). The binary has a checksum, so a
+        // damaged file is never given to the driver. The cache file is:
+        //      "easy3d-program-binary" | key (8 bytes) | identity size (4 bytes) | identity | format (4 bytes) |
+        //      checksum (8 bytes) | binary
+
+        const char cache_magic[] = "easy3d-program-binary";
+
+        std::string driver_identity() {
+            std::string identity;
+            for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+                const GLubyte* str = glGetString(name);
+                identity += std::string(str ? reinterpret_cast<const char*>(str) : "") + "\n";
+            }
+            return identity;
+        }
+
+
+        uint64_t program_key(const std::string& name, const ShaderCodes& codes,
+                             const std::vector<ShaderProgram::Attribute>& attributes,
+                             const std::vector<std::string>& outputs)
+        {
+            uint64_t key = 0;
+            hash_combine(key, name);
+            for (const auto& c : codes) {
+                hash_combine(key, static_cast<int>(c.first));
+                hash_combine(key, c.second);
+            }
+            for (const auto& a : attributes) {
+                hash_combine(key, static_cast<int>(a.first));
+                hash_combine(key, a.second);
+            }
+            for (const auto& o : outputs)
+                hash_combine(key, o);
+            return key;
+        }
+
+
+        std::string cache_file(const std::string& dir, uint64_t key) {
+            std::ostringstream file;
+            file << dir << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+            return file.str();
+        }
+
+
+        // restores a program from the cache. Returns false if it is not cached, or the cached binary is outdated or
+        // rejected by the driver.
+        bool load_cached(ShaderProgram* program, const std::string& file, uint64_t key, const std::string& identity) {
+            if (!file_system::is_file(file))
+                return false;
+
+            std::string data;
+            file_system::read_file_to_string(file, data);
+            const std::size_t magic_size = sizeof(cache_magic);
+            std::size_t pos = magic_size + sizeof(uint64_t) + sizeof(uint32_t);
+            if (data.size() < pos || std::memcmp(data.data(), cache_magic, magic_size) != 0)
+                return false;
+
+            uint64_t cached_key = 0;
+            std::memcpy(&cached_key, data.data() + magic_size, sizeof(uint64_t));
+            uint32_t identity_size = 0;
+            std::memcpy(&identity_size, data.data() + magic_size + sizeof(uint64_t), sizeof(uint32_t));
+            if (cached_key != key || data.size() < pos + identity_size + sizeof(uint32_t) ||
+                data.compare(pos, identity_size, identity) != 0)
+                return false;
+
+            pos += identity_size;
+            uint32_t format = 0;
+            std::memcpy(&format, data.data() + pos, sizeof(uint32_t));
+            pos += sizeof(uint32_t);
+            uint64_t checksum = 0;
+            if (data.size() < pos + sizeof(uint64_t))
+                return false;
+            std::memcpy(&checksum, data.data() + pos, sizeof(uint64_t));
+            pos += sizeof(uint64_t);
+            if (hash_range(data.begin() + pos, data.end()) != checksum)
+                return false;
+            return program->set_binary(format, data.substr(pos));
+        }
+
+
+        // the id of the current process, which makes the temporary cache files of the processes distinct
+        unsigned long process_id() {
+#ifdef _WIN32
+            return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+            return static_cast<unsigned long>(getpid());
+#endif // _WIN32
+        }
+
+
+        // renames a file, atomically replacing the target if it exists (unlike file_system::rename_file())
+        bool replace_file(const std::string& old_name, const std::string& new_name) {
+#ifdef _WIN32
+            return MoveFileExA(old_name.c_str(), new_name.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            return std::rename(old_name.c_str(), new_name.c_str()) == 0;
+#endif // _WIN32
+        }
+
+
+        void save_cached(ShaderProgram* program, const std::string& file, uint64_t key, const std::string& identity) {
+            unsigned int format = 0;
+            std::string binary;
+            if (!program->get_binary(format, binary))
+                return;
+
+            const std::string dir = file_system::parent_directory(file);
+            if (!file_system::is_directory(dir) && !file_system::create_directory(dir))
+                return;
+
+            const uint32_t identity_size = static_cast<uint32_t>(identity.size());
+            const uint32_t binary_format = format;
+            const uint64_t checksum = hash_range(binary.begin(), binary.end());
+            std::string data(cache_magic, sizeof(cache_magic));
+            data.append(reinterpret_cast<const char*>(&key), sizeof(uint64_t));
+            data.append(reinterpret_cast<const char*>(&identity_size), sizeof(uint32_t));
+            data.append(identity);
+            data.append(reinterpret_cast<const char*>(&binary_format), sizeof(uint32_t));
+            data.append(reinterpret_cast<const char*>(&checksum), sizeof(uint64_t));
+            data.append(binary);
+
+            // written aside (to a file of this process, so concurrent writers do not interleave) and then renamed over
+            // the target, so a reader never sees a partial or missing file
+            const std::string tmp_file = file + "." + std::to_string(process_id()) + ".tmp";
+            file_system::write_string_to_file(data, tmp_file);
+            if (!replace_file(tmp_file, file)) {
+                LOG_FIRST_N(WARNING, 1) << "failed writing program binary cache: " << file << " (this is the first record)";
+                file_system::delete_file(tmp_file);
+            }
+        }
+
+
+        // creates a program from the code of its shaders, or from its cached binary if the cache directory is given
+        ShaderProgram* create_program(const std::string& name, const ShaderCodes& codes,
+                                      const std::vector<ShaderProgram::Attribute>& attributes,
+                                      const std::vector<std::string>& outputs,
+                                      const std::string& cache_directory)
+        {
+            ShaderProgram* program = new ShaderProgram(name);
+
+            const bool cached = !cache_directory.empty() && OpenglInfo::is_supported("GL_ARB_get_program_binary");
+            std::string file, identity;
+            uint64_t key = 0;
+            if (cached) {
+                key = program_key(name, codes, attributes, outputs);
+                file = cache_file(cache_directory, key);
+                identity = driver_identity();
+                if (load_cached(program, file, key, identity))
+                    return program;
+            }
+
+            for (const auto& c : codes) {
+                if (!program->load_shader_from_code(c.first, c.second)) {
+                    delete program;
+                    return nullptr;
+                }
+            }
+
+            program->set_attrib_names(attributes);	easy3d_debug_log_gl_error;
+            for (std::size_t i = 0; i < outputs.size(); ++i)
+                program->set_program_output(static_cast<int>(i), outputs[i]);
+
+            if (cached)
+                glProgramParameteri(program->get_program(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+            const bool success = program->link_program();	easy3d_debug_log_gl_error;
+            if (!success) {
+                delete program;
+                return nullptr;
+            }
+
+            if (cached)
+                save_cached(program, file, key, identity);
+            return program;
+        }
+
+    }
 
 
     ShaderProgram* ShaderManager::get_program(const std::string& shader_name) {
@@ -44,71 +285,62 @@ namespace easy3d {
     }
 
 
+    ShaderProgram* ShaderManager::get_program(const std::string& shader_name, const std::vector<std::string>& defines) {
+        return get_program(details::variant_name(shader_name, defines));
+    }
+
+
     ShaderProgram* ShaderManager::create_program_from_files(
         const std::string& base_name,
         const std::vector<ShaderProgram::Attribute>& attributes /* = std::vector<ShaderProgram::Attribute>() */,
         const std::vector<std::string>& outputs /* = std::vector<std::string>() */,
-        bool geom_shader /* = false */ )
+        bool geom_shader /* = false */,
+        const std::vector<std::string>& defines /* = std::vector<std::string>() */ )
     {
-        std::unordered_map<std::string, bool>::iterator it = attempt_load_program_.find(base_name);
+        const std::string name = details::variant_name(base_name, defines);
+        std::unordered_map<std::string, bool>::iterator it = attempt_load_program_.find(name);
         if (it == attempt_load_program_.end())
-            attempt_load_program_[base_name] = true;
-        else if (!attempt_load_program_[base_name])
+            attempt_load_program_[name] = true;
+        else if (!attempt_load_program_[name])
             return nullptr;
 
         const std::string dir = resource::directory() + "/shaders/";
         const std::string vs_file = dir + base_name + ".vert";
         if (!file_system::is_file(vs_file)) {
             LOG_FIRST_N(ERROR, 1) << "vertex shader file \'" << vs_file + " does not exist (this is the first record)";
-            attempt_load_program_[base_name] = false;
+            attempt_load_program_[name] = false;
             return nullptr;
         }
         const std::string fs_file = dir + base_name + ".frag";
         if (!file_system::is_file(fs_file)) {
             LOG_FIRST_N(ERROR, 1) << "fragment shader file \'" << fs_file + " does not exist (this is the first record)";
-            attempt_load_program_[base_name] = false;
+            attempt_load_program_[name] = false;
             return nullptr;
         }
         const std::string gs_file = dir + base_name + ".geom";
         if (geom_shader && !file_system::is_file(gs_file)) {
             LOG_FIRST_N(ERROR, 1) << "geometry shader file \'" << gs_file + " does not exist (this is the first record)";
-            attempt_load_program_[base_name] = false;
-            return nullptr;
-        }
-
-        ShaderProgram* program = new ShaderProgram(base_name);
-
-        bool success = program->load_shader_from_file(ShaderProgram::VERTEX, vs_file);
-        if (!success) {
-            delete program;
-            return nullptr;
-        }
-
-        success = program->load_shader_from_file(ShaderProgram::FRAGMENT, fs_file);
-        if (!success) {
-            delete program;
+            attempt_load_program_[name] = false;
             return nullptr;
         }
 
-        if (geom_shader) {
-            success = program->load_shader_from_file(ShaderProgram::GEOMETRY, gs_file);
-            if (!success) {
-                delete program;
+        details::ShaderCodes codes;
+        codes.emplace_back(ShaderProgram::VERTEX, details::shader_code(vs_file, defines));
+        codes.emplace_back(ShaderProgram::FRAGMENT, details::shader_code(fs_file, defines));
+        if (geom_shader)
+            codes.emplace_back(ShaderProgram::GEOMETRY, details::shader_code(gs_file, defines));
+        for (const auto& c : codes) {
+            if (c.second.empty()) {
+                LOG(ERROR) << "failed reading the shaders of program \'" << name << "\'";
                 return nullptr;
             }
         }
 
-        program->set_attrib_names(attributes);	easy3d_debug_log_gl_error;
-        for (std::size_t i = 0; i < outputs.size(); ++i)
-            program->set_program_output(static_cast<int>(i), outputs[i]);
-
-        success = program->link_program();	easy3d_debug_log_gl_error;
-        if (!success) {
-            delete program;
+        ShaderProgram* program = details::create_program(name, codes, attributes, outputs, cache_directory_);
+        if (!program)
             return nullptr;
-        }
 
-        programs_[base_name] = program;
+        programs_[name] = program;
         return program;
     }
 
@@ -153,49 +385,31 @@ namespace easy3d {
 			return nullptr;
 		}
 
-		ShaderProgram* program = new ShaderProgram(name);
+		details::ShaderCodes codes;
 
 		std::string vert_code;
         file_system::read_file_to_string(vert_file, vert_code);
 		if (!extra_vert_code.empty())
 			string::replace_substring(vert_code, "//INSERT", extra_vert_code);
-        bool success = program->load_shader_from_code(ShaderProgram::VERTEX, vert_code);
-        if (!success) {
-            delete program;
-            return nullptr;
-        }
-		
+		codes.emplace_back(ShaderProgram::VERTEX, vert_code);
+
 		std::string frag_code;
         file_system::read_file_to_string(frag_file, frag_code);
 		if (!extra_frag_code.empty())
 			string::replace_substring(frag_code, "//INSERT", extra_frag_code);
-        success = program->load_shader_from_code(ShaderProgram::FRAGMENT, frag_code);
-        if (!success) {
-            delete program;
-            return nullptr;
-        }
+		codes.emplace_back(ShaderProgram::FRAGMENT, frag_code);
 
 		if (!geom_file_name.empty()) {
 			std::string geom_code;
             file_system::read_file_to_string(geom_file, geom_code);
 			if (!extra_geom_code.empty())
 				string::replace_substring(geom_code, "//INSERT", extra_geom_code);
-            success = program->load_shader_from_code(ShaderProgram::GEOMETRY, geom_code);
-            if (!success) {
-                delete program;
-                return nullptr;
-            }
+			codes.emplace_back(ShaderProgram::GEOMETRY, geom_code);
 		}
 
-		program->set_attrib_names(attributes);	easy3d_debug_log_gl_error;
-		for (std::size_t i = 0; i < outputs.size(); ++i)
-			program->set_program_output(static_cast<int>(i), outputs[i]);
-
-        success = program->link_program();	easy3d_debug_log_gl_error;
-        if (!success) {
-            delete program;
-            return nullptr;
-        }
+		ShaderProgram* program = details::create_program(name, codes, attributes, outputs, cache_directory_);
+		if (!program)
+			return nullptr;
 
 		programs_[name] = program;
 		return program;
@@ -220,6 +434,11 @@ namespace easy3d {
     }
 
 
+    void ShaderManager::set_cache_directory(const std::string& dir) {
+        cache_directory_ = dir;
+    }
+
+
 	void ShaderManager::reload() {
 		// simply delete all. the programs will be loaded if needed
 		terminate();
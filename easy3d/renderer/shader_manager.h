@@ -45,12 +45,20 @@ namespace easy3d {
         // shader_name: the base name of the program's source file.
         static ShaderProgram* get_program(const std::string& shader_name);
 
+        // return the variant of the program compiled with the given preprocessor definitions if it exists and is
+        // working, otherwise return 0. With no definitions, this is the same as get_program(shader_name).
+        static ShaderProgram* get_program(const std::string& shader_name, const std::vector<std::string>& defines);
+
         // create a shader program from shader source files specified by the shader file's base name.
+        // defines: the preprocessor definitions (e.g., "QUANTIZED_VERTEX") inserted into all the shaders right after
+        //          the #version directive. A program can thus have several variants sharing the same source files,
+        //          each of which is retrieved by get_program(shader_name, defines).
         static ShaderProgram* create_program_from_files(
             const std::string& file_base_name,
             const std::vector<ShaderProgram::Attribute>& attributes = std::vector<ShaderProgram::Attribute>(),
             const std::vector<std::string>& outputs = std::vector<std::string>(),
-            bool geom_shader = false
+            bool geom_shader = false,
+            const std::vector<std::string>& defines = std::vector<std::string>()
         );
 
         // create a shader program from shader source files specified by individual file names.
@@ -68,6 +76,14 @@ namespace easy3d {
 
         static std::vector<ShaderProgram*> all_programs();
 
+        // the directory of the program binary cache (empty by default, i.e., no cache). Creating a program from its
+        // binary is much faster than compiling and linking it. The binaries are stored when the programs are built,
+        // and are reused as long as the sources, the attribute bindings, the outputs, and the OpenGL driver (vendor,
+        // renderer, and version) are the same. Otherwise (and if a binary is damaged or rejected) the program is built
+        // from source again and the cache is updated. Requires OpenGL >= 4.1.
+        static void set_cache_directory(const std::string& dir);
+        static const std::string& cache_directory() { return cache_directory_; }
+
         // destroy all shader programs.
         static void terminate();
 
@@ -78,6 +94,7 @@ namespace easy3d {
         // as find forces construction/copy/destruction of a std::sting copy of the const char*.
         static std::unordered_map<std::string, ShaderProgram*>	programs_;
         static std::unordered_map<std::string, bool>			attempt_load_program_; // avoid multiple attempt
+        static std::string                                      cache_directory_;
     };
 
 }
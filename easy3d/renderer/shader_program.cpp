@@ -42,6 +42,7 @@
 #include <cassert>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #include <easy3d/renderer/opengl.h>
 #include <easy3d/renderer/opengl_info.h>
@@ -1359,11 +1360,75 @@ namespace easy3d {
         }
 
 		std::string code = _read_file(file_name);
-		if (code.empty()) {
+		if (code.size() <= 4) {
 			LOG(ERROR) << "empty program in file: " << file_name;
 			return false;
 		}
 
+		const GLenum format = *(const GLenum*)(code.data());
+		if (!set_binary(format, code.substr(4))) {
+			LOG(ERROR) << "load program failed: " << file_name;
+			return false;
+		}
+		return true;
+	}
+
+
+    bool ShaderProgram::save_binary(const std::string& file_name) {
+        if (!OpenglInfo::is_supported("GL_ARB_get_program_binary")) {
+            LOG(ERROR) << "save binary program requires OpenGL >= 4.1";
+            return false;
+        }
+
+        unsigned int format = 0;
+        std::string binary;
+        if (!get_binary(format, binary))
+            return false;
+
+		std::ofstream stream;
+		stream.open(file_name.c_str(), std::ios::binary | std::ios::out);
+		if (stream.is_open()) {
+			stream.write((const char*)&format, 4);
+			stream.write(binary.data(), binary.size());
+            return true;
+		}
+        return false;
+	}
+
+
+    bool ShaderProgram::get_binary(unsigned int& format, std::string& binary) {
+		// check the program linked or not
+		std::string log;
+		if (!program_info_log(log)) {
+            LOG(ERROR) << "program not linked yet." <<
+                         (!log.empty() ? " " + log  : "");
+            return false;
+		}
+
+        int length = 0;
+		glGetProgramiv(program_, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+		    return false;
+
+		binary.resize(length);
+		GLenum binary_format = 0;
+		glGetProgramBinary(program_, length, &length, &binary_format, &binary[0]);
+		binary.resize(length);
+		format = binary_format;
+		return length > 0;
+	}
+
+
+    bool ShaderProgram::set_binary(unsigned int format, const std::string& binary) {
+        // a format not supported (any more) would raise an OpenGL error
+        int num = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num);
+        std::vector<int> formats(num);
+        if (num > 0)
+            glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+        if (binary.empty() || std::find(formats.begin(), formats.end(), static_cast<int>(format)) == formats.end())
+            return false;
+
 		if (program_)
 			clear();
 		program_ = glCreateProgram();
@@ -1372,10 +1437,9 @@ namespace easy3d {
 			return false;
 		}
 
-		const char* bindata = &code[0];
-		glProgramBinary(program_, *(GLenum*)bindata, bindata + 4, GLsizei(code.size() - 4));
-		
-		// check the program linked or not
+		glProgramBinary(program_, format, binary.data(), GLsizei(binary.size()));
+
+		// the driver may reject the binary, e.g., it has been updated
 		std::string log;
 		if (program_info_log(log)) {
 			_add_uniforms();	
@@ -1393,43 +1457,9 @@ namespace easy3d {
 			return true;
 		}
 		else {
-			LOG(ERROR) << "load program failed: " << log;
 			clear(); // we don't need the program anymore; Also don't leak shaders either.
 			return false;
 		}
 	}
 
-
-    bool ShaderProgram::save_binary(const std::string& file_name) {
-        if (!OpenglInfo::is_supported("GL_ARB_get_program_binary")) {
-            LOG(ERROR) << "save binary program requires OpenGL >= 4.1";
-            return false;
-        }
-
-		// check the program linked or not
-		std::string log;
-		if (!program_info_log(log)) {
-            LOG(ERROR) << "program not linked yet." <<
-                         (!log.empty() ? " " + log  : "");
-            return false;
-		}
-
-        int datasize;
-        int datasize2;
-		glGetProgramiv(program_, GL_PROGRAM_BINARY_LENGTH, &datasize);
-
-		std::string binraw;
-		binraw.resize(datasize + 4);
-		char* bindata = &binraw[0];
-		glGetProgramBinary(program_, datasize, &datasize2, (GLenum*)bindata, bindata + 4);
-
-		std::ofstream stream;
-		stream.open(file_name.c_str(), std::ios::binary | std::ios::out);
-		if (stream.is_open()) {
-			stream.write(bindata, datasize + 4);
-            return true;
-		}
-        return false;
-	}
-
 }
@@ -248,6 +248,13 @@ namespace easy3d {
 		bool load_binary(const std::string& file_name);
         bool save_binary(const std::string& file_name);
 
+		// The binary of the program and its format, e.g., for caching the program (see ShaderManager). Some drivers
+		// only provide the binary if GL_PROGRAM_BINARY_RETRIEVABLE_HINT was set before linking.
+		bool get_binary(unsigned int& format, std::string& binary);
+		// Restores the program from a binary. It fails quietly if the format is not supported or the driver rejects
+		// the binary (e.g., the driver has been updated), in which case the program must be built from source.
+		bool set_binary(unsigned int format, const std::string& binary);
+
 	protected:
 
 		// AUX STRUCTURES
@@ -96,10 +96,12 @@ namespace easy3d {
 
 
     bool VertexArrayObject::create_array_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size, std::size_t dim, bool dynamic) {
-        release_buffer(buffer);
 		bind();
-        glGenBuffers(1, &buffer);                       easy3d_debug_log_gl_error;
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);                   easy3d_debug_log_gl_error;
+        }
         glBindBuffer(GL_ARRAY_BUFFER, buffer);			easy3d_debug_log_gl_error;
+        // re-specifying the data store of an existing buffer orphans the old one
         glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);		easy3d_debug_log_gl_error;
         glEnableVertexAttribArray(index);               easy3d_debug_log_gl_error;
         glVertexAttribPointer(index, int(dim), GL_FLOAT, GL_FALSE, 0, nullptr);		easy3d_debug_log_gl_error;
@@ -115,10 +117,12 @@ namespace easy3d {
 
 
     bool VertexArrayObject::create_element_buffer(GLuint &buffer, const void *data, std::size_t size, bool dynamic) {
-        release_buffer(buffer);
 		bind();
-        glGenBuffers(1, &buffer);                                           easy3d_debug_log_gl_error;
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);                                       easy3d_debug_log_gl_error;
+        }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);                      easy3d_debug_log_gl_error;
+        // re-specifying the data store of an existing buffer orphans the old one
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);		easy3d_debug_log_gl_error;
         if (glGetError() != GL_NO_ERROR) {
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);                       easy3d_debug_log_gl_error;
@@ -131,6 +135,63 @@ namespace easy3d {
 	}
 
 
+    bool VertexArrayObject::create_buffer(GLuint& buffer, const void* data, std::size_t size, bool dynamic) {
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);                   easy3d_debug_log_gl_error;
+        }
+        // the array buffer binding is not part of the VAO state, so no VAO is involved here
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);			easy3d_debug_log_gl_error;
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);		easy3d_debug_log_gl_error;
+        if (glGetError() != GL_NO_ERROR) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);           easy3d_debug_log_gl_error;
+            glDeleteBuffers(1, &buffer);                easy3d_debug_log_gl_error;
+            buffer = 0;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);               easy3d_debug_log_gl_error;
+        return (glGetError() == GL_NO_ERROR);
+    }
+
+
+    bool VertexArrayObject::bind_array_buffer(GLuint buffer, GLuint index, std::size_t dim) {
+        return bind_array_buffer(buffer, index, dim, GL_FLOAT, false, 0, 0);
+    }
+
+
+    bool VertexArrayObject::bind_array_buffer(GLuint buffer, GLuint index, std::size_t dim, GLenum type,
+                                              bool normalized, std::size_t stride, std::size_t offset) {
+        assert(buffer != 0);
+        bind();
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);			easy3d_debug_log_gl_error;
+        glEnableVertexAttribArray(index);               easy3d_debug_log_gl_error;
+        glVertexAttribPointer(index, int(dim), type, normalized ? GL_TRUE : GL_FALSE, GLsizei(stride),
+                              reinterpret_cast<const void*>(offset));		easy3d_debug_log_gl_error;
+        glBindBuffer(GL_ARRAY_BUFFER, 0);               easy3d_debug_log_gl_error;
+        release();
+        return (glGetError() == GL_NO_ERROR);
+    }
+
+
+    bool VertexArrayObject::update_array_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+        assert(buffer != 0);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);                              easy3d_debug_log_gl_error;
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);               easy3d_debug_log_gl_error;
+        glBindBuffer(GL_ARRAY_BUFFER, 0);                                   easy3d_debug_log_gl_error;
+        return (glGetError() == GL_NO_ERROR);
+    }
+
+
+    bool VertexArrayObject::update_element_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+        assert(buffer != 0);
+        // the element array buffer binding is part of the VAO state
+        bind();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);                      easy3d_debug_log_gl_error;
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);       easy3d_debug_log_gl_error;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);                           easy3d_debug_log_gl_error;
+        release();
+        return (glGetError() == GL_NO_ERROR);
+    }
+
+
     bool VertexArrayObject::create_storage_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size) {
         if (!OpenglInfo::is_supported("GL_ARB_shader_storage_buffer_object")) {
             LOG(ERROR) << "shader storage buffer object not supported on this platform";
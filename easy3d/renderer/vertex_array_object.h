@@ -70,6 +70,10 @@ namespace easy3d {
 		// @param index: the index of the generic vertex attribute.
         /**
          * @brief Creates an OpenGL array buffer and upload data to the buffer.
+         * @details If \p buffer already exists, its data store is re-specified instead of deleting and re-creating
+         *      the buffer object. The old data store is orphaned, i.e., the driver can hand out a new one without
+         *      waiting for the pending draw calls that still read from the old one. This is the preferred way to
+         *      rewrite the whole buffer.
          * @param handle The name of the buffer object.
          * @param index  The index of the generic vertex attribute to be enabled.
          * @param data   The pointer to the data.
@@ -81,6 +85,54 @@ namespace easy3d {
         bool create_array_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size, std::size_t dim, bool dynamic = false);
         bool create_element_buffer(GLuint& buffer, const void* data, std::size_t size, bool dynamic = false);
 
+        /**
+         * @brief Updates a subset of the data store of an existing array buffer (using glBufferSubData()).
+         * @param buffer The name of the buffer object.
+         * @param offset The offset into the buffer's data store where data replacement will begin, in bytes.
+         * @param size   The size in bytes of the data store region being replaced.
+         * @param data   The pointer to the new data that will be copied into the data store.
+         * @return \c true on success.
+         */
+        bool update_array_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+        bool update_element_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+        /**
+         * @brief Creates (or re-specifies) a buffer object that is not attached to any vertex array object, e.g., a
+         *      buffer shared by several vertex array objects.
+         * @param buffer The name of the buffer object.
+         * @param data   The pointer to the data.
+         * @param size   The size of the data in bytes.
+         * @param dynamic The expected usage pattern is GL_STATIC_DRAW or GL_DYNAMIC_DRAW.
+         * @return \c true on success.
+         * @sa bind_array_buffer().
+         */
+        static bool create_buffer(GLuint& buffer, const void* data, std::size_t size, bool dynamic = false);
+
+        /**
+         * @brief Attaches an existing array buffer to a generic vertex attribute of this vertex array object.
+         * @param buffer The name of the buffer object.
+         * @param index  The index of the generic vertex attribute to be enabled.
+         * @param dim    The number of components per generic vertex attribute. Must be 1, 2, 3, 4.
+         * @return \c true on success.
+         */
+        bool bind_array_buffer(GLuint buffer, GLuint index, std::size_t dim);
+
+        /**
+         * @brief Attaches an existing array buffer to a generic vertex attribute of this vertex array object, where
+         *      the attribute is stored in the buffer with the given type and layout, e.g., in an interleaved buffer.
+         * @param buffer The name of the buffer object.
+         * @param index  The index of the generic vertex attribute to be enabled.
+         * @param dim    The number of components per generic vertex attribute. Must be 1, 2, 3, 4.
+         * @param type   The data type of each component, e.g., GL_FLOAT, GL_UNSIGNED_SHORT, GL_UNSIGNED_BYTE.
+         * @param normalized Whether integer values are mapped to [0, 1] (unsigned) or [-1, 1] (signed) when they
+         *      are accessed, otherwise they are converted to floats directly.
+         * @param stride The byte offset between consecutive attributes (0: tightly packed).
+         * @param offset The byte offset of the first attribute in the buffer.
+         * @return \c true on success.
+         */
+        bool bind_array_buffer(GLuint buffer, GLuint index, std::size_t dim, GLenum type, bool normalized,
+                               std::size_t stride, std::size_t offset);
+
 		// @param index: the index of the binding point.
         bool create_storage_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size);
         bool update_storage_buffer(GLuint& buffer, GLintptr offset, GLsizeiptr size, const void* data);
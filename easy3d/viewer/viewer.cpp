@@ -41,7 +41,9 @@
 #include <easy3d/core/graph.h>
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/renderer/renderer.h>
+#include <easy3d/renderer/render_queue.h>
 #include <easy3d/renderer/drawable_points.h>
+#include <easy3d/renderer/drawable_points_lod.h>
 #include <easy3d/renderer/drawable_lines.h>
 #include <easy3d/renderer/drawable_triangles.h>
 #include <easy3d/renderer/shader_program.h>
@@ -57,6 +59,7 @@
 #include <easy3d/renderer/text_renderer.h>
 #include <easy3d/renderer/texture_manager.h>
 #include <easy3d/renderer/buffers.h>
+#include <easy3d/renderer/buffers_async.h>
 #include <easy3d/fileio/resources.h>
 #include <easy3d/fileio/point_cloud_io.h>
 #include <easy3d/fileio/graph_io.h>
@@ -94,7 +97,8 @@ namespace easy3d {
               full_screen_(full_screen), background_color_(0.9f, 0.9f, 1.0f, 1.0f),
               process_events_(true), texter_(nullptr), pressed_button_(-1), modifiers_(-1), drag_active_(false),
               mouse_current_x_(0), mouse_current_y_(0), mouse_pressed_x_(0), mouse_pressed_y_(0), pressed_key_(-1),
-              show_pivot_point_(false), drawable_axes_(nullptr), show_camera_path_(false), model_idx_(-1) {
+              show_pivot_point_(false), drawable_axes_(nullptr), show_camera_path_(false), model_idx_(-1),
+              render_queue_(new RenderQueue) {
         // Avoid locale-related number parsing issues.
         setlocale(LC_NUMERIC, "C");
 
@@ -470,7 +474,12 @@ namespace easy3d {
         delete camera_;
         delete drawable_axes_;
         delete texter_;
+        delete render_queue_;
+        render_queue_ = nullptr;
 
+        // the buffers being prepared refer to the models
+        buffers::AsyncUpdater::terminate();
+        buffers::AsyncUpdater::set_ready_callback(nullptr);
         clear_scene();
 
         ShaderManager::terminate();
@@ -1037,6 +1046,12 @@ namespace easy3d {
         texter_->add_font(resource::directory() + "/fonts/en_Earth-Normal.ttf");
         texter_->add_font(resource::directory() + "/fonts/en_Roboto-Medium.ttf");
 
+        // redraw when the buffers prepared asynchronously are ready to be uploaded (see buffers::AsyncUpdater)
+        buffers::AsyncUpdater::set_ready_callback([]() { glfwPostEmptyEvent(); });
+
+        // the shader programs are built from their binaries cached by the previous runs
+        ShaderManager::set_cache_directory(file_system::home_directory() + "/.easy3d/shader_cache");
+
         // print usage
         std::cout << usage() << std::endl;
     }
@@ -1348,7 +1363,12 @@ namespace easy3d {
             glClearColor(background_color_[0], background_color_[1], background_color_[2], background_color_[3]);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
+        // the snapshot shows the current state of the models: the buffers are not updated asynchronously
+        const bool async_update = buffers::AsyncUpdater::is_enabled();
+        buffers::AsyncUpdater::finish();
+        buffers::AsyncUpdater::set_enabled(false);
         const_cast<Viewer *>(this)->draw();
+        buffers::AsyncUpdater::set_enabled(async_update);
 
         fbo.release();
 
@@ -1450,6 +1470,21 @@ namespace easy3d {
         glClearColor(background_color_[0], background_color_[1], background_color_[2], 1.0f);
         glClearDepth(1.0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        // the buffers prepared asynchronously are uploaded within the time budget of a frame, the rest in the next
+        buffers::AsyncUpdater::upload();
+        if (buffers::AsyncUpdater::num_ready() > 0)
+            update();
+
+        // the level-of-detail drawables select (and upload) their nodes once per frame, before any rendering pass
+        for (auto d : drawables_) {
+            auto lod = dynamic_cast<PointsLodDrawable *>(d);
+            if (lod) {
+                lod->update(camera());
+                if (lod->num_pending_nodes() > 0)
+                    update();
+            }
+        }
     }
 
 
@@ -1525,42 +1560,18 @@ namespace easy3d {
 
 
     void Viewer::draw() const {
-        for (const auto m : models_) {
-            if (!m->renderer()->is_visible())
-                continue;
-
-            // Let's check if edges and surfaces are both shown. If true, we
-            // make the depth coordinates of the surface smaller, so that displaying
-            // the mesh and the surface together does not cause Z-fighting.
-            std::size_t count = 0;
-            for (auto d : m->renderer()->lines_drawables()) {
-                if (d->is_visible()) {
-                    d->draw(camera(), false); easy3d_debug_log_gl_error;
-                    ++count;
-                }
-            }
-
-            for (auto d : m->renderer()->points_drawables()) {
-                if (d->is_visible())
-                    d->draw(camera(), false); easy3d_debug_log_gl_error;
-            }
+        // The drawables are submitted through the render queue, which sorts them by their state and draws the
+        // surfaces of many small models in a few draw calls. For each model with both edges and surfaces shown, the
+        // depth coordinates of the surface are made smaller, so that displaying the mesh and the surface together
+        // does not cause Z-fighting.
+        for (const auto m : models_)
+            render_queue_->add(m);
 
-            if (count > 0) {
-                glEnable(GL_POLYGON_OFFSET_FILL);
-                glPolygonOffset(0.5f, -0.0001f);
-            }
-            for (auto d : m->renderer()->triangles_drawables()) {
-                if (d->is_visible())
-                    d->draw(camera(), false); easy3d_debug_log_gl_error;
-            }
-            if (count > 0)
-                glDisable(GL_POLYGON_OFFSET_FILL);
-        }
+        for (auto d : drawables_)
+            render_queue_->add(d);
 
-        for (auto d : drawables_) {
-            if (d->is_visible())
-                d->draw(camera(), false);
-        }
+        render_queue_->draw(camera());
+        easy3d_debug_log_gl_error;
     }
 
 
@@ -40,6 +40,7 @@ namespace easy3d {
 	class Model;
     class Drawable;
     class TrianglesDrawable;
+    class RenderQueue;
     class TextRenderer;
 
     /**
@@ -263,6 +264,14 @@ namespace easy3d {
          */
         const std::vector<Drawable*>& drawables() const { return drawables_; }
 
+        /**
+         * @brief The render queue through which the models and drawables are drawn.
+         * @details The queue sorts the drawables by their shader and state and batches the surfaces of many small
+         *          models (see RenderQueue). It can be configured, e.g., to disable the batching, or to report the
+         *          CPU time of the submission of each frame.
+         */
+        RenderQueue* render_queue() const { return render_queue_; }
+
         /**
          * @brief Delete all visual contents of the viewer (all models and drawables).
          */
@@ -443,6 +452,8 @@ namespace easy3d {
 
         // drawables independent of any model
         std::vector<Drawable*> drawables_;
+
+        RenderQueue* render_queue_;
 	};
 
 }
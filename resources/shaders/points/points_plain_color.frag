@@ -24,6 +24,7 @@ in Data{
     vec4 color;
     vec3 position;
     vec3 normal;
+    flat int vertex_id;
 } DataIn;
 
 out vec4 outputF;
@@ -39,7 +40,7 @@ void main(void) {
         color = backside_color;
 
     if (highlight) {
-        if (gl_PrimitiveID >= hightlight_id_min && gl_PrimitiveID <= hightlight_id_max)
+        if (DataIn.vertex_id >= hightlight_id_min && DataIn.vertex_id <= hightlight_id_max)
         color = mix(color, vec3(1.0, 0.0, 0.0), 0.8);
     }
 
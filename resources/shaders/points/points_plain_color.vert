@@ -1,8 +1,34 @@
 #version 150
 
+#ifdef QUANTIZED_VERTEX
+// the attributes are quantized (see Drawable::VF_QUANTIZED)
+in  vec4 vtx_position;// point position relative to its tile, in [0, 1], and the tile index
+in  vec3 vtx_color;// point color
+in  vec2 vtx_normal;// octahedral-encoded point normal
+
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+
+vec3 decode_normal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#else
 in  vec3 vtx_position;// point position
 in  vec3 vtx_color;// point color
 in  vec3 vtx_normal;// point normal
+#endif
 
 uniform mat4    MVP;
 uniform vec4    default_color = vec4(0.0f, 1.0f, 0.0f, 1.0f);
@@ -17,23 +43,33 @@ out Data{
     vec4 color;
     vec3 position;
     vec3 normal;
+    flat int vertex_id;    // the index of the point (the primitive ID differs if the points are reordered)
 } DataOut;
 
 
 void main(void) {
-    DataOut.position = vtx_position;
-    DataOut.normal = vtx_normal;
+#ifdef QUANTIZED_VERTEX
+    vec3 position = decode_position(vtx_position);
+    vec3 normal = decode_normal(vtx_normal);
+#else
+    vec3 position = vtx_position;
+    vec3 normal = vtx_normal;
+#endif
+
+    DataOut.position = position;
+    DataOut.normal = normal;
+    DataOut.vertex_id = gl_VertexID;
 
     if (per_vertex_color)
         DataOut.color = vec4(vtx_color, 1.0);
     else
         DataOut.color = default_color;
 
-    gl_Position = MVP * vec4(vtx_position, 1.0);
+    gl_Position = MVP * vec4(position, 1.0);
 
     if (clippingPlaneEnabled) {
-        gl_ClipDistance[0] = dot(vec4(vtx_position, 1.0), clippingPlane0);
+        gl_ClipDistance[0] = dot(vec4(position, 1.0), clippingPlane0);
         if (crossSectionEnabled)
-            gl_ClipDistance[1] = dot(vec4(vtx_position, 1.0), clippingPlane1);
+            gl_ClipDistance[1] = dot(vec4(position, 1.0), clippingPlane1);
     }
 }
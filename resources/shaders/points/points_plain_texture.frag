@@ -31,6 +31,7 @@ in Data{
 	vec3 position;
 	vec2 texcoord;
 	vec3 normal;
+	flat int vertex_id;
 } DataIn;
 
 
@@ -46,7 +47,7 @@ void main()
 	}
 
 	if (highlight) {
-		if (gl_PrimitiveID >= hightlight_id_min && gl_PrimitiveID <= hightlight_id_max)
+		if (DataIn.vertex_id >= hightlight_id_min && DataIn.vertex_id <= hightlight_id_max)
 			color = mix(color, vec3(1.0, 0.0, 0.0), 0.8);
 	}
 
@@ -1,9 +1,35 @@
 #version 150
 // please send comments or report bug to: liangliang.nan@gmail.com
 
+#ifdef QUANTIZED_VERTEX
+// the attributes are quantized (see Drawable::VF_QUANTIZED)
+in vec4 vtx_position;   // relative to its tile, in [0, 1], and the tile index
+in vec2 vtx_texcoord;
+in vec2 vtx_normal;     // octahedral-encoded
+
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+
+vec3 decode_normal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#else
 in vec3 vtx_position;
 in vec2 vtx_texcoord;
 in vec3 vtx_normal;
+#endif
 
 uniform mat4    MVP;
 
@@ -17,20 +43,30 @@ out Data{
     vec3 position;
     vec2 texcoord;
     vec3 normal;
+    flat int vertex_id;    // the index of the point (the primitive ID differs if the points are reordered)
 } DataOut;
 
 
 void main() {
-    DataOut.position = vtx_position;
+#ifdef QUANTIZED_VERTEX
+    vec3 position = decode_position(vtx_position);
+    vec3 normal = decode_normal(vtx_normal);
+#else
+    vec3 position = vtx_position;
+    vec3 normal = vtx_normal;
+#endif
+
+    DataOut.position = position;
     DataOut.texcoord = vtx_texcoord;
-    DataOut.normal = vtx_normal;
+    DataOut.normal = normal;
+    DataOut.vertex_id = gl_VertexID;
 
     // Output position of the vertex, in clip space : MVP * position
-    gl_Position = MVP * vec4(vtx_position, 1.0);
+    gl_Position = MVP * vec4(position, 1.0);
 
     if (clippingPlaneEnabled) {
-        gl_ClipDistance[0] = dot(vec4(vtx_position, 1.0), clippingPlane0);
+        gl_ClipDistance[0] = dot(vec4(position, 1.0), clippingPlane0);
         if (crossSectionEnabled)
-        gl_ClipDistance[1] = dot(vec4(vtx_position, 1.0), clippingPlane1);
+        gl_ClipDistance[1] = dot(vec4(position, 1.0), clippingPlane1);
     }
 }
@@ -1,18 +1,42 @@
 #version 330 core   // for geometry shader to work
 // please send comments or report bug to: liangliang.nan@gmail.com
 
+#ifdef QUANTIZED_VERTEX
+in vec4  vtx_position;  // relative to its tile, in [0, 1], and the tile index
+#else
 in vec3  vtx_position;
+#endif
 in vec2  vtx_texcoord;
+
+#ifdef QUANTIZED_VERTEX
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+#endif
 //in float sphere_radius;
 
 out		vec2	texcoord;
 //out float	sphere_radius_in;
+flat out int	vertex_id;    // the index of the point (the primitive ID differs if the points are reordered)
 
 void main()
 {  
 	texcoord = vtx_texcoord;
 
 	//sphere_radius_in = sphere_radius;
+	vertex_id = gl_VertexID;
 
+#ifdef QUANTIZED_VERTEX
+	gl_Position = vec4(decode_position(vtx_position), 1.0);
+#else
 	gl_Position = vec4(vtx_position, 1.0);
+#endif
 }
\ No newline at end of file
@@ -25,6 +25,7 @@ uniform int  hightlight_id_max;
 in Data{
     vec4    position;// in eye space
     vec4    sphere_color;
+    flat int vertex_id;
 //float	sphere_radius;
 } DataIn;
 
@@ -88,7 +89,7 @@ void main()
 
         vec3 color = DataIn.sphere_color.xyz;
         if (highlight) {
-            if (gl_PrimitiveID >= hightlight_id_min && gl_PrimitiveID <= hightlight_id_max)
+            if (DataIn.vertex_id >= hightlight_id_min && DataIn.vertex_id <= hightlight_id_max)
             color = mix(color, vec3(1.0, 0.0, 0.0), 0.8);
         }
 
@@ -137,7 +138,7 @@ void main()
 
         vec3 color = DataIn.sphere_color.xyz;
         if (highlight) {
-            if (gl_PrimitiveID >= hightlight_id_min && gl_PrimitiveID <= hightlight_id_max)
+            if (DataIn.vertex_id >= hightlight_id_min && DataIn.vertex_id <= hightlight_id_max)
             color = mix(color, vec3(1.0, 0.0, 0.0), 0.8);
         }
 
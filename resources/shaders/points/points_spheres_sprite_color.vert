@@ -4,8 +4,26 @@
 uniform mat4 MV;
 uniform mat4 PROJ;
 
+#ifdef QUANTIZED_VERTEX
+in vec4  vtx_position;  // relative to its tile, in [0, 1], and the tile index
+#else
 in vec3  vtx_position;
+#endif
 in vec3  vtx_color;
+
+#ifdef QUANTIZED_VERTEX
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+#endif
 //in float sphere_radius;
 
 uniform int	    screen_width;   // scale to calculate size in pixels
@@ -21,6 +39,7 @@ uniform vec4 clippingPlane1;
 out Data {
     vec4    position;// in eye space
     vec4    sphere_color;
+    flat int vertex_id;    // the index of the point (the primitive ID differs if the points are reordered)
 //float	sphere_radius;
 } DataOut;
 
@@ -32,9 +51,14 @@ void main()
         else
             DataOut.sphere_color = default_color;
 	//DataOut.sphere_radius = sphere_radius;
+    DataOut.vertex_id = gl_VertexID;
 
 	// Output vertex position
+#ifdef QUANTIZED_VERTEX
+        DataOut.position = MV * vec4(decode_position(vtx_position), 1.0); // eye space
+#else
         DataOut.position = MV * vec4(vtx_position, 1.0); // eye space
+#endif
 
 	// http://stackoverflow.com/questions/8608844/resizing-point-sprites-based-on-distance-from-the-camera
 	vec4 projCorner = PROJ * vec4(sphere_radius, sphere_radius, DataOut.position.z, DataOut.position.w);
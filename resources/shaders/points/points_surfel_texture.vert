@@ -1,21 +1,57 @@
 #version 330   // for geometry shader to work
 // please send comments or report bug to: liangliang.nan@gmail.com
 
+#ifdef QUANTIZED_VERTEX
+// the attributes are quantized (see Drawable::VF_QUANTIZED)
+in  vec4 vtx_position;  // point position relative to its tile, in [0, 1], and the tile index
+in  vec2 vtx_texcoord;  // texture coordinate
+in  vec2 vtx_normal;    // octahedral-encoded point normal
+
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+
+vec3 decode_normal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#else
 in  vec3 vtx_position;  // point position
 in  vec2 vtx_texcoord;  // texture coordinate
 in  vec3 vtx_normal;    // point normal
+#endif
 
 out VertexData
 {
     vec2  texcoord;
     vec3  normal;
+    flat int vertex_id;    // the index of the point (the primitive ID differs if the points are reordered)
 } vertexOut;
 
 
 void main()
 {
-    gl_Position = vec4(vtx_position, 1.0);
+#ifdef QUANTIZED_VERTEX
+    vec3 position = decode_position(vtx_position);
+    vec3 normal = decode_normal(vtx_normal);
+#else
+    vec3 position = vtx_position;
+    vec3 normal = vtx_normal;
+#endif
+
+    gl_Position = vec4(position, 1.0);
 
     vertexOut.texcoord = vtx_texcoord;
-    vertexOut.normal = vtx_normal;
+    vertexOut.normal = normal;
+    vertexOut.vertex_id = gl_VertexID;
 }
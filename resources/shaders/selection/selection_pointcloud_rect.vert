@@ -1,7 +1,24 @@
 #version 430
 // please send comments or report bug to: liangliang.nan@gmail.com
 
+#ifdef QUANTIZED_VERTEX
+// the attributes are quantized (see Drawable::VF_QUANTIZED)
+in  vec4		vtx_position;	// vertex position relative to its tile, and the tile index
+
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+#else
 in  vec3		vtx_position;	// vertex position
+#endif
 
 uniform mat4	MVP;		// model-view-projection matrix
 uniform ivec4	viewport;		// view port
@@ -15,7 +32,11 @@ layout(std430, binding = 1) buffer selection_t {
 
 void main()
 {
+#ifdef QUANTIZED_VERTEX
+	vec4 p = MVP * vec4(decode_position(vtx_position), 1.0);
+#else
 	vec4 p = MVP * vec4(vtx_position, 1.0);
+#endif
 	float x = p.x / p.w * 0.5 + 0.5;
 	float y = p.y / p.w * 0.5 + 0.5;
 	x = x * viewport[2] + viewport[0];
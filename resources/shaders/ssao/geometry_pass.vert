@@ -1,7 +1,32 @@
 #version 150
 
+#ifdef QUANTIZED_VERTEX
+// the attributes are quantized (see Drawable::VF_QUANTIZED)
+in vec4 vtx_position;   // relative to its tile, in [0, 1], and the tile index
+in vec2 vtx_normal;     // octahedral-encoded normal
+
+uniform vec3  quantization_offset;  // the origin of the tiles
+uniform vec3  quantization_scale;   // the extent of a tile
+uniform ivec3 quantization_tiles;   // the number of tiles along each axis
+
+// the position is relative to its tile, whose (normalized) index is stored in the fourth component
+vec3 decode_position(vec4 q) {
+    int tile = int(q.w * 65535.0 + 0.5);
+    ivec3 t = ivec3(tile % quantization_tiles.x, (tile / quantization_tiles.x) % quantization_tiles.y,
+                    tile / (quantization_tiles.x * quantization_tiles.y));
+    return quantization_offset + quantization_scale * (vec3(t) + q.xyz);
+}
+
+vec3 decode_normal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#else
 in vec3 vtx_position;
 in vec3 vtx_normal;
+#endif
 
 out Data{
     vec3 position;
@@ -15,10 +40,14 @@ uniform mat4 PROJ;
 
 void main()
 {
+#ifdef QUANTIZED_VERTEX
+    vec4 viewPos = MV * vec4(decode_position(vtx_position), 1.0);
+    DataOut.normal = invMV * decode_normal(vtx_normal);
+#else
     vec4 viewPos = MV * vec4(vtx_position, 1.0);
-    DataOut.position = viewPos.xyz;
-
     DataOut.normal = invMV * vtx_normal;
+#endif
+    DataOut.position = viewPos.xyz;
     
     gl_Position = PROJ * viewPos;
 }
@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tests.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <easy3d/renderer/opengl.h>        // Initialize with glewInit()
+#include <3rd_party/glfw/include/GLFW/glfw3.h>    // Include glfw3.h after our OpenGL definitions
+#include <easy3d/util/logging.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    struct Test {
+        const char* name;
+        bool (*function)();
+        bool rendering;     // requires an OpenGL context
+    };
+
+    const std::vector<Test> tests = {
+            {"delaunay_queries",    test_delaunay_queries,    false},
+            {"ransac_tiled",        test_ransac_tiled,        false},
+            {"buffers_packing",     test_buffers_packing,     false},
+            {"point_cloud_lod",     test_point_cloud_lod,     false},
+            {"dirty_ranges",        test_dirty_ranges,        true},
+            {"quantization",        test_quantization,        true},
+            {"points_lod_drawable", test_points_lod_drawable, true},
+    };
+
+
+    // creates an invisible window providing the OpenGL context for the rendering tests
+    GLFWwindow* create_context() {
+        if (!glfwInit()) {
+            LOG(ERROR) << "could not initialize GLFW";
+            return nullptr;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        GLFWwindow* window = glfwCreateWindow(800, 600, "Tests", nullptr, nullptr);
+        if (!window) {
+            LOG(ERROR) << "could not create an OpenGL context";
+            glfwTerminate();
+            return nullptr;
+        }
+        glfwMakeContextCurrent(window);
+        glewExperimental = GL_TRUE;
+        if (glewInit() != GLEW_OK) {
+            LOG(ERROR) << "could not initialize GLEW";
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return nullptr;
+        }
+        glGetError(); // pull and ignore unhandled errors like GL_INVALID_ENUM
+        return window;
+    }
+
+}
+
+
+// Usage: Tests [name ...]. Runs the given tests, or all of them.
+int main(int argc, char** argv) {
+    logging::initialize(false, "", google::GLOG_WARNING);
+
+    std::vector<details::Test> selected;
+    for (const auto& test : details::tests) {
+        bool requested = (argc == 1);
+        for (int i = 1; i < argc; ++i)
+            requested = requested || (std::strcmp(argv[i], test.name) == 0);
+        if (requested)
+            selected.push_back(test);
+    }
+
+    GLFWwindow* window = nullptr;
+    int num_passed = 0, num_failed = 0;
+    for (const auto& test : selected) {
+        if (test.rendering && !window) {
+            window = details::create_context();
+            if (!window) {
+                std::cout << "[ SKIPPED ] " << test.name << " (no OpenGL context)" << std::endl;
+                continue;
+            }
+        }
+        std::cout << "[ RUN     ] " << test.name << std::endl;
+        const bool success = test.function();
+        std::cout << (success ? "[      OK ] " : "[  FAILED ] ") << test.name << std::endl;
+        if (success)
+            ++num_passed;
+        else
+            ++num_failed;
+    }
+
+    if (window) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    std::cout << num_passed << " of " << selected.size() << " tests passed" << std::endl;
+    return num_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,266 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tests.h"
+
+#include <cmath>
+#include <memory>
+
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/renderer/state.h>
+#include <easy3d/fileio/surface_mesh_io.h>
+#include <easy3d/fileio/resources.h>
+#include <easy3d/algo/surface_mesh_subdivision.h>
+#include <easy3d/algo/tessellator.h>
+#include <easy3d/util/stop_watch.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    // the area of the faces of a mesh (each face is split into a fan of triangles)
+    double faces_area(SurfaceMesh *mesh) {
+        double area = 0.0;
+        for (auto f : mesh->faces()) {
+            std::vector<vec3> corners;
+            for (auto v : mesh->vertices(f))
+                corners.push_back(mesh->position(v));
+            for (std::size_t i = 1; i + 1 < corners.size(); ++i)
+                area += length(cross(corners[i] - corners[0], corners[i + 1] - corners[0])) * 0.5;
+        }
+        return area;
+    }
+
+
+    // the area of the triangles of packed buffers (indexed if the element buffer is in use)
+    double triangles_area(const buffers::BufferData &data) {
+        const std::vector<vec3> &points = data.points.vector();
+        const std::vector<unsigned int> &indices = data.indices.vector();
+        const std::size_t num = data.indices.in_use() ? indices.size() : points.size();
+        double area = 0.0;
+        for (std::size_t i = 0; i + 2 < num; i += 3) {
+            const vec3 &a = points[data.indices.in_use() ? indices[i] : i];
+            const vec3 &b = points[data.indices.in_use() ? indices[i + 1] : i + 1];
+            const vec3 &c = points[data.indices.in_use() ? indices[i + 2] : i + 2];
+            area += length(cross(b - a, c - a)) * 0.5;
+        }
+        return area;
+    }
+
+
+    // the packing of the faces before the buffers_packing layer: the faces are triangulated one by one by the
+    // Tessellator, which also merges the duplicated vertices. Returns the number of triangles.
+    std::size_t tessellate_faces(SurfaceMesh *mesh, std::vector<vec3> &points, std::vector<vec3> &normals,
+                                 std::vector<unsigned int> &indices) {
+        auto triangle_range = mesh->face_property<std::pair<int, int> >("f:triangle_range");
+        auto positions = mesh->get_vertex_property<vec3>("v:point");
+        mesh->update_vertex_normals();
+        auto vertex_normals = mesh->get_vertex_property<vec3>("v:normal");
+
+        Tessellator tessellator;
+        int count_triangles = 0;
+        for (auto face : mesh->faces()) {
+            tessellator.begin_polygon(mesh->compute_face_normal(face));
+            tessellator.set_winding_rule(Tessellator::WINDING_NONZERO);
+            tessellator.begin_contour();
+            for (auto v : mesh->vertices(face)) {
+                Tessellator::Vertex vertex(positions[v], v.idx());
+                vertex.append(vertex_normals[v]);
+                tessellator.add_vertex(vertex);
+            }
+            tessellator.end_contour();
+            tessellator.end_polygon();
+
+            const int num = static_cast<int>(tessellator.num_elements_in_polygon());
+            triangle_range[face] = std::make_pair(count_triangles, count_triangles + num - 1);
+            count_triangles += num;
+        }
+
+        const std::vector<Tessellator::Vertex *> &vertices = tessellator.vertices();
+        points.clear();
+        normals.clear();
+        for (auto v : vertices) {
+            points.emplace_back(v->data());
+            normals.emplace_back(v->data() + 3);
+        }
+        indices.clear();
+        for (const auto &triangle : tessellator.elements())
+            indices.insert(indices.end(), triangle.begin(), triangle.end());
+        return tessellator.elements().size();
+    }
+
+
+    // checks the triangles packed for a polygonal mesh with each coloring scheme
+    bool check_triangles(SurfaceMesh *mesh) {
+        bool success = true;
+        const double area = faces_area(mesh);
+        const double tolerance = 1e-3 * area;
+
+        buffers::BufferData data;
+        State state;
+        EXPECT(buffers::pack_triangles(mesh, state, data));
+        // the positions are shared with the model, and the triangles cover the faces
+        EXPECT(data.points.vector().data() == mesh->points().data());
+        EXPECT(data.indices.in_use() && !data.colors.in_use());
+        EXPECT(std::abs(triangles_area(data) - area) < tolerance);
+
+        // the triangles of each face are contiguous
+        auto triangle_range = mesh->get_face_property<std::pair<int, int> >("f:triangle_range");
+        EXPECT(triangle_range);
+        if (triangle_range) {
+            int next = 0;
+            for (auto f : mesh->faces()) {
+                EXPECT(triangle_range[f].first == next);
+                next = triangle_range[f].second + 1;
+            }
+            EXPECT(next == static_cast<int>(data.indices.size() / 3));
+        }
+
+        // face colors: each corner has its own vertex, and each triangle has the color of its face
+        auto colors = mesh->face_property<vec3>("f:color");
+        for (auto f : mesh->faces())
+            colors[f] = vec3(static_cast<float>(f.idx() % 7), 0.0f, 1.0f);
+        state.set_property_coloring(State::FACE, "f:color");
+        EXPECT(buffers::pack_triangles(mesh, state, data));
+        EXPECT(data.colors.size() == data.points.size());
+        EXPECT(std::abs(triangles_area(data) - area) < tolerance);
+        if (triangle_range && data.indices.in_use()) {
+            std::size_t num_wrong = 0;
+            for (auto f : mesh->faces()) {
+                for (int t = triangle_range[f].first; t <= triangle_range[f].second; ++t) {
+                    for (int k = 0; k < 3; ++k) {
+                        const vec3 &c = data.colors.vector()[data.indices.vector()[t * 3 + k]];
+                        num_wrong += (distance2(c, colors[f]) > 0.0f);
+                    }
+                }
+            }
+            EXPECT(num_wrong == 0);
+        }
+
+        // scalar fields on the vertices and on the faces
+        auto vertex_scalars = mesh->vertex_property<float>("v:scalar");
+        for (auto v : mesh->vertices())
+            vertex_scalars[v] = static_cast<float>(v.idx());
+        state.set_scalar_coloring(State::VERTEX, "v:scalar");
+        EXPECT(buffers::pack_triangles(mesh, state, data));
+        EXPECT(data.texcoords.size() == mesh->vertices_size());
+        auto face_scalars = mesh->face_property<float>("f:scalar");
+        for (auto f : mesh->faces())
+            face_scalars[f] = static_cast<float>(f.idx());
+        state.set_scalar_coloring(State::FACE, "f:scalar");
+        EXPECT(buffers::pack_triangles(mesh, state, data));
+        EXPECT(data.texcoords.size() == data.points.size());
+
+        // a missing property is reported
+        state.set_scalar_coloring(State::VERTEX, "v:missing");
+        EXPECT(!buffers::pack_triangles(mesh, state, data));
+
+        // the cached triangulation is reused until the connectivity changes
+        State uniform;
+        EXPECT(buffers::pack_triangles(mesh, uniform, data));
+        const std::vector<unsigned int> first = data.indices.vector();
+        EXPECT(buffers::pack_triangles(mesh, uniform, data));
+        EXPECT(data.indices.vector() == first);
+        mesh->delete_face(SurfaceMesh::Face(0));
+        mesh->garbage_collection();
+        EXPECT(buffers::pack_triangles(mesh, uniform, data));
+        EXPECT(data.indices.size() < first.size());
+        EXPECT(std::abs(triangles_area(data) - faces_area(mesh)) < tolerance);
+
+        mesh->remove_face_property(colors);
+        mesh->remove_vertex_property(vertex_scalars);
+        mesh->remove_face_property(face_scalars);
+        return success;
+    }
+
+}
+
+
+bool test_buffers_packing() {
+    bool success = true;
+
+    // a large quad mesh
+    const std::string file = resource::directory() + "/data/fandisk_quads.off";
+    std::unique_ptr<SurfaceMesh> mesh(SurfaceMeshIO::load(file));
+    EXPECT(mesh != nullptr);
+    if (!mesh)
+        return false;
+    for (int i = 0; i < 5; ++i)
+        SurfaceMeshSubdivision::catmull_clark(mesh.get());
+    std::cout << "  mesh: " << mesh->n_faces() << " faces, " << mesh->n_vertices() << " vertices" << std::endl;
+
+    // packing the plain faces vs. the previous per-face tessellation
+    std::vector<vec3> points, normals;
+    std::vector<unsigned int> indices;
+    StopWatch w;
+    const std::size_t num_tessellated = details::tessellate_faces(mesh.get(), points, normals, indices);
+    const double t_tessellator = w.elapsed_seconds(3);
+
+    buffers::BufferData data;
+    State state;
+    w.restart();
+    EXPECT(buffers::pack_triangles(mesh.get(), state, data));
+    const double t_packing = w.elapsed_seconds(3);
+    w.restart();
+    EXPECT(buffers::pack_triangles(mesh.get(), state, data));
+    const double t_cached = w.elapsed_seconds(3);
+    EXPECT(data.indices.size() == num_tessellated * 3);
+    std::cout << "  plain faces: " << num_tessellated << " triangles\n"
+              << "    tessellator (per face): " << t_tessellator << " s\n"
+              << "    pack_triangles: " << t_packing << " s\n"
+              << "    pack_triangles (cached triangulation): " << t_cached << " s" << std::endl;
+
+    success = details::check_triangles(mesh.get()) && success;
+
+    // points: the deleted vertices are skipped by an element buffer
+    PointCloud cloud;
+    for (int i = 0; i <= 100; ++i)
+        cloud.add_vertex(vec3(static_cast<float>(i), 0.0f, 0.0f));
+    auto scalars = cloud.add_vertex_property<float>("v:scalar");
+    for (auto v : cloud.vertices())
+        scalars[v] = static_cast<float>(v.idx());
+    State points_state;
+    EXPECT(buffers::pack_points(&cloud, points_state, data));
+    EXPECT(!data.indices.in_use() && data.points.size() == cloud.vertices_size());
+
+    // the scalar field is clamped by 5% on each side
+    points_state.set_scalar_coloring(State::VERTEX, "v:scalar");
+    EXPECT(buffers::pack_points(&cloud, points_state, data));
+    EXPECT(data.texcoords.vector()[5].x == 0.0f && data.texcoords.vector()[95].x == 1.0f);
+
+    for (int i = 0; i <= 100; i += 10)
+        cloud.delete_vertex(PointCloud::Vertex(i));
+    EXPECT(buffers::pack_points(&cloud, points_state, data));
+    EXPECT(data.indices.in_use() && data.indices.size() == cloud.n_vertices());
+    std::size_t num_deleted = 0;
+    for (auto id : data.indices.vector())
+        num_deleted += cloud.is_deleted(PointCloud::Vertex(static_cast<int>(id)));
+    EXPECT(num_deleted == 0);
+
+    return success;
+}
@@ -0,0 +1,183 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tests.h"
+
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <string>
+
+#include <easy3d/algo/delaunay_2d.h>
+#include <easy3d/algo/delaunay_3d.h>
+#include <easy3d/util/stop_watch.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    // the smallest barycentric coordinate of point p in triangle t (negative if p is outside t)
+    double min_barycentric_coordinate(const Delaunay2 &dt, unsigned int t, const vec2 &p) {
+        const vec2 *v[3];
+        for (unsigned int i = 0; i < 3; ++i)
+            v[i] = &dt.vertex(dt.tri_vertex(t, i));
+        auto area = [](const vec2 &a, const vec2 &b, const vec2 &c) {
+            return (double(b.x) - a.x) * (double(c.y) - a.y) - (double(b.y) - a.y) * (double(c.x) - a.x);
+        };
+        const double total = area(*v[0], *v[1], *v[2]);
+        double result = std::numeric_limits<double>::max();
+        for (unsigned int i = 0; i < 3; ++i) {
+            const vec2 *w[3] = {v[0], v[1], v[2]};
+            w[i] = &p;
+            result = std::min(result, area(*w[0], *w[1], *w[2]) / total);
+        }
+        return result;
+    }
+
+    // the smallest barycentric coordinate of point p in tetrahedron t (negative if p is outside t)
+    double min_barycentric_coordinate(const Delaunay3 &dt, unsigned int t, const vec3 &p) {
+        const vec3 *v[4];
+        for (unsigned int i = 0; i < 4; ++i)
+            v[i] = &dt.vertex(dt.tet_vertex(t, i));
+        auto volume = [](const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d) {
+            const double u[3] = {double(b.x) - a.x, double(b.y) - a.y, double(b.z) - a.z};
+            const double v[3] = {double(c.x) - a.x, double(c.y) - a.y, double(c.z) - a.z};
+            const double w[3] = {double(d.x) - a.x, double(d.y) - a.y, double(d.z) - a.z};
+            return u[0] * (v[1] * w[2] - v[2] * w[1]) - u[1] * (v[0] * w[2] - v[2] * w[0]) +
+                   u[2] * (v[0] * w[1] - v[1] * w[0]);
+        };
+        const double total = volume(*v[0], *v[1], *v[2], *v[3]);
+        double result = std::numeric_limits<double>::max();
+        for (unsigned int i = 0; i < 4; ++i) {
+            const vec3 *w[4] = {v[0], v[1], v[2], v[3]};
+            w[i] = &p;
+            result = std::min(result, volume(*w[0], *w[1], *w[2], *w[3]) / total);
+        }
+        return result;
+    }
+
+    // compares the nearest-vertex queries of a triangulation with a linear scan of its vertices
+    template<typename DT, typename VT>
+    bool compare_with_linear_scan(const DT &dt, const std::vector<VT> &queries, const std::string &title) {
+        bool success = true;
+
+        StopWatch w;
+        std::vector<unsigned int> nearest;
+        dt.nearest_vertices(queries, nearest);
+        const double t_batched = w.elapsed_seconds(3);
+
+        w.restart();
+        for (const auto &q : queries)
+            nearest[0] = dt.nearest_vertex(q);
+        const double t_single = w.elapsed_seconds(3);
+        dt.nearest_vertices(queries, nearest);
+
+        // the linear scan is too slow for all queries
+        const std::size_t num_scanned = std::min<std::size_t>(queries.size(), 2000);
+        w.restart();
+        std::size_t num_wrong = 0;
+        for (std::size_t i = 0; i < num_scanned; ++i) {
+            float min_dist = std::numeric_limits<float>::max();
+            for (unsigned int v = 0; v < dt.nb_vertices(); ++v)
+                min_dist = std::min(min_dist, distance2(dt.vertex(v), queries[i]));
+            if (distance2(dt.vertex(nearest[i]), queries[i]) > min_dist)
+                ++num_wrong;
+        }
+        const double t_scan = w.elapsed_seconds(3) * queries.size() / num_scanned;
+        EXPECT(num_wrong == 0);
+
+        // point location (the queries outside the convex hull are not located)
+        std::vector<int> cells;
+        w.restart();
+        dt.locate(queries, cells);
+        const double t_locate = w.elapsed_seconds(3);
+        const double tolerance = 1e-4;  // in barycentric coordinates, for the queries on (or near) the cell borders
+        std::size_t num_located = 0, num_wrong_cells = 0;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            if (cells[i] < 0)
+                continue;
+            ++num_located;
+            if (min_barycentric_coordinate(dt, cells[i], queries[i]) < -tolerance)
+                ++num_wrong_cells;
+        }
+        EXPECT(num_located > 0);
+        EXPECT(num_wrong_cells == 0);
+
+        // the queries that are not located must not be (strictly) inside any cell. The linear scan is too slow for
+        // all of them.
+        std::size_t num_unlocated = 0, num_missed = 0;
+        for (std::size_t i = 0; i < queries.size() && num_unlocated < 100; ++i) {
+            if (cells[i] >= 0)
+                continue;
+            ++num_unlocated;
+            for (unsigned int c = 0; c < dt.nb_cells(); ++c) {
+                if (min_barycentric_coordinate(dt, c, queries[i]) > tolerance) {
+                    ++num_missed;
+                    break;
+                }
+            }
+        }
+        EXPECT(num_unlocated > 0);
+        EXPECT(num_missed == 0);
+
+        std::cout << "  " << title << ": " << dt.nb_vertices() << " vertices, " << queries.size() << " queries\n"
+                  << "    nearest vertex (batched): " << t_batched << " s\n"
+                  << "    nearest vertex (one by one): " << t_single << " s\n"
+                  << "    linear scan (estimated from " << num_scanned << " queries): " << t_scan << " s\n"
+                  << "    locate (batched): " << t_locate << " s, " << num_located << " located" << std::endl;
+        return success;
+    }
+
+}
+
+
+bool test_delaunay_queries() {
+    bool success = true;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    const std::size_t num = 200000;
+    std::vector<vec2> points_2d(num), queries_2d(num);
+    for (auto &p : points_2d)
+        p = vec2(uniform(rng), uniform(rng) * 3.0f);
+    for (auto &p : queries_2d)  // some of them outside the convex hull
+        p = vec2(uniform(rng) * 1.2f - 0.1f, uniform(rng) * 3.0f);
+    Delaunay2 dt2;
+    dt2.set_vertices(points_2d);
+    success = details::compare_with_linear_scan(dt2, queries_2d, "2D") && success;
+
+    std::vector<vec3> points_3d(num), queries_3d(num);
+    for (auto &p : points_3d)
+        p = vec3(uniform(rng), uniform(rng), uniform(rng));
+    for (auto &p : queries_3d)
+        p = vec3(uniform(rng), uniform(rng), uniform(rng) * 1.2f - 0.1f);
+    Delaunay3 dt3;
+    dt3.set_vertices(points_3d);
+    success = details::compare_with_linear_scan(dt3, queries_3d, "3D") && success;
+
+    return success;
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tests.h"
+
+#include <cstring>
+
+#include <easy3d/renderer/drawable_points.h>
+#include <easy3d/renderer/vertex_array_object.h>
+#include <easy3d/util/stop_watch.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    // a drawable whose buffers can be read back from the GPU
+    class ReadableDrawable : public PointsDrawable {
+    public:
+        ReadableDrawable() : PointsDrawable("readable") {}
+
+        std::vector<vec3> read(unsigned int buffer, std::size_t num) const {
+            std::vector<vec3> data(num);
+            vao()->get_buffer_data(GL_ARRAY_BUFFER, buffer, 0, num * sizeof(vec3), data.data());
+            return data;
+        }
+    };
+
+
+    bool same(const std::vector<vec3> &a, const std::vector<vec3> &b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(vec3)) == 0;
+    }
+
+}
+
+
+bool test_dirty_ranges() {
+    bool success = true;
+
+    // sorting and merging
+    DirtyRanges ranges;
+    ranges.add(5, 5);
+    ranges.add(0, 3);
+    ranges.add(8, 4);
+    ranges.add(20);
+    ranges.add(3);
+    const std::vector<DirtyRanges::Range> merged = ranges.ranges();
+    EXPECT(merged.size() == 3);
+    if (merged.size() == 3) {
+        EXPECT(merged[0] == DirtyRanges::Range(0, 4));
+        EXPECT(merged[1] == DirtyRanges::Range(5, 12));
+        EXPECT(merged[2] == DirtyRanges::Range(20, 21));
+    }
+    EXPECT(ranges.ranges(8).size() == 1);
+
+    const std::size_t num = 4000000;
+    std::vector<vec3> points(num), colors(num);
+    for (std::size_t i = 0; i < num; ++i) {
+        points[i] = vec3(static_cast<float>(i), 0.0f, 0.0f);
+        colors[i] = vec3(0.0f, static_cast<float>(i), 0.0f);
+    }
+
+    details::ReadableDrawable drawable;
+    StopWatch w;
+    drawable.update_vertex_buffer(points);
+    drawable.update_color_buffer(colors);
+    glFinish();
+    const double t_full = w.elapsed_seconds(3);
+    const unsigned int vertex_buffer = drawable.vertex_buffer();
+    const unsigned int color_buffer = drawable.color_buffer();
+    EXPECT(vertex_buffer != 0 && color_buffer != 0);
+    EXPECT(details::same(drawable.read(vertex_buffer, num), points));
+
+    // scattered edits: only the modified ranges are uploaded to the same buffer
+    ranges.clear();
+    for (std::size_t i = 0; i < num; i += 1000) {
+        points[i] = vec3(-1.0f, 1.0f, 2.0f);
+        ranges.add(i);
+    }
+    for (std::size_t i = 100; i < 200; ++i) {
+        points[i].z = 9.0f;
+        ranges.add(i);
+    }
+    points[num - 1] = vec3(5.0f, 7e6f, 1.0f);
+    ranges.add(num - 1);
+    w.restart();
+    drawable.update_vertex_buffer(points, ranges);
+    glFinish();
+    const double t_partial = w.elapsed_seconds(3);
+    EXPECT(drawable.vertex_buffer() == vertex_buffer);
+    EXPECT(details::same(drawable.read(vertex_buffer, num), points));
+    // the bounding box is enlarged by the modified vertices
+    EXPECT(drawable.bounding_box().max().y == 7e6f);
+    EXPECT(drawable.bounding_box().min().x == -1.0f);
+
+    ranges.clear();
+    ranges.add(10, 5);
+    ranges.add(3);
+    for (std::size_t i = 10; i < 15; ++i)
+        colors[i] = vec3(1.0f, 1.0f, 1.0f);
+    colors[3] = vec3(2.0f, 2.0f, 2.0f);
+    drawable.update_color_buffer(colors, ranges);
+    EXPECT(drawable.color_buffer() == color_buffer);
+    EXPECT(details::same(drawable.read(color_buffer, num), colors));
+
+    // the elements not marked as modified are not uploaded...
+    std::vector<vec3> uploaded = points;
+    points[num / 2] = vec3(3.0f, 3.0f, 3.0f);
+    ranges.clear();
+    ranges.add(0, num / 4);
+    drawable.update_vertex_buffer(points, ranges);
+    EXPECT(details::same(drawable.read(vertex_buffer, num), uploaded));
+
+    // ...unless more than half of the buffer is modified, in which case the whole buffer is rewritten
+    ranges.clear();
+    ranges.add(0, num / 2 + 1);
+    w.restart();
+    drawable.update_vertex_buffer(points, ranges);
+    glFinish();
+    const double t_rewrite = w.elapsed_seconds(3);
+    EXPECT(drawable.vertex_buffer() == vertex_buffer);
+    EXPECT(details::same(drawable.read(vertex_buffer, num), points));
+
+    // a different number of elements also rewrites the whole buffer
+    points.resize(num / 2);
+    ranges.clear();
+    ranges.add(0);
+    drawable.update_vertex_buffer(points, ranges);
+    EXPECT(drawable.vertex_buffer() == vertex_buffer);
+    EXPECT(details::same(drawable.read(vertex_buffer, num / 2), points));
+
+    std::cout << "  " << num << " vertices\n"
+              << "    full upload (positions and colors): " << t_full << " s\n"
+              << "    partial upload (" << num / 1000 + 101 << " modified vertices): " << t_partial << " s\n"
+              << "    rewrite (more than half modified): " << t_rewrite << " s" << std::endl;
+    return success;
+}
@@ -0,0 +1,339 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tests.h"
+
+#include <random>
+#include <cmath>
+#include <set>
+#include <tuple>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/renderer/point_cloud_lod.h>
+#include <easy3d/renderer/drawable_points_lod.h>
+#include <easy3d/renderer/renderer.h>
+#include <easy3d/renderer/framebuffer_object.h>
+#include <easy3d/renderer/frustum.h>
+#include <easy3d/renderer/camera.h>
+#include <easy3d/renderer/opengl.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/stop_watch.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    // a terrain-like point cloud of 100 m x 50 m, with per-vertex normals and colors
+    PointCloud *terrain(int num) {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        PointCloud *cloud = new PointCloud;
+        auto normals = cloud->add_vertex_property<vec3>("v:normal");
+        auto colors = cloud->add_vertex_property<vec3>("v:color");
+        for (int i = 0; i < num; ++i) {
+            const float x = uniform(rng) * 100.0f, y = uniform(rng) * 50.0f;
+            auto v = cloud->add_vertex(vec3(x, y, std::sin(x * 0.1f) * 3.0f + std::cos(y * 0.2f) * 2.0f));
+            normals[v] = normalize(vec3(uniform(rng) * 0.1f, uniform(rng) * 0.1f, 1.0f));
+            colors[v] = vec3(0.5f + 0.5f * uniform(rng), 0.3f, 0.8f);
+        }
+        return cloud;
+    }
+
+    bool inside(const Box3 &box, const vec3 &p) {
+        for (int k = 0; k < 3; ++k) {
+            if (p[k] < box.min()[k] || p[k] > box.max()[k])
+                return false;
+        }
+        return true;
+    }
+
+    // a view of the whole point cloud from above, looking a bit forward
+    void setup_camera(Camera &camera, const Box3 &box, int width, int height) {
+        camera.setScreenWidthAndHeight(width, height);
+        camera.setViewDirection(vec3(0.0f, 0.6f, -1.0f));
+        camera.setSceneBoundingBox(box.min(), box.max());
+        camera.showEntireScene();
+    }
+
+    // checks that a selection is within the point budget and the frustum, and that it contains the parents of its
+    // nodes. Returns the number of selected points.
+    std::size_t check_selection(const PointCloudLod &lod, const std::vector<int> &selection, const Camera *camera,
+                                std::size_t point_budget, bool &success) {
+        const std::set<int> nodes(selection.begin(), selection.end());
+        EXPECT(nodes.size() == selection.size());
+        const Frustum frustum(camera);
+        std::size_t num = 0;
+        for (auto n : selection) {
+            const PointCloudLod::Node &node = lod.nodes()[n];
+            num += node.size;
+            EXPECT(node.parent < 0 || nodes.count(node.parent));
+            EXPECT(frustum.intersects(node.box));
+        }
+        EXPECT(num <= point_budget);
+        return num;
+    }
+
+    // renders a drawable into an offscreen framebuffer and returns the RGBA pixels
+    std::vector<unsigned char> render(const Drawable *drawable, const Camera *camera, FramebufferObject *fbo) {
+        fbo->bind();
+        glViewport(0, 0, fbo->width(), fbo->height());
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClearDepth(1.0f);
+        glEnable(GL_DEPTH_TEST);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawable->draw(camera);
+        fbo->release();
+
+        std::vector<unsigned char> pixels;
+        fbo->read_color(0, pixels, GL_RGBA);
+        return pixels;
+    }
+
+}
+
+
+// the octree, the node selection, and the loader (no rendering context is needed)
+bool test_point_cloud_lod() {
+    bool success = true;
+
+    const int num = 2000000;
+    PointCloud *cloud = details::terrain(num);
+    // duplicated points (which cannot be separated by subdivision), and a deleted one that must not be written
+    for (int i = 0; i < num; i += 1000)
+        cloud->position(PointCloud::Vertex(i)) = vec3(1.0f, 1.0f, 1.0f);
+    cloud->delete_vertex(PointCloud::Vertex(5));
+
+    const std::string file = "test_point_cloud_lod.lod";
+    StopWatch w;
+    EXPECT(PointCloudLod::build(cloud, file));
+    const double t_build = w.elapsed_seconds(3);
+
+    PointCloudLod lod;
+    w.restart();
+    EXPECT(lod.open(file));
+    const double t_open = w.elapsed_seconds(3);
+    EXPECT(lod.num_points() == cloud->n_vertices() && lod.has_normals() && lod.has_colors());
+    std::cout << "  " << lod.num_points() << " points: build " << t_build << " s, open " << t_open << " s, "
+              << lod.nodes().size() << " nodes" << std::endl;
+
+    // every point is stored exactly once, in the box of its node, and the children follow their parents
+    std::multiset<std::tuple<float, float, float> > expected, stored;
+    for (auto v : cloud->vertices()) {
+        const vec3 &p = cloud->position(v);
+        expected.insert(std::make_tuple(p.x, p.y, p.z));
+    }
+    w.restart();
+    for (std::size_t i = 0; i < lod.nodes().size(); ++i) {
+        const PointCloudLod::Node &node = lod.nodes()[i];
+        PointCloudLod::Points points;
+        EXPECT(lod.load(static_cast<int>(i), points));
+        EXPECT(points.points.size() == node.size);
+        EXPECT(points.normals.size() == node.size && points.colors.size() == node.size);
+        for (const auto &p : points.points) {
+            EXPECT(details::inside(node.box, p));
+            stored.insert(std::make_tuple(p.x, p.y, p.z));
+        }
+        if (node.parent >= 0) {
+            EXPECT(node.parent < static_cast<int>(i));
+            const int *children = lod.nodes()[node.parent].children;
+            EXPECT(std::find(children, children + 8, static_cast<int>(i)) != children + 8);
+        }
+    }
+    std::cout << "    load all nodes: " << w.elapsed_seconds(3) << " s" << std::endl;
+    EXPECT(stored == expected);
+
+    PointCloudLod::Points points;
+    EXPECT(!lod.load(-1, points));
+    EXPECT(!lod.load(static_cast<int>(lod.nodes().size()), points));
+    PointCloudLod invalid;
+    EXPECT(!invalid.open("test_point_cloud_lod.nonexistent"));
+    EXPECT(!invalid.is_open());
+
+    // selection
+    Camera camera;
+    details::setup_camera(camera, lod.bounding_box(), 800, 600);
+    for (std::size_t budget : {std::size_t(100000), std::size_t(500000), std::size_t(5000000)}) {
+        w.restart();
+        const std::vector<int> selection = lod.select(&camera, budget);
+        const double t_select = w.elapsed_seconds(6);
+        const std::size_t n = details::check_selection(lod, selection, &camera, budget, success);
+        std::cout << "    select (budget " << budget << "): " << selection.size() << " nodes, " << n << " points, "
+                  << t_select * 1000.0 << " ms" << std::endl;
+    }
+    EXPECT(lod.select(&camera, num, 0.0f).size() == lod.nodes().size());
+
+    // zoomed in: the deeper nodes of a smaller region
+    Camera close = camera;
+    close.setPosition(vec3(60.0f, 20.0f, 10.0f));
+    close.lookAt(vec3(60.0f, 20.0f, 0.0f));
+    const std::vector<int> selection = lod.select(&close, 500000);
+    details::check_selection(lod, selection, &close, 500000, success);
+    int max_depth = 0;
+    for (auto n : selection)
+        max_depth = std::max(max_depth, lod.nodes()[n].depth);
+    EXPECT(max_depth > 0);
+
+    // looking away: nothing is selected
+    Camera away = camera;
+    away.setPosition(vec3(0.0f, 0.0f, 1000.0f));
+    away.setViewDirection(vec3(0.0f, 0.0f, 1.0f));
+    EXPECT(lod.select(&away, 500000).empty());
+
+    Camera ortho = camera;
+    ortho.setType(Camera::ORTHOGRAPHIC);
+    EXPECT(!lod.select(&ortho, 500000).empty());
+
+    // the loader
+    {
+        PointCloudLodLoader loader(&lod);
+        const std::vector<int> requested = lod.select(&camera, 1000000);
+        w.restart();
+        loader.request(requested);
+        loader.wait();
+        std::cout << "    loader: " << requested.size() << " nodes in " << w.elapsed_seconds(3) << " s" << std::endl;
+        EXPECT(loader.num_pending() == 0);
+        std::vector<std::pair<int, PointCloudLod::Points> > loaded;
+        loader.fetch(loaded);
+        EXPECT(loaded.size() == requested.size());
+        std::set<int> nodes;
+        for (const auto &entry : loaded) {
+            nodes.insert(entry.first);
+            EXPECT(entry.second.points.size() == lod.nodes()[entry.first].size);
+        }
+        EXPECT(nodes == std::set<int>(requested.begin(), requested.end()));
+        loader.fetch(loaded);
+        EXPECT(loaded.empty());
+
+        // a new request replaces the previous one: the nodes no longer wanted are not loaded
+        std::vector<int> all(lod.nodes().size());
+        for (std::size_t i = 0; i < all.size(); ++i)
+            all[i] = static_cast<int>(i);
+        loader.request(all);
+        loader.request(std::vector<int>(1, 0));
+        loader.wait();
+        loader.fetch(loaded);
+        EXPECT(loaded.size() < all.size());
+
+        // destroyed while loading
+        loader.request(all);
+    }
+
+    delete cloud;
+    file_system::delete_file(file);
+    return success;
+}
+
+
+// the drawable: the nodes are selected once per frame by update(), and drawn progressively as they are loaded
+bool test_points_lod_drawable() {
+    bool success = true;
+
+    const int num = 500000;
+    PointCloud *cloud = details::terrain(num);
+    const std::string file = "test_points_lod_drawable.lod";
+    EXPECT(PointCloudLod::build(cloud, file));
+
+    Renderer *renderer = new Renderer(cloud);
+    PointsDrawable *vertices = renderer->get_points_drawable("vertices");
+    vertices->set_property_coloring(State::VERTEX, "v:color");
+
+    const int width = 400, height = 300;
+    FramebufferObject fbo(width, height);
+    fbo.add_color_buffer();
+    fbo.add_depth_buffer();
+    Camera camera;
+    details::setup_camera(camera, cloud->bounding_box(), width, height);
+
+    for (auto format : {Drawable::VF_FLOAT, Drawable::VF_QUANTIZED}) {
+        PointsLodDrawable drawable("lod");
+        EXPECT(drawable.open(file));
+        drawable.set_vertex_format(format);
+        vertices->set_vertex_format(format);
+
+        // without an update, nothing is selected and drawing does not select anything
+        details::render(&drawable, &camera, &fbo);
+        EXPECT(drawable.selected_nodes().empty() && drawable.num_resident_points() == 0);
+
+        // no budget: the frames are refined until all the nodes are resident
+        drawable.set_point_budget(num);
+        drawable.set_gpu_budget(num);
+        drawable.set_max_screen_error(0.0f);
+        int frames = 0;
+        StopWatch w;
+        do {
+            drawable.update(&camera);
+            details::render(&drawable, &camera, &fbo);
+            if (drawable.num_pending_nodes() > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        } while (drawable.num_pending_nodes() > 0 && ++frames < 10000);
+        EXPECT(drawable.num_resident_points() == static_cast<std::size_t>(num));
+        std::cout << "  format " << format << ": all nodes resident after " << frames << " frames, "
+                  << w.elapsed_seconds(3) << " s" << std::endl;
+
+        // several passes of a frame render the same nodes
+        const std::vector<int> selected = drawable.selected_nodes();
+        w.restart();
+        const std::vector<unsigned char> image = details::render(&drawable, &camera, &fbo);
+        const double t_lod = w.elapsed_seconds(3);
+        EXPECT(details::render(&drawable, &camera, &fbo) == image);
+        EXPECT(drawable.selected_nodes() == selected);
+
+        const std::vector<unsigned char> expected = details::render(vertices, &camera, &fbo);
+        std::size_t lit = 0, different = 0;
+        for (std::size_t i = 0; i < expected.size(); i += 4) {
+            lit += (expected[i] | expected[i + 1] | expected[i + 2]) != 0;
+            int diff = 0;
+            for (int k = 0; k < 3; ++k)
+                diff = std::max(diff, std::abs(static_cast<int>(expected[i + k]) - static_cast<int>(image[i + k])));
+            different += (diff > 8);
+        }
+        EXPECT(lit > 1000 && different <= lit / 20);
+
+        // a point budget and a GPU budget
+        drawable.set_point_budget(50000);
+        drawable.set_gpu_budget(100000);
+        drawable.set_max_screen_error(1.0f);
+        drawable.update(&camera);
+        std::size_t n = 0;
+        for (auto node : drawable.selected_nodes())
+            n += drawable.lod().nodes()[node].size;
+        EXPECT(n <= 50000);
+        EXPECT(drawable.num_resident_points() <= 100000);
+        w.restart();
+        details::render(&drawable, &camera, &fbo);
+        std::cout << "    frame: " << t_lod << " s, with a budget of 50000 points: " << w.elapsed_seconds(3) << " s ("
+                  << n << " points)" << std::endl;
+    }
+
+    delete renderer;
+    delete cloud;
+    file_system::delete_file(file);
+    return success;
+}
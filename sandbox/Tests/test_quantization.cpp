@@ -0,0 +1,211 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tests.h"
+
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/constant.h>
+#include <easy3d/renderer/renderer.h>
+#include <easy3d/renderer/buffers_packing.h>
+#include <easy3d/renderer/buffers_quantization.h>
+#include <easy3d/renderer/drawable_points.h>
+#include <easy3d/renderer/framebuffer_object.h>
+#include <easy3d/renderer/camera.h>
+#include <easy3d/renderer/shader_manager.h>
+#include <easy3d/renderer/shader_program.h>
+#include <easy3d/renderer/opengl_info.h>
+#include <easy3d/renderer/opengl.h>
+#include <easy3d/util/stop_watch.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    // renders a points drawable into an offscreen framebuffer and returns the RGBA pixels
+    std::vector<unsigned char> render(const PointsDrawable *drawable, const Camera *camera, FramebufferObject *fbo) {
+        fbo->bind();
+        glViewport(0, 0, fbo->width(), fbo->height());
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClearDepth(1.0f);
+        glEnable(GL_DEPTH_TEST);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawable->draw(camera);
+        fbo->release();
+
+        std::vector<unsigned char> pixels;
+        fbo->read_color(0, pixels, GL_RGBA);
+        return pixels;
+    }
+
+}
+
+
+bool test_quantization() {
+    bool success = true;
+
+    // a city-scale scan: 10 km x 10 km x 200 m
+    const int num = 10000000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    buffers::BufferData data;
+    std::vector<vec3> &points = data.points.owned();
+    std::vector<vec3> &normals = data.normals.owned();
+    std::vector<vec3> &colors = data.colors.owned();
+    points.resize(num);
+    normals.resize(num);
+    colors.resize(num);
+    for (int i = 0; i < num; ++i) {
+        points[i] = vec3(uniform(rng) * 10000.0f, uniform(rng) * 10000.0f, uniform(rng) * 200.0f);
+        normals[i] = normalize(vec3(uniform(rng) - 0.5f, uniform(rng) - 0.5f, uniform(rng) - 0.5f) + vec3(1e-4f));
+        colors[i] = vec3(uniform(rng), 0.3f, 1.0f);
+    }
+
+    buffers::QuantizedVertices quantized;
+    StopWatch w;
+    EXPECT(buffers::quantize(data, quantized));
+    const double t_encode = w.elapsed_seconds(3);
+    EXPECT(quantized.stride == 16 && quantized.size() == static_cast<std::size_t>(num));
+    EXPECT(quantized.tiles.x * quantized.tiles.y * quantized.tiles.z <= 65535);
+
+    // the errors w.r.t. the quantization steps (the float arithmetic adds a few ulps of the coordinates)
+    double max_position_error[3] = {0.0, 0.0, 0.0};
+    double max_angle = 0.0, max_color_error = 0.0;
+    for (int i = 0; i < num; ++i) {
+        const vec3 p = quantized.position(i);
+        const vec3 n = quantized.normal(i);
+        const vec3 c = quantized.color(i);
+        for (int k = 0; k < 3; ++k) {
+            max_position_error[k] = std::max(max_position_error[k], static_cast<double>(std::abs(p[k] - points[i][k])));
+            max_color_error = std::max(max_color_error, static_cast<double>(std::abs(c[k] - colors[i][k])));
+        }
+        const double angle = std::atan2(length(cross(n, normals[i])), dot(n, normals[i]));
+        max_angle = std::max(max_angle, angle * 180.0 / M_PI);
+    }
+    double whole_box_step[3];
+    for (int k = 0; k < 3; ++k) {
+        const double extent = quantized.scale[k] * quantized.tiles[k];
+        whole_box_step[k] = extent / 65535.0;
+        const double tile_step = quantized.scale[k] / 65535.0;
+        EXPECT(max_position_error[k] <= tile_step * 0.5 + (std::abs(quantized.offset[k]) + extent) * 2.4e-7);
+    }
+    EXPECT(max_angle < 0.01);
+    EXPECT(max_color_error <= 0.5 / 255.0 + 1e-6);
+
+    std::cout << "  " << num << " points with normals and colors, " << quantized.tiles << " tiles\n"
+              << "    encoding: " << t_encode << " s, " << quantized.data.size() / 1e6 << " MB vs "
+              << num * 36 / 1e6 << " MB of floats\n"
+              << "    max position error: " << max_position_error[0] << " " << max_position_error[1] << " "
+              << max_position_error[2] << " (a single box of 16-bit positions has a step of " << whole_box_step[0]
+              << " " << whole_box_step[1] << " " << whole_box_step[2] << ")\n"
+              << "    max normal error: " << max_angle << " degrees, max color error: " << max_color_error << std::endl;
+
+    // upload time
+    PointsDrawable drawable("benchmark");
+    drawable.update_vertex_buffer(points);
+    drawable.update_normal_buffer(normals);
+    drawable.update_color_buffer(colors);
+    glFinish();
+    w.restart();
+    drawable.update_vertex_buffer(points);
+    drawable.update_normal_buffer(normals);
+    drawable.update_color_buffer(colors);
+    glFinish();
+    const double t_float = w.elapsed_seconds(3);
+    drawable.update_quantized_buffer(quantized);
+    glFinish();
+    w.restart();
+    drawable.update_quantized_buffer(quantized);
+    glFinish();
+    const double t_quantized = w.elapsed_seconds(3);
+    EXPECT(drawable.quantized_buffer());
+    EXPECT(drawable.vertex_buffer() == drawable.normal_buffer() && drawable.vertex_buffer() == drawable.color_buffer());
+    std::cout << "    upload: " << t_quantized << " s vs " << t_float << " s for the float arrays" << std::endl;
+
+    // the quantized and the float layouts render the same images
+    PointCloud cloud;
+    auto cloud_normals = cloud.add_vertex_property<vec3>("v:normal");
+    auto cloud_colors = cloud.add_vertex_property<vec3>("v:color");
+    for (int i = 0; i < 20000; ++i) {
+        auto v = cloud.add_vertex(vec3(uniform(rng) * 2000.0f, uniform(rng) * 2000.0f, uniform(rng) * 40.0f));
+        cloud_normals[v] = normalize(vec3(uniform(rng) - 0.5f, uniform(rng) - 0.5f, 1.0f));
+        cloud_colors[v] = vec3(uniform(rng) * 0.5f + 0.5f, 0.2f, 0.7f);
+    }
+    Renderer renderer(&cloud);
+    PointsDrawable *vertices = renderer.get_points_drawable("vertices");
+    vertices->set_point_size(3.0f);
+    vertices->set_property_coloring(State::VERTEX, "v:color");
+
+    const int size = 256;
+    FramebufferObject fbo(size, size);
+    fbo.add_color_buffer();
+    fbo.add_depth_buffer();
+    Camera camera;
+    camera.setScreenWidthAndHeight(size, size);
+    camera.setSceneBoundingBox(cloud.bounding_box().min(), cloud.bounding_box().max());
+    camera.showEntireScene();
+    for (auto impostor : {PointsDrawable::PLAIN, PointsDrawable::SPHERE, PointsDrawable::SURFEL}) {
+        vertices->set_impostor_type(impostor);
+        vertices->set_vertex_format(Drawable::VF_FLOAT);
+        vertices->update();
+        const std::vector<unsigned char> expected = details::render(vertices, &camera, &fbo);
+        EXPECT(!vertices->quantized_buffer());
+        vertices->set_vertex_format(Drawable::VF_QUANTIZED);
+        const std::vector<unsigned char> image = details::render(vertices, &camera, &fbo);
+        EXPECT(vertices->quantized_buffer());
+
+        std::size_t lit = 0, different = 0;
+        for (std::size_t i = 0; i < expected.size(); i += 4) {
+            lit += (expected[i] | expected[i + 1] | expected[i + 2]) != 0;
+            int diff = 0;
+            for (int k = 0; k < 3; ++k)
+                diff = std::max(diff, std::abs(static_cast<int>(expected[i + k]) - static_cast<int>(image[i + k])));
+            different += (diff > 8);
+        }
+        EXPECT(lit > 1000 && different <= lit / 100);
+    }
+
+    // the other programs drawing the points (ambient occlusion, selection) have quantized variants
+    const std::vector<std::string> defines(1, "QUANTIZED_VERTEX");
+    std::vector<ShaderProgram::Attribute> attributes = {
+            ShaderProgram::Attribute(ShaderProgram::POSITION, "vtx_position"),
+            ShaderProgram::Attribute(ShaderProgram::NORMAL, "vtx_normal")
+    };
+    const std::vector<std::string> outputs = {"gPosition", "gNormal"};
+    EXPECT(ShaderManager::create_program_from_files("ssao/geometry_pass", attributes, outputs, false, defines));
+    if (OpenglInfo::gl_version_number() >= 4.3) {
+        attributes.resize(1);
+        EXPECT(ShaderManager::create_program_from_files("selection/selection_pointcloud_rect", attributes,
+                                                        std::vector<std::string>(), false, defines));
+        EXPECT(ShaderManager::create_program_from_files("selection/selection_pointcloud_lasso", attributes,
+                                                        std::vector<std::string>(), false, defines));
+    }
+
+    return success;
+}
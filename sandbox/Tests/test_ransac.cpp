@@ -0,0 +1,184 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tests.h"
+
+#include <random>
+#include <map>
+
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/constant.h>
+#include <easy3d/algo/point_cloud_ransac.h>
+#include <easy3d/util/stop_watch.h>
+
+
+using namespace easy3d;
+
+
+namespace details {
+
+    // samples a synthetic city scan: a ground plane, a grid of box-shaped buildings (four walls and a roof each), and
+    // cylindrical towers. The vertex property "v:surface" records the surface each point was sampled from.
+    PointCloud *city_scan(int num_points, int num_blocks) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        std::normal_distribution<float> noise(0.0f, 0.005f);
+
+        struct Quad {
+            vec3 origin, u, v;
+        };  // a rectangle spanned by u and v
+        std::vector<Quad> quads;
+        struct Tower {
+            vec3 center;
+            float radius, height;
+        };
+        std::vector<Tower> towers;
+
+        const float block = 10.0f;
+        const float extent = block * num_blocks;
+        quads.push_back({vec3(0, 0, 0), vec3(extent, 0, 0), vec3(0, extent, 0)});
+        for (int i = 0; i < num_blocks; ++i) {
+            for (int j = 0; j < num_blocks; ++j) {
+                const vec3 corner(i * block + 2.0f, j * block + 2.0f, 0.0f);
+                if ((i + j) % 4 == 3) {
+                    towers.push_back({corner + vec3(3, 3, 0), 1.5f + uniform(rng), 5.0f + 10.0f * uniform(rng)});
+                    continue;
+                }
+                const float w = 4.0f + 2.0f * uniform(rng), d = 4.0f + 2.0f * uniform(rng);
+                const float h = 3.0f + 12.0f * uniform(rng);
+                quads.push_back({corner, vec3(w, 0, 0), vec3(0, 0, h)});
+                quads.push_back({corner + vec3(0, d, 0), vec3(w, 0, 0), vec3(0, 0, h)});
+                quads.push_back({corner, vec3(0, d, 0), vec3(0, 0, h)});
+                quads.push_back({corner + vec3(w, 0, 0), vec3(0, d, 0), vec3(0, 0, h)});
+                quads.push_back({corner + vec3(0, 0, h), vec3(w, 0, 0), vec3(0, d, 0)});
+            }
+        }
+
+        // the points are distributed proportionally to the areas
+        std::vector<float> areas;
+        for (const auto &q : quads)
+            areas.push_back(length(cross(q.u, q.v)));
+        for (const auto &t : towers)
+            areas.push_back(2.0f * static_cast<float>(M_PI) * t.radius * t.height);
+        std::discrete_distribution<int> pick(areas.begin(), areas.end());
+
+        PointCloud *cloud = new PointCloud;
+        auto normals = cloud->add_vertex_property<vec3>("v:normal");
+        auto surfaces = cloud->add_vertex_property<int>("v:surface");
+        for (int i = 0; i < num_points; ++i) {
+            const int s = pick(rng);
+            vec3 p, n;
+            if (s < static_cast<int>(quads.size())) {
+                const Quad &q = quads[s];
+                p = q.origin + q.u * uniform(rng) + q.v * uniform(rng);
+                n = normalize(cross(q.u, q.v));
+            } else {
+                const Tower &t = towers[s - quads.size()];
+                const float angle = 2.0f * static_cast<float>(M_PI) * uniform(rng);
+                n = vec3(std::cos(angle), std::sin(angle), 0.0f);
+                p = t.center + t.radius * n + vec3(0, 0, t.height * uniform(rng));
+            }
+            auto v = cloud->add_vertex(p + n * noise(rng));
+            normals[v] = n;
+            surfaces[v] = s;
+        }
+        return cloud;
+    }
+
+
+    // measures the quality of the detected primitives against the surfaces the points were sampled from:
+    //  - assigned: the fraction of the points assigned to a primitive;
+    //  - purity: the fraction of the assigned points that were sampled from the dominant surface of their primitive;
+    //  - completeness: the fraction of the points that are in the largest primitive of their surface.
+    void evaluate(PointCloud *cloud, float &assigned, float &purity, float &completeness) {
+        auto surfaces = cloud->get_vertex_property<int>("v:surface");
+        auto indices = cloud->get_vertex_property<int>("v:primitive_index");
+        std::map<std::pair<int, int>, int> counts;    // (primitive, surface) -> number of points
+        int num_assigned = 0;
+        for (auto v : cloud->vertices()) {
+            if (indices[v] < 0)
+                continue;
+            ++num_assigned;
+            ++counts[std::make_pair(indices[v], surfaces[v])];
+        }
+        std::map<int, int> dominant_of_primitive, largest_of_surface;
+        for (const auto &c : counts) {
+            int &d = dominant_of_primitive[c.first.first];
+            d = std::max(d, c.second);
+            int &l = largest_of_surface[c.first.second];
+            l = std::max(l, c.second);
+        }
+        int num_pure = 0, num_complete = 0;
+        for (const auto &d : dominant_of_primitive)
+            num_pure += d.second;
+        for (const auto &l : largest_of_surface)
+            num_complete += l.second;
+        const float num = static_cast<float>(cloud->n_vertices());
+        assigned = num_assigned / num;
+        purity = num_assigned > 0 ? num_pure / static_cast<float>(num_assigned) : 0.0f;
+        completeness = num_complete / num;
+    }
+
+}
+
+
+bool test_ransac_tiled() {
+    bool success = true;
+
+    PointCloud *cloud = details::city_scan(1000000, 6);
+    PrimitivesRansac ransac;
+    ransac.add_primitive_type(PrimitivesRansac::PLANE);
+    ransac.add_primitive_type(PrimitivesRansac::CYLINDER);
+
+    const unsigned int min_support = 200;
+    const float dist_thresh = 0.001f;
+    std::cout << "  " << cloud->n_vertices() << " points" << std::endl;
+
+    StopWatch w;
+    const int num_single = ransac.detect(cloud, min_support, dist_thresh);
+    const double t_single = w.elapsed_seconds(3);
+    float single_assigned, single_purity, single_completeness;
+    details::evaluate(cloud, single_assigned, single_purity, single_completeness);
+    std::cout << "  single-shot: " << num_single << " primitives, " << t_single << " s ("
+              << cloud->n_vertices() / t_single / 1e6 << " M points/s), assigned " << single_assigned << ", purity "
+              << single_purity << ", completeness " << single_completeness << std::endl;
+
+    w.restart();
+    const int num_tiled = ransac.detect_tiled(cloud, 0.25f, 0.1f, min_support, dist_thresh);
+    const double t_tiled = w.elapsed_seconds(3);
+    float tiled_assigned, tiled_purity, tiled_completeness;
+    details::evaluate(cloud, tiled_assigned, tiled_purity, tiled_completeness);
+    std::cout << "  tiled:       " << num_tiled << " primitives, " << t_tiled << " s ("
+              << cloud->n_vertices() / t_tiled / 1e6 << " M points/s), assigned " << tiled_assigned << ", purity "
+              << tiled_purity << ", completeness " << tiled_completeness << std::endl;
+
+    EXPECT(num_tiled > 0);
+    EXPECT(tiled_assigned > 0.95f * single_assigned);
+    EXPECT(tiled_purity > 0.95f * single_purity);
+    EXPECT(tiled_completeness > 0.9f * single_completeness);
+
+    delete cloud;
+    return success;
+}
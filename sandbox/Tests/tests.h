@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2015 by Liangliang Nan (liangliang.nan@gmail.com)
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++
+ *      library for processing and rendering 3D data. 2018.
+ * ------------------------------------------------------------------
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EASY3D_SANDBOX_TESTS_H
+#define EASY3D_SANDBOX_TESTS_H
+
+#include <iostream>
+
+
+// Tests and benchmarks of the performance-critical parts of Easy3D. Each test returns false if any of its checks
+// failed, and prints its timings to std::cout. The tests marked as "rendering" require an OpenGL context, which is
+// created by the test runner (see main.cpp).
+
+#define EXPECT(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            success = false; \
+        } \
+    } while (0)
+
+
+// algorithms
+bool test_delaunay_queries();
+bool test_ransac_tiled();
+
+// renderer
+bool test_buffers_packing();
+bool test_dirty_ranges();
+bool test_point_cloud_lod();
+bool test_points_lod_drawable();
+bool test_quantization();
+
+
+#endif  // EASY3D_SANDBOX_TESTS_H